@@ -32,7 +32,10 @@ CActiveDeterministicMasternodeManager* activeMasternodeManager{nullptr};
 
 // Definition of static constexpr members (required for ODR-use in C++14)
 constexpr int CActiveDeterministicMasternodeManager::DMM_BLOCK_INTERVAL_SECONDS;
-constexpr int CActiveDeterministicMasternodeManager::DMM_CHECK_INTERVAL_SECONDS;
+constexpr int CActiveDeterministicMasternodeManager::DMM_IDLE_WAIT_SECONDS;
+constexpr int CActiveDeterministicMasternodeManager::DMM_RETRY_MILLIS;
+constexpr int CActiveDeterministicMasternodeManager::DMM_TEMPLATE_LEAD_MILLIS;
+constexpr int CActiveDeterministicMasternodeManager::DMM_TEMPLATE_MAX_AGE_MILLIS;
 constexpr int CActiveDeterministicMasternodeManager::DMM_MISSED_BLOCK_TIMEOUT;
 
 static bool GetLocalAddress(CService& addrRet)
@@ -215,6 +218,13 @@ void CActiveDeterministicMasternodeManager::Init(const CBlockIndex* pindexTip)
     StartDMMScheduler();
 }
 
+CActiveDeterministicMasternodeManager::CActiveDeterministicMasternodeManager() = default;
+
+CActiveDeterministicMasternodeManager::~CActiveDeterministicMasternodeManager()
+{
+    StopDMMScheduler();
+}
+
 void CActiveDeterministicMasternodeManager::Reset(masternode_state_t _state, const CBlockIndex* pindexTip)
 {
     // Stop the scheduler before reset
@@ -269,11 +279,11 @@ void CActiveDeterministicMasternodeManager::UpdatedBlockTip(const CBlockIndex* p
         }
 
         // =============================================
-        // DMM Block Producer Scheduler - Try producing
+        // DMM Block Producer Scheduler - New deadline
         // =============================================
-        // When we receive a new block tip, check if we are the designated
-        // producer for the NEXT block and produce if so
-        TryProducingBlock(pindexNew);
+        // When we receive a new block tip, the scheduler thread computes when
+        // our slot for the NEXT block opens and produces right then
+        WakeDMMScheduler();
 
     } else {
         // MN might have (re)appeared with a new ProTx or we've found some peers
@@ -355,8 +365,8 @@ static int64_t CalculateAlignedBlockTime(const CBlockIndex* pindexPrev, int64_t
     int rawSlot = 1 + (extra / consensus.nHuFallbackRecoverySeconds);
 
     // Clamp to max fallback slots
-    if (rawSlot > 360) {
-        rawSlot = 360;
+    if (rawSlot > mn_consensus::MAX_FALLBACK_SLOTS) {
+        rawSlot = mn_consensus::MAX_FALLBACK_SLOTS;
     }
 
     outSlot = rawSlot;
@@ -512,21 +522,21 @@ bool CActiveDeterministicMasternodeManager::TryProducingBlock(const CBlockIndex*
     // Get payout script from the MN registration (already a CScript)
     CScript scriptPubKey = dmn->pdmnState->scriptPayout;
 
-    // Create block template
+    // Use the template pre-assembled just before our slot, if still fresh
     std::unique_ptr<CBlockTemplate> pblocktemplate;
     {
-        LOCK(cs_main);
-        pblocktemplate = BlockAssembler(Params(), false).CreateNewBlock(
-            scriptPubKey,
-            nullptr,    // pwallet
-            true,       // fMNBlock
-            nullptr,    // availableCoins
-            false,      // fNoMempoolTx
-            false,      // fTestValidity - we'll sign and validate ourselves
-            const_cast<CBlockIndex*>(pindexPrev),
-            false,      // stopOnNewBlock
-            true        // fIncludeQfc
-        );
+        LOCK(cs_dmmTemplate);
+        if (pPreparedTemplate && hashPreparedPrev == pindexPrev->GetBlockHash() &&
+            GetTimeMillis() - nPreparedTimeMillis <= DMM_TEMPLATE_MAX_AGE_MILLIS) {
+            pblocktemplate = std::move(pPreparedTemplate);
+            WITH_LOCK(cs_dmmStats, dmmStats.nTemplatesUsed++);
+        }
+        pPreparedTemplate.reset();
+    }
+
+    // Create block template
+    if (!pblocktemplate) {
+        pblocktemplate = CreateDMMBlockTemplate(pindexPrev, scriptPubKey);
     }
 
     if (!pblocktemplate) {
@@ -570,43 +580,151 @@ bool CActiveDeterministicMasternodeManager::TryProducingBlock(const CBlockIndex*
     }
 }
 
-void CActiveDeterministicMasternodeManager::StartDMMScheduler()
+std::unique_ptr<CBlockTemplate> CActiveDeterministicMasternodeManager::CreateDMMBlockTemplate(const CBlockIndex* pindexPrev, const CScript& scriptPubKey) const
 {
-    if (fDMMSchedulerRunning.load()) {
-        LogPrint(BCLog::MASTERNODE, "DMM-SCHEDULER: Already running\n");
+    LOCK(cs_main);
+    return BlockAssembler(Params(), false).CreateNewBlock(
+        scriptPubKey,
+        nullptr,    // pwallet
+        true,       // fMNBlock
+        nullptr,    // availableCoins
+        false,      // fNoMempoolTx
+        false,      // fTestValidity - we'll sign and validate ourselves
+        const_cast<CBlockIndex*>(pindexPrev),
+        false,      // stopOnNewBlock
+        true        // fIncludeQfc
+    );
+}
+
+void CActiveDeterministicMasternodeManager::PrepareDMMBlockTemplate(const CBlockIndex* pindexPrev)
+{
+    {
+        LOCK(cs_dmmTemplate);
+        if (pPreparedTemplate && hashPreparedPrev == pindexPrev->GetBlockHash()) {
+            return;
+        }
+    }
+
+    CKey operatorKey;
+    CDeterministicMNCPtr dmn;
+    if (!GetOperatorKey(operatorKey, dmn)) {
         return;
     }
 
-    fDMMSchedulerRunning.store(true);
-    LogPrintf("DMM-SCHEDULER: Starting periodic block producer thread (check interval=%ds, block interval=%ds)\n",
-              DMM_CHECK_INTERVAL_SECONDS, DMM_BLOCK_INTERVAL_SECONDS);
-
-    dmmSchedulerThread = std::thread([this]() {
-        while (fDMMSchedulerRunning.load() && !ShutdownRequested()) {
-            // Check frequently (every DMM_CHECK_INTERVAL_SECONDS) to not miss our production window
-            // The fallback rotates every nHuFallbackRecoverySeconds (10s on testnet),
-            // so we need to check more often than that to catch our slot
-            for (int i = 0; i < DMM_CHECK_INTERVAL_SECONDS * 10 && fDMMSchedulerRunning.load() && !ShutdownRequested(); ++i) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+    int64_t nStart = GetTimeMillis();
+    std::unique_ptr<CBlockTemplate> pblocktemplate = CreateDMMBlockTemplate(pindexPrev, dmn->pdmnState->scriptPayout);
+    if (!pblocktemplate) {
+        return;
+    }
+    LogPrint(BCLog::MASTERNODE, "DMM-SCHEDULER: Pre-assembled template for block %d in %dms\n",
+             pindexPrev->nHeight + 1, GetTimeMillis() - nStart);
 
-            if (!fDMMSchedulerRunning.load() || ShutdownRequested()) {
+    LOCK(cs_dmmTemplate);
+    pPreparedTemplate = std::move(pblocktemplate);
+    hashPreparedPrev = pindexPrev->GetBlockHash();
+    nPreparedTimeMillis = GetTimeMillis();
+    WITH_LOCK(cs_dmmStats, dmmStats.nTemplatesPrepared++);
+}
+
+bool CActiveDeterministicMasternodeManager::GetNextLocalSlotTime(const CBlockIndex* pindexPrev, int64_t& nSlotMillisOut) const
+{
+    nSlotMillisOut = 0;
+    if (!pindexPrev || !IsReady()) {
+        return false;
+    }
+
+    const Consensus::Params& consensus = Params().GetConsensus();
+    CDeterministicMNList mnList = deterministicMNManager->GetListForBlock(pindexPrev);
+    auto schedule = mn_consensus::GetBlockProducerSchedule(pindexPrev, mnList);
+    if (schedule->vRanked.empty()) {
+        return false;
+    }
+
+    int64_t nSlotTime = -1;
+    if (pindexPrev->nHeight + 1 <= consensus.nDMMBootstrapHeight) {
+        // Bootstrap: primary producer only, right away
+        if (schedule->vRanked[0].second->proTxHash == info.proTxHash) {
+            nSlotTime = GetTime();
+        }
+    } else {
+        // First slot, from the current one on, that rotates to the local MN
+        const int nCurrentSlot = mn_consensus::GetProducerSlot(pindexPrev, GetTime());
+        const int nLastSlot = std::min(mn_consensus::MAX_FALLBACK_SLOTS, nCurrentSlot + (int)schedule->nCandidates);
+        for (int nSlot = nCurrentSlot; nSlot <= nLastSlot; nSlot++) {
+            if (schedule->vRanked[nSlot % schedule->nCandidates].second->proTxHash == info.proTxHash) {
+                nSlotTime = mn_consensus::GetProducerSlotStartTime(pindexPrev, nSlot);
                 break;
             }
+        }
+    }
+    if (nSlotTime < 0) {
+        return false;
+    }
 
-            // Get current chain tip
-            const CBlockIndex* pindexTip = nullptr;
-            {
-                LOCK(cs_main);
-                pindexTip = chainActive.Tip();
-            }
+    nSlotTime = std::max(nSlotTime, nLastBlockProduced.load() + DMM_BLOCK_INTERVAL_SECONDS);
+    nSlotMillisOut = nSlotTime * 1000;
+    return true;
+}
 
-            if (pindexTip && IsReady()) {
-                TryProducingBlock(pindexTip);
+void CActiveDeterministicMasternodeManager::ThreadDMMScheduler()
+{
+    while (fDMMSchedulerRunning.load() && !ShutdownRequested()) {
+        WITH_LOCK(cs_dmmStats, dmmStats.nWakeups++);
+
+        // Get current chain tip
+        const CBlockIndex* pindexTip = nullptr;
+        {
+            LOCK(cs_main);
+            pindexTip = chainActive.Tip();
+        }
+
+        int64_t nNowMillis = GetTimeMillis();
+        int64_t nWakeMillis = nNowMillis + DMM_IDLE_WAIT_SECONDS * 1000;
+        int64_t nSlotMillis = 0;
+
+        if (pindexTip && IsReady() && GetNextLocalSlotTime(pindexTip, nSlotMillis)) {
+            if (nNowMillis >= nSlotMillis) {
+                // Our slot is open: produce now
+                const int64_t nWakeLatency = nNowMillis - nSlotMillis;
+                if (TryProducingBlock(pindexTip)) {
+                    LOCK(cs_dmmStats);
+                    dmmStats.nBlocksProduced++;
+                    dmmStats.wake.Add(nWakeLatency);
+                    dmmStats.submit.Add(GetTimeMillis() - nSlotMillis);
+                }
+                // The new tip wakes us up; retry soon if production failed
+                nWakeMillis = GetTimeMillis() + DMM_RETRY_MILLIS;
+            } else if (nNowMillis >= nSlotMillis - DMM_TEMPLATE_LEAD_MILLIS) {
+                // Just before our slot: assemble the block now, sign it at the deadline
+                PrepareDMMBlockTemplate(pindexTip);
+                nWakeMillis = nSlotMillis;
+            } else {
+                nWakeMillis = std::min(nWakeMillis, nSlotMillis - DMM_TEMPLATE_LEAD_MILLIS);
             }
         }
-        LogPrintf("DMM-SCHEDULER: Periodic thread stopped\n");
-    });
+
+        WAIT_LOCK(cs_dmmScheduler, lock);
+        cvDMMScheduler.wait_until(lock, std::chrono::system_clock::time_point(std::chrono::milliseconds(nWakeMillis)), [this] {
+            return fDMMWakeRequested || !fDMMSchedulerRunning.load() || ShutdownRequested();
+        });
+        fDMMWakeRequested = false;
+    }
+    LogPrintf("DMM-SCHEDULER: Scheduler thread stopped\n");
+}
+
+void CActiveDeterministicMasternodeManager::StartDMMScheduler()
+{
+    if (fDMMSchedulerRunning.load()) {
+        LogPrint(BCLog::MASTERNODE, "DMM-SCHEDULER: Already running\n");
+        return;
+    }
+
+    fDMMSchedulerRunning.store(true);
+    LogPrintf("DMM-SCHEDULER: Starting block producer thread (event driven, block interval=%ds)\n",
+              DMM_BLOCK_INTERVAL_SECONDS);
+
+    dmmSchedulerThread = std::thread(&TraceThread<std::function<void()> >, "dmmsched",
+                                     std::function<void()>(std::bind(&CActiveDeterministicMasternodeManager::ThreadDMMScheduler, this)));
 }
 
 void CActiveDeterministicMasternodeManager::StopDMMScheduler()
@@ -615,15 +733,44 @@ void CActiveDeterministicMasternodeManager::StopDMMScheduler()
         return;
     }
 
-    LogPrintf("DMM-SCHEDULER: Stopping periodic thread...\n");
+    LogPrintf("DMM-SCHEDULER: Stopping scheduler thread...\n");
     fDMMSchedulerRunning.store(false);
+    WakeDMMScheduler();
 
     if (dmmSchedulerThread.joinable()) {
         dmmSchedulerThread.join();
     }
+    WITH_LOCK(cs_dmmTemplate, pPreparedTemplate.reset());
     LogPrintf("DMM-SCHEDULER: Stopped\n");
 }
 
+void CActiveDeterministicMasternodeManager::WakeDMMScheduler()
+{
+    {
+        LOCK(cs_dmmScheduler);
+        fDMMWakeRequested = true;
+    }
+    cvDMMScheduler.notify_one();
+}
+
+CDMMSchedulerStats CActiveDeterministicMasternodeManager::GetDMMSchedulerStats() const
+{
+    LOCK(cs_dmmStats);
+    return dmmStats;
+}
+
+void CDMMLatencyHistogram::Add(int64_t nMs)
+{
+    nMs = std::max<int64_t>(nMs, 0);
+    size_t nBucket = 0;
+    while (nBucket < DMM_LATENCY_BUCKETS_MS.size() && nMs > DMM_LATENCY_BUCKETS_MS[nBucket]) {
+        nBucket++;
+    }
+    vCounts[nBucket]++;
+    nCount++;
+    nTotalMs += nMs;
+    nMaxMs = std::max(nMaxMs, nMs);
+}
 
 // ============================================================================
 // DMN-Only Helper Functions (Legacy system removed)
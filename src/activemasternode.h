@@ -13,10 +13,14 @@
 #include "sync.h"
 #include "validationinterface.h"
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <thread>
 
 class CActiveDeterministicMasternodeManager;
+struct CBlockTemplate;
 
 extern CActiveDeterministicMasternodeManager* activeMasternodeManager;
 
@@ -28,6 +32,31 @@ struct CActiveMasternodeInfo
     CService service;
 };
 
+/** Upper bounds (ms) of the DMM slot latency histogram buckets (last bucket: above) */
+static const std::array<int64_t, 8> DMM_LATENCY_BUCKETS_MS{{10, 50, 100, 250, 500, 1000, 2500, 5000}};
+
+/** Latency histogram of the DMM scheduler, relative to the opening of the local MN's slot */
+struct CDMMLatencyHistogram
+{
+    std::array<uint64_t, DMM_LATENCY_BUCKETS_MS.size() + 1> vCounts{};
+    uint64_t nCount{0};
+    int64_t nTotalMs{0};
+    int64_t nMaxMs{0};
+
+    void Add(int64_t nMs);
+};
+
+/** DMM scheduler statistics (getdmmschedulerstats) */
+struct CDMMSchedulerStats
+{
+    uint64_t nWakeups{0};           // scheduler loop iterations
+    uint64_t nBlocksProduced{0};
+    uint64_t nTemplatesPrepared{0};
+    uint64_t nTemplatesUsed{0};     // pre-assembled template used at the slot
+    CDMMLatencyHistogram wake;      // slot open -> production started
+    CDMMLatencyHistogram submit;    // slot open -> block accepted locally (ready to relay)
+};
+
 class CActiveDeterministicMasternodeManager : public CValidationInterface
 {
 public:
@@ -51,11 +80,40 @@ private:
     std::atomic<bool> fDMMSchedulerRunning{false};
     std::thread dmmSchedulerThread;
     static constexpr int DMM_BLOCK_INTERVAL_SECONDS = 60;    // Minimum time between blocks we produce
-    static constexpr int DMM_CHECK_INTERVAL_SECONDS = 5;     // How often to check if we should produce
+    static constexpr int DMM_IDLE_WAIT_SECONDS = 30;         // Re-evaluation interval without any event
+    static constexpr int DMM_RETRY_MILLIS = 1000;            // Retry delay when our slot is open but production failed
+    static constexpr int DMM_TEMPLATE_LEAD_MILLIS = 500;     // Pre-assemble the block template this early
+    static constexpr int DMM_TEMPLATE_MAX_AGE_MILLIS = 2000; // Older pre-assembled templates are rebuilt
     static constexpr int DMM_MISSED_BLOCK_TIMEOUT = 90;
 
+    // Scheduler wake-up (tip change, finality, stop)
+    Mutex cs_dmmScheduler;
+    std::condition_variable cvDMMScheduler;
+    bool fDMMWakeRequested{false};
+
+    // Block template pre-assembled before our slot
+    Mutex cs_dmmTemplate;
+    std::unique_ptr<CBlockTemplate> pPreparedTemplate;
+    uint256 hashPreparedPrev;
+    int64_t nPreparedTimeMillis{0};
+
+    mutable Mutex cs_dmmStats;
+    CDMMSchedulerStats dmmStats;
+
+    /**
+     * Time (ms) at which the next slot of the local MN opens for the block
+     * after pindexPrev, also honoring DMM_BLOCK_INTERVAL_SECONDS.
+     * @return false if no slot of the local MN is reachable
+     */
+    bool GetNextLocalSlotTime(const CBlockIndex* pindexPrev, int64_t& nSlotMillisOut) const;
+
+    std::unique_ptr<CBlockTemplate> CreateDMMBlockTemplate(const CBlockIndex* pindexPrev, const CScript& scriptPubKey) const;
+    void PrepareDMMBlockTemplate(const CBlockIndex* pindexPrev);
+    void ThreadDMMScheduler();
+
 public:
-    ~CActiveDeterministicMasternodeManager() override { StopDMMScheduler(); }
+    CActiveDeterministicMasternodeManager();
+    ~CActiveDeterministicMasternodeManager() override;
     void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
 
     void Init(const CBlockIndex* pindexTip);
@@ -86,6 +144,11 @@ public:
 
     void StartDMMScheduler();
     void StopDMMScheduler();
+
+    /** Re-evaluate the next local slot now (new tip, finality reached) */
+    void WakeDMMScheduler();
+
+    CDMMSchedulerStats GetDMMSchedulerStats() const;
 };
 
 bool GetActiveMasternodeKeys(CTxIn& vin, Optional<CKey>& key, CKey& operatorKey);
@@ -0,0 +1,139 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "checkqueue.h"
+#include "key.h"
+#include "piv2/piv2_finality.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <cassert>
+
+// Finality certificates as found in the blocks downloaded during sync: a
+// 12 member quorum, 8 signers per certificate. A batch of certificates is
+// checked on a CCheckQueue with 1/2/4/8 threads, like the HU verification
+// workers do with the certificates of the connected blocks.
+
+static const int CERT_QUORUM_SIZE = 12;
+static const int CERT_SIGNERS = 8;
+static const size_t CERT_BATCH_SIZE = 64;
+
+struct CertBatch {
+    std::vector<std::pair<uint256, CPubKey>> vQuorum;
+    std::vector<uint256> vBlockHashes;
+    std::vector<CBlockFinalityCert> vCerts;
+};
+
+static const CertBatch& GetCertBatch()
+{
+    static CertBatch batch;
+    if (!batch.vCerts.empty()) {
+        return batch;
+    }
+
+    std::vector<CKey> vKeys;
+    for (int i = 0; i < CERT_QUORUM_SIZE; i++) {
+        CKey key;
+        key.MakeNewKey(true);
+        vKeys.push_back(key);
+        batch.vQuorum.emplace_back(::SerializeHash(i), key.GetPubKey());
+    }
+    for (size_t n = 0; n < CERT_BATCH_SIZE; n++) {
+        const uint256 blockHash = ::SerializeHash(std::make_pair(std::string("block"), (int)n));
+        const uint256 msgHash = hu::GetHuSignatureHash(blockHash);
+        CBlockFinalityCert cert;
+        for (int i = 0; i < CERT_SIGNERS; i++) {
+            // A different subset of the quorum for each block
+            const int nIndex = (i + (int)n) % CERT_QUORUM_SIZE;
+            cert.nSigners |= uint64_t{1} << nIndex;
+        }
+        for (int i = 0; i < CERT_QUORUM_SIZE; i++) {
+            if (!((cert.nSigners >> i) & 1)) continue;
+            std::vector<unsigned char> vchSig;
+            bool fSigned = vKeys[i].SignCompact(msgHash, vchSig);
+            assert(fSigned);
+            cert.vSigs.push_back(vchSig);
+        }
+        batch.vBlockHashes.push_back(blockHash);
+        batch.vCerts.push_back(cert);
+    }
+    return batch;
+}
+
+class CCertCheck
+{
+private:
+    const CBlockFinalityCert* cert{nullptr};
+    uint256 blockHash;
+    const std::vector<std::pair<uint256, CPubKey>>* vQuorum{nullptr};
+
+public:
+    CCertCheck() {}
+    CCertCheck(const CBlockFinalityCert& certIn, const uint256& blockHashIn, const std::vector<std::pair<uint256, CPubKey>>& vQuorumIn) :
+        cert(&certIn), blockHash(blockHashIn), vQuorum(&vQuorumIn) {}
+
+    bool operator()()
+    {
+        std::vector<std::pair<hu::CHuSignature, int>> vSigs;
+        return hu::CheckFinalityCert(*cert, blockHash, *vQuorum, vSigs);
+    }
+
+    void swap(CCertCheck& check)
+    {
+        std::swap(cert, check.cert);
+        std::swap(blockHash, check.blockHash);
+        std::swap(vQuorum, check.vQuorum);
+    }
+};
+
+// One certificate at a time, on the calling thread
+static void FinalityCertVerify(benchmark::State& state)
+{
+    const CertBatch& batch = GetCertBatch();
+    std::vector<std::pair<hu::CHuSignature, int>> vSigs;
+    size_t n = 0;
+    while (state.KeepRunning()) {
+        bool fValid = hu::CheckFinalityCert(batch.vCerts[n], batch.vBlockHashes[n], batch.vQuorum, vSigs);
+        assert(fValid);
+        n = (n + 1) % batch.vCerts.size();
+    }
+}
+
+static void FinalityCertBatchBench(benchmark::State& state, int nThreads)
+{
+    const CertBatch& batch = GetCertBatch();
+
+    CCheckQueue<CCertCheck> queue(4);
+    boost::thread_group tg;
+    for (int i = 0; i < nThreads - 1; i++) {
+        tg.create_thread([&]{ queue.Thread(); });
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<CCertCheck> vChecks;
+        vChecks.reserve(batch.vCerts.size());
+        for (size_t n = 0; n < batch.vCerts.size(); n++) {
+            vChecks.emplace_back(batch.vCerts[n], batch.vBlockHashes[n], batch.vQuorum);
+        }
+        CCheckQueueControl<CCertCheck> control(&queue);
+        control.Add(vChecks);
+        bool fValid = control.Wait();
+        assert(fValid);
+    }
+
+    tg.interrupt_all();
+    tg.join_all();
+}
+
+static void FinalityCertBatch1Thread(benchmark::State& state) { FinalityCertBatchBench(state, 1); }
+static void FinalityCertBatch2Threads(benchmark::State& state) { FinalityCertBatchBench(state, 2); }
+static void FinalityCertBatch4Threads(benchmark::State& state) { FinalityCertBatchBench(state, 4); }
+static void FinalityCertBatch8Threads(benchmark::State& state) { FinalityCertBatchBench(state, 8); }
+
+BENCHMARK(FinalityCertVerify, 200);
+BENCHMARK(FinalityCertBatch1Thread, 5);
+BENCHMARK(FinalityCertBatch2Threads, 10);
+BENCHMARK(FinalityCertBatch4Threads, 20);
+BENCHMARK(FinalityCertBatch8Threads, 30);
@@ -0,0 +1,103 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chainparams.h"
+#include "piv2/piv2_state.h"
+#include "piv2/piv2_validation.h"
+#include "piv2/piv2_yield.h"
+#include "piv2/zkpiv2_db.h"
+#include "piv2/zkpiv2_note.h"
+#include "random.h"
+
+#include <cassert>
+
+// Compares the daily yield engines on a synthetic locked-note set:
+// - legacy: scan every note and rewrite Ur_accumulated of each mature one
+// - accumulator: promote one interval of maturity buckets and bump yield_index
+static const size_t YIELD_BENCH_NOTES = 1000000;
+// Share of notes that mature inside the benchmarked yield interval
+static const size_t YIELD_BENCH_MATURING_DIVISOR = 100;
+
+static const uint32_t YIELD_BENCH_BASE_HEIGHT = 100000;
+
+static HuGlobalState g_yield_bench_state;
+
+static void SetupYieldBenchNotes()
+{
+    static bool fInitialized = false;
+    if (fInitialized) return;
+    fInitialized = true;
+
+    SelectParams(CBaseChainParams::REGTEST);
+    assert(InitZKHUDB(1 << 26, true, true /* fMemory */));
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+
+    const uint32_t nInterval = khu_yield::GetYieldInterval();
+    const uint32_t nMaturity = khu_yield::GetMaturityBlocks();
+
+    // Steady state: every note older than the last yield is already counted
+    g_yield_bench_state.SetNull();
+    g_yield_bench_state.R_annual = 4000;
+    g_yield_bench_state.last_yield_update_height = YIELD_BENCH_BASE_HEIGHT;
+    g_yield_bench_state.yield_index = 1000 * khu_yield::GetYieldIndexIncrement(4000);
+
+    FastRandomContext rng(true);
+    for (size_t i = 0; i < YIELD_BENCH_NOTES; ++i) {
+        const bool fMaturing = (i % YIELD_BENCH_MATURING_DIVISOR) == 0;
+        const uint32_t nLockHeight = fMaturing ?
+            YIELD_BENCH_BASE_HEIGHT - nMaturity + 1 + rng.randrange(nInterval) :
+            1 + rng.randrange(YIELD_BENCH_BASE_HEIGHT - nMaturity);
+        ZKHUNoteData note(100 * COIN + rng.randrange(10000 * COIN), nLockHeight, 0, rng.rand256(), rng.rand256());
+
+        assert(zkhuDB->WriteNote(note.cm, note));
+        assert(khu_yield::AddNoteToYieldIndex(note, g_yield_bench_state));
+        g_yield_bench_state.Z += note.amount;
+    }
+    g_yield_bench_state.C = g_yield_bench_state.Z;
+
+    // Yield epoch at the last yield height (index history for UNLOCK)
+    assert(zkhuDB->WriteYieldEpoch(YIELD_BENCH_BASE_HEIGHT, ZKHUYieldEpoch(0, 0, 4000)));
+
+    zkhuDB->CommitCurTransaction();
+    assert(zkhuDB->CommitRootTransaction(uint256()));
+}
+
+static void KHUYieldLegacyPerNote(benchmark::State& state)
+{
+    SetupYieldBenchNotes();
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    const uint32_t nHeight = YIELD_BENCH_BASE_HEIGHT + khu_yield::GetYieldInterval();
+
+    while (state.KeepRunning()) {
+        CAmount totalYield = 0;
+        zkhuDB->IterateNotes([&](const uint256& noteId, const ZKHUNoteData& note) {
+            if (note.bSpent || !khu_yield::IsNoteMature(note.nLockStartHeight, nHeight)) return true;
+            const CAmount dailyYield = khu_yield::CalculateDailyYieldForNote(note.amount, 4000);
+            totalYield += dailyYield;
+            ZKHUNoteData updatedNote = note;
+            updatedNote.Ur_accumulated += dailyYield;
+            return zkhuDB->WriteNote(noteId, updatedNote);
+        });
+        assert(totalYield > 0);
+        zkhuDB->CommitCurTransaction();
+        assert(zkhuDB->CommitRootTransaction(uint256()));
+    }
+}
+
+static void KHUYieldAccumulator(benchmark::State& state)
+{
+    SetupYieldBenchNotes();
+    const uint32_t nHeight = YIELD_BENCH_BASE_HEIGHT + khu_yield::GetYieldInterval();
+
+    while (state.KeepRunning()) {
+        // Connect + disconnect of one yield block
+        HuGlobalState huState = g_yield_bench_state;
+        assert(khu_yield::ApplyDailyYield(huState, nHeight, 0));
+        assert(khu_yield::UndoDailyYield(huState, nHeight, 0));
+    }
+}
+
+BENCHMARK(KHUYieldLegacyPerNote, 1);
+BENCHMARK(KHUYieldAccumulator, 20000);
@@ -0,0 +1,42 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench/bench.h"
+
+#include "fs.h"
+#include "logging.h"
+#include "uint256.h"
+
+// Cost of a -debug=hu line for the thread logging it, written to a file
+// synchronously or queued for the writer thread.
+
+static void LoggingBench(benchmark::State& state, bool fAsync)
+{
+    const fs::path dir = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(dir);
+    {
+        BCLog::Logger logger;
+        logger.m_print_to_file = true;
+        logger.m_log_time_micros = true;
+        logger.m_file_path = dir / "debug.log";
+        assert(logger.OpenDebugLog());
+        if (fAsync) {
+            logger.StartAsync(DEFAULT_LOGBUFFERSIZE, true);
+        }
+
+        const uint256 hash = uint256S("0x9c1f2a6dbd4e5a1f0e6c28a5f2b3c1d4e5f60718293a4b5c6d7e8f9001122334");
+        int64_t n = 0;
+        while (state.KeepRunning()) {
+            logger.LogPrintStr(strprintf("%s: note %s:%d locked, amount=%d, height=%d\n", "ApplyHULock", hash.ToString(), n % 4, n * 1000, 1234567));
+            n++;
+        }
+    }
+    fs::remove_all(dir);
+}
+
+static void LoggingSync(benchmark::State& state) { LoggingBench(state, false); }
+static void LoggingAsync(benchmark::State& state) { LoggingBench(state, true); }
+
+BENCHMARK(LoggingSync, 100000);
+BENCHMARK(LoggingAsync, 100000);
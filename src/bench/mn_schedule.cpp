@@ -0,0 +1,102 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "evo/blockproducer.h"
+#include "evo/deterministicmns.h"
+#include "hash.h"
+#include "piv2/piv2_quorum.h"
+
+#include <cassert>
+
+// Producer / HU quorum selection over synthetic MN lists:
+// - full: hash every MN and sort them all (CalculateBlockProducerScores)
+// - schedule: top-k selection, recomputed on every call (cache cleared)
+// - cached: memoized schedule lookup (what header and signature checks hit)
+
+static CDeterministicMNList MakeBenchMNList(size_t nCount, const uint256& listBlockHash)
+{
+    CDeterministicMNList mnList(listBlockHash, 100, 0);
+    for (size_t i = 0; i < nCount; i++) {
+        const uint256 seed = Hash(BEGIN(i), END(i));
+        auto state = std::make_shared<CDeterministicMNState>();
+        std::vector<unsigned char> vchPubKey(seed.begin(), seed.end());
+        vchPubKey.insert(vchPubKey.begin(), 0x02);
+        state->pubKeyOperator = CPubKey(vchPubKey);
+        state->keyIDOwner = CKeyID(uint160(std::vector<unsigned char>(seed.begin(), seed.begin() + 20)));
+        state->UpdateConfirmedHash(seed, listBlockHash);
+
+        auto dmn = std::make_shared<CDeterministicMN>(i);
+        dmn->proTxHash = seed;
+        dmn->collateralOutpoint = COutPoint(seed, 0);
+        dmn->nOperatorReward = 0;
+        dmn->pdmnState = state;
+        mnList.AddMN(dmn);
+    }
+    return mnList;
+}
+
+enum class ScheduleBenchMode { FULL, SCHEDULE, CACHED, QUORUM, QUORUM_CACHED };
+
+static void MNScheduleBench(benchmark::State& state, size_t nMNs, ScheduleBenchMode mode)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const uint256 prevHash = uint256S("0xabcdef1234567890abcdef1234567890abcdef1234567890abcdef1234567890");
+    const CDeterministicMNList mnList = MakeBenchMNList(nMNs, prevHash);
+    CBlockIndex indexPrev;
+    indexPrev.phashBlock = &prevHash;
+    indexPrev.nHeight = 100;
+
+    mn_consensus::ClearBlockProducerScheduleCache();
+    hu::ClearHuQuorumCache();
+    while (state.KeepRunning()) {
+        switch (mode) {
+        case ScheduleBenchMode::FULL:
+            assert(mn_consensus::CalculateBlockProducerScores(&indexPrev, mnList).size() == nMNs);
+            break;
+        case ScheduleBenchMode::SCHEDULE:
+            mn_consensus::ClearBlockProducerScheduleCache();
+            // fall through
+        case ScheduleBenchMode::CACHED:
+            assert(mn_consensus::GetBlockProducerSchedule(&indexPrev, mnList)->nCandidates == nMNs);
+            break;
+        case ScheduleBenchMode::QUORUM:
+            hu::ClearHuQuorumCache();
+            // fall through
+        case ScheduleBenchMode::QUORUM_CACHED:
+            assert(!hu::GetHuQuorum(mnList, 9, prevHash).empty());
+            break;
+        }
+    }
+}
+
+static void MNScheduleFull1k(benchmark::State& state) { MNScheduleBench(state, 1000, ScheduleBenchMode::FULL); }
+static void MNScheduleFull5k(benchmark::State& state) { MNScheduleBench(state, 5000, ScheduleBenchMode::FULL); }
+static void MNScheduleFull20k(benchmark::State& state) { MNScheduleBench(state, 20000, ScheduleBenchMode::FULL); }
+static void MNScheduleTopK1k(benchmark::State& state) { MNScheduleBench(state, 1000, ScheduleBenchMode::SCHEDULE); }
+static void MNScheduleTopK5k(benchmark::State& state) { MNScheduleBench(state, 5000, ScheduleBenchMode::SCHEDULE); }
+static void MNScheduleTopK20k(benchmark::State& state) { MNScheduleBench(state, 20000, ScheduleBenchMode::SCHEDULE); }
+static void MNScheduleCached1k(benchmark::State& state) { MNScheduleBench(state, 1000, ScheduleBenchMode::CACHED); }
+static void MNScheduleCached5k(benchmark::State& state) { MNScheduleBench(state, 5000, ScheduleBenchMode::CACHED); }
+static void MNScheduleCached20k(benchmark::State& state) { MNScheduleBench(state, 20000, ScheduleBenchMode::CACHED); }
+static void HUQuorumTopK1k(benchmark::State& state) { MNScheduleBench(state, 1000, ScheduleBenchMode::QUORUM); }
+static void HUQuorumTopK5k(benchmark::State& state) { MNScheduleBench(state, 5000, ScheduleBenchMode::QUORUM); }
+static void HUQuorumTopK20k(benchmark::State& state) { MNScheduleBench(state, 20000, ScheduleBenchMode::QUORUM); }
+static void HUQuorumCached20k(benchmark::State& state) { MNScheduleBench(state, 20000, ScheduleBenchMode::QUORUM_CACHED); }
+
+BENCHMARK(MNScheduleFull1k, 200);
+BENCHMARK(MNScheduleFull5k, 40);
+BENCHMARK(MNScheduleFull20k, 10);
+BENCHMARK(MNScheduleTopK1k, 200);
+BENCHMARK(MNScheduleTopK5k, 40);
+BENCHMARK(MNScheduleTopK20k, 10);
+BENCHMARK(MNScheduleCached1k, 500000);
+BENCHMARK(MNScheduleCached5k, 500000);
+BENCHMARK(MNScheduleCached20k, 500000);
+BENCHMARK(HUQuorumTopK1k, 200);
+BENCHMARK(HUQuorumTopK5k, 40);
+BENCHMARK(HUQuorumTopK20k, 10);
+BENCHMARK(HUQuorumCached20k, 500000);
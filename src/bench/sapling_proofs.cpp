@@ -0,0 +1,93 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chainparams.h"
+#include "checkqueue.h"
+#include "consensus/validation.h"
+#include "sapling/incrementalmerkletree.h"
+#include "sapling/sapling_validation.h"
+#include "sapling/transaction_builder.h"
+#include "util/system.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <cassert>
+
+// Proof verification of a shielded-heavy block, as done by ContextualCheckBlock:
+// N txs (1 spend, 2 outputs) verified on a CCheckQueue with 1/2/4/8 threads
+// (the caller counts as one, like the -par script-check threads). The shielded
+// proof cache is never set up here, so every iteration verifies the proofs.
+
+static const size_t BLOCK_SHIELDED_TXS = 16;
+
+static const std::vector<CTransaction>& GetShieldedBlockTxs()
+{
+    static std::vector<CTransaction> vTxs;
+    if (!vTxs.empty()) {
+        return vTxs;
+    }
+
+    initZKSNARKS();
+    SelectParams(CBaseChainParams::REGTEST);
+    UpdateNetworkUpgradeParameters(Consensus::UPGRADE_V5_0, 1);
+    const Consensus::Params& consensus = Params().GetConsensus();
+
+    const auto sk = libzcash::SaplingSpendingKey::random();
+    const auto expsk = sk.expanded_spending_key();
+    const auto fvk = sk.full_viewing_key();
+    const auto pa = sk.default_address();
+
+    for (size_t i = 0; i < BLOCK_SHIELDED_TXS; i++) {
+        libzcash::SaplingNote note(pa, 100 * COIN);
+        SaplingMerkleTree tree;
+        tree.append(note.cmu().get());
+
+        auto builder = TransactionBuilder(consensus);
+        builder.SetFee(COIN);
+        builder.AddSaplingSpend(expsk, note, tree.root(), tree.witness());
+        builder.AddSaplingOutput(fvk.ovk, pa, 50 * COIN, {});
+        builder.AddSaplingOutput(fvk.ovk, pa, 49 * COIN, {});
+        vTxs.emplace_back(builder.Build().GetTxOrThrow());
+    }
+    return vTxs;
+}
+
+static void SaplingProofsBench(benchmark::State& state, int nThreads)
+{
+    const std::vector<CTransaction>& vTxs = GetShieldedBlockTxs();
+    const CChainParams& params = Params();
+
+    CCheckQueue<SaplingValidation::CProofCheck> queue(4);
+    boost::thread_group tg;
+    for (int i = 0; i < nThreads - 1; i++) {
+        tg.create_thread([&]{ queue.Thread(); });
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<SaplingValidation::CProofCheck> vChecks;
+        CValidationState valState;
+        for (const CTransaction& tx : vTxs) {
+            bool fValid = SaplingValidation::ContextualCheckTransaction(tx, valState, params, 2, true, false, &vChecks);
+            assert(fValid);
+        }
+        CCheckQueueControl<SaplingValidation::CProofCheck> control(&queue);
+        control.Add(vChecks);
+        bool fProofsValid = control.Wait();
+        assert(fProofsValid);
+    }
+
+    tg.interrupt_all();
+    tg.join_all();
+}
+
+static void SaplingProofsBlock1Thread(benchmark::State& state) { SaplingProofsBench(state, 1); }
+static void SaplingProofsBlock2Threads(benchmark::State& state) { SaplingProofsBench(state, 2); }
+static void SaplingProofsBlock4Threads(benchmark::State& state) { SaplingProofsBench(state, 4); }
+static void SaplingProofsBlock8Threads(benchmark::State& state) { SaplingProofsBench(state, 8); }
+
+BENCHMARK(SaplingProofsBlock1Thread, 5);
+BENCHMARK(SaplingProofsBlock2Threads, 10);
+BENCHMARK(SaplingProofsBlock4Threads, 20);
+BENCHMARK(SaplingProofsBlock8Threads, 30);
@@ -0,0 +1,89 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "sapling/sapling_trialdecrypt.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <cassert>
+#include <map>
+
+// Wallet scan of a shielded-heavy block: every output is trial-decrypted with
+// every ivk of the wallet, on a CCheckQueue with 1 or 8 threads. One output in
+// a hundred is ours, so nearly all the attempts fail, like in a real scan.
+// The 10,000 ivk case scans 10 outputs instead of 1,000: the same number of
+// attempts as the 100 ivk case, to keep an iteration within seconds.
+
+static const size_t BLOCK_SHIELDED_OUTPUTS = 1000;
+
+static const std::vector<libzcash::SaplingIncomingViewingKey>& GetWalletIvks(size_t nIvks)
+{
+    static std::map<size_t, std::vector<libzcash::SaplingIncomingViewingKey>> mapIvks;
+    auto& vIvks = mapIvks[nIvks];
+    while (vIvks.size() < nIvks) {
+        vIvks.emplace_back(libzcash::SaplingSpendingKey::random().full_viewing_key().in_viewing_key());
+    }
+    return vIvks;
+}
+
+static std::vector<OutputDescription> GetBlockOutputs(const libzcash::SaplingIncomingViewingKey& ivk, size_t nOutputs)
+{
+    // About half of the diversifiers are valid: take the first one
+    diversifier_t d = {};
+    Optional<libzcash::SaplingPaymentAddress> ourAddr;
+    while (!(ourAddr = ivk.address(d))) {
+        d[0]++;
+    }
+    const std::array<unsigned char, ZC_MEMO_SIZE> memo = {{0xF6}};
+
+    std::vector<OutputDescription> vOutputs;
+    for (size_t n = 0; n < nOutputs; n++) {
+        const auto addr = (n % 100 == 0) ? *ourAddr : libzcash::SaplingSpendingKey::random().default_address();
+        libzcash::SaplingNote note(addr, 100 * COIN);
+        auto res = libzcash::SaplingNotePlaintext(note, memo).encrypt(addr.pk_d);
+        assert(res);
+        OutputDescription output;
+        output.cmu = *note.cmu();
+        output.ephemeralKey = res->second.get_epk();
+        output.encCiphertext = res->first;
+        vOutputs.emplace_back(output);
+    }
+    return vOutputs;
+}
+
+static void SaplingTrialDecryptBench(benchmark::State& state, size_t nIvks, size_t nOutputs, int nThreads)
+{
+    // Our outputs are to the last ivk: they are found after trying all the others
+    const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks = GetWalletIvks(nIvks);
+    const std::vector<OutputDescription> vOutputs = GetBlockOutputs(vIvks.back(), nOutputs);
+
+    CCheckQueue<CSaplingTrialDecryptCheck> queue(8);
+    boost::thread_group tg;
+    for (int i = 0; i < nThreads - 1; i++) {
+        tg.create_thread([&]{ queue.Thread(); });
+    }
+
+    while (state.KeepRunning()) {
+        const auto vResults = TrialDecryptSaplingOutputs(vOutputs, vIvks, &queue);
+        assert(vResults[0] && vResults[0]->nIvk == nIvks - 1);
+    }
+
+    tg.interrupt_all();
+    tg.join_all();
+}
+
+static void SaplingTrialDecrypt1Ivk1Thread(benchmark::State& state) { SaplingTrialDecryptBench(state, 1, BLOCK_SHIELDED_OUTPUTS, 1); }
+static void SaplingTrialDecrypt1Ivk8Threads(benchmark::State& state) { SaplingTrialDecryptBench(state, 1, BLOCK_SHIELDED_OUTPUTS, 8); }
+static void SaplingTrialDecrypt100Ivks1Thread(benchmark::State& state) { SaplingTrialDecryptBench(state, 100, BLOCK_SHIELDED_OUTPUTS, 1); }
+static void SaplingTrialDecrypt100Ivks8Threads(benchmark::State& state) { SaplingTrialDecryptBench(state, 100, BLOCK_SHIELDED_OUTPUTS, 8); }
+static void SaplingTrialDecrypt10000Ivks1Thread(benchmark::State& state) { SaplingTrialDecryptBench(state, 10000, 10, 1); }
+static void SaplingTrialDecrypt10000Ivks8Threads(benchmark::State& state) { SaplingTrialDecryptBench(state, 10000, 10, 8); }
+
+BENCHMARK(SaplingTrialDecrypt1Ivk1Thread, 20);
+BENCHMARK(SaplingTrialDecrypt1Ivk8Threads, 100);
+BENCHMARK(SaplingTrialDecrypt100Ivks1Thread, 1);
+BENCHMARK(SaplingTrialDecrypt100Ivks8Threads, 2);
+BENCHMARK(SaplingTrialDecrypt10000Ivks1Thread, 1);
+BENCHMARK(SaplingTrialDecrypt10000Ivks8Threads, 2);
@@ -18,6 +18,7 @@
 #include "consensus/validation.h"
 #include "evo/blockproducer.h"
 #include "masternode-payments.h"
+#include "piv2/piv2_finality.h"
 #include "policy/policy.h"
 #include "piv2_chainwork.h"
 #include "primitives/transaction.h"
@@ -241,6 +242,12 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
 
     (void)fIncludeQfc; // Suppress unused parameter warning
 
+    // DMM: carry the quorum signatures of the parent (producing requires its finality)
+    if (pblock->nVersion >= FINALITY_CERT_BLOCK_VERSION && hu::huFinalityHandler &&
+        hu::huFinalityHandler->GetFinalityCert(pindexPrev->GetBlockHash(), chainparams.GetConsensus().nHuQuorumThreshold, pblock->finalityCert)) {
+        nBlockSize += ::GetSerializeSize(pblock->finalityCert, PROTOCOL_VERSION);
+    }
+
     if (!fNoMempoolTx) {
         // Add transactions from mempool
         LOCK2(cs_main,mempool.cs);
@@ -619,7 +626,7 @@ void IncrementExtraNonce(std::shared_ptr<CBlock>& pblock, int nHeight, unsigned
 int32_t ComputeBlockVersion(const Consensus::Params& consensus, int nHeight)
 {
     if (NetworkUpgradeActive(nHeight, consensus, Consensus::UPGRADE_V5_0)) {
-        return CBlockHeader::CURRENT_VERSION;       // v11 (since 5.2.99)
+        return CBlockHeader::CURRENT_VERSION;       // v12 (finality certificate)
     } else if (consensus.NetworkUpgradeActive(nHeight, Consensus::UPGRADE_V4_0)) {
         return 7;
     } else if (consensus.NetworkUpgradeActive(nHeight, Consensus::UPGRADE_V3_4)) {
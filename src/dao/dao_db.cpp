@@ -0,0 +1,168 @@
+// Copyright (c) 2025 The PIVHU developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "dao/dao_db.h"
+
+#include "clientversion.h"
+#include "util/system.h"
+
+#include <vector>
+
+static const char DB_DAO_PROPOSAL = 'P';
+static const char DB_DAO_PROPOSAL_CYCLE = 'H';
+static const char DB_DAO_TALLY = 'T';
+static const char DB_DAO_VOTE = 'V';
+static const char DB_DAO_PAID = 'X';
+
+typedef std::pair<char, std::pair<CDAOCycleKey, uint256>> DAOCycleHashKey;
+
+static DAOCycleHashKey ProposalKey(uint32_t nCycleStart, const uint256& hash)
+{
+    return std::make_pair(DB_DAO_PROPOSAL, std::make_pair(CDAOCycleKey(nCycleStart), hash));
+}
+
+static DAOCycleHashKey PaidKey(uint32_t nCycleStart, const uint256& hash)
+{
+    return std::make_pair(DB_DAO_PAID, std::make_pair(CDAOCycleKey(nCycleStart), hash));
+}
+
+static std::pair<char, std::pair<uint256, uint256>> VoteKey(const uint256& proposalHash, const uint256& proTxHash)
+{
+    return std::make_pair(DB_DAO_VOTE, std::make_pair(proposalHash, proTxHash));
+}
+
+CDAODB::CDAODB(size_t nCacheSize, bool fMemory, bool fWipe) :
+    CKHUTransactionalDB(GetDataDir() / "khu" / "dao", nCacheSize, fMemory, fWipe)
+{
+}
+
+// ============================================================================
+// Proposals and votes
+// ============================================================================
+
+bool CDAODB::WriteProposal(const CDAOProposal& proposal)
+{
+    LOCK(cs);
+    CDBBatch batch(CLIENT_VERSION);
+    batch.Write(ProposalKey(proposal.nCycleStart, proposal.hash), proposal);
+    batch.Write(std::make_pair(DB_DAO_PROPOSAL_CYCLE, proposal.hash), proposal.nCycleStart);
+    batch.Write(std::make_pair(DB_DAO_TALLY, proposal.hash), CDAOTally());
+    return WriteBatch(batch);
+}
+
+bool CDAODB::ReadProposal(const uint256& hash, CDAOProposal& proposal)
+{
+    uint32_t nCycleStart;
+    if (!Read(std::make_pair(DB_DAO_PROPOSAL_CYCLE, hash), nCycleStart) ||
+        !Read(ProposalKey(nCycleStart, hash), proposal)) {
+        return false;
+    }
+    proposal.hash = hash;
+    return true;
+}
+
+bool CDAODB::HaveProposal(const uint256& hash)
+{
+    return Exists(std::make_pair(DB_DAO_PROPOSAL_CYCLE, hash));
+}
+
+bool CDAODB::ReadTally(const uint256& hash, CDAOTally& tally)
+{
+    return Read(std::make_pair(DB_DAO_TALLY, hash), tally);
+}
+
+bool CDAODB::WriteVote(const CDAOVote& vote)
+{
+    LOCK(cs);
+    CDAOTally tally;
+    if (!ReadTally(vote.proposalHash, tally)) {
+        return error("%s: no tally for proposal %s", __func__, vote.proposalHash.ToString());
+    }
+
+    const auto key = VoteKey(vote.proposalHash, vote.proTxHash);
+    CDAOVote prev;
+    if (Read(key, prev)) {
+        tally.Add(prev.vote, -1);
+    }
+    tally.Add(vote.vote, 1);
+
+    CDBBatch batch(CLIENT_VERSION);
+    batch.Write(key, vote);
+    batch.Write(std::make_pair(DB_DAO_TALLY, vote.proposalHash), tally);
+    return WriteBatch(batch);
+}
+
+bool CDAODB::EraseProposal(const uint256& hash)
+{
+    LOCK(cs);
+    uint32_t nCycleStart;
+    if (!Read(std::make_pair(DB_DAO_PROPOSAL_CYCLE, hash), nCycleStart)) {
+        return true;
+    }
+
+    std::vector<uint256> vVoters;
+    ForEachVote(hash, [&](const CDAOVote& vote) {
+        vVoters.push_back(vote.proTxHash);
+        return true;
+    });
+
+    CDBBatch batch(CLIENT_VERSION);
+    for (const uint256& proTxHash : vVoters) {
+        batch.Erase(VoteKey(hash, proTxHash));
+    }
+    batch.Erase(std::make_pair(DB_DAO_TALLY, hash));
+    batch.Erase(std::make_pair(DB_DAO_PROPOSAL_CYCLE, hash));
+    batch.Erase(ProposalKey(nCycleStart, hash));
+    return WriteBatch(batch);
+}
+
+// ============================================================================
+// Payout markers
+// ============================================================================
+
+bool CDAODB::IsPaid(uint32_t nCycleStart, const uint256& hash)
+{
+    return Exists(PaidKey(nCycleStart, hash));
+}
+
+bool CDAODB::WritePaid(uint32_t nCycleStart, const uint256& hash, int nHeight)
+{
+    return Write(PaidKey(nCycleStart, hash), nHeight);
+}
+
+bool CDAODB::UndoPaid(uint32_t nCycleStart, int nHeight)
+{
+    LOCK(cs);
+    std::vector<uint256> vPaid;
+    IteratePrefix<CDAOCycleKey, std::pair<CDAOCycleKey, uint256>, int>(DB_DAO_PAID, CDAOCycleKey(nCycleStart),
+        [&](const std::pair<CDAOCycleKey, uint256>& key, int nPaidHeight) {
+            if (key.first.nCycleStart != nCycleStart) return false;
+            if (nPaidHeight == nHeight) vPaid.push_back(key.second);
+            return true;
+        });
+    for (const uint256& hash : vPaid) {
+        Erase(PaidKey(nCycleStart, hash));
+    }
+    return true;
+}
+
+bool CDAODB::WipePaid()
+{
+    LOCK(cs);
+    std::vector<DAOCycleHashKey> vKeys;
+    IteratePrefix<CDAOCycleKey, std::pair<CDAOCycleKey, uint256>, int>(DB_DAO_PAID, CDAOCycleKey(0),
+        [&](const std::pair<CDAOCycleKey, uint256>& key, int) {
+            vKeys.emplace_back(DB_DAO_PAID, key);
+            return true;
+        });
+    if (vKeys.empty()) {
+        return true;
+    }
+
+    CDBBatch batch(CLIENT_VERSION);
+    for (const auto& key : vKeys) {
+        batch.Erase(key);
+    }
+    return WriteBatch(batch, true);
+}
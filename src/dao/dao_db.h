@@ -0,0 +1,187 @@
+// Copyright (c) 2025 The PIVHU developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PIVHU_DAO_DB_H
+#define PIVHU_DAO_DB_H
+
+#include "dao/dao_proposal.h"
+#include "piv2/piv2_dbtransaction.h"
+
+#include <limits>
+#include <stdint.h>
+
+/** Running vote counters of a proposal, updated by every stored vote */
+struct CDAOTally
+{
+    int32_t nYes{0};
+    int32_t nNo{0};
+
+    void Add(DAOVote vote, int nDelta)
+    {
+        if (vote == DAOVote::YES) nYes += nDelta;
+        else if (vote == DAOVote::NO) nNo += nDelta;
+    }
+
+    SERIALIZE_METHODS(CDAOTally, obj) { READWRITE(obj.nYes, obj.nNo); }
+};
+
+/** Cycle start serialized big endian, so that the cycles sort by height on disk */
+struct CDAOCycleKey
+{
+    uint32_t nCycleStart;
+
+    explicit CDAOCycleKey(uint32_t nCycleStartIn = 0) : nCycleStart(nCycleStartIn) {}
+
+    SERIALIZE_METHODS(CDAOCycleKey, obj)
+    {
+        READWRITE(Using<BigEndianFormatter<4>>(obj.nCycleStart));
+    }
+};
+
+/**
+ * CDAODB - LevelDB store of the DAO proposals and votes
+ *
+ * DATABASE KEYS:
+ * - 'P' + cycleStart (big endian) + proposalHash -> CDAOProposal
+ * - 'H' + proposalHash -> cycleStart (lookup by hash)
+ * - 'T' + proposalHash -> CDAOTally
+ * - 'V' + proposalHash + proTxHash -> CDAOVote
+ * - 'X' + cycleStart (big endian) + proposalHash -> payout height
+ *
+ * Proposals, votes and tallies are submitted over RPC, not by blocks: they
+ * are written straight to disk, bypassing the block transaction. The payout
+ * markers ('X') are written by ProcessHUBlock, so they go through the block
+ * transaction (dropped with a failed block, erased on disconnect) and are
+ * flushed with the other KHU databases.
+ */
+class CDAODB : public CKHUTransactionalDB
+{
+public:
+    explicit CDAODB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+
+private:
+    CDAODB(const CDAODB&);
+    void operator=(const CDAODB&);
+
+    /** Typed cursor loop over the keys starting with (prefix, start) */
+    template<typename StartType, typename KeyType, typename ValueType, typename Func>
+    bool IteratePrefix(char prefix, const StartType& start, Func func);
+
+public:
+    // Proposals and votes (written through)
+    bool WriteProposal(const CDAOProposal& proposal);
+    bool ReadProposal(const uint256& hash, CDAOProposal& proposal);
+    bool HaveProposal(const uint256& hash);
+    bool ReadTally(const uint256& hash, CDAOTally& tally);
+
+    /** Store a vote, replacing the masternode's previous one, and update the tally */
+    bool WriteVote(const CDAOVote& vote);
+
+    /** Erase a proposal with its tally and votes */
+    bool EraseProposal(const uint256& hash);
+
+    /**
+     * Proposals of one cycle, in hash order (single cursor pass)
+     * @param func Functor: bool(const CDAOProposal&) - return false to stop
+     */
+    template<typename Func>
+    bool ForEachProposal(uint32_t nCycleStart, Func func);
+
+    /**
+     * Cycles with at least one proposal, from the oldest
+     * @param func Functor: bool(uint32_t nCycleStart) - return false to stop
+     */
+    template<typename Func>
+    bool ForEachCycle(Func func);
+
+    /**
+     * Votes of one proposal
+     * @param func Functor: bool(const CDAOVote&) - return false to stop
+     */
+    template<typename Func>
+    bool ForEachVote(const uint256& proposalHash, Func func);
+
+    // Payout markers (block transaction)
+    bool IsPaid(uint32_t nCycleStart, const uint256& hash);
+    bool WritePaid(uint32_t nCycleStart, const uint256& hash, int nHeight);
+
+    /** Erase the markers written by the payout block at nHeight (disconnect) */
+    bool UndoPaid(uint32_t nCycleStart, int nHeight);
+
+    /** Erase every payout marker, before the chain is replayed (-reindex) */
+    bool WipePaid();
+};
+
+template<typename StartType, typename KeyType, typename ValueType, typename Func>
+bool CDAODB::IteratePrefix(char prefix, const StartType& start, Func func)
+{
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(std::make_pair(prefix, start));
+
+    while (pcursor->Valid()) {
+        std::pair<char, KeyType> key;
+        if (!pcursor->GetKey(key) || key.first != prefix) {
+            break; // End of sub-namespace
+        }
+
+        ValueType value;
+        if (!pcursor->GetValue(value)) {
+            return false;
+        }
+        if (!func(key.second, value)) {
+            break;
+        }
+
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+template<typename Func>
+bool CDAODB::ForEachProposal(uint32_t nCycleStart, Func func)
+{
+    return IteratePrefix<CDAOCycleKey, std::pair<CDAOCycleKey, uint256>, CDAOProposal>('P', CDAOCycleKey(nCycleStart),
+        [&](const std::pair<CDAOCycleKey, uint256>& key, CDAOProposal& proposal) {
+            if (key.first.nCycleStart != nCycleStart) return false;
+            proposal.hash = key.second; // not serialized
+            return func(static_cast<const CDAOProposal&>(proposal));
+        });
+}
+
+template<typename Func>
+bool CDAODB::ForEachCycle(Func func)
+{
+    // One record per proposal: skip to the next cycle instead of walking them
+    uint32_t nNext = 0;
+    while (true) {
+        bool fFound = false;
+        uint32_t nCycleStart = 0;
+        IteratePrefix<CDAOCycleKey, std::pair<CDAOCycleKey, uint256>, CDAOProposal>('P', CDAOCycleKey(nNext),
+            [&](const std::pair<CDAOCycleKey, uint256>& key, const CDAOProposal&) {
+                fFound = true;
+                nCycleStart = key.first.nCycleStart;
+                return false;
+            });
+        if (!fFound || !func(nCycleStart)) {
+            return true;
+        }
+        if (nCycleStart == std::numeric_limits<uint32_t>::max()) {
+            return true;
+        }
+        nNext = nCycleStart + 1;
+    }
+}
+
+template<typename Func>
+bool CDAODB::ForEachVote(const uint256& proposalHash, Func func)
+{
+    return IteratePrefix<uint256, std::pair<uint256, uint256>, CDAOVote>('V', proposalHash,
+        [&](const std::pair<uint256, uint256>& key, const CDAOVote& vote) {
+            return key.first == proposalHash && func(vote);
+        });
+}
+
+#endif // PIVHU_DAO_DB_H
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "dao/dao_proposal.h"
+#include "dao/dao_db.h"
 #include "hash.h"
 #include "logging.h"
 #include "evo/deterministicmns.h"
@@ -133,6 +134,9 @@ bool CDAOVote::Sign(const CKey& secretKey)
 // CDAOManager
 //
 
+CDAOManager::CDAOManager() = default;
+CDAOManager::~CDAOManager() = default;
+
 uint32_t CDAOManager::GetCycleStart(uint32_t nHeight)
 {
     // Cycles start at height 0, then every GetDAOCycleBlocks()
@@ -157,14 +161,22 @@ bool CDAOManager::SubmitProposal(const CDAOProposal& proposal, std::string& strE
         return false;
     }
 
+    if (!db) {
+        strError = "DAO database not initialized";
+        return false;
+    }
+
     // Check for duplicate
-    if (mapProposals.count(proposal.hash)) {
+    if (db->HaveProposal(proposal.hash)) {
         strError = "Proposal already exists";
         return false;
     }
 
     // Add proposal
-    mapProposals[proposal.hash] = proposal;
+    if (!db->WriteProposal(proposal)) {
+        strError = "Failed to store proposal";
+        return false;
+    }
 
     LogPrint(BCLog::MASTERNODE, "CDAOManager::SubmitProposal: %s (%s) for %d PIVHU\n",
              proposal.strName, proposal.hash.ToString(), proposal.nAmount / COIN);
@@ -176,15 +188,20 @@ bool CDAOManager::CastVote(const CDAOVote& vote, std::string& strError)
 {
     LOCK(cs_dao);
 
+    if (!db) {
+        strError = "DAO database not initialized";
+        return false;
+    }
+
     // Check proposal exists
-    auto it = mapProposals.find(vote.proposalHash);
-    if (it == mapProposals.end()) {
+    CDAOProposal proposal;
+    if (!db->ReadProposal(vote.proposalHash, proposal)) {
         strError = "Proposal not found";
         return false;
     }
 
     // Check voting is open
-    if (!it->second.IsVotingOpen(vote.nHeight)) {
+    if (!proposal.IsVotingOpen(vote.nHeight)) {
         strError = "Voting not open for this proposal";
         return false;
     }
@@ -203,8 +220,11 @@ bool CDAOManager::CastVote(const CDAOVote& vote, std::string& strError)
         return false;
     }
 
-    // Store vote (overwrites previous vote from same MN)
-    mapVotes[vote.proposalHash][vote.proTxHash] = vote;
+    // Store vote (overwrites previous vote from same MN) and update the counters
+    if (!db->WriteVote(vote)) {
+        strError = "Failed to store vote";
+        return false;
+    }
 
     LogPrint(BCLog::MASTERNODE, "CDAOManager::CastVote: MN %s voted %s on %s\n",
              vote.proTxHash.ToString().substr(0, 8),
@@ -217,18 +237,16 @@ bool CDAOManager::CastVote(const CDAOVote& vote, std::string& strError)
 bool CDAOManager::GetProposal(const uint256& hash, CDAOProposal& proposal) const
 {
     LOCK(cs_dao);
-    auto it = mapProposals.find(hash);
-    if (it == mapProposals.end()) {
+    if (!db || !db->ReadProposal(hash, proposal)) {
         return false;
     }
-    proposal = it->second;
 
     // Count current votes
     int nYes = 0, nNo = 0;
     CountVotes(hash, nYes, nNo);
     proposal.nYesVotes = nYes;
     proposal.nNoVotes = nNo;
-    proposal.fPaid = setExecuted.count(hash) > 0;
+    proposal.fPaid = db->IsPaid(proposal.nCycleStart, hash);
 
     return true;
 }
@@ -237,52 +255,58 @@ std::vector<CDAOProposal> CDAOManager::GetActiveProposals(uint32_t nHeight) cons
 {
     LOCK(cs_dao);
     std::vector<CDAOProposal> result;
+    if (!db) {
+        return result;
+    }
     uint32_t nCycleStart = GetCycleStart(nHeight);
 
-    for (const auto& pair : mapProposals) {
-        if (pair.second.nCycleStart == nCycleStart) {
-            CDAOProposal prop = pair.second;
+    auto mnList = deterministicMNManager->GetListAtChainTip();
+    db->ForEachProposal(nCycleStart, [&](const CDAOProposal& proposal) {
+        CDAOProposal prop = proposal;
 
-            // Count votes
-            int nYes = 0, nNo = 0;
-            CountVotes(prop.hash, nYes, nNo);
-            prop.nYesVotes = nYes;
-            prop.nNoVotes = nNo;
-            prop.fPaid = setExecuted.count(prop.hash) > 0;
+        // Count votes
+        int nYes = 0, nNo = 0;
+        CountVotes(prop.hash, mnList, nYes, nNo);
+        prop.nYesVotes = nYes;
+        prop.nNoVotes = nNo;
+        prop.fPaid = db->IsPaid(nCycleStart, prop.hash);
 
-            result.push_back(prop);
-        }
-    }
+        result.push_back(prop);
+        return true;
+    });
 
     return result;
 }
 
 void CDAOManager::CountVotes(const uint256& proposalHash, int& nYes, int& nNo) const
 {
-    // Note: cs_dao should already be held
+    LOCK(cs_dao);
+    // Only count votes from currently valid MNs
+    CountVotes(proposalHash, deterministicMNManager->GetListAtChainTip(), nYes, nNo);
+}
+
+void CDAOManager::CountVotes(const uint256& proposalHash, const CDeterministicMNList& mnList, int& nYes, int& nNo) const
+{
+    AssertLockHeld(cs_dao);
     nYes = 0;
     nNo = 0;
-
-    auto it = mapVotes.find(proposalHash);
-    if (it == mapVotes.end()) {
+    if (!db) {
         return;
     }
 
-    // Only count votes from currently valid MNs
-    auto mnList = deterministicMNManager->GetListAtChainTip();
-
-    for (const auto& votePair : it->second) {
+    db->ForEachVote(proposalHash, [&](const CDAOVote& vote) {
         // Check MN still exists
-        if (!mnList.GetMN(votePair.first)) {
-            continue;
+        if (!mnList.GetMN(vote.proTxHash)) {
+            return true;
         }
 
-        if (votePair.second.vote == DAOVote::YES) {
+        if (vote.vote == DAOVote::YES) {
             nYes++;
-        } else if (votePair.second.vote == DAOVote::NO) {
+        } else if (vote.vote == DAOVote::NO) {
             nNo++;
         }
-    }
+        return true;
+    });
 }
 
 bool CDAOManager::ExecutePayouts(int nHeight, CAmount nTreasuryBalance,
@@ -291,6 +315,10 @@ bool CDAOManager::ExecutePayouts(int nHeight, CAmount nTreasuryBalance,
     LOCK(cs_dao);
     payouts.clear();
 
+    if (!db) {
+        return true;
+    }
+
     uint32_t nCycleStart = GetCycleStart(nHeight);
 
     // Get total MN count for approval threshold
@@ -300,33 +328,33 @@ bool CDAOManager::ExecutePayouts(int nHeight, CAmount nTreasuryBalance,
     if (nTotalMNs == 0) {
         return true; // No MNs, no payouts
     }
+    const int nRequired = (nTotalMNs / 2) + 1;
 
     // Collect approved proposals sorted by votes (highest first)
     std::vector<CDAOProposal> approved;
 
-    for (auto& pair : mapProposals) {
-        CDAOProposal& prop = pair.second;
-
-        // Only this cycle's proposals
-        if (prop.nCycleStart != nCycleStart) continue;
-
+    // Only this cycle's proposals
+    db->ForEachProposal(nCycleStart, [&](const CDAOProposal& proposal) {
         // Only at payout height (day 30)
-        if (!prop.IsPayoutHeight(nHeight)) continue;
+        if (!proposal.IsPayoutHeight(nHeight)) return true;
 
         // Already paid?
-        if (setExecuted.count(prop.hash)) continue;
+        if (db->IsPaid(nCycleStart, proposal.hash)) return true;
 
-        // Count votes
-        int nYes = 0, nNo = 0;
-        CountVotes(prop.hash, nYes, nNo);
-        prop.nYesVotes = nYes;
-        prop.nNoVotes = nNo;
+        // The running counters include the votes of MNs removed since: they
+        // are an upper bound, and only the candidates are recounted
+        CDAOTally tally;
+        if (!db->ReadTally(proposal.hash, tally) || tally.nYes < nRequired) return true;
+
+        CDAOProposal prop = proposal;
+        CountVotes(prop.hash, mnList, prop.nYesVotes, prop.nNoVotes);
 
         // Check approval
         if (prop.IsApproved(nTotalMNs)) {
             approved.push_back(prop);
         }
-    }
+        return true;
+    });
 
     // Sort by YES votes (descending) - prioritize most popular proposals
     std::sort(approved.begin(), approved.end(),
@@ -341,7 +369,7 @@ bool CDAOManager::ExecutePayouts(int nHeight, CAmount nTreasuryBalance,
         if (prop.nAmount <= nRemaining) {
             payouts.push_back({prop.paymentAddress, prop.nAmount});
             nRemaining -= prop.nAmount;
-            setExecuted.insert(prop.hash);
+            db->WritePaid(nCycleStart, prop.hash, nHeight);
 
             LogPrintf("CDAOManager: Approved payout %s (%s) for %d PIVHU\n",
                       prop.strName, prop.hash.ToString().substr(0, 8), prop.nAmount / COIN);
@@ -354,32 +382,57 @@ bool CDAOManager::ExecutePayouts(int nHeight, CAmount nTreasuryBalance,
     return true;
 }
 
+bool CDAOManager::UndoPayouts(int nHeight)
+{
+    LOCK(cs_dao);
+    const uint32_t nCycleStart = GetCycleStart(nHeight);
+    if (!db || nHeight - nCycleStart != GetDAOPayoutHeight() - 1) {
+        return true; // Payouts only happen on the last block of a cycle
+    }
+    return db->UndoPaid(nCycleStart, nHeight);
+}
+
 void CDAOManager::CleanOldProposals(uint32_t nHeight)
 {
     LOCK(cs_dao);
+    if (!db) {
+        return;
+    }
 
     uint32_t nCycleStart = GetCycleStart(nHeight);
 
     // Remove proposals from 2+ cycles ago
     uint32_t cycleBlocks = GetDAOCycleBlocks();
-    for (auto it = mapProposals.begin(); it != mapProposals.end(); ) {
-        if (it->second.nCycleStart + (2 * cycleBlocks) < nCycleStart) {
-            mapVotes.erase(it->first);
-            it = mapProposals.erase(it);
-        } else {
-            ++it;
+    std::vector<uint256> vExpired;
+    db->ForEachCycle([&](uint32_t nCycle) {
+        if (nCycle + (2 * cycleBlocks) >= nCycleStart) {
+            return false; // Cycles are visited oldest first
         }
+        db->ForEachProposal(nCycle, [&](const CDAOProposal& proposal) {
+            vExpired.push_back(proposal.hash);
+            return true;
+        });
+        return true;
+    });
+    for (const uint256& hash : vExpired) {
+        db->EraseProposal(hash);
     }
 }
 
-bool CDAOManager::Load()
+bool CDAOManager::Load(size_t nCacheSize, bool fReindex)
 {
-    // TODO: Load from LevelDB
-    return true;
-}
+    LOCK(cs_dao);
+    try {
+        db.reset();
+        db = std::make_unique<CDAODB>(nCacheSize, false, false);
+    } catch (const std::exception& e) {
+        return error("%s: failed to open the DAO database: %s", __func__, e.what());
+    }
 
-bool CDAOManager::Save() const
-{
-    // TODO: Save to LevelDB
+    // Proposals and votes are not in the chain and survive a reindex,
+    // the payouts are replayed with it
+    if (fReindex && !db->WipePaid()) {
+        return error("%s: failed to reset the DAO payouts", __func__);
+    }
     return true;
 }
@@ -15,6 +15,9 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
+
+class CDeterministicMNList;
 
 /**
  * PIVHU DAO Monthly Proposal System
@@ -191,25 +194,28 @@ public:
     }
 };
 
+class CDAODB;
+
 /**
  * CDAOManager - Manages proposals and votes
+ *
+ * Proposals and votes live in CDAODB (dao_db.h), with running yes/no
+ * counters per proposal. Nothing is held in memory: a cycle is read with
+ * one cursor pass over its key prefix.
  */
 class CDAOManager
 {
 private:
     mutable RecursiveMutex cs_dao;
 
-    // Active proposals (by hash)
-    std::map<uint256, CDAOProposal> mapProposals;
+    std::unique_ptr<CDAODB> db;
 
-    // Votes per proposal
-    std::map<uint256, std::map<uint256, CDAOVote>> mapVotes;  // proposalHash -> (proTxHash -> vote)
-
-    // Executed proposals (for history)
-    std::set<uint256> setExecuted;
+    // Count the votes of currently registered MNs (cs_dao held)
+    void CountVotes(const uint256& proposalHash, const CDeterministicMNList& mnList, int& nYes, int& nNo) const;
 
 public:
-    CDAOManager() = default;
+    CDAOManager();
+    ~CDAOManager();
 
     // Submit a new proposal
     bool SubmitProposal(const CDAOProposal& proposal, std::string& strError);
@@ -229,15 +235,20 @@ public:
     // Execute approved proposals (called during block connection)
     bool ExecutePayouts(int nHeight, CAmount nTreasuryBalance, std::vector<std::pair<CTxDestination, CAmount>>& payouts);
 
+    // Forget the payouts of a disconnected payout block
+    bool UndoPayouts(int nHeight);
+
     // Get current cycle start for a given height
     static uint32_t GetCycleStart(uint32_t nHeight);
 
     // Clean old proposals
     void CleanOldProposals(uint32_t nHeight);
 
-    // Persistence
-    bool Load();
-    bool Save() const;
+    // Persistence: open the store (payout markers are dropped on -reindex, the chain replays them)
+    bool Load(size_t nCacheSize, bool fReindex);
+
+    // Store, flushed with the KHU databases (nullptr before Load)
+    CDAODB* GetDB() const { return db.get(); }
 };
 
 // Global DAO manager
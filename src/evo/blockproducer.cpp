@@ -10,14 +10,106 @@
 #include "hash.h"
 #include "logging.h"
 #include "pubkey.h"
+#include "saltedhasher.h"
+#include "sync.h"
+#include "unordered_lru_cache.h"
 
 #include <algorithm>
 
 namespace mn_consensus {
 
-// Maximum fallback slots before we clamp (1 hour / fallbackWindow)
-// Prevents integer overflow and limits how long we wait for any single producer
-static const int MAX_FALLBACK_SLOTS = 360;  // 360 * 10s = 1 hour
+// Producer schedule cache: hash(prevBlockHash, height, mnList block hash) -> schedule
+static Mutex cs_scheduleCache;
+static unordered_lru_cache<uint256, std::shared_ptr<const CBlockProducerSchedule>, StaticSaltedHasher>
+    scheduleCache(BLOCK_PRODUCER_SCHEDULE_CACHE_SIZE);
+
+// Descending score, tie-breaker: proTxHash lexicographically
+static bool CompareProducerScores(const std::pair<arith_uint256, CDeterministicMNCPtr>& a,
+                                  const std::pair<arith_uint256, CDeterministicMNCPtr>& b)
+{
+    if (a.first == b.first) {
+        return a.second->proTxHash < b.second->proTxHash;
+    }
+    return a.first > b.first;
+}
+
+// Scores of every valid, confirmed MN (unsorted)
+static std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>>
+ComputeProducerScores(const CBlockIndex* pindexPrev, const CDeterministicMNList& mnList)
+{
+    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
+
+    const uint256& prevBlockHash = pindexPrev->GetBlockHash();
+    const int nHeight = pindexPrev->nHeight + 1;
+
+    scores.reserve(mnList.GetValidMNsCount());
+
+    // Only valid (non-PoSe-banned), confirmed MNs
+    mnList.ForEachMN(true /* onlyValid */, [&](const CDeterministicMNCPtr& dmn) {
+        // Skip unconfirmed MNs (prevents hash grinding)
+        if (dmn->pdmnState->confirmedHash.IsNull()) {
+            return;
+        }
+
+        arith_uint256 score = ComputeMNBlockScore(prevBlockHash, nHeight, dmn->proTxHash);
+        scores.emplace_back(score, dmn);
+    });
+
+    return scores;
+}
+
+static std::shared_ptr<const CBlockProducerSchedule>
+ComputeBlockProducerSchedule(const CBlockIndex* pindexPrev, const CDeterministicMNList& mnList)
+{
+    auto schedule = std::make_shared<CBlockProducerSchedule>();
+    schedule->vRanked = ComputeProducerScores(pindexPrev, mnList);
+    schedule->nCandidates = schedule->vRanked.size();
+
+    // Slots are clamped to MAX_FALLBACK_SLOTS: only rank the reachable ones
+    const size_t nRanked = std::min(schedule->nCandidates, (size_t)MAX_FALLBACK_SLOTS + 1);
+    std::partial_sort(schedule->vRanked.begin(), schedule->vRanked.begin() + nRanked,
+                      schedule->vRanked.end(), CompareProducerScores);
+    schedule->vRanked.resize(nRanked);
+    schedule->vRanked.shrink_to_fit();
+    return schedule;
+}
+
+std::shared_ptr<const CBlockProducerSchedule>
+GetBlockProducerSchedule(const CBlockIndex* pindexPrev, const CDeterministicMNList& mnList)
+{
+    if (!pindexPrev) {
+        return std::make_shared<const CBlockProducerSchedule>();
+    }
+    if (mnList.GetBlockHash().IsNull()) {
+        return ComputeBlockProducerSchedule(pindexPrev, mnList);
+    }
+
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << pindexPrev->GetBlockHash();
+    ss << pindexPrev->nHeight;
+    ss << mnList.GetBlockHash();
+    const uint256 key = ss.GetHash();
+
+    std::shared_ptr<const CBlockProducerSchedule> schedule;
+    {
+        LOCK(cs_scheduleCache);
+        if (scheduleCache.get(key, schedule)) {
+            return schedule;
+        }
+    }
+
+    schedule = ComputeBlockProducerSchedule(pindexPrev, mnList);
+
+    LOCK(cs_scheduleCache);
+    scheduleCache.insert(key, schedule);
+    return schedule;
+}
+
+void ClearBlockProducerScheduleCache()
+{
+    LOCK(cs_scheduleCache);
+    scheduleCache.clear();
+}
 
 arith_uint256 ComputeMNBlockScore(const uint256& prevBlockHash, int nHeight, const uint256& proTxHash)
 {
@@ -86,6 +178,21 @@ int GetProducerSlot(const CBlockIndex* pindexPrev, int64_t nBlockTime)
     return slot;
 }
 
+int64_t GetProducerSlotStartTime(const CBlockIndex* pindexPrev, int nSlot)
+{
+    if (!pindexPrev) {
+        return 0;
+    }
+
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const int64_t prevTime = pindexPrev->GetBlockTime();
+    if (nSlot <= 0) {
+        return prevTime;
+    }
+    return prevTime + consensus.nHuLeaderTimeoutSeconds +
+           (int64_t)(std::min(nSlot, MAX_FALLBACK_SLOTS) - 1) * consensus.nHuFallbackRecoverySeconds;
+}
+
 /**
  * Get the expected block producer based on block header data.
  *
@@ -116,16 +223,16 @@ bool GetExpectedProducer(const CBlockIndex* pindexPrev,
         return false;
     }
 
-    auto scores = CalculateBlockProducerScores(pindexPrev, mnList);
-    if (scores.empty()) {
+    auto schedule = GetBlockProducerSchedule(pindexPrev, mnList);
+    if (schedule->vRanked.empty()) {
         LogPrint(BCLog::MASTERNODE, "%s: No confirmed MNs for block %d\n",
                  __func__, pindexPrev->nHeight + 1);
         return false;
     }
 
     int slot = GetProducerSlot(pindexPrev, nBlockTime);
-    outProducerIndex = slot % (int)scores.size();  // Wrap around using modulo
-    outMn = scores[outProducerIndex].second;
+    outProducerIndex = slot % (int)schedule->nCandidates;  // Wrap around using modulo
+    outMn = schedule->vRanked[outProducerIndex].second;    // slot <= MAX_FALLBACK_SLOTS: always ranked
 
     if (outProducerIndex > 0) {
         LogPrint(BCLog::MASTERNODE, "%s: Block %d expected producer #%d: %s (slot=%d, nTime=%d)\n",
@@ -145,31 +252,10 @@ CalculateBlockProducerScores(const CBlockIndex* pindexPrev, const CDeterministic
         return scores;
     }
 
-    const uint256& prevBlockHash = pindexPrev->GetBlockHash();
-    const int nHeight = pindexPrev->nHeight + 1;
-
-    scores.reserve(mnList.GetValidMNsCount());
-
-    // Only valid (non-PoSe-banned), confirmed MNs
-    mnList.ForEachMN(true /* onlyValid */, [&](const CDeterministicMNCPtr& dmn) {
-        // Skip unconfirmed MNs (prevents hash grinding)
-        if (dmn->pdmnState->confirmedHash.IsNull()) {
-            return;
-        }
-
-        arith_uint256 score = ComputeMNBlockScore(prevBlockHash, nHeight, dmn->proTxHash);
-        scores.emplace_back(score, dmn);
-    });
+    scores = ComputeProducerScores(pindexPrev, mnList);
 
     // Sort descending by score
-    std::sort(scores.begin(), scores.end(),
-        [](const auto& a, const auto& b) {
-            if (a.first == b.first) {
-                // Tie-breaker: proTxHash lexicographically
-                return a.second->proTxHash < b.second->proTxHash;
-            }
-            return a.first > b.first;
-        });
+    std::sort(scores.begin(), scores.end(), CompareProducerScores);
 
     return scores;
 }
@@ -184,20 +270,20 @@ bool GetBlockProducer(const CBlockIndex* pindexPrev,
         return false;
     }
 
-    auto scores = CalculateBlockProducerScores(pindexPrev, mnList);
+    auto schedule = GetBlockProducerSchedule(pindexPrev, mnList);
 
-    if (scores.empty()) {
+    if (schedule->vRanked.empty()) {
         LogPrint(BCLog::MASTERNODE, "%s: No confirmed MNs for block %d\n",
                  __func__, pindexPrev->nHeight + 1);
         return false;
     }
 
-    outMn = scores[0].second;
+    outMn = schedule->vRanked[0].second;
 
     LogPrint(BCLog::MASTERNODE, "%s: Block %d producer: %s (score: %s)\n",
              __func__, pindexPrev->nHeight + 1,
              outMn->proTxHash.ToString().substr(0, 16),
-             scores[0].first.ToString().substr(0, 16));
+             schedule->vRanked[0].first.ToString().substr(0, 16));
 
     return true;
 }
@@ -215,9 +301,9 @@ bool GetBlockProducerWithFallback(const CBlockIndex* pindexPrev,
         return false;
     }
 
-    auto scores = CalculateBlockProducerScores(pindexPrev, mnList);
+    auto schedule = GetBlockProducerSchedule(pindexPrev, mnList);
 
-    if (scores.empty()) {
+    if (schedule->vRanked.empty()) {
         LogPrint(BCLog::MASTERNODE, "%s: No confirmed MNs for block %d\n",
                  __func__, pindexPrev->nHeight + 1);
         return false;
@@ -246,10 +332,15 @@ bool GetBlockProducerWithFallback(const CBlockIndex* pindexPrev,
 
         // Wrap around using modulo to rotate through all available MNs
         // This ensures offline MNs don't block progress forever
-        producerIndex = rawIndex % (int)scores.size();
+        producerIndex = rawIndex % (int)schedule->nCandidates;
     }
 
-    outMn = scores[producerIndex].second;
+    if (producerIndex < (int)schedule->vRanked.size()) {
+        outMn = schedule->vRanked[producerIndex].second;
+    } else {
+        // Unclamped fallback index past the ranked slots: full ranking
+        outMn = CalculateBlockProducerScores(pindexPrev, mnList)[producerIndex].second;
+    }
     outProducerIndex = producerIndex;
 
     if (producerIndex > 0) {
@@ -11,11 +11,20 @@
 #include "primitives/block.h"
 #include "uint256.h"
 
+#include <memory>
+#include <vector>
+
 class CBlockIndex;
 class CValidationState;
 
 namespace mn_consensus {
 
+/** Maximum fallback slots before we clamp (1 hour / fallbackWindow) */
+static const int MAX_FALLBACK_SLOTS = 360;  // 360 * 10s = 1 hour
+
+/** Number of producer schedules kept (one per prev block / MN list pair) */
+static const size_t BLOCK_PRODUCER_SCHEDULE_CACHE_SIZE = 64;
+
 /**
  * MN-only block production for PIVHU chain.
  *
@@ -71,6 +80,15 @@ bool GetBlockProducer(const CBlockIndex* pindexPrev,
  */
 int GetProducerSlot(const CBlockIndex* pindexPrev, int64_t nBlockTime);
 
+/**
+ * First timestamp of a producer slot (inverse of GetProducerSlot()).
+ *
+ * @param pindexPrev  Previous block index
+ * @param nSlot       Producer slot index (0 = primary, 1+ = fallback)
+ * @return            Earliest nTime for which GetProducerSlot() returns nSlot
+ */
+int64_t GetProducerSlotStartTime(const CBlockIndex* pindexPrev, int nSlot);
+
 /**
  * Get the expected block producer based on block header data.
  *
@@ -124,6 +142,37 @@ bool GetBlockProducerWithFallback(const CBlockIndex* pindexPrev,
 std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>>
 CalculateBlockProducerScores(const CBlockIndex* pindexPrev, const CDeterministicMNList& mnList);
 
+/**
+ * Producer ranking for one block.
+ *
+ * Only the slots that GetProducerSlot() can reach are ranked (top-k partial
+ * selection instead of a full sort): vRanked holds the best
+ * min(nCandidates, MAX_FALLBACK_SLOTS + 1) MNs, sorted descending.
+ */
+struct CBlockProducerSchedule {
+    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> vRanked;
+    size_t nCandidates{0};  // valid, confirmed MNs
+};
+
+/**
+ * Get the producer schedule of the block after pindexPrev (memoized).
+ *
+ * Schedules are cached per (prevBlockHash, height, mnList block hash): a new
+ * MN list diff gives a new key, and UndoBlock() clears the cache on reorgs.
+ * Lists not bound to a block (null block hash) are ranked without caching.
+ *
+ * @param pindexPrev     Previous block index
+ * @param mnList         DMN list at pindexPrev
+ * @return               Schedule (empty for a null pindexPrev)
+ */
+std::shared_ptr<const CBlockProducerSchedule>
+GetBlockProducerSchedule(const CBlockIndex* pindexPrev, const CDeterministicMNList& mnList);
+
+/**
+ * Drop every memoized producer schedule (MN list undo / reorg).
+ */
+void ClearBlockProducerScheduleCache();
+
 /**
  * Sign block with MN operator ECDSA key.
  *
@@ -7,6 +7,7 @@
 
 #include "chain.h"
 #include "coins.h"
+#include "evo/blockproducer.h"
 #include "chainparams.h"
 #include "consensus/params.h"  // For Consensus::GenesisMN
 #include "hash.h"              // For CHashWriter
@@ -17,6 +18,7 @@
 #include "guiinterface.h"
 #include "masternodeman.h" // for mnodeman (!TODO: remove)
 #include "netbase.h"       // For Lookup()
+#include "piv2/piv2_quorum.h"
 #include "script/standard.h"
 #include "spork.h"
 #include "sync.h"
@@ -603,6 +605,8 @@ bool CDeterministicMNManager::ProcessBlock(const CBlock& block, const CBlockInde
 
         diff.nHeight = pindex->nHeight;
         mnListDiffsCache.emplace(pindex->GetBlockHash(), diff);
+        // The block is about to become the tip
+        PublishRecentList(newList);
     } catch (const std::exception& e) {
         LogPrintf("CDeterministicMNManager::%s -- internal error: %s\n", __func__, e.what());
         return _state.DoS(100, false, REJECT_INVALID, "failed-dmn-block");
@@ -644,8 +648,18 @@ bool CDeterministicMNManager::UndoBlock(const CBlock& block, const CBlockIndex*
 
         mnListsCache.erase(blockHash);
         mnListDiffsCache.erase(blockHash);
+        for (auto& recentList : recentLists) {
+            auto mnList = std::atomic_load(&recentList);
+            if (mnList && mnList->GetBlockHash() == blockHash) {
+                std::atomic_store(&recentList, CDeterministicMNListCPtr());
+            }
+        }
     }
 
+    // Schedules memoized on this branch are not needed anymore
+    mn_consensus::ClearBlockProducerScheduleCache();
+    hu::ClearHuQuorumCache();
+
     if (diff.HasChanges()) {
         auto inversedDiff = curList.BuildDiff(prevList);
         GetMainSignals().NotifyMasternodeListChanged(true, curList, inversedDiff);
@@ -659,6 +673,8 @@ void CDeterministicMNManager::SetTipIndex(const CBlockIndex* pindex)
 {
     LOCK(cs);
     tipIndex = pindex;
+    // Usually published by ProcessBlock, otherwise built by the next GetListAtChainTip
+    std::atomic_store(&tipList, pindex ? FindRecentList(pindex->GetBlockHash()) : CDeterministicMNListCPtr());
 }
 
 bool CDeterministicMNManager::BuildNewListFromBlock(const CBlock& block, const CBlockIndex* pindexPrev, CValidationState& _state, CDeterministicMNList& mnListRet, bool debugLogs)
@@ -935,13 +951,18 @@ void CDeterministicMNManager::DecreasePoSePenalties(CDeterministicMNList& mnList
 
 CDeterministicMNList CDeterministicMNManager::GetListForBlock(const CBlockIndex* pindex)
 {
-    LOCK(cs);
-
     // Return early before enforcement
     if (!IsDIP3Enforced(pindex->nHeight)) {
         return {};
     }
 
+    // The lists of the last blocks are read without the lock
+    if (const auto recentList = FindRecentList(pindex->GetBlockHash())) {
+        return *recentList;
+    }
+
+    LOCK(cs);
+
     CDeterministicMNList snapshot;
     std::list<const CBlockIndex*> listDiffIndexes;
 
@@ -999,6 +1020,9 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlock(const CBlockIndex*
             snapshot.SetBlockHash(diffIndex->GetBlockHash());
             snapshot.SetHeight(diffIndex->nHeight);
         }
+        if (IsMemSnapshotHeight(diffIndex)) {
+            mnListsCache.emplace(diffIndex->GetBlockHash(), snapshot);
+        }
     }
 
     if (tipIndex) {
@@ -1010,16 +1034,52 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlock(const CBlockIndex*
         }
     }
 
+    PublishRecentList(snapshot);
     return snapshot;
 }
 
 CDeterministicMNList CDeterministicMNManager::GetListAtChainTip()
 {
+    if (const auto mnList = std::atomic_load(&tipList)) {
+        return *mnList;
+    }
+
     LOCK(cs);
     if (!tipIndex) {
         return {};
     }
-    return GetListForBlock(tipIndex);
+    CDeterministicMNList mnList = GetListForBlock(tipIndex);
+    std::atomic_store(&tipList, std::make_shared<const CDeterministicMNList>(mnList));
+    return mnList;
+}
+
+bool CDeterministicMNManager::IsMemSnapshotHeight(const CBlockIndex* pindex) const
+{
+    AssertLockHeld(cs);
+    const int nDepth = tipIndex ? tipIndex->nHeight - pindex->nHeight : 0;
+    const int nPeriod = nDepth < DISK_SNAPSHOT_PERIOD ? MEM_SNAPSHOT_PERIOD_RECENT : MEM_SNAPSHOT_PERIOD;
+    return (pindex->nHeight % nPeriod) == 0;
+}
+
+CDeterministicMNManager::CDeterministicMNListCPtr CDeterministicMNManager::FindRecentList(const uint256& blockHash) const
+{
+    for (const auto& recentList : recentLists) {
+        auto mnList = std::atomic_load(&recentList);
+        if (mnList && mnList->GetBlockHash() == blockHash) {
+            return mnList;
+        }
+    }
+    return nullptr;
+}
+
+void CDeterministicMNManager::PublishRecentList(const CDeterministicMNList& mnList)
+{
+    AssertLockHeld(cs);
+    if (FindRecentList(mnList.GetBlockHash())) {
+        return;
+    }
+    std::atomic_store(&recentLists[nNextRecentList], std::make_shared<const CDeterministicMNList>(mnList));
+    nNextRecentList = (nNextRecentList + 1) % RECENT_LISTS;
 }
 
 bool CDeterministicMNManager::IsDIP3Enforced(int nHeight) const
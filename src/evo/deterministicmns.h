@@ -20,6 +20,8 @@
 #include <immer/map.hpp>
 #include <immer/map_transient.hpp>
 
+#include <array>
+#include <memory>
 #include <unordered_map>
 
 class CBlock;
@@ -567,6 +569,10 @@ class CDeterministicMNManager
     static const int DISK_SNAPSHOT_PERIOD = 1440; // once per day
     static const int DISK_SNAPSHOTS = 3; // keep cache for 3 disk snapshots to have 2 full days covered
     static const int LIST_DIFFS_CACHE_SIZE = DISK_SNAPSHOT_PERIOD * DISK_SNAPSHOTS;
+    // in-memory snapshots kept when rebuilding a list, denser in the last day of blocks
+    static const int MEM_SNAPSHOT_PERIOD_RECENT = 16;
+    static const int MEM_SNAPSHOT_PERIOD = 144;
+    static const size_t RECENT_LISTS = 8; // lists of the last blocks, readable without cs
 
 public:
     mutable RecursiveMutex cs;
@@ -578,6 +584,17 @@ private:
     std::unordered_map<uint256, CDeterministicMNListDiff, StaticSaltedHasher> mnListDiffsCache;
     const CBlockIndex* tipIndex{nullptr};
 
+    /**
+     * Immutable lists published for the readers, swapped with the atomic
+     * shared_ptr functions: the list of tipIndex (null until computed) and a
+     * ring of the lists of the last connected or requested blocks. Written
+     * under cs, read without it. The copies share the immer maps.
+     */
+    typedef std::shared_ptr<const CDeterministicMNList> CDeterministicMNListCPtr;
+    CDeterministicMNListCPtr tipList;
+    std::array<CDeterministicMNListCPtr, RECENT_LISTS> recentLists;
+    size_t nNextRecentList{0};
+
 public:
     explicit CDeterministicMNManager(CEvoDB& _evoDb);
 
@@ -607,6 +624,11 @@ public:
 
 private:
     void CleanupCache(int nHeight);
+
+    /** Whether a list rebuilt for pindex is kept in mnListsCache, to bound the diffs replayed by the next lookups */
+    bool IsMemSnapshotHeight(const CBlockIndex* pindex) const;
+    CDeterministicMNListCPtr FindRecentList(const uint256& blockHash) const;
+    void PublishRecentList(const CDeterministicMNList& mnList);
 };
 
 extern std::unique_ptr<CDeterministicMNManager> deterministicMNManager;
@@ -21,6 +21,7 @@
 #include "checkpoints.h"
 #include "compat/sanity.h"
 #include "consensus/upgrades.h"
+#include "crypto/sha256.h"
 #include "fs.h"
 #include "httpserver.h"
 #include "httprpc.h"
@@ -37,6 +38,8 @@
 #include "policy/policy.h"
 #include "rpc/register.h"
 #include "rpc/server.h"
+#include "sapling/sapling_proofcache.h"
+#include "sapling/sapling_trialdecrypt.h"
 #include "script/sigcache.h"
 #include "script/standard.h"
 #include "scheduler.h"
@@ -231,6 +234,7 @@ void Shutdown()
     // using the other before destroying them.
     if (peerLogic) UnregisterValidationInterface(peerLogic.get());
     if (g_connman) g_connman->Stop();
+    hu::StopHuSignaling();
 
     StopTorControl();
 
@@ -335,6 +339,7 @@ void Shutdown()
     globalVerifyHandle.reset();
     ECC_Stop();
     LogPrintf("%s: done\n", __func__);
+    g_logger->StopAsync();
 }
 
 /**
@@ -447,6 +452,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-dnsseed", "Query for peer addresses via DNS lookup, if low on addresses (default: 1 unless -connect/-noconnect)");
     strUsage += HelpMessageOpt("-externalip=<ip>", "Specify your own public address");
     strUsage += HelpMessageOpt("-forcednsseed", strprintf("Always query for peer addresses via DNS lookup (default: %u)", DEFAULT_FORCEDNSSEED));
+    strUsage += HelpMessageOpt("-husigthreads=<n>", strprintf("Number of HU finality signature verification threads (0 to %d, 0 = verify on the message handler thread, default: %d)", hu::MAX_HU_SIG_THREADS, hu::DEFAULT_HU_SIG_THREADS));
     strUsage += HelpMessageOpt("-listen", strprintf("Accept connections from outside (default: %u if no -proxy or -connect/-noconnect)", DEFAULT_LISTEN));
     strUsage += HelpMessageOpt("-listenonion", strprintf("Automatically create Tor hidden service (default: %d)", DEFAULT_LISTEN_ONION));
     strUsage += HelpMessageOpt("-maxconnections=<n>", strprintf("Maintain at most <n> connections to peers (default: %u)", DEFAULT_MAX_PEER_CONNECTIONS));
@@ -516,9 +522,14 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-logips", strprintf("Include IP addresses in debug output (default: %u)", DEFAULT_LOGIPS));
     strUsage += HelpMessageOpt("-logtimestamps", strprintf("Prepend debug output with timestamp (default: %u)", DEFAULT_LOGTIMESTAMPS));
     strUsage += HelpMessageOpt("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS));
+    strUsage += HelpMessageOpt("-logasync", strprintf("Write the debug output from a dedicated thread, the lines queued last can be lost if the process crashes (default: %u)", DEFAULT_LOGASYNC));
+    strUsage += HelpMessageOpt("-logbuffersize=<n>", strprintf("Number of lines queued for the -logasync writer (default: %u)", DEFAULT_LOGBUFFERSIZE));
+    strUsage += HelpMessageOpt("-logoverflow=<mode>", strprintf("What to do when the -logasync queue is full: 'block' waits for the writer, 'drop' discards and counts the lines (default: %s)", DEFAULT_LOGOVERFLOW));
     if (showDebug) {
         strUsage += HelpMessageOpt("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)");
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-checkmoneysupply", strprintf("Check the money supply against a full scan of the UTXO set at startup, in the background (default: %u)", DEFAULT_CHECK_MONEY_SUPPLY));
+        strUsage += HelpMessageOpt("-maxshieldedsigcachesize=<n>", strprintf("Limit size of shielded proof cache to <n> MiB (default: %u)", DEFAULT_MAX_SHIELDED_SIG_CACHE_SIZE));
     }
     strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf("Fees (in %s/Kb) smaller than this are considered zero fee for relaying and transaction creation (default: %s)", CURRENCY_UNIT, FormatMoney(::minRelayTxFee.GetFeePerK())));
@@ -1150,6 +1161,9 @@ bool AppInitSanityChecks()
 {
     // ********************************************************* Step 4: sanity checks
 
+    std::string sha256_algo = SHA256AutoDetect();
+    LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+
     // Initialize elliptic curve code
     RandomInit();
     ECC_Start();
@@ -1186,6 +1200,17 @@ bool AppInitMain()
         if (!g_logger->OpenDebugLog())
             return UIError(strprintf(_("Could not open debug log file %s"), g_logger->m_file_path.string()));
     }
+    if (gArgs.GetBoolArg("-logasync", DEFAULT_LOGASYNC)) {
+        const std::string strOverflow = gArgs.GetArg("-logoverflow", DEFAULT_LOGOVERFLOW);
+        if (strOverflow != "block" && strOverflow != "drop") {
+            return UIError(strprintf(_("Invalid -logoverflow mode '%s', must be 'block' or 'drop'"), strOverflow));
+        }
+        const int64_t nBufferSize = gArgs.GetArg("-logbuffersize", DEFAULT_LOGBUFFERSIZE);
+        if (nBufferSize <= 0) {
+            return UIError(strprintf(_("Invalid -logbuffersize=%d, must be positive"), nBufferSize));
+        }
+        g_logger->StartAsync(nBufferSize, strOverflow == "block");
+    }
 #ifdef ENABLE_WALLET
     LogPrintf("Using BerkeleyDB version %s\n", DbEnv::version(0, 0, 0));
 #endif
@@ -1211,11 +1236,20 @@ bool AppInitMain()
     }
 
     InitSignatureCache();
+    InitShieldedProofCache();
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i = 0; i < nScriptCheckThreads - 1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i = 0; i < nScriptCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadSaplingCheck);
+#ifdef ENABLE_WALLET
+        if (!gArgs.GetBoolArg("-disablewallet", DEFAULT_DISABLE_WALLET)) {
+            for (int i = 0; i < nScriptCheckThreads - 1; i++)
+                threadGroup.create_thread(&ThreadSaplingTrialDecrypt);
+        }
+#endif
     }
 
     if (gArgs.IsArgSet("-sporkkey")) // spork priv key
@@ -1583,6 +1617,12 @@ bool AppInitMain()
                         break;
                     }
                     assert(chainActive.Tip() != nullptr);
+
+                    // KHU databases are flushed together with the coins view
+                    if (!VerifyKHUBestBlock(pcoinsTip->GetBestBlock())) {
+                        strLoadError = strprintf(_("KHU databases are not in sync with the chainstate. You will need to rebuild the database using %s."), "-reindex");
+                        break;
+                    }
                 }
 
                 // Fresh genesis - no historical legacy data to prune
@@ -1725,10 +1765,10 @@ bool AppInitMain()
     }
     LogPrintf("chainActive.Height() = %d\n", chain_active_height);
 
-    // Update money supply
-    if (!fReindex && !fReindexChainState) {
-        uiInterface.InitMessage(_("Calculating money supply..."));
-        MoneySupply.Update(pcoinsTip->GetTotalAmount(), chain_active_height);
+    // Money supply: maintained by block connection, computed once from the UTXO set
+    // in the background if the chainstate was written without it
+    if (!LoadMoneySupply() || gArgs.GetBoolArg("-checkmoneysupply", DEFAULT_CHECK_MONEY_SUPPLY)) {
+        threadGroup.create_thread(&ThreadVerifyMoneySupply);
     }
 
 
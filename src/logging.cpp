@@ -5,8 +5,11 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "logging.h"
+#include "util/threadnames.h"
 #include "utiltime.h"
 
+#include <algorithm>
+
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
 
@@ -33,6 +36,14 @@ static int FileWriteStr(const std::string &str, FILE *fp)
     return fwrite(str.data(), 1, str.size(), fp);
 }
 
+BCLog::Logger::~Logger()
+{
+    StopAsync();
+    if (m_fileout) {
+        fclose(m_fileout);
+    }
+}
+
 bool BCLog::Logger::OpenDebugLog()
 {
     std::lock_guard<std::mutex> scoped_lock(m_file_mutex);
@@ -170,43 +181,67 @@ std::vector<CLogCategoryActive> ListActiveLogCategories()
     return ret;
 }
 
-std::string BCLog::Logger::LogTimestampStr(const std::string &str)
+std::string BCLog::Logger::LogTimestampStr(const LogEntry& entry) const
 {
-    std::string strStamped;
+    if (!entry.fTimestamp)
+        return entry.str;
+
+    // The writer thread stamps the lines of a whole second: format the date once
+    static thread_local int64_t nCachedTime = -1;
+    static thread_local std::string strCachedTime;
+    if (entry.nTimeMicros/1000000 != nCachedTime) {
+        nCachedTime = entry.nTimeMicros/1000000;
+        strCachedTime = FormatISO8601DateTime(nCachedTime);
+    }
 
-    if (!m_log_timestamps)
-        return str;
+    std::string strStamped = strCachedTime;
+    if (m_log_time_micros) {
+        strStamped.pop_back();
+        strStamped += strprintf(".%06dZ", entry.nTimeMicros % 1000000);
+    }
+    if (entry.nMockTime) {
+        strStamped += " (mocktime: " + FormatISO8601DateTime(entry.nMockTime) + ")";
+    }
+    return strStamped + ' ' + entry.str;
+}
 
-    if (m_started_new_line) {
-        int64_t nTimeMicros = GetTimeMicros();
-        strStamped = FormatISO8601DateTime(nTimeMicros/1000000);
-        if (m_log_time_micros) {
-            strStamped.pop_back();
-            strStamped += strprintf(".%06dZ", nTimeMicros % 1000000);
+void BCLog::Logger::LogPrintStr(const std::string &str)
+{
+    LogEntry entry;
+    if (m_log_timestamps && m_started_new_line) {
+        entry.fTimestamp = true;
+        entry.nTimeMicros = GetTimeMicros();
+        entry.nMockTime = GetMockTime();
+    }
+    m_started_new_line = !str.empty() && str[str.size()-1] == '\n';
+    entry.str = str;
+
+    m_producers++;
+    if (m_async) {
+        while (!m_buffer->TryPush(entry)) {
+            if (!m_block_on_overflow) {
+                m_dropped++;
+                break;
+            }
+            m_writer_cv.notify_one();
+            std::this_thread::yield();
         }
-        int64_t mocktime = GetMockTime();
-        if (mocktime) {
-            strStamped += " (mocktime: " + FormatISO8601DateTime(mocktime) + ")";
+        m_producers--;
+        if (m_writer_sleeping.load(std::memory_order_relaxed)) {
+            m_writer_cv.notify_one();
         }
-        strStamped += ' ' + str;
-    } else
-        strStamped = str;
-
-    if (!str.empty() && str[str.size()-1] == '\n')
-        m_started_new_line = true;
-    else
-        m_started_new_line = false;
+        return;
+    }
+    m_producers--;
 
-    return strStamped;
+    WriteToOutputs(LogTimestampStr(entry));
 }
 
-void BCLog::Logger::LogPrintStr(const std::string &str)
+void BCLog::Logger::WriteToOutputs(const std::string& str)
 {
-    std::string strTimestamped = LogTimestampStr(str);
-
     if (m_print_to_console) {
         // print to console
-        fwrite(strTimestamped.data(), 1, strTimestamped.size(), stdout);
+        fwrite(str.data(), 1, str.size(), stdout);
         fflush(stdout);
     }
 
@@ -215,7 +250,7 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
 
         // buffer if we haven't opened the log yet
         if (m_fileout == nullptr) {
-            m_msgs_before_open.push_back(strTimestamped);
+            m_msgs_before_open.push_back(str);
 
         } else {
             // reopen the log file, if requested
@@ -228,8 +263,69 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
                     m_fileout = new_fileout;
                 }
             }
-            FileWriteStr(strTimestamped, m_fileout);
+            FileWriteStr(str, m_fileout);
+        }
+    }
+}
+
+void BCLog::Logger::StartAsync(size_t nBufferSize, bool fBlockOnOverflow)
+{
+    if (m_async) return;
+    m_buffer.reset(new LogRingBuffer(std::max<size_t>(nBufferSize, 1)));
+    m_block_on_overflow = fBlockOnOverflow;
+    m_writer_stop = false;
+    m_writer_thread = std::thread(&BCLog::Logger::WriterThread, this);
+    m_async = true;
+}
+
+void BCLog::Logger::StopAsync()
+{
+    if (!m_async.exchange(false)) return;
+    // The callers that saw m_async set are about to push their line
+    while (m_producers > 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        m_writer_stop = true;
+    }
+    m_writer_cv.notify_one();
+    m_writer_thread.join();
+}
+
+void BCLog::Logger::WriterThread()
+{
+    util::ThreadRename("pivx-logger");
+
+    // Largest write: the lines are appended to one string and written at once
+    constexpr size_t MAX_BATCH_SIZE = 1 << 20;
+
+    std::string batch;
+    uint64_t nDroppedReported = 0;
+    LogEntry entry;
+    while (true) {
+        const bool fStop = m_writer_stop;
+        batch.clear();
+        while (batch.size() < MAX_BATCH_SIZE && m_buffer->TryPop(entry)) {
+            batch += LogTimestampStr(entry);
+        }
+        const uint64_t nDropped = m_dropped;
+        if (nDropped != nDroppedReported) {
+            batch += strprintf("Logger: %u messages dropped, the log buffer is full\n", nDropped - nDroppedReported);
+            nDroppedReported = nDropped;
+        }
+        if (!batch.empty()) {
+            WriteToOutputs(batch);
+            continue;
         }
+        // Stopped and nothing left: the queue was empty after the stop request
+        if (fStop) break;
+
+        std::unique_lock<std::mutex> lock(m_writer_mutex);
+        m_writer_sleeping = true;
+        // The callers notify without the mutex, a missed wakeup only delays the write
+        m_writer_cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return m_writer_stop || !m_buffer->Empty(); });
+        m_writer_sleeping = false;
     }
 }
 
@@ -258,6 +354,59 @@ void BCLog::Logger::ShrinkDebugFile()
         fclose(file);
 }
 
+BCLog::LogRingBuffer::LogRingBuffer(size_t nCapacity)
+{
+    // At least two slots: with one, a free and a published slot have the same sequence
+    size_t nSize = 2;
+    while (nSize < nCapacity) nSize <<= 1;
+    m_slots.reset(new Slot[nSize]);
+    m_mask = nSize - 1;
+    for (size_t i = 0; i < nSize; i++) {
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool BCLog::LogRingBuffer::TryPush(LogEntry& entry)
+{
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        const size_t seq = slot->seq.load(std::memory_order_acquire);
+        const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            // Free slot at our position: claim it
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            // Still holds the entry of the previous lap: full
+            return false;
+        } else {
+            // Claimed by another producer
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+    slot->entry = std::move(entry);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool BCLog::LogRingBuffer::Empty() const
+{
+    return m_slots[m_tail & m_mask].seq.load(std::memory_order_acquire) != m_tail + 1;
+}
+
+bool BCLog::LogRingBuffer::TryPop(LogEntry& entry)
+{
+    Slot& slot = m_slots[m_tail & m_mask];
+    if (slot.seq.load(std::memory_order_acquire) != m_tail + 1) {
+        return false;
+    }
+    entry = std::move(slot.entry);
+    slot.seq.store(m_tail + m_mask + 1, std::memory_order_release);
+    m_tail++;
+    return true;
+}
+
 /// HU-Core
 
 CBatchedLogger::CBatchedLogger(BCLog::Logger* _logger, BCLog::LogFlags _category, const std::string& _header) :
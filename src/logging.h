@@ -16,15 +16,21 @@
 #include "tinyformat.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 
 static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
+static const bool DEFAULT_LOGASYNC      = true;
+static const unsigned int DEFAULT_LOGBUFFERSIZE = 65536;
+static const char* const DEFAULT_LOGOVERFLOW = "block";
 extern const char * const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogIPs;
@@ -65,6 +71,47 @@ namespace BCLog {
         ALL         = ~(uint32_t)0,
     };
 
+    /** A log line on its way to the outputs: the timestamp is taken by the caller, formatted by the writer. */
+    struct LogEntry
+    {
+        bool fTimestamp{false};
+        int64_t nTimeMicros{0};
+        int64_t nMockTime{0};
+        std::string str;
+    };
+
+    /**
+     * Bounded lock-free queue of log entries, many producers and a single
+     * consumer. Every slot has a sequence number: a producer claims the next
+     * position with a CAS on m_head, fills the slot and publishes it by
+     * bumping the sequence, the consumer frees it by bumping it once more.
+     * The capacity is rounded up to a power of two, two slots at least.
+     */
+    class LogRingBuffer
+    {
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> seq;
+            LogEntry entry;
+        };
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask;
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) size_t m_tail{0};
+
+    public:
+        explicit LogRingBuffer(size_t nCapacity);
+
+        size_t Capacity() const { return m_mask + 1; }
+        /** Enqueue entry, return false (entry untouched) if the buffer is full */
+        bool TryPush(LogEntry& entry);
+        /** Whether there is no entry to dequeue. Consumer only. */
+        bool Empty() const;
+        /** Dequeue the oldest entry, return false if the buffer is empty. Consumer only. */
+        bool TryPop(LogEntry& entry);
+    };
+
     class Logger
     {
     private:
@@ -72,6 +119,23 @@ namespace BCLog {
         std::mutex m_file_mutex;
         std::list<std::string> m_msgs_before_open;
 
+        /**
+         * Asynchronous mode: LogPrintStr only queues the line in m_buffer, the
+         * writer thread formats the timestamps and writes the lines in batches.
+         * m_producers counts the callers between the m_async check and the
+         * push, so that StopAsync can wait for them before the last drain.
+         */
+        std::unique_ptr<LogRingBuffer> m_buffer;
+        std::atomic<bool> m_async{false};
+        std::atomic<int> m_producers{0};
+        bool m_block_on_overflow{true};
+        std::atomic<uint64_t> m_dropped{0};
+        std::thread m_writer_thread;
+        std::mutex m_writer_mutex;
+        std::condition_variable m_writer_cv;
+        std::atomic<bool> m_writer_sleeping{false};
+        std::atomic<bool> m_writer_stop{false};
+
         /**
          * m_started_new_line is a state variable that will suppress printing of
          * the timestamp when multiple calls are made that don't end in a
@@ -82,9 +146,14 @@ namespace BCLog {
         /** Log categories bitfield. */
         std::atomic<uint32_t> m_categories{0};
 
-        std::string LogTimestampStr(const std::string& str);
+        std::string LogTimestampStr(const LogEntry& entry) const;
+        /** Write to the console and the debug log file, the timestamps already in */
+        void WriteToOutputs(const std::string& str);
+        void WriterThread();
 
     public:
+        ~Logger();
+
         bool m_print_to_console = false;
         bool m_print_to_file = false;
 
@@ -97,6 +166,19 @@ namespace BCLog {
         /** Send a string to the log output */
         void LogPrintStr(const std::string &str);
 
+        /**
+         * Hand the writes over to a writer thread, through a buffer of
+         * nBufferSize lines. When the buffer is full the callers wait for the
+         * writer if fBlockOnOverflow, otherwise their lines are dropped and
+         * counted (the writer logs how many).
+         */
+        void StartAsync(size_t nBufferSize, bool fBlockOnOverflow);
+        /** Write the queued lines, stop the writer thread and go back to synchronous writes */
+        void StopAsync();
+        bool IsAsync() const { return m_async.load(); }
+        /** Number of lines dropped because the buffer was full */
+        uint64_t GetDroppedCount() const { return m_dropped.load(); }
+
         /** Returns whether logs will be written to any output */
         bool Enabled() const { return m_print_to_console || m_print_to_file; }
 
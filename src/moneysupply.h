@@ -10,6 +10,11 @@
 
 /*
  * Class used to cache the sum of utxo's values
+ *
+ * Maintained incrementally: every connected (disconnected) block adds the
+ * value of the outputs it creates (removes) minus the value of the coins it
+ * spends (restores), as recorded in its undo data. The value is written to
+ * the chainstate DB on every flush, tagged with the best block.
  */
 class CMoneySupply {
 private:
@@ -17,19 +22,39 @@ private:
     CAmount nSupply;
     // height of the chain when the supply was last updated
     int64_t nHeight;
+    // false until loaded from the chainstate DB or computed by a full UTXO scan
+    bool fValid;
 
 public:
-    CMoneySupply(): nSupply(0), nHeight(0) {}
+    CMoneySupply(): nSupply(0), nHeight(0), fValid(false) {}
 
     void Update(const CAmount& _nSupply, int _nHeight)
     {
         LOCK(cs);
         nSupply = _nSupply;
         nHeight = _nHeight;
+        fValid = true;
+    }
+
+    // Block connected (or disconnected, nDelta negative)
+    void Add(const CAmount& nDelta, int _nHeight)
+    {
+        LOCK(cs);
+        nSupply += nDelta;
+        nHeight = _nHeight;
+    }
+
+    // Result of a full UTXO scan: the scanned total minus the supply at the scanned block
+    void Adjust(const CAmount& nCorrection)
+    {
+        LOCK(cs);
+        nSupply += nCorrection;
+        fValid = true;
     }
 
     CAmount Get() const { LOCK(cs); return nSupply; }
     int64_t GetCacheHeight() const { LOCK(cs); return nHeight; }
+    bool IsValid() const { LOCK(cs); return fValid; }
 };
 
 #endif // HU_MONEYSUPPLY_H
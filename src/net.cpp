@@ -1504,20 +1504,25 @@ void CConnman::SocketHandler()
                     pnode->CloseSocketDisconnect();
                 RecordBytesRecv(nBytes);
                 if (notify) {
+                    // Until the first message after the handshake is processed everything
+                    // goes to the general lane, to keep VERSION/VERACK/MNAUTH in order
+                    const bool fUseLanes = pnode->fFirstMessageReceived;
                     size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        if (!it->complete())
-                            break;
+                    bool fLaneAdded[MSG_LANE_COUNT] = {};
+                    LOCK(pnode->cs_vProcessMsg);
+                    while (!pnode->vRecvMsg.empty() && pnode->vRecvMsg.front().complete()) {
+                        auto it = pnode->vRecvMsg.begin();
+                        const MsgLane lane = fUseLanes ? GetMsgLane(it->hdr.GetCommand()) : MSG_LANE_GENERAL;
                         nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
+                        pnode->vProcessMsg[lane].splice(pnode->vProcessMsg[lane].end(), pnode->vRecvMsg, it);
+                        msgLanes[lane].nQueued++;
+                        fLaneAdded[lane] = true;
                     }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+                    pnode->nProcessQueueSize += nSizeAdded;
+                    pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+                    for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+                        if (fLaneAdded[lane]) WakeMessageHandler((MsgLane)lane);
                     }
-                    WakeMessageHandler();
                 }
             } else if (nBytes == 0) {
                 // socket closed gracefully
@@ -1559,13 +1564,69 @@ void CConnman::ThreadSocketHandler()
     }
 }
 
-void CConnman::WakeMessageHandler()
+void CConnman::WakeMessageHandler(MsgLane lane)
 {
+    MsgLaneState& state = msgLanes[lane];
     {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+        std::lock_guard<std::mutex> lock(state.mutexMsgProc);
+        state.fMsgProcWake = true;
     }
-    condMsgProc.notify_one();
+    state.condMsgProc.notify_one();
+}
+
+MsgLane GetMsgLane(const std::string& strCommand)
+{
+    if (strCommand == NetMsgType::BLOCK ||
+        strCommand == NetMsgType::CMPCTBLOCK ||
+        strCommand == NetMsgType::BLOCKTXN ||
+        strCommand == NetMsgType::HEADERS ||
+        strCommand == NetMsgType::HUSIG ||
+        strCommand == NetMsgType::MNAUTH) {
+        return MSG_LANE_PRIORITY;
+    }
+    return MSG_LANE_GENERAL;
+}
+
+std::string GetMsgLaneName(MsgLane lane)
+{
+    switch (lane) {
+    case MSG_LANE_PRIORITY: return "priority";
+    case MSG_LANE_GENERAL: return "general";
+    default: return "unknown";
+    }
+}
+
+bool CConnman::PollMessage(CNode* pnode, MsgLane lane, std::list<CNetMessage>& msgs, bool& fMoreWork)
+{
+    LOCK(pnode->cs_vProcessMsg);
+    std::list<CNetMessage>& vProcessMsg = pnode->vProcessMsg[lane];
+    if (vProcessMsg.empty())
+        return false;
+    // Just take one message
+    msgs.splice(msgs.begin(), vProcessMsg, vProcessMsg.begin());
+    pnode->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+    pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+    fMoreWork = !vProcessMsg.empty();
+
+    MsgLaneState& state = msgLanes[lane];
+    const int64_t nLatency = std::max<int64_t>(0, GetTimeMicros() - msgs.front().nTime);
+    state.nQueued--;
+    state.nProcessed++;
+    state.nLatencyTotal += nLatency;
+    int64_t nMax = state.nLatencyMax;
+    while (nLatency > nMax && !state.nLatencyMax.compare_exchange_weak(nMax, nLatency)) {}
+    return true;
+}
+
+CMsgLaneStats CConnman::GetMsgLaneStats(MsgLane lane) const
+{
+    const MsgLaneState& state = msgLanes[lane];
+    CMsgLaneStats stats;
+    stats.nQueued = state.nQueued;
+    stats.nProcessed = state.nProcessed;
+    stats.nLatencyTotal = state.nLatencyTotal;
+    stats.nLatencyMax = state.nLatencyMax;
+    return stats;
 }
 
 void CConnman::WakeSelect()
@@ -1984,8 +2045,9 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
     }
 }
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(MsgLane lane)
 {
+    MsgLaneState& laneState = msgLanes[lane];
     int64_t nLastSendMessagesTimeMasternodes = 0;
 
     while (!flagInterruptMsgProc) {
@@ -1993,41 +2055,62 @@ void CConnman::ThreadMessageHandler()
 
         bool fMoreWork = false;
 
-        // Don't send other messages to quorum nodes too often
-        bool fSkipSendMessagesForMasternodes = true;
-        if (GetTimeMillis() - nLastSendMessagesTimeMasternodes >= 100) {
-            fSkipSendMessagesForMasternodes = false;
+        // The general lane sends to the regular peers and the priority lane to
+        // the quorum nodes: right after it processed one of their messages,
+        // otherwise not more often than every 100 ms.
+        bool fSendMessagesForMasternodes = false;
+        if (lane == MSG_LANE_PRIORITY && GetTimeMillis() - nLastSendMessagesTimeMasternodes >= 100) {
+            fSendMessagesForMasternodes = true;
             nLastSendMessagesTimeMasternodes = GetTimeMillis();
         }
 
-        for (CNode* pnode : vNodesCopy) {
-            if (pnode->fDisconnect)
-                continue;
-
+        auto processNode = [&](CNode* pnode) {
             // Receive messages
-            bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
+            const uint64_t nProcessedBefore = laneState.nProcessed;
+            bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, lane, flagInterruptMsgProc);
             fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
             if (flagInterruptMsgProc)
                 return;
 
             // Send messages
-            if (!fSkipSendMessagesForMasternodes || !pnode->m_masternode_connection) {
+            const bool fSend = pnode->m_masternode_connection ?
+                               lane == MSG_LANE_PRIORITY && (fSendMessagesForMasternodes || laneState.nProcessed != nProcessedBefore) :
+                               lane == MSG_LANE_GENERAL;
+            if (fSend) {
                 LOCK(pnode->cs_sendProcessing);
                 m_msgproc->SendMessages(pnode, flagInterruptMsgProc);
             }
+        };
+
+        for (CNode* pnode : vNodesCopy) {
+            if (pnode->fDisconnect)
+                continue;
+
+            // A peer is handled by one lane at a time. The priority lane does not
+            // wait for the general one, it comes back to the peer on the next pass.
+            if (lane == MSG_LANE_PRIORITY) {
+                TRY_LOCK(pnode->cs_processMessages, lockProcess);
+                if (!lockProcess) {
+                    fMoreWork = true;
+                    continue;
+                }
+                processNode(pnode);
+            } else {
+                LOCK(pnode->cs_processMessages);
+                processNode(pnode);
+            }
 
             if (flagInterruptMsgProc)
                 return;
         }
 
-
         ReleaseNodeVector(vNodesCopy);
 
-        std::unique_lock<std::mutex> lock(mutexMsgProc);
+        std::unique_lock<std::mutex> lock(laneState.mutexMsgProc);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this] { return fMsgProcWake; });
+            laneState.condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&laneState] { return laneState.fMsgProcWake; });
         }
-        fMsgProcWake = false;
+        laneState.fMsgProcWake = false;
     }
 }
 
@@ -2288,9 +2371,9 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        std::unique_lock<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = false;
+    for (MsgLaneState& laneState : msgLanes) {
+        std::unique_lock<std::mutex> lock(laneState.mutexMsgProc);
+        laneState.fMsgProcWake = false;
     }
 
 #ifdef USE_WAKEUP_PIPE
@@ -2340,8 +2423,9 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
                 std::bind(&CConnman::ThreadOpenConnections, this, connOptions.m_specified_outgoing)));
     }
 
-    // Process messages
-    threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    // Process messages, one thread per lane
+    msgLanes[MSG_LANE_GENERAL].threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, MSG_LANE_GENERAL)));
+    msgLanes[MSG_LANE_PRIORITY].threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msgprio", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, MSG_LANE_PRIORITY)));
 
     // Dump network addresses
     scheduler.scheduleEvery(std::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL * 1000);
@@ -2374,11 +2458,13 @@ void CExplicitNetCleanup::callCleanup()
 
 void CConnman::Interrupt()
 {
-    {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        flagInterruptMsgProc = true;
+    for (MsgLaneState& laneState : msgLanes) {
+        {
+            std::lock_guard<std::mutex> lock(laneState.mutexMsgProc);
+            flagInterruptMsgProc = true;
+        }
+        laneState.condMsgProc.notify_all();
     }
-    condMsgProc.notify_all();
 
     interruptNet();
     if (m_tiertwo_conn_man) m_tiertwo_conn_man->interrupt();
@@ -2399,8 +2485,10 @@ void CConnman::Interrupt()
 
 void CConnman::Stop()
 {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (MsgLaneState& laneState : msgLanes) {
+        if (laneState.threadMessageHandler.joinable())
+            laneState.threadMessageHandler.join();
+    }
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -2448,6 +2536,12 @@ void CConnman::Stop()
 void CConnman::DeleteNode(CNode* pnode)
 {
     assert(pnode);
+    {
+        LOCK(pnode->cs_vProcessMsg);
+        for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+            msgLanes[lane].nQueued -= pnode->vProcessMsg[lane].size();
+        }
+    }
     bool fUpdateConnectionTime = false;
     m_msgproc->FinalizeNode(pnode->GetId(), fUpdateConnectionTime);
     if (fUpdateConnectionTime) {
@@ -108,6 +108,32 @@ static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Defaul
 
 typedef int NodeId;
 
+/**
+ * Message processing lanes. Every peer has a receive queue per lane, and each
+ * lane is served by its own thread, so a flood of tx/inv from regular peers
+ * does not delay the messages on the critical path to finality. The messages
+ * of a peer are processed in order within a lane, but a priority message can
+ * overtake the general ones received before it.
+ */
+enum MsgLane : uint8_t {
+    MSG_LANE_PRIORITY = 0,  //!< blocks, headers, HU signatures and masternode auth
+    MSG_LANE_GENERAL,       //!< everything else: tx relay, address gossip, tier two sync...
+    MSG_LANE_COUNT
+};
+
+/** Lane a message is processed on, once the peer completed the handshake */
+MsgLane GetMsgLane(const std::string& strCommand);
+std::string GetMsgLaneName(MsgLane lane);
+
+/** Message processing counters of a lane, for getnetworkinfo */
+struct CMsgLaneStats
+{
+    uint64_t nQueued{0};       //!< messages waiting in the lane queues of all the peers
+    uint64_t nProcessed{0};    //!< messages taken from the lane since startup
+    int64_t nLatencyTotal{0};  //!< sum of the receive-to-processing delays, in microseconds
+    int64_t nLatencyMax{0};    //!< largest receive-to-processing delay, in microseconds
+};
+
 struct AddedNodeInfo
 {
     std::string strAddedNode;
@@ -124,6 +150,7 @@ struct AddedNodeInfo
 };
 
 class CTransaction;
+class CNetMessage;
 class CNodeStats;
 class CClientUIInterface;
 
@@ -370,6 +397,10 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Take the next message of pnode's lane queue. Returns false if the queue is empty. */
+    bool PollMessage(CNode* pnode, MsgLane lane, std::list<CNetMessage>& msgs, bool& fMoreWork);
+    CMsgLaneStats GetMsgLaneStats(MsgLane lane) const;
+
     void SetAsmap(std::vector<bool> asmap) { addrman.m_asmap = std::move(asmap); }
     /** Unique tier two connections manager */
     TierTwoConnMan* GetTierTwoConnMan() { return m_tiertwo_conn_man.get(); };
@@ -391,7 +422,7 @@ private:
     void AddOneShot(const std::string& strDest);
     void ProcessOneShot();
     void ThreadOpenConnections(const std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(MsgLane lane);
     void AcceptConnection(const ListenSocket& hListenSocket);
     void DisconnectNodes();
     void NotifyNumConnectionsChanged();
@@ -402,7 +433,7 @@ private:
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
-    void WakeMessageHandler();
+    void WakeMessageHandler(MsgLane lane);
 
     uint64_t CalculateKeyedNetGroup(const CAddress& ad);
 
@@ -486,11 +517,20 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0{0}, nSeed1{0};
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake{false};
-
-    std::condition_variable condMsgProc;
-    std::mutex mutexMsgProc;
+    /** Wake-up flag, thread and counters of a message processing lane */
+    struct MsgLaneState
+    {
+        bool fMsgProcWake{false};
+        std::condition_variable condMsgProc;
+        std::mutex mutexMsgProc;
+        std::thread threadMessageHandler;
+
+        std::atomic<uint64_t> nQueued{0};
+        std::atomic<uint64_t> nProcessed{0};
+        std::atomic<int64_t> nLatencyTotal{0};
+        std::atomic<int64_t> nLatencyMax{0};
+    };
+    MsgLaneState msgLanes[MSG_LANE_COUNT];
     std::atomic<bool> flagInterruptMsgProc;
 
     CThreadInterrupt interruptNet;
@@ -505,7 +545,6 @@ private:
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
 
     std::unique_ptr<TierTwoConnMan> m_tiertwo_conn_man;
 };
@@ -680,8 +719,11 @@ public:
     RecursiveMutex cs_vRecv;
 
     RecursiveMutex cs_vProcessMsg;
-    std::list<CNetMessage> vProcessMsg;
-    size_t nProcessQueueSize;
+    std::list<CNetMessage> vProcessMsg[MSG_LANE_COUNT];
+    size_t nProcessQueueSize; // total size of the messages of all the lanes
+
+    // Held by the lane processing a message of (or sending messages to) this peer
+    RecursiveMutex cs_processMessages;
 
     RecursiveMutex cs_sendProcessing;
 
@@ -918,6 +960,11 @@ public:
             }
         } else if (inv.type == MSG_BLOCK) {
             vInventoryBlockToSend.push_back(inv.hash);
+        } else if (inv.type == MSG_HU_SIGNATURE) {
+            // Announced once per peer, and never back to a peer that sent or announced it
+            if (filterInventoryKnown.contains(inv.hash)) return;
+            filterInventoryKnown.insert(inv.hash);
+            vInventoryTierTwoToSend.emplace_back(inv);
         } else {
             vInventoryTierTwoToSend.emplace_back(inv);
         }
@@ -956,7 +1003,7 @@ public:
 class NetEventsInterface
 {
 public:
-    virtual bool ProcessMessages(CNode* pnode, std::atomic<bool>& interrupt) = 0;
+    virtual bool ProcessMessages(CNode* pnode, MsgLane lane, std::atomic<bool>& interrupt) = 0;
     virtual bool SendMessages(CNode* pnode, std::atomic<bool>& interrupt) EXCLUSIVE_LOCKS_REQUIRED(pnode->cs_sendProcessing) = 0;
     virtual void InitializeNode(CNode* pnode) = 0;
     virtual void FinalizeNode(NodeId id, bool& update_connection_time) = 0;
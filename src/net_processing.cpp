@@ -7,6 +7,8 @@
 
 #include "net_processing.h"
 
+#include "activemasternode.h"
+#include "blockencodings.h"
 #include "chain.h"
 #include "evo/deterministicmns.h"
 #include "evo/mnauth.h"
@@ -106,6 +108,7 @@ struct QueuedBlock {
     int64_t nTime;              //! Time of "getdata" request in microseconds.
     int nValidatedQueuedBefore; //! Number of blocks queued with validated headers (globally) at the time this one is requested.
     bool fValidatedHeaders;     //! Whether this block has validated headers at the time of request.
+    std::unique_ptr<PartiallyDownloadedBlock> partialBlock; //! Optional, used for compact block reconstruction.
 };
 std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> > mapBlocksInFlight;
 
@@ -115,6 +118,15 @@ int nQueuedValidatedHeaders = 0;
 /** Number of preferable block download peers. */
 int nPreferredDownload = 0;
 
+/** Number of peers waiting to be disconnected for misbehaving. Written under cs_main. */
+std::atomic<int> nPeersShouldBan{0};
+
+/** Last connected block, kept to answer cmpctblock/getblocktxn without reading it back from disk. */
+RecursiveMutex cs_most_recent_block;
+std::shared_ptr<const CBlock> most_recent_block GUARDED_BY(cs_most_recent_block);
+std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_block GUARDED_BY(cs_most_recent_block);
+uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
+
 } // anon namespace
 
 namespace
@@ -225,6 +237,12 @@ struct CNodeState {
     int nBlocksInFlight;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload;
+    //! Whether this peer can give us compact blocks (sent sendcmpct version 1)
+    bool fProvidesHeaderAndIDs;
+    //! Whether this peer wants new blocks announced with a cmpctblock (high-bandwidth mode)
+    bool fPreferHeaderAndIDs;
+    //! Whether we asked this peer to announce new blocks to us with a cmpctblock
+    bool fRequestedHeaderAndIDs;
     //! Addresses processed
     uint64_t amt_addr_processed = 0;
     //! Addresses rate limited
@@ -243,6 +261,9 @@ struct CNodeState {
         nStallingSince = 0;
         nBlocksInFlight = 0;
         fPreferredDownload = false;
+        fProvidesHeaderAndIDs = false;
+        fPreferHeaderAndIDs = false;
+        fRequestedHeaderAndIDs = false;
     }
 };
 
@@ -315,7 +336,8 @@ void MarkBlockAsReceived(const uint256& hash)
 }
 
 // Requires cs_main.
-void MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex* pindex = nullptr)
+// pit (optional) is set to the new in-flight entry, e.g. to attach a partial (compact) block to it.
+void MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex* pindex = nullptr, std::list<QueuedBlock>::iterator* pit = nullptr)
 {
     CNodeState* state = State(nodeid);
     assert(state != nullptr);
@@ -323,11 +345,13 @@ void MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex*
     // Make sure it's not listed somewhere already.
     MarkBlockAsReceived(hash);
 
-    QueuedBlock newentry = {hash, pindex, GetTimeMicros(), nQueuedValidatedHeaders, pindex != nullptr};
+    QueuedBlock newentry = {hash, pindex, GetTimeMicros(), nQueuedValidatedHeaders, pindex != nullptr, nullptr};
     nQueuedValidatedHeaders += newentry.fValidatedHeaders;
-    std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(), newentry);
+    std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(), std::move(newentry));
     state->nBlocksInFlight++;
     mapBlocksInFlight[hash] = std::make_pair(nodeid, it);
+    if (pit)
+        *pit = it;
 }
 
 /** Check whether the last unknown block a peer advertised is not yet known. */
@@ -486,6 +510,7 @@ void PeerLogicValidation::FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTim
         mapBlocksInFlight.erase(entry.hash);
     EraseOrphansFor(nodeid);
     nPreferredDownload -= state->fPreferredDownload;
+    nPeersShouldBan -= state->fShouldBan;
 
     mapNodeState.erase(nodeid);
     LogPrint(BCLog::NET, "Cleared nodestate for peer=%d\n", nodeid);
@@ -640,6 +665,7 @@ void Misbehaving(NodeId pnode, int howmuch, const std::string& message) EXCLUSIV
     std::string message_prefixed = message.empty() ? "" : (": " + message);
     if (state->nMisbehavior >= banscore && state->nMisbehavior - howmuch < banscore) {
         LogPrint(BCLog::NET, "%s: %s peer=%d (%d -> %d) BAN THRESHOLD EXCEEDED%s\n", __func__, state->name, pnode, state->nMisbehavior-howmuch, state->nMisbehavior, message_prefixed);
+        if (!state->fShouldBan) nPeersShouldBan++;
         state->fShouldBan = true;
     } else {
         LogPrint(BCLog::NET, "%s: %s peer=%d (%d -> %d)%s\n", __func__, state->name, pnode, state->nMisbehavior-howmuch, state->nMisbehavior, message_prefixed);
@@ -711,6 +737,14 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn) :
 
 void PeerLogicValidation::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex)
 {
+    if (!IsInitialBlockDownload()) {
+        auto pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock);
+        LOCK(cs_most_recent_block);
+        most_recent_block_hash = pindex->GetBlockHash();
+        most_recent_block = pblock;
+        most_recent_compact_block = pcmpctblock;
+    }
+
     LOCK(g_cs_orphans);
 
     std::vector<uint256> vOrphanErase;
@@ -747,12 +781,29 @@ void PeerLogicValidation::UpdatedBlockTip(const CBlockIndex* pindexNew, const CB
 
     if (!fInitialDownload) {
         const uint256& hashNewTip = pindexNew->GetBlockHash();
+        std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock;
+        {
+            LOCK(cs_most_recent_block);
+            if (most_recent_block_hash == hashNewTip) {
+                pcmpctblock = most_recent_compact_block;
+            }
+        }
         // Relay inventory, but don't relay old inventory during initial block download.
-        connman->ForEachNode([nNewHeight, hashNewTip](CNode* pnode) {
+        // High-bandwidth compact block peers get the block itself, saving a getdata round trip.
+        LOCK(cs_main);
+        connman->ForEachNode([this, nNewHeight, &hashNewTip, &pcmpctblock](CNode* pnode) {
+            AssertLockHeld(cs_main);
             // Don't sync from MN only connections.
             if (!pnode->CanRelay()) {
                 return;
             }
+            CNodeState* state = State(pnode->GetId());
+            if (pcmpctblock && state && state->fPreferHeaderAndIDs && pnode->nVersion >= SHORT_IDS_BLOCKS_VERSION) {
+                LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", __func__, hashNewTip.ToString(), pnode->GetId());
+                connman->PushMessage(pnode, CNetMsgMaker(pnode->GetSendVersion()).Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+                pnode->AddInventoryKnown(CInv(MSG_BLOCK, hashNewTip));
+                return;
+            }
             if (nNewHeight > (pnode->nStartingHeight != -1 ? pnode->nStartingHeight - 2000 : 0)) {
                 pnode->PushInventory(CInv(MSG_BLOCK, hashNewTip));
             }
@@ -840,6 +891,8 @@ bool static AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
     case MSG_QUORUM_RECOVERED_SIG:
     case MSG_CLSIG:
         return true; // PIVHU: pretend we have it to avoid requests
+    case MSG_HU_SIGNATURE:
+        return !hu::huSignalingManager || hu::huSignalingManager->AlreadyHave(inv.hash);
     }
 
     // Don't know what it is, just say we already got one
@@ -912,6 +965,14 @@ bool static PushTierTwoGetDataRequest(const CInv& inv,
     if (inv.type == MSG_QUORUM_RECOVERED_SIG || inv.type == MSG_CLSIG) {
         return false; // PIVHU: no longer supported
     }
+
+    if (inv.type == MSG_HU_SIGNATURE) {
+        hu::CHuSignature sig;
+        if (hu::huSignalingManager && hu::huSignalingManager->GetSignatureByInv(inv.hash, sig)) {
+            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::HUSIG, sig));
+            return true;
+        }
+    }
     // nothing was pushed.
     return false;
 }
@@ -945,7 +1006,15 @@ void static ProcessGetBlockData(CNode* pfrom, const CInv& inv, CConnman* connman
             assert(!"cannot load block from disk");
         if (inv.type == MSG_BLOCK)
             connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, block));
-        else // MSG_FILTERED_BLOCK)
+        else if (inv.type == MSG_CMPCT_BLOCK) {
+            // A compact block only helps a peer that is about to catch up with our tip,
+            // and it may not have the transactions of older blocks: send those in full.
+            if (pfrom->nVersion >= SHORT_IDS_BLOCKS_VERSION && chainActive.Height() - pindex->nHeight < MAX_CMPCTBLOCK_DEPTH) {
+                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(block)));
+            } else {
+                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, block));
+            }
+        } else // MSG_FILTERED_BLOCK)
         {
             bool send_ = false;
             CMerkleBlock merkleBlock;
@@ -997,7 +1066,8 @@ bool static IsTierTwoInventoryTypeKnown(int type)
            type == MSG_QUORUM_JUSTIFICATION ||
            type == MSG_QUORUM_PREMATURE_COMMITMENT ||
            type == MSG_QUORUM_RECOVERED_SIG ||
-           type == MSG_CLSIG;
+           type == MSG_CLSIG ||
+           type == MSG_HU_SIGNATURE;
 }
 
 void static ProcessGetData(CNode* pfrom, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
@@ -1048,7 +1118,7 @@ void static ProcessGetData(CNode* pfrom, CConnman* connman, const std::atomic<bo
 
     if (it != pfrom->vRecvGetData.end() && !pfrom->fPauseSend) {
         const CInv &inv = *it;
-        if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK) {
+        if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK) {
             it++;
             ProcessGetBlockData(pfrom, inv, connman, interruptMsgProc);
         }
@@ -1069,6 +1139,52 @@ void static ProcessGetData(CNode* pfrom, CConnman* connman, const std::atomic<bo
 }
 
 bool fRequestedSporksIDB = false;
+static void SendBlockTransactions(const CBlock& block, const BlockTransactionsRequest& req, CNode* pfrom, CConnman* connman)
+{
+    BlockTransactions resp(req);
+    for (size_t i = 0; i < req.indexes.size(); i++) {
+        if (req.indexes[i] >= block.vtx.size()) {
+            LOCK(cs_main);
+            Misbehaving(pfrom->GetId(), 100, strprintf("getblocktxn with out-of-bounds tx indices from peer=%d", pfrom->GetId()));
+            return;
+        }
+        resp.txn[i] = block.vtx[req.indexes[i]];
+    }
+    connman->PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::BLOCKTXN, resp));
+}
+
+/** Complete the compact block in flight from pfrom with the missing transactions and process it */
+static void ProcessBlockTransactions(CNode* pfrom, const BlockTransactions& resp, CConnman* connman)
+{
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+    {
+        LOCK(cs_main);
+        auto it = mapBlocksInFlight.find(resp.blockhash);
+        if (it == mapBlocksInFlight.end() || !it->second.second->partialBlock || it->second.first != pfrom->GetId()) {
+            LogPrint(BCLog::NET, "Peer %d sent us block transactions for block we weren't expecting\n", pfrom->GetId());
+            return;
+        }
+
+        PartiallyDownloadedBlock& partialBlock = *it->second.second->partialBlock;
+        ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn);
+        if (status == READ_STATUS_INVALID) {
+            MarkBlockAsReceived(resp.blockhash); // Reset in-flight state in case of whitelist
+            Misbehaving(pfrom->GetId(), 100, strprintf("invalid compact block/non-matching block transactions from peer=%d", pfrom->GetId()));
+            return;
+        } else if (status == READ_STATUS_FAILED) {
+            // Might have collided, fall back to getdata now :(
+            std::vector<CInv> invs;
+            invs.emplace_back(MSG_BLOCK, resp.blockhash);
+            connman->PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::GETDATA, invs));
+            return;
+        }
+
+        MarkBlockAsReceived(resp.blockhash);
+        mapBlockSource.emplace(resp.blockhash, pfrom->GetId());
+    }
+    ProcessNewBlock(pblock, nullptr);
+}
+
 bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vRecv, int64_t nTimeReceived, CConnman* connman, std::atomic<bool>& interruptMsgProc)
 {
     LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->GetId());
@@ -1285,6 +1401,14 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
             CMNAuth::PushMNAUTH(pfrom, *connman);
         }
 
+        if (pfrom->nVersion >= SHORT_IDS_BLOCKS_VERSION && !pfrom->m_masternode_probe_connection) {
+            // Tell our peer we can provide compact blocks (low-bandwidth: announced by inv).
+            // High-bandwidth mode is requested later, from masternode peers only.
+            bool fAnnounceUsingCMPCTBLOCK = false;
+            uint64_t nCMPCTBLOCKVersion = 1;
+            connman->PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::SENDCMPCT, fAnnounceUsingCMPCTBLOCK, nCMPCTBLOCKVersion));
+        }
+
         pfrom->fSuccessfullyConnected = true;
         LogPrintf("New outbound peer connected: version: %d, blocks=%d, peer=%d%s\n",
                   pfrom->nVersion.load(), pfrom->nStartingHeight, pfrom->GetId(),
@@ -1305,6 +1429,19 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
         return false;
     }
 
+    else if (strCommand == NetMsgType::SENDCMPCT) {
+        bool fAnnounceUsingCMPCTBLOCK = false;
+        uint64_t nCMPCTBLOCKVersion = 0;
+        vRecv >> fAnnounceUsingCMPCTBLOCK >> nCMPCTBLOCKVersion;
+        if (nCMPCTBLOCKVersion == 1) {
+            LOCK(cs_main);
+            CNodeState* nodestate = State(pfrom->GetId());
+            nodestate->fProvidesHeaderAndIDs = true;
+            nodestate->fPreferHeaderAndIDs = fAnnounceUsingCMPCTBLOCK;
+        }
+        return true;
+    }
+
     else if (strCommand == NetMsgType::QSENDRECSIGS) {
         bool b;
         vRecv >> b;
@@ -1447,9 +1584,23 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
             if (inv.type == MSG_BLOCK) {
                 UpdateBlockAvailability(pfrom->GetId(), inv.hash);
                 if (!fAlreadyHave && !fImporting && !fReindex && !mapBlocksInFlight.count(inv.hash)) {
-                    // Add this to the list of blocks to request
-                    vToFetch.push_back(inv);
-                    LogPrint(BCLog::NET, "getblocks (%d) %s to peer=%d\n", pindexBestHeader->nHeight, inv.hash.ToString(), pfrom->GetId());
+                    if (Params().HeadersFirstSyncingActive() && pfrom->nVersion >= HEADERS_FIRST_VERSION) {
+                        // First request the headers preceding the announced block. The block itself
+                        // is fetched directly only when we are close to the tip, otherwise it is
+                        // downloaded (from any peer) once its header is connected.
+                        connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexBestHeader), inv.hash));
+                        CNodeState* nodestate = State(pfrom->GetId());
+                        if (chainActive.Tip()->GetBlockTime() > GetAdjustedTime() - Params().GetConsensus().nTargetSpacing * 20 &&
+                            nodestate->nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+                            vToFetch.emplace_back(nodestate->fProvidesHeaderAndIDs ? MSG_CMPCT_BLOCK : MSG_BLOCK, inv.hash);
+                            MarkBlockAsInFlight(pfrom->GetId(), inv.hash);
+                        }
+                        LogPrint(BCLog::NET, "getheaders (%d) %s to peer=%d\n", pindexBestHeader->nHeight, inv.hash.ToString(), pfrom->GetId());
+                    } else {
+                        // Add this to the list of blocks to request
+                        vToFetch.push_back(inv);
+                        LogPrint(BCLog::NET, "getblocks (%d) %s to peer=%d\n", pindexBestHeader->nHeight, inv.hash.ToString(), pfrom->GetId());
+                    }
                 }
             } else {
                 // Allowed inv request types while we are in IBD
@@ -1481,6 +1632,10 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
                         case MSG_CLSIG:
                             doubleRequestDelay = 5 * 1000000;
                             break;
+                        case MSG_HU_SIGNATURE:
+                            // Finality of the tip waits on it: ask another peer soon
+                            doubleRequestDelay = 2 * 1000000;
+                            break;
                         }
                         pfrom->AskFor(inv, doubleRequestDelay);
                     }
@@ -1514,7 +1669,7 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
     }
 
 
-    else if (strCommand == NetMsgType::GETBLOCKS || strCommand == NetMsgType::GETHEADERS) {
+    else if (strCommand == NetMsgType::GETBLOCKS) {
 
         // Don't relay blocks inv to masternode-only connections
         if (!pfrom->CanRelay()) {
@@ -1559,26 +1714,28 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
     }
 
 
-    else if (strCommand == NetMsgType::HEADERS && Params().HeadersFirstSyncingActive()) {
+    else if (strCommand == NetMsgType::GETHEADERS) {
         CBlockLocator locator;
         uint256 hashStop;
         vRecv >> locator >> hashStop;
 
         if (locator.vHave.size() > MAX_LOCATOR_SZ) {
-            LogPrint(BCLog::NET, "getblocks locator size %lld > %d, disconnect peer=%d\n", locator.vHave.size(), MAX_LOCATOR_SZ, pfrom->GetId());
+            LogPrint(BCLog::NET, "getheaders locator size %lld > %d, disconnect peer=%d\n", locator.vHave.size(), MAX_LOCATOR_SZ, pfrom->GetId());
             pfrom->fDisconnect = true;
             return true;
         }
 
         LOCK(cs_main);
 
-        if (IsInitialBlockDownload())
+        if (IsInitialBlockDownload() && !pfrom->fWhitelisted) {
+            LogPrint(BCLog::NET, "Ignoring getheaders from peer=%d because node is in initial block download\n", pfrom->GetId());
             return true;
+        }
 
-        CBlockIndex* pindex = nullptr;
+        const CBlockIndex* pindex = nullptr;
         if (locator.IsNull()) {
             // If locator is null, return the hashStop block
-            CBlockIndex* pindex = LookupBlockIndex(hashStop);
+            pindex = LookupBlockIndex(hashStop);
             if (!pindex)
                 return true;
         } else {
@@ -1588,10 +1745,12 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
                 pindex = chainActive.Next(pindex);
         }
 
-        // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
+        // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count and the
+        // (empty) producer signature and finality certificate at the end. The producer signature is checked by
+        // ConnectBlock, once the MN list of the parent block is known.
         std::vector<CBlock> vHeaders;
         int nLimit = MAX_HEADERS_RESULTS;
-        LogPrintf("getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.ToString(), pfrom->GetId());
+        LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom->GetId());
         for (; pindex; pindex = chainActive.Next(pindex)) {
             vHeaders.push_back(pindex->GetBlockHeader());
             if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
@@ -1762,6 +1921,12 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
         for (unsigned int n = 0; n < nCount; n++) {
             vRecv >> headers[n];
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
+            std::vector<unsigned char> vchBlockSig;
+            vRecv >> vchBlockSig; // ignore producer signature; checked with the block.
+            if (headers[n].nVersion >= FINALITY_CERT_BLOCK_VERSION && vRecv.GetVersion() >= FINALITY_CERT_VERSION) {
+                CBlockFinalityCert finalityCert;
+                vRecv >> finalityCert; // ignore finality certificate; processed with the block.
+            }
         }
 
         LOCK(cs_main);
@@ -1778,10 +1943,10 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
                 return false;
             }
 
-            /*TODO: this has a CBlock cast on it so that it will compile. There should be a solution for this
-             * before headers are reimplemented on mainnet
-             */
-            if (!AcceptBlockHeader((CBlock)header, state, &pindexLast)) {
+            // The producer of a block is picked from the MN list of its parent, which only
+            // exists once the parent is connected: VerifyBlockProducerSignature runs in
+            // ConnectBlock (CheckBlockMNOnly), as for blocks announced by inv.
+            if (!AcceptBlockHeader(CBlock(header), state, &pindexLast)) {
                 int nDoS;
                 if (state.IsInvalid(nDoS)) {
                     if (nDoS > 0) {
@@ -1801,11 +1966,174 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
             // Headers message had its maximum size; the peer may have more headers.
             // TODO: optimize: if pindexLast is an ancestor of chainActive.Tip or pindexBestHeader, continue
             // from there instead.
-            LogPrintf("more getheaders (%d) to end to peer=%d (startheight:%d)\n", pindexLast->nHeight, pfrom->GetId(), pfrom->nStartingHeight);
+            LogPrint(BCLog::NET, "more getheaders (%d) to end to peer=%d (startheight:%d)\n", pindexLast->nHeight, pfrom->GetId(), pfrom->nStartingHeight);
             connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexLast), UINT256_ZERO));
         }
     }
 
+    else if (strCommand == NetMsgType::CMPCTBLOCK && !fImporting && !fReindex) // Ignore blocks received while importing
+    {
+        CBlockHeaderAndShortTxIDs cmpctblock;
+        vRecv >> cmpctblock;
+
+        const CBlockIndex* pindex = nullptr;
+        {
+            LOCK(cs_main);
+            if (!LookupBlockIndex(cmpctblock.header.hashPrevBlock)) {
+                // Doesn't connect (or is genesis), instead of DoSing in AcceptBlockHeader, request deeper headers
+                if (!IsInitialBlockDownload())
+                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexBestHeader), UINT256_ZERO));
+                return true;
+            }
+
+            CValidationState state;
+            CBlockIndex* pindexNew = nullptr;
+            if (!AcceptBlockHeader(CBlock(cmpctblock.header), state, &pindexNew)) {
+                int nDoS;
+                if (state.IsInvalid(nDoS)) {
+                    if (nDoS > 0) {
+                        Misbehaving(pfrom->GetId(), nDoS, "invalid header in cmpctblock");
+                    } else {
+                        LogPrint(BCLog::NET, "peer=%d: invalid header in cmpctblock\n", pfrom->GetId());
+                    }
+                }
+                return true;
+            }
+            pindex = pindexNew;
+        }
+
+        // A block fully rebuilt from our mempool while the same block is in flight from another peer
+        bool fBlockReconstructed = false;
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        BlockTransactions txnFromMempool;
+        {
+            LOCK(cs_main);
+            UpdateBlockAvailability(pfrom->GetId(), pindex->GetBlockHash());
+
+            // Nothing to do if we already have it or a better chain. Blocks that do not extend
+            // our tip are left to the headers-first download, which fetches them in full.
+            if ((pindex->nStatus & BLOCK_HAVE_DATA) ||
+                pindex->nChainWork <= chainActive.Tip()->nChainWork ||
+                pindex->pprev != chainActive.Tip()) {
+                return true;
+            }
+
+            auto blockInFlightIt = mapBlocksInFlight.find(pindex->GetBlockHash());
+            const bool fAlreadyInFlight = blockInFlightIt != mapBlocksInFlight.end();
+
+            if (!fAlreadyInFlight || blockInFlightIt->second.first == pfrom->GetId()) {
+                if (fAlreadyInFlight && blockInFlightIt->second.second->partialBlock) {
+                    // Duplicate cmpctblock for a block we are already rebuilding
+                    return true;
+                }
+                std::list<QueuedBlock>::iterator queuedBlockIt;
+                MarkBlockAsInFlight(pfrom->GetId(), pindex->GetBlockHash(), pindex, &queuedBlockIt);
+                queuedBlockIt->partialBlock.reset(new PartiallyDownloadedBlock(&mempool));
+                PartiallyDownloadedBlock& partialBlock = *queuedBlockIt->partialBlock;
+
+                ReadStatus status = partialBlock.InitData(cmpctblock);
+                if (status == READ_STATUS_INVALID) {
+                    MarkBlockAsReceived(pindex->GetBlockHash()); // Reset in-flight state in case of whitelist
+                    Misbehaving(pfrom->GetId(), 100, strprintf("invalid compact block from peer=%d", pfrom->GetId()));
+                    return true;
+                } else if (status == READ_STATUS_FAILED) {
+                    // Duplicate txindexes, the block is now in-flight, so just request it
+                    std::vector<CInv> vInv(1);
+                    vInv[0] = CInv(MSG_BLOCK, pindex->GetBlockHash());
+                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETDATA, vInv));
+                    return true;
+                }
+
+                BlockTransactionsRequest req;
+                for (size_t i = 0; i < cmpctblock.BlockTxCount(); i++) {
+                    if (!partialBlock.IsTxAvailable(i))
+                        req.indexes.push_back(i);
+                }
+                if (!req.indexes.empty()) {
+                    req.blockhash = pindex->GetBlockHash();
+                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETBLOCKTXN, req));
+                    return true;
+                }
+                // Everything was in our mempool: complete the block right away (below)
+                txnFromMempool.blockhash = pindex->GetBlockHash();
+            } else {
+                // The block is in flight from another peer: take it from this one only if the
+                // mempool has all of it, otherwise let the other download complete.
+                PartiallyDownloadedBlock tempBlock(&mempool);
+                ReadStatus status = tempBlock.InitData(cmpctblock);
+                if (status != READ_STATUS_OK) {
+                    // TODO: don't ignore failures
+                    return true;
+                }
+                std::vector<CTransactionRef> dummy;
+                status = tempBlock.FillBlock(*pblock, dummy);
+                if (status == READ_STATUS_OK) {
+                    fBlockReconstructed = true;
+                    MarkBlockAsReceived(pindex->GetBlockHash());
+                    mapBlockSource.emplace(pindex->GetBlockHash(), pfrom->GetId());
+                }
+            }
+        }
+
+        if (!txnFromMempool.blockhash.IsNull()) {
+            ProcessBlockTransactions(pfrom, txnFromMempool, connman);
+        } else if (fBlockReconstructed) {
+            ProcessNewBlock(pblock, nullptr);
+        }
+    }
+
+    else if (strCommand == NetMsgType::GETBLOCKTXN) {
+        BlockTransactionsRequest req;
+        vRecv >> req;
+
+        std::shared_ptr<const CBlock> recent_block;
+        {
+            LOCK(cs_most_recent_block);
+            if (most_recent_block_hash == req.blockhash)
+                recent_block = most_recent_block;
+            // Unlock cs_most_recent_block to avoid cs_main lock inversion
+        }
+        if (recent_block) {
+            SendBlockTransactions(*recent_block, req, pfrom, connman);
+            return true;
+        }
+
+        CBlock block;
+        {
+            LOCK(cs_main);
+            const CBlockIndex* pindex = LookupBlockIndex(req.blockhash);
+            if (!pindex || !(pindex->nStatus & BLOCK_HAVE_DATA)) {
+                LogPrint(BCLog::NET, "Peer %d sent us a getblocktxn for a block we don't have\n", pfrom->GetId());
+                return true;
+            }
+
+            if (pindex->nHeight >= chainActive.Height() - MAX_BLOCKTXN_DEPTH) {
+                if (!ReadBlockFromDisk(block, pindex))
+                    assert(!"cannot load block from disk");
+            }
+        }
+        if (block.IsNull()) {
+            // If an older block is requested (should never happen in practice,
+            // but can happen in tests) send a block response instead of a
+            // blocktxn response. Sending a full block response instead of a
+            // small blocktxn response is preferable in the case where a peer
+            // might maliciously send lots of getblocktxn requests to trigger
+            // expensive disk reads, because it will require the peer to
+            // actually receive all the data read from disk over the network.
+            LogPrint(BCLog::NET, "Peer %d sent us a getblocktxn for a block > %i deep\n", pfrom->GetId(), MAX_BLOCKTXN_DEPTH);
+            ProcessGetBlockData(pfrom, CInv(MSG_BLOCK, req.blockhash), connman, interruptMsgProc);
+            return true;
+        }
+        SendBlockTransactions(block, req, pfrom, connman);
+    }
+
+    else if (strCommand == NetMsgType::BLOCKTXN && !fImporting && !fReindex) // Ignore blocks received while importing
+    {
+        BlockTransactions resp;
+        vRecv >> resp;
+        ProcessBlockTransactions(pfrom, resp, connman);
+    }
+
     else if (strCommand == NetMsgType::BLOCK && !fImporting && !fReindex) // Ignore blocks received while importing
     {
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
@@ -1828,12 +2156,18 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
             }
         } else {
             pfrom->AddInventoryKnown(inv);
-            if (!mapBlockIndex.count(hashBlock)) {
-                {
-                    LOCK(cs_main);
-                    MarkBlockAsReceived(hashBlock);
+            bool fProcess;
+            {
+                LOCK(cs_main);
+                // With headers-first sync the block index already holds the header of a requested block
+                const CBlockIndex* pindex = LookupBlockIndex(hashBlock);
+                fProcess = !pindex || !(pindex->nStatus & BLOCK_HAVE_DATA);
+                MarkBlockAsReceived(hashBlock);
+                if (fProcess) {
                     mapBlockSource.emplace(hashBlock, pfrom->GetId());
                 }
+            }
+            if (fProcess) {
                 ProcessNewBlock(pblock, nullptr);
 
                 // Disconnect node if its running an old protocol version,
@@ -2021,6 +2355,11 @@ bool static ProcessMessage(CNode* pfrom, std::string strCommand, CDataStream& vR
         LogPrint(BCLog::HU, "Received HUSIG from peer=%d for block %s\n",
                  pfrom->GetId(), sig.blockHash.ToString().substr(0, 16));
 
+        // Don't announce it back, and don't request it from the peers that announced it
+        const uint256 invHash = sig.GetHash();
+        pfrom->AddInventoryKnown(CInv(MSG_HU_SIGNATURE, invHash));
+        connman->RemoveAskFor(invHash, MSG_HU_SIGNATURE);
+
         if (hu::huSignalingManager) {
             hu::huSignalingManager->ProcessHuSignature(sig, pfrom, connman);
         }
@@ -2075,6 +2414,7 @@ static bool DisconnectIfBanned(CNode* pnode, CConnman* connman)
 
     if (state.fShouldBan) {
         state.fShouldBan = false;
+        nPeersShouldBan--;
         if (pnode->fWhitelisted) {
             LogPrintf("Warning: not punishing whitelisted peer %s!\n", pnode->addr.ToString());
         } else if (pnode->fAddnode) {
@@ -2092,7 +2432,7 @@ static bool DisconnectIfBanned(CNode* pnode, CConnman* connman)
     return false;
 }
 
-bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
+bool PeerLogicValidation::ProcessMessages(CNode* pfrom, MsgLane lane, std::atomic<bool>& interruptMsgProc)
 {
     // Message format
     //  (4) message start
@@ -2103,30 +2443,28 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     //
     bool fMoreWork = false;
 
-    if (!pfrom->vRecvGetData.empty())
-        ProcessGetData(pfrom, connman, interruptMsgProc);
+    // Pending getdata answers are served by the general lane: the priority
+    // messages don't wait behind them
+    if (lane == MSG_LANE_GENERAL) {
+        if (!pfrom->vRecvGetData.empty())
+            ProcessGetData(pfrom, connman, interruptMsgProc);
 
-    if (pfrom->fDisconnect)
-        return false;
+        if (pfrom->fDisconnect)
+            return false;
 
-    // this maintains the order of responses
-    if (!pfrom->vRecvGetData.empty()) return true;
+        // this maintains the order of responses
+        if (!pfrom->vRecvGetData.empty()) return true;
+    } else if (pfrom->fDisconnect) {
+        return false;
+    }
 
     // Don't bother if send buffer is too full to respond anyway
     if (pfrom->fPauseSend)
         return false;
 
     std::list<CNetMessage> msgs;
-    {
-        LOCK(pfrom->cs_vProcessMsg);
-        if (pfrom->vProcessMsg.empty())
-            return false;
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
-        pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
-        fMoreWork = !pfrom->vProcessMsg.empty();
-    }
+    if (!connman->PollMessage(pfrom, lane, msgs, fMoreWork))
+        return false;
     CNetMessage& msg(msgs.front());
 
     msg.SetVersion(pfrom->GetRecvVersion());
@@ -2166,7 +2504,7 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, connman, interruptMsgProc);
         if (interruptMsgProc)
             return false;
-        if (!pfrom->vRecvGetData.empty())
+        if (lane == MSG_LANE_GENERAL && !pfrom->vRecvGetData.empty())
             fMoreWork = true;
     } catch (const std::ios_base::failure& e) {
         if (strstr(e.what(), "end of data")) {
@@ -2189,8 +2527,11 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
                  pfrom->GetId());
     }
 
-    LOCK(cs_main);
-    DisconnectIfBanned(pfrom, connman);
+    // Most messages (tx, addr, inv...) don't get anybody punished: skip cs_main then
+    if (nPeersShouldBan > 0) {
+        LOCK(cs_main);
+        DisconnectIfBanned(pfrom, connman);
+    }
 
     return fMoreWork;
 }
@@ -2307,13 +2648,31 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
             if ((nSyncStarted == 0 && fFetch) || pindexBestHeader->GetBlockTime() > GetAdjustedTime() - 6 * 60 * 60) { // NOTE: was "close to today" and 24h in Bitcoin
                 state.fSyncStarted = true;
                 nSyncStarted++;
-                //CBlockIndex *pindexStart = pindexBestHeader->pprev ? pindexBestHeader->pprev : pindexBestHeader;
-                //LogPrint(BCLog::NET, "initial getheaders (%d) to peer=%d (startheight:%d)\n", pindexStart->nHeight, pto->GetId(), pto->nStartingHeight);
-                //pto->PushMessage(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexStart), UINT256_ZERO);
-                connman->PushMessage(pto, msgMaker.Make(NetMsgType::GETBLOCKS, chainActive.GetLocator(chainActive.Tip()), UINT256_ZERO));
+                if (Params().HeadersFirstSyncingActive() && pto->nVersion >= HEADERS_FIRST_VERSION) {
+                    // Start one back, so that the peer answers with at least our best header and
+                    // becomes a download source for FindNextBlocksToDownload.
+                    const CBlockIndex* pindexStart = pindexBestHeader->pprev ? pindexBestHeader->pprev : pindexBestHeader;
+                    LogPrint(BCLog::NET, "initial getheaders (%d) to peer=%d (startheight:%d)\n", pindexStart->nHeight, pto->GetId(), pto->nStartingHeight);
+                    connman->PushMessage(pto, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexStart), UINT256_ZERO));
+                } else {
+                    connman->PushMessage(pto, msgMaker.Make(NetMsgType::GETBLOCKS, chainActive.GetLocator(chainActive.Tip()), UINT256_ZERO));
+                }
             }
         }
 
+        // Ask masternode peers to announce new blocks with a cmpctblock (high-bandwidth mode):
+        // the HU quorum signs a block as soon as it has it, so its members relay to each other
+        // without the inv/getdata round trip.
+        if (state.fProvidesHeaderAndIDs && !state.fRequestedHeaderAndIDs && pto->nVersion >= SHORT_IDS_BLOCKS_VERSION &&
+            activeMasternodeManager && activeMasternodeManager->IsReady() &&
+            !WITH_LOCK(pto->cs_mnauth, return pto->verifiedProRegTxHash.IsNull())) {
+            state.fRequestedHeaderAndIDs = true;
+            bool fAnnounceUsingCMPCTBLOCK = true;
+            uint64_t nCMPCTBLOCKVersion = 1;
+            connman->PushMessage(pto, msgMaker.Make(NetMsgType::SENDCMPCT, fAnnounceUsingCMPCTBLOCK, nCMPCTBLOCKVersion));
+            LogPrint(BCLog::NET, "requesting high-bandwidth compact blocks from masternode peer=%d\n", pto->GetId());
+        }
+
         // Resend wallet transactions that haven't gotten in a block yet
         // Except during reindex, importing and IBD, when old wallet
         // transactions become unconfirmed and spams other nodes.
@@ -6,6 +6,7 @@
 #define HU_HU_COINS_H
 
 #include "amount.h"
+#include "memusage.h"
 #include "script/script.h"
 #include "serialize.h"
 #include "uint256.h"
@@ -100,6 +101,11 @@ struct CKHUUTXO {
     bool IsNull() const {
         return amount == 0 && scriptPubKey.empty();
     }
+
+    //! Mémoire dynamique (script), pour le budget -dbcache
+    size_t DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(scriptPubKey);
+    }
 };
 
 /**
@@ -12,7 +12,7 @@ static const char DB_KHU_COMMITMENT_PREFIX = 'C';   // Commitment data
 static const char DB_KHU_LATEST_FINALIZED = 'L';    // Latest finalized height
 
 CHUCommitmentDB::CHUCommitmentDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    CDBWrapper(GetDataDir() / "khu" / "commitments", nCacheSize, fMemory, fWipe)
+    CKHUTransactionalDB(GetDataDir() / "khu" / "commitments", nCacheSize, fMemory, fWipe)
 {
 }
 
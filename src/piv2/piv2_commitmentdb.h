@@ -5,7 +5,7 @@
 #ifndef HU_HU_COMMITMENTDB_H
 #define HU_HU_COMMITMENTDB_H
 
-#include "dbwrapper.h"
+#include "piv2/piv2_dbtransaction.h"
 #include "piv2/piv2_commitment.h"
 
 #include <stdint.h>
@@ -15,7 +15,7 @@
  *
  * Keys: 'K'+'C'+height -> HuStateCommitment, 'K'+'L' -> latestFinalizedHeight
  */
-class CHUCommitmentDB : public CDBWrapper
+class CHUCommitmentDB : public CKHUTransactionalDB
 {
 public:
     explicit CHUCommitmentDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -0,0 +1,85 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "piv2/piv2_dbtransaction.h"
+
+#include "piv2/piv2_utxo.h"
+
+#include <string>
+
+// Best block marker (outside every 'K'/'U'/'D' KHU key space)
+static const std::string KHUDB_BEST_BLOCK = "b_b";
+
+CKHUTransactionalDB::CKHUTransactionalDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe) :
+    CDBWrapper(path, nCacheSize, fMemory, fWipe),
+    rootBatch(CLIENT_VERSION),
+    rootDBTransaction(static_cast<CDBWrapper&>(*this), rootBatch, CLIENT_VERSION),
+    curDBTransaction(rootDBTransaction, rootDBTransaction, CLIENT_VERSION)
+{
+}
+
+void CKHUTransactionalDB::CommitCurTransaction()
+{
+    LOCK(cs);
+    curDBTransaction.Commit();
+}
+
+void CKHUTransactionalDB::RollbackCurTransaction()
+{
+    LOCK(cs);
+    curDBTransaction.Clear();
+}
+
+bool CKHUTransactionalDB::CommitRootTransaction(const uint256& hashBestBlock)
+{
+    LOCK(cs);
+    assert(curDBTransaction.IsClean());
+    rootDBTransaction.Write(KHUDB_BEST_BLOCK, hashBestBlock);
+    rootDBTransaction.Commit();
+    bool ret = WriteBatch(rootBatch);
+    rootBatch.Clear();
+    return ret;
+}
+
+size_t CKHUTransactionalDB::GetMemoryUsage() const
+{
+    LOCK(cs);
+    return rootDBTransaction.GetMemoryUsage() + curDBTransaction.GetMemoryUsage();
+}
+
+bool CKHUTransactionalDB::ReadBestBlock(uint256& hashBestBlock) const
+{
+    return Read(KHUDB_BEST_BLOCK, hashBestBlock);
+}
+
+CKHUDBScopedCommitter::CKHUDBScopedCommitter(std::vector<CKHUTransactionalDB*> vDBsIn) :
+    vDBs(std::move(vDBsIn))
+{
+}
+
+CKHUDBScopedCommitter::~CKHUDBScopedCommitter()
+{
+    if (!didCommitOrRollback)
+        Rollback();
+}
+
+void CKHUDBScopedCommitter::Commit()
+{
+    assert(!didCommitOrRollback);
+    didCommitOrRollback = true;
+    CommitKHUCoinsBlock();
+    for (CKHUTransactionalDB* db : vDBs) {
+        db->CommitCurTransaction();
+    }
+}
+
+void CKHUDBScopedCommitter::Rollback()
+{
+    assert(!didCommitOrRollback);
+    didCommitOrRollback = true;
+    RollbackKHUCoinsBlock();
+    for (CKHUTransactionalDB* db : vDBs) {
+        db->RollbackCurTransaction();
+    }
+}
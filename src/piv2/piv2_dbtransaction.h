@@ -0,0 +1,129 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HU_HU_DBTRANSACTION_H
+#define HU_HU_DBTRANSACTION_H
+
+#include "clientversion.h"
+#include "dbwrapper.h"
+#include "fs.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * CKHUTransactionalDB - Write-buffered LevelDB base for all KHU databases
+ *
+ * Same layering as CEvoDB:
+ *
+ *   curDBTransaction   mutations of the block being connected/disconnected
+ *         │ CommitCurTransaction() (block accepted) / Rollback (block failed)
+ *   rootDBTransaction  every accepted block since the last flush
+ *         │ CommitRootTransaction() (FlushStateToDisk, one CDBBatch)
+ *   LevelDB
+ *
+ * Subclasses keep calling Read/Write/Erase/Exists/NewIterator exactly as with
+ * a plain CDBWrapper; those calls are shadowed here so that reads see pending
+ * writes and writes never touch the disk during block connect.
+ *
+ * A best block marker is written into the same batch on every root commit,
+ * so that a KHU database which missed a flush is detected at startup.
+ */
+class CKHUTransactionalDB : public CDBWrapper
+{
+public:
+    mutable RecursiveMutex cs;
+
+private:
+    typedef CDBTransaction<CDBWrapper, CDBBatch> RootTransaction;
+    typedef CDBTransaction<RootTransaction, RootTransaction> CurTransaction;
+
+    CDBBatch rootBatch;
+    RootTransaction rootDBTransaction;
+    mutable CurTransaction curDBTransaction;
+
+protected:
+    CKHUTransactionalDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe);
+
+    template <typename K, typename V>
+    bool Read(const K& key, V& value) const
+    {
+        LOCK(cs);
+        return curDBTransaction.Read(key, value);
+    }
+
+    template <typename K, typename V>
+    bool Write(const K& key, const V& value)
+    {
+        LOCK(cs);
+        curDBTransaction.Write(key, value);
+        return true;
+    }
+
+    template <typename K>
+    bool Exists(const K& key) const
+    {
+        LOCK(cs);
+        return curDBTransaction.Exists(key);
+    }
+
+    template <typename K>
+    bool Erase(const K& key)
+    {
+        LOCK(cs);
+        curDBTransaction.Erase(key);
+        return true;
+    }
+
+    /** Cursor over disk + pending writes (caller must hold cs while iterating) */
+    std::unique_ptr<CDBTransactionIterator<CurTransaction>> NewIterator()
+    {
+        AssertLockHeld(cs);
+        return curDBTransaction.NewIteratorUniquePtr();
+    }
+
+public:
+    virtual ~CKHUTransactionalDB() = default;
+
+    /** Move the current block's mutations into the root transaction */
+    virtual void CommitCurTransaction();
+
+    /** Drop the current block's mutations (subclasses also drop derived caches) */
+    virtual void RollbackCurTransaction();
+
+    /** Write all accepted mutations plus the best block marker in one batch */
+    bool CommitRootTransaction(const uint256& hashBestBlock);
+
+    /** Memory held by mutations not yet written to disk */
+    size_t GetMemoryUsage() const;
+
+    /** Best block of the last root commit (false if never flushed) */
+    bool ReadBestBlock(uint256& hashBestBlock) const;
+};
+
+/**
+ * CKHUDBScopedCommitter - Per-block transaction over every KHU database
+ *
+ * Created before ConnectBlock/DisconnectBlock, committed once the block is
+ * accepted. Rolls back on destruction otherwise (failed block, TestBlockValidity,
+ * VerifyDB), exactly like CEvoDBScopedCommitter. The KHU coins block view
+ * (piv2_utxo.h) is committed or dropped together with the databases.
+ */
+class CKHUDBScopedCommitter
+{
+private:
+    std::vector<CKHUTransactionalDB*> vDBs;
+    bool didCommitOrRollback{false};
+
+public:
+    explicit CKHUDBScopedCommitter(std::vector<CKHUTransactionalDB*> vDBsIn);
+    ~CKHUDBScopedCommitter();
+
+    void Commit();
+    void Rollback();
+};
+
+#endif // HU_HU_DBTRANSACTION_H
@@ -12,8 +12,6 @@
 #include "hash.h"
 #include "logging.h"
 
-#include <algorithm>
-
 namespace khu_domc {
 
 // ============================================================================
@@ -196,48 +194,17 @@ uint16_t CalculateDomcMedian(
         return currentR; // Fallback: keep current R
     }
 
-    // Collect all valid reveals for this cycle
-    std::vector<DomcReveal> reveals;
-    if (!domcDB->GetRevealsForCycle(cycleId, reveals)) {
-        LogPrint(BCLog::HU, "CalculateDomcMedian: No reveals found for cycle %u\n", cycleId);
-        return currentR; // No reveals → keep current R
-    }
-
-    // Extract R proposals from valid reveals
-    std::vector<uint16_t> proposals;
-    proposals.reserve(reveals.size());
-
-    for (const auto& reveal : reveals) {
-        // Verify reveal matches a commit
-        DomcCommit commit;
-        if (!domcDB->ReadCommit(reveal.mnOutpoint, cycleId, commit)) {
-            LogPrint(BCLog::HU, "CalculateDomcMedian: No commit found for reveal (MN=%s)\n",
-                     reveal.mnOutpoint.ToString());
-            continue; // Skip invalid reveal
-        }
-
-        // Verify commit hash matches reveal
-        if (commit.hashCommit != reveal.GetCommitHash()) {
-            LogPrint(BCLog::HU, "CalculateDomcMedian: Commit hash mismatch (MN=%s)\n",
-                     reveal.mnOutpoint.ToString());
-            continue; // Skip invalid reveal
-        }
-
-        // Valid reveal → add to proposals
-        proposals.push_back(reveal.nRProposal);
-    }
-
-    // V1 RULE: No minimum quorum
-    if (proposals.empty()) {
-        LogPrint(BCLog::HU, "CalculateDomcMedian: No valid proposals for cycle %u (keeping R=%u)\n",
+    // Reveals are only stored once matched against their commit
+    // (ValidateDomcRevealTx), the tally counts each of them once
+    uint16_t median = 0;
+    size_t nVotes = 0;
+    if (!domcDB->GetRevealMedian(cycleId, median, nVotes)) {
+        // V1 RULE: No minimum quorum
+        LogPrint(BCLog::HU, "CalculateDomcMedian: No reveals found for cycle %u (keeping R=%u)\n",
                  cycleId, currentR);
         return currentR; // 0 valid votes → keep current R
     }
 
-    // Calculate median (floor index)
-    std::sort(proposals.begin(), proposals.end());
-    uint16_t median = proposals[proposals.size() / 2];
-
     // Clamp to R_MAX_dynamic (governance safety limit)
     if (median > R_MAX_dynamic) {
         LogPrint(BCLog::HU, "CalculateDomcMedian: Clamping median %u to R_MAX %u\n",
@@ -246,7 +213,7 @@ uint16_t CalculateDomcMedian(
     }
 
     LogPrint(BCLog::HU, "CalculateDomcMedian: Cycle %u → %zu valid votes, median R=%u (clamped to %u)\n",
-             cycleId, proposals.size(), median, R_MAX_dynamic);
+             cycleId, nVotes, median, R_MAX_dynamic);
 
     return median;
 }
@@ -385,13 +385,6 @@ bool ApplyDomcCommitTx(const CTransaction& tx, uint32_t nHeight)
         return false;
     }
 
-    // Add masternode to cycle index (for GetRevealsForCycle)
-    if (!domcDB->AddMasternodeToCycleIndex(commit.nCycleId, commit.mnOutpoint)) {
-        LogPrintf("ERROR: ApplyDomcCommitTx: Failed to add MN to cycle index (MN=%s, cycle=%u)\n",
-                  commit.mnOutpoint.ToString(), commit.nCycleId);
-        return false;
-    }
-
     LogPrint(BCLog::HU, "ApplyDomcCommitTx: Stored commit from MN %s for cycle %u\n",
              commit.mnOutpoint.ToString(), commit.nCycleId);
 
@@ -7,62 +7,176 @@
 #include "logging.h"
 #include "util/system.h"
 
+#include <cassert>
 #include <memory>
 
 // Database key prefixes
 static const char DB_DOMC = 'D';
-static const char DB_DOMC_COMMIT = 'C';
-static const char DB_DOMC_REVEAL = 'R';
-static const char DB_DOMC_INDEX = 'I';
+static const char DB_DOMC_COMMIT = 'c';
+static const char DB_DOMC_REVEAL = 'r';
+
+// Former layout: 'D' + 'C'/'R' + mnOutpoint + cycleId, 'D' + 'I' + cycleId index
+static const char DB_DOMC_LEGACY_COMMIT = 'C';
+static const char DB_DOMC_LEGACY_REVEAL = 'R';
+static const char DB_DOMC_LEGACY_INDEX = 'I';
+
+/** Cycle ID serialized big endian, so that the cycles sort by height on disk */
+struct DomcCycleKey
+{
+    uint32_t nCycleId;
+
+    explicit DomcCycleKey(uint32_t nCycleIdIn = 0) : nCycleId(nCycleIdIn) {}
+
+    SERIALIZE_METHODS(DomcCycleKey, obj)
+    {
+        READWRITE(Using<BigEndianFormatter<4>>(obj.nCycleId));
+    }
+};
+
+typedef std::pair<char, std::pair<char, std::pair<DomcCycleKey, COutPoint>>> DomcVoteKey;
+
+static DomcVoteKey VoteKey(char prefix, uint32_t cycleId, const COutPoint& mnOutpoint)
+{
+    return std::make_pair(DB_DOMC, std::make_pair(prefix, std::make_pair(DomcCycleKey(cycleId), mnOutpoint)));
+}
+
+static std::pair<char, std::pair<char, DomcCycleKey>> CyclePrefix(char prefix, uint32_t cycleId)
+{
+    return std::make_pair(DB_DOMC, std::make_pair(prefix, DomcCycleKey(cycleId)));
+}
 
 // Global DOMC database instance
 static std::unique_ptr<CKHUDomcDB> pkhudomcdb;
 
+// ============================================================================
+// CDomcRevealTally implementation
+// ============================================================================
+
+void CDomcRevealTally::Update(uint16_t nR, int32_t nDelta)
+{
+    for (size_t i = (size_t)nR + 1; i <= TALLY_RANGE; i += i & (~i + 1)) {
+        vTree[i] += nDelta;
+    }
+}
+
+void CDomcRevealTally::Remove(uint16_t nR)
+{
+    assert(nVotes > 0);
+    Update(nR, -1);
+    nVotes--;
+}
+
+uint16_t CDomcRevealTally::Median() const
+{
+    assert(nVotes > 0);
+    // Smallest value with at least nVotes / 2 + 1 proposals <= value
+    size_t nRank = nVotes / 2 + 1;
+    size_t pos = 0;
+    for (size_t step = TALLY_RANGE; step > 0; step >>= 1) {
+        if (pos + step <= TALLY_RANGE && vTree[pos + step] < nRank) {
+            pos += step;
+            nRank -= vTree[pos];
+        }
+    }
+    // Fenwick index pos + 1 holds value pos
+    return (uint16_t)pos;
+}
+
 // ============================================================================
 // CKHUDomcDB implementation
 // ============================================================================
 
 CKHUDomcDB::CKHUDomcDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    CDBWrapper(GetDataDir() / "khu" / "domc", nCacheSize, fMemory, fWipe)
+    CKHUTransactionalDB(GetDataDir() / "khu" / "domc", nCacheSize, fMemory, fWipe)
 {
 }
 
+void CKHUDomcDB::CommitCurTransaction()
+{
+    LOCK(cs);
+    vPendingTally.clear();
+    CKHUTransactionalDB::CommitCurTransaction();
+}
+
+void CKHUDomcDB::RollbackCurTransaction()
+{
+    LOCK(cs);
+    // Undo the tally updates of the dropped reveals, newest first
+    for (auto it = vPendingTally.rbegin(); it != vPendingTally.rend(); ++it) {
+        CDomcRevealTally& tally = mapTallies.at(std::get<0>(*it));
+        if (std::get<2>(*it) > 0) {
+            tally.Remove(std::get<1>(*it));
+        } else {
+            tally.Add(std::get<1>(*it));
+        }
+    }
+    vPendingTally.clear();
+    CKHUTransactionalDB::RollbackCurTransaction();
+}
+
+CDomcRevealTally& CKHUDomcDB::GetTally(uint32_t cycleId)
+{
+    AssertLockHeld(cs);
+    auto it = mapTallies.find(cycleId);
+    if (it != mapTallies.end()) {
+        return it->second;
+    }
+
+    CDomcRevealTally& tally = mapTallies[cycleId];
+    auto pcursor = NewIterator();
+    pcursor->Seek(CyclePrefix(DB_DOMC_REVEAL, cycleId));
+    while (pcursor->Valid()) {
+        DomcVoteKey key;
+        if (!pcursor->GetKey(key) || key.first != DB_DOMC || key.second.first != DB_DOMC_REVEAL ||
+            key.second.second.first.nCycleId != cycleId) {
+            break; // End of the cycle's reveals
+        }
+        khu_domc::DomcReveal reveal;
+        if (pcursor->GetValue(reveal)) {
+            tally.Add(reveal.nRProposal);
+        }
+        pcursor->Next();
+    }
+
+    LogPrint(BCLog::HU, "%s: Loaded %zu reveals for cycle %u\n", __func__, tally.Size(), cycleId);
+    return tally;
+}
+
+void CKHUDomcDB::UpdateTally(uint32_t cycleId, uint16_t nR, int nDelta)
+{
+    AssertLockHeld(cs);
+    CDomcRevealTally& tally = GetTally(cycleId);
+    if (nDelta > 0) {
+        tally.Add(nR);
+    } else {
+        tally.Remove(nR);
+    }
+    vPendingTally.emplace_back(cycleId, nR, nDelta);
+}
+
 // ============================================================================
 // COMMIT operations
 // ============================================================================
 
 bool CKHUDomcDB::WriteCommit(const khu_domc::DomcCommit& commit)
 {
-    // Key: 'D' + 'C' + mnOutpoint + cycleId
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_COMMIT,
-                                           std::make_pair(commit.mnOutpoint, commit.nCycleId)));
-    return Write(key, commit);
+    return Write(VoteKey(DB_DOMC_COMMIT, commit.nCycleId, commit.mnOutpoint), commit);
 }
 
 bool CKHUDomcDB::ReadCommit(const COutPoint& mnOutpoint, uint32_t cycleId,
                             khu_domc::DomcCommit& commit)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_COMMIT,
-                                           std::make_pair(mnOutpoint, cycleId)));
-    return Read(key, commit);
+    return Read(VoteKey(DB_DOMC_COMMIT, cycleId, mnOutpoint), commit);
 }
 
 bool CKHUDomcDB::HaveCommit(const COutPoint& mnOutpoint, uint32_t cycleId)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_COMMIT,
-                                           std::make_pair(mnOutpoint, cycleId)));
-    return Exists(key);
+    return Exists(VoteKey(DB_DOMC_COMMIT, cycleId, mnOutpoint));
 }
 
 bool CKHUDomcDB::EraseCommit(const COutPoint& mnOutpoint, uint32_t cycleId)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_COMMIT,
-                                           std::make_pair(mnOutpoint, cycleId)));
-    return Erase(key);
+    return Erase(VoteKey(DB_DOMC_COMMIT, cycleId, mnOutpoint));
 }
 
 // ============================================================================
@@ -71,124 +185,185 @@ bool CKHUDomcDB::EraseCommit(const COutPoint& mnOutpoint, uint32_t cycleId)
 
 bool CKHUDomcDB::WriteReveal(const khu_domc::DomcReveal& reveal)
 {
-    // Key: 'D' + 'R' + mnOutpoint + cycleId
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_REVEAL,
-                                           std::make_pair(reveal.mnOutpoint, reveal.nCycleId)));
-    return Write(key, reveal);
+    LOCK(cs);
+    const auto key = VoteKey(DB_DOMC_REVEAL, reveal.nCycleId, reveal.mnOutpoint);
+
+    // Load the tally before the write, so that the reveal is counted once
+    GetTally(reveal.nCycleId);
+    khu_domc::DomcReveal prev;
+    if (Read(key, prev)) {
+        UpdateTally(reveal.nCycleId, prev.nRProposal, -1);
+    }
+    if (!Write(key, reveal)) {
+        return false;
+    }
+    UpdateTally(reveal.nCycleId, reveal.nRProposal, 1);
+    return true;
 }
 
 bool CKHUDomcDB::ReadReveal(const COutPoint& mnOutpoint, uint32_t cycleId,
                             khu_domc::DomcReveal& reveal)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_REVEAL,
-                                           std::make_pair(mnOutpoint, cycleId)));
-    return Read(key, reveal);
+    return Read(VoteKey(DB_DOMC_REVEAL, cycleId, mnOutpoint), reveal);
 }
 
 bool CKHUDomcDB::HaveReveal(const COutPoint& mnOutpoint, uint32_t cycleId)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_REVEAL,
-                                           std::make_pair(mnOutpoint, cycleId)));
-    return Exists(key);
+    return Exists(VoteKey(DB_DOMC_REVEAL, cycleId, mnOutpoint));
 }
 
 bool CKHUDomcDB::EraseReveal(const COutPoint& mnOutpoint, uint32_t cycleId)
 {
-    auto key = std::make_pair(DB_DOMC,
-                              std::make_pair(DB_DOMC_REVEAL,
-                                           std::make_pair(mnOutpoint, cycleId)));
+    LOCK(cs);
+    const auto key = VoteKey(DB_DOMC_REVEAL, cycleId, mnOutpoint);
+
+    GetTally(cycleId);
+    khu_domc::DomcReveal prev;
+    if (Read(key, prev)) {
+        UpdateTally(cycleId, prev.nRProposal, -1);
+    }
     return Erase(key);
 }
 
 // ============================================================================
-// CYCLE INDEX operations
+// CYCLE operations
 // ============================================================================
 
-bool CKHUDomcDB::AddMasternodeToCycleIndex(uint32_t cycleId, const COutPoint& mnOutpoint)
+bool CKHUDomcDB::GetRevealsForCycle(uint32_t cycleId, std::vector<khu_domc::DomcReveal>& reveals)
 {
-    // Read existing index
-    std::vector<COutPoint> mnOutpoints;
-    GetMasternodesForCycle(cycleId, mnOutpoints);
+    reveals.clear();
 
-    // Check if already in index
-    for (const auto& existing : mnOutpoints) {
-        if (existing == mnOutpoint) {
-            return true; // Already indexed
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(CyclePrefix(DB_DOMC_REVEAL, cycleId));
+    while (pcursor->Valid()) {
+        DomcVoteKey key;
+        if (!pcursor->GetKey(key) || key.first != DB_DOMC || key.second.first != DB_DOMC_REVEAL ||
+            key.second.second.first.nCycleId != cycleId) {
+            break; // End of the cycle's reveals
+        }
+        khu_domc::DomcReveal reveal;
+        if (!pcursor->GetValue(reveal)) {
+            return error("%s: invalid reveal record for MN %s in cycle %u", __func__,
+                         key.second.second.second.ToString(), cycleId);
         }
+        reveals.push_back(reveal);
+        pcursor->Next();
     }
 
-    // Add to index
-    mnOutpoints.push_back(mnOutpoint);
-
-    // Write updated index
-    auto key = std::make_pair(DB_DOMC, std::make_pair(DB_DOMC_INDEX, cycleId));
-    return Write(key, mnOutpoints);
+    return !reveals.empty();
 }
 
-bool CKHUDomcDB::GetMasternodesForCycle(uint32_t cycleId, std::vector<COutPoint>& mnOutpoints)
+bool CKHUDomcDB::GetRevealMedian(uint32_t cycleId, uint16_t& nMedian, size_t& nVotes)
 {
-    auto key = std::make_pair(DB_DOMC, std::make_pair(DB_DOMC_INDEX, cycleId));
-    return Read(key, mnOutpoints);
+    LOCK(cs);
+    const CDomcRevealTally& tally = GetTally(cycleId);
+    nVotes = tally.Size();
+    if (nVotes == 0) {
+        return false;
+    }
+    nMedian = tally.Median();
+    return true;
 }
 
-bool CKHUDomcDB::GetRevealsForCycle(uint32_t cycleId, std::vector<khu_domc::DomcReveal>& reveals)
+bool CKHUDomcDB::EraseCycleData(uint32_t cycleId)
 {
-    reveals.clear();
-
-    // Get list of masternodes that participated in this cycle
-    std::vector<COutPoint> mnOutpoints;
-    if (!GetMasternodesForCycle(cycleId, mnOutpoints)) {
-        return false; // No masternodes in this cycle
+    LOCK(cs);
+
+    // Collect the keys first: the cursor walks the transaction being modified
+    std::vector<COutPoint> vCommits;
+    std::vector<khu_domc::DomcReveal> vReveals;
+    {
+        auto pcursor = NewIterator();
+        pcursor->Seek(CyclePrefix(DB_DOMC_COMMIT, cycleId));
+        while (pcursor->Valid()) {
+            DomcVoteKey key;
+            if (!pcursor->GetKey(key) || key.first != DB_DOMC || key.second.first != DB_DOMC_COMMIT ||
+                key.second.second.first.nCycleId != cycleId) {
+                break;
+            }
+            vCommits.push_back(key.second.second.second);
+            pcursor->Next();
+        }
     }
+    GetRevealsForCycle(cycleId, vReveals);
 
-    // Collect reveals from all masternodes
-    for (const auto& mnOutpoint : mnOutpoints) {
-        khu_domc::DomcReveal reveal;
-        if (ReadReveal(mnOutpoint, cycleId, reveal)) {
-            reveals.push_back(reveal);
-        }
+    for (const COutPoint& mnOutpoint : vCommits) {
+        EraseCommit(mnOutpoint, cycleId);
+    }
+    for (const khu_domc::DomcReveal& reveal : vReveals) {
+        EraseReveal(reveal.mnOutpoint, cycleId);
     }
 
-    return !reveals.empty();
-}
+    LogPrint(BCLog::HU, "EraseCycleData: Erased %zu commits and %zu reveals for cycle %u\n",
+             vCommits.size(), vReveals.size(), cycleId);
 
-bool CKHUDomcDB::EraseCycleIndex(uint32_t cycleId)
-{
-    auto key = std::make_pair(DB_DOMC, std::make_pair(DB_DOMC_INDEX, cycleId));
-    return Erase(key);
+    return true;
 }
 
-bool CKHUDomcDB::EraseCycleData(uint32_t cycleId)
+bool CKHUDomcDB::UpgradeLegacyKeys()
 {
-    // Get list of masternodes that participated in this cycle
-    std::vector<COutPoint> mnOutpoints;
-    bool hasIndex = GetMasternodesForCycle(cycleId, mnOutpoints);
-
-    if (hasIndex) {
-        // Erase all commits and reveals for this cycle
-        for (const auto& mnOutpoint : mnOutpoints) {
-            // Erase commit (if exists)
-            EraseCommit(mnOutpoint, cycleId);
-
-            // Erase reveal (if exists)
-            EraseReveal(mnOutpoint, cycleId);
+    LOCK(cs);
+
+    typedef std::pair<char, std::pair<char, std::pair<COutPoint, uint32_t>>> LegacyVoteKey;
+    std::vector<khu_domc::DomcCommit> vCommits;
+    std::vector<khu_domc::DomcReveal> vReveals;
+    std::vector<uint32_t> vIndexes;
+    {
+        auto pcursor = NewIterator();
+        pcursor->Seek(std::make_pair(DB_DOMC, DB_DOMC_LEGACY_COMMIT));
+        while (pcursor->Valid()) {
+            std::pair<char, char> prefix;
+            if (!pcursor->GetKey(prefix) || prefix.first != DB_DOMC) {
+                break;
+            }
+            if (prefix.second == DB_DOMC_LEGACY_COMMIT) {
+                vCommits.emplace_back();
+                if (!pcursor->GetValue(vCommits.back())) {
+                    return error("%s: invalid legacy commit record", __func__);
+                }
+            } else if (prefix.second == DB_DOMC_LEGACY_INDEX) {
+                std::pair<char, std::pair<char, uint32_t>> key;
+                if (pcursor->GetKey(key)) {
+                    vIndexes.push_back(key.second.second);
+                }
+            } else if (prefix.second == DB_DOMC_LEGACY_REVEAL) {
+                vReveals.emplace_back();
+                if (!pcursor->GetValue(vReveals.back())) {
+                    return error("%s: invalid legacy reveal record", __func__);
+                }
+            } else {
+                break; // 'C' < 'I' < 'R' < 'c' < 'r'
+            }
+            pcursor->Next();
         }
+    }
 
-        LogPrint(BCLog::HU, "EraseCycleData: Erased %zu commits/reveals for cycle %u\n",
-                 mnOutpoints.size(), cycleId);
+    if (vCommits.empty() && vReveals.empty() && vIndexes.empty()) {
+        return true;
     }
 
-    // Erase the cycle index
-    bool result = EraseCycleIndex(cycleId);
+    for (const auto& commit : vCommits) {
+        Erase(LegacyVoteKey(DB_DOMC, {DB_DOMC_LEGACY_COMMIT, {commit.mnOutpoint, commit.nCycleId}}));
+        WriteCommit(commit);
+    }
+    for (const auto& reveal : vReveals) {
+        Erase(LegacyVoteKey(DB_DOMC, {DB_DOMC_LEGACY_REVEAL, {reveal.mnOutpoint, reveal.nCycleId}}));
+        WriteReveal(reveal);
+    }
+    for (uint32_t cycleId : vIndexes) {
+        Erase(std::make_pair(DB_DOMC, std::make_pair(DB_DOMC_LEGACY_INDEX, cycleId)));
+    }
+    CommitCurTransaction();
 
-    if (result) {
-        LogPrint(BCLog::HU, "EraseCycleData: Successfully cleaned up cycle %u\n", cycleId);
+    uint256 hashBestBlock;
+    if (ReadBestBlock(hashBestBlock) && !CommitRootTransaction(hashBestBlock)) {
+        return error("%s: failed to write the upgraded DOMC votes", __func__);
     }
 
-    return result;
+    LogPrintf("KHU: Upgraded %zu DOMC commits and %zu reveals to the per-cycle key layout\n",
+              vCommits.size(), vReveals.size());
+    return true;
 }
 
 // ============================================================================
@@ -200,6 +375,10 @@ bool InitKHUDomcDB(size_t nCacheSize, bool fReindex)
     try {
         pkhudomcdb.reset();
         pkhudomcdb = std::make_unique<CKHUDomcDB>(nCacheSize, false, fReindex);
+        if (!pkhudomcdb->UpgradeLegacyKeys()) {
+            LogPrintf("ERROR: Failed to upgrade KHU DOMC database\n");
+            return false;
+        }
         LogPrint(BCLog::HU, "KHU: Initialized DOMC database (Phase 6.2 Governance)\n");
         return true;
     } catch (const std::exception& e) {
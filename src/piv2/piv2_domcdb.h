@@ -5,30 +5,64 @@
 #ifndef HU_HU_DOMCDB_H
 #define HU_HU_DOMCDB_H
 
-#include "dbwrapper.h"
+#include "piv2/piv2_dbtransaction.h"
 #include "piv2/piv2_domc.h"
 #include "primitives/transaction.h"
 
+#include <map>
 #include <stdint.h>
+#include <tuple>
 #include <vector>
 
+/**
+ * CDomcRevealTally - Order statistics over the R proposals of one cycle
+ *
+ * Fenwick tree indexed by the proposal value (the whole uint16_t range, so
+ * the median is exactly the one of the sorted proposal list). Add/Remove and
+ * the median query are O(log 65536), independent of the number of voters.
+ */
+class CDomcRevealTally
+{
+private:
+    static const size_t TALLY_RANGE = 1 << 16;
+
+    std::vector<uint32_t> vTree;  // 1-based, vTree[i] covers values (i - lowbit(i), i]
+    size_t nVotes{0};
+
+    void Update(uint16_t nR, int32_t nDelta);
+
+public:
+    CDomcRevealTally() : vTree(TALLY_RANGE + 1, 0) {}
+
+    void Add(uint16_t nR) { Update(nR, 1); nVotes++; }
+    void Remove(uint16_t nR);
+
+    size_t Size() const { return nVotes; }
+
+    /** proposals[Size() / 2] of the sorted proposals (Size() must be > 0) */
+    uint16_t Median() const;
+};
+
 /**
  * CKHUDomcDB - LevelDB persistence layer for DOMC votes
  *
  * Phase 6.2: Stores DOMC commit/reveal votes from masternodes
  *
  * DATABASE KEYS:
- * - 'D' + 'C' + mnOutpoint + cycleId -> DomcCommit (commit vote)
- * - 'D' + 'R' + mnOutpoint + cycleId -> DomcReveal (reveal vote)
- * - 'D' + 'I' + cycleId -> std::vector<COutPoint> (index of MNs in cycle)
+ * - 'D' + 'c' + cycleId (big endian) + mnOutpoint -> DomcCommit (commit vote)
+ * - 'D' + 'r' + cycleId (big endian) + mnOutpoint -> DomcReveal (reveal vote)
+ *
+ * The votes of a cycle are contiguous on disk and enumerated with a single
+ * cursor pass; there is no per-cycle index record to rewrite on every vote.
  *
  * ARCHITECTURE:
  * - Commits stored during commit phase (cycle_start + 132480 → 152640)
  * - Reveals stored during reveal phase (cycle_start + 152640 → 172800)
- * - At cycle boundary: read all reveals, calculate median(R)
+ * - Every applied reveal updates an in-memory tally of its cycle
+ *   (CDomcRevealTally), median(R) is read from the tally
  * - Reorg support: erase votes when unwinding blocks
  */
-class CKHUDomcDB : public CDBWrapper
+class CKHUDomcDB : public CKHUTransactionalDB
 {
 public:
     explicit CKHUDomcDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -37,7 +71,18 @@ private:
     CKHUDomcDB(const CKHUDomcDB&);
     void operator=(const CKHUDomcDB&);
 
+    //! Reveal tally per cycle, loaded by one cursor pass on first use (guarded by cs)
+    std::map<uint32_t, CDomcRevealTally> mapTallies;
+    //! Tally updates of the current block transaction: (cycleId, R, +1/-1)
+    std::vector<std::tuple<uint32_t, uint16_t, int>> vPendingTally;
+
+    CDomcRevealTally& GetTally(uint32_t cycleId);
+    void UpdateTally(uint32_t cycleId, uint16_t nR, int nDelta);
+
 public:
+    void CommitCurTransaction() override;
+    void RollbackCurTransaction() override;
+
     // ========================================================================
     // COMMIT operations
     // ========================================================================
@@ -45,7 +90,7 @@ public:
     /**
      * WriteCommit - Store DOMC commit vote
      *
-     * Key: 'D' + 'C' + mnOutpoint + cycleId
+     * Key: 'D' + 'c' + cycleId + mnOutpoint
      *
      * @param commit Commit to store
      * @return true on success, false on failure
@@ -88,7 +133,8 @@ public:
     /**
      * WriteReveal - Store DOMC reveal vote
      *
-     * Key: 'D' + 'R' + mnOutpoint + cycleId
+     * Key: 'D' + 'r' + cycleId + mnOutpoint
+     * Also adds nRProposal to the cycle's tally.
      *
      * @param reveal Reveal to store
      * @return true on success, false on failure
@@ -116,7 +162,7 @@ public:
     bool HaveReveal(const COutPoint& mnOutpoint, uint32_t cycleId);
 
     /**
-     * EraseReveal - Delete reveal (for reorg)
+     * EraseReveal - Delete reveal (for reorg), and remove it from the tally
      *
      * @param mnOutpoint Masternode collateral outpoint
      * @param cycleId Cycle ID
@@ -125,35 +171,13 @@ public:
     bool EraseReveal(const COutPoint& mnOutpoint, uint32_t cycleId);
 
     // ========================================================================
-    // CYCLE INDEX operations
+    // CYCLE operations (cursor over the cycle's key prefix)
     // ========================================================================
 
     /**
-     * AddMasternodeToCycleIndex - Add masternode to cycle index
+     * GetRevealsForCycle - Collect all reveals of a cycle
      *
-     * Maintains list of masternodes that voted in a cycle.
-     * Used for GetRevealsForCycle() to efficiently collect all reveals.
-     *
-     * @param cycleId Cycle ID
-     * @param mnOutpoint Masternode collateral outpoint
-     * @return true on success
-     */
-    bool AddMasternodeToCycleIndex(uint32_t cycleId, const COutPoint& mnOutpoint);
-
-    /**
-     * GetMasternodesForCycle - Get list of masternodes in cycle
-     *
-     * @param cycleId Cycle ID
-     * @param mnOutpoints Output parameter for masternode list
-     * @return true if index exists, false otherwise
-     */
-    bool GetMasternodesForCycle(uint32_t cycleId, std::vector<COutPoint>& mnOutpoints);
-
-    /**
-     * GetRevealsForCycle - Collect all valid reveals for a cycle
-     *
-     * Used by CalculateDomcMedian() to gather R proposals.
-     * Returns only reveals that have matching commits.
+     * Reveals are only written once validated against their commit.
      *
      * @param cycleId Cycle ID (cycle start height)
      * @param reveals Output parameter for reveal list
@@ -162,23 +186,35 @@ public:
     bool GetRevealsForCycle(uint32_t cycleId, std::vector<khu_domc::DomcReveal>& reveals);
 
     /**
-     * EraseCycleIndex - Delete cycle index (for reorg)
+     * GetRevealMedian - Median R proposal of a cycle, from the in-memory tally
      *
-     * @param cycleId Cycle ID
-     * @return true on success
+     * @param cycleId Cycle ID (cycle start height)
+     * @param nMedian Output: proposals[n / 2] of the sorted proposals
+     * @param nVotes Output: number of reveals
+     * @return true if the cycle has at least one reveal
      */
-    bool EraseCycleIndex(uint32_t cycleId);
+    bool GetRevealMedian(uint32_t cycleId, uint16_t& nMedian, size_t& nVotes);
 
     /**
      * EraseCycleData - Delete all data for a cycle (for reorg)
      *
-     * Removes all commits, reveals, and index for a given cycle.
+     * Removes all commits and reveals of a given cycle.
      * Called by UndoFinalizeDomcCycle to clean up after reorg.
      *
      * @param cycleId Cycle ID (cycle start height)
      * @return true on success, false on failure
      */
     bool EraseCycleData(uint32_t cycleId);
+
+    /**
+     * UpgradeLegacyKeys - Move votes stored under the former key layout
+     *
+     * 'D' + 'C'/'R' + mnOutpoint + cycleId and the 'D' + 'I' + cycleId index
+     * are rewritten under the per-cycle prefixes. Called once at startup.
+     *
+     * @return true on success (including nothing to upgrade)
+     */
+    bool UpgradeLegacyKeys();
 };
 
 // ============================================================================
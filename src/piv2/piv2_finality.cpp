@@ -6,11 +6,15 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "hash.h"
 #include "logging.h"
 #include "tiertwo/tiertwo_sync_state.h"
 #include "utiltime.h"
 #include "validation.h"
 
+#include <algorithm>
+#include <bitset>
+
 #include <boost/filesystem.hpp>
 
 namespace hu {
@@ -18,8 +22,26 @@ namespace hu {
 std::unique_ptr<CHuFinalityHandler> huFinalityHandler;
 std::unique_ptr<CHuFinalityDB> pHuFinalityDB;
 
-// DB key prefix for finality records
+// DB key prefixes: finality records, finalized block per height, pruned height
 static const char DB_HU_FINALITY = 'F';
+static const char DB_HU_FINALITY_HEIGHT = 'H';
+static const char DB_HU_PRUNED_HEIGHT = 'P';
+
+// ============================================================================
+// CHuFinality Implementation
+// ============================================================================
+
+bool CHuFinality::AddSigner(int nIndex, const std::vector<unsigned char>& vchSig)
+{
+    if (nIndex < 0 || nIndex >= MAX_HU_QUORUM_SIZE || HasSigner(nIndex)) {
+        return false;
+    }
+    // Signatures follow the order of the set bits
+    const uint64_t nLower = nSigners & ((uint64_t{1} << nIndex) - 1);
+    vSigs.insert(vSigs.begin() + std::bitset<MAX_HU_QUORUM_SIZE>(nLower).count(), vchSig);
+    nSigners |= uint64_t{1} << nIndex;
+    return true;
+}
 
 // ============================================================================
 // CHuFinalityDB Implementation
@@ -32,7 +54,15 @@ CHuFinalityDB::CHuFinalityDB(size_t nCacheSize, bool fMemory, bool fWipe)
 
 bool CHuFinalityDB::WriteFinality(const CHuFinality& finality)
 {
-    return Write(std::make_pair(DB_HU_FINALITY, finality.blockHash), finality);
+    CDBBatch batch(CLIENT_VERSION);
+    batch.Write(std::make_pair(DB_HU_FINALITY, finality.blockHash), finality);
+    batch.Write(std::make_pair(DB_HU_FINALITY_HEIGHT, finality.nHeight), finality.blockHash);
+    return WriteBatch(batch);
+}
+
+bool CHuFinalityDB::ReadFinalizedBlock(int nHeight, uint256& blockHash) const
+{
+    return Read(std::make_pair(DB_HU_FINALITY_HEIGHT, nHeight), blockHash);
 }
 
 bool CHuFinalityDB::ReadFinality(const uint256& blockHash, CHuFinality& finality) const
@@ -59,6 +89,27 @@ bool CHuFinalityDB::IsBlockFinal(const uint256& blockHash, int nThreshold) const
     return finality.HasFinality(nThreshold);
 }
 
+bool CHuFinalityDB::PruneFinality(int nFromHeight, int nToHeight)
+{
+    CDBBatch batch(CLIENT_VERSION);
+    for (int nHeight = nFromHeight + 1; nHeight <= nToHeight; nHeight++) {
+        uint256 blockHash;
+        if (ReadFinalizedBlock(nHeight, blockHash)) {
+            batch.Erase(std::make_pair(DB_HU_FINALITY, blockHash));
+            batch.Erase(std::make_pair(DB_HU_FINALITY_HEIGHT, nHeight));
+        }
+    }
+    batch.Write(DB_HU_PRUNED_HEIGHT, nToHeight);
+    return WriteBatch(batch);
+}
+
+int CHuFinalityDB::ReadPrunedHeight() const
+{
+    int nHeight = -1;
+    Read(DB_HU_PRUNED_HEIGHT, nHeight);
+    return nHeight;
+}
+
 // ============================================================================
 // Global Functions
 // ============================================================================
@@ -89,26 +140,64 @@ void ShutdownHuFinality()
 
 bool IsBlockHuFinal(const uint256& blockHash)
 {
-    if (!pHuFinalityDB) {
+    if (!huFinalityHandler) {
         return false;
     }
 
     const Consensus::Params& consensus = Params().GetConsensus();
-    return pHuFinalityDB->IsBlockFinal(blockHash, consensus.nHuQuorumThreshold);
+    CHuFinality finality;
+    return huFinalityHandler->GetFinality(blockHash, finality) &&
+           finality.HasFinality(consensus.nHuQuorumThreshold);
 }
 
-bool WouldViolateHuFinality(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork)
+uint256 GetHuSignatureHash(const uint256& blockHash)
 {
-    if (!pindexNew || !pindexFork || !pHuFinalityDB) {
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << std::string("HUSIG");
+    ss << blockHash;
+    return ss.GetHash();
+}
+
+bool CheckFinalityCert(const CBlockFinalityCert& cert, const uint256& blockHash,
+                       const std::vector<std::pair<uint256, CPubKey>>& vQuorum,
+                       std::vector<std::pair<CHuSignature, int>>& vSigsOut)
+{
+    vSigsOut.clear();
+    if (std::bitset<MAX_HU_QUORUM_SIZE>(cert.nSigners).count() != cert.vSigs.size()) {
+        return false;
+    }
+    if (vQuorum.size() < MAX_HU_QUORUM_SIZE && (cert.nSigners >> vQuorum.size()) != 0) {
         return false;
     }
 
-    const Consensus::Params& consensus = Params().GetConsensus();
+    const uint256 msgHash = GetHuSignatureHash(blockHash);
+    size_t nSig = 0;
+    for (int i = 0; i < (int)vQuorum.size() && i < MAX_HU_QUORUM_SIZE; i++) {
+        if (!((cert.nSigners >> i) & 1)) continue;
+        const std::vector<unsigned char>& vchSig = cert.vSigs[nSig++];
+        if (!vQuorum[i].second.VerifyCompact(msgHash, vchSig)) {
+            vSigsOut.clear();
+            return false;
+        }
+        CHuSignature sig;
+        sig.blockHash = blockHash;
+        sig.proTxHash = vQuorum[i].first;
+        sig.vchSig = vchSig;
+        vSigsOut.emplace_back(std::move(sig), i);
+    }
+    return true;
+}
+
+bool WouldViolateHuFinality(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork)
+{
+    if (!pindexNew || !pindexFork || !huFinalityHandler) {
+        return false;
+    }
 
     // Walk from fork point to current tip, checking for finalized blocks
     const CBlockIndex* pindex = chainActive.Tip();
     while (pindex && pindex != pindexFork) {
-        if (pHuFinalityDB->IsBlockFinal(pindex->GetBlockHash(), consensus.nHuQuorumThreshold)) {
+        if (huFinalityHandler->HasFinality(pindex->nHeight, pindex->GetBlockHash())) {
             LogPrint(BCLog::HU, "HU Finality: Reorg blocked - block %s at height %d is finalized\n",
                      pindex->GetBlockHash().ToString().substr(0, 16), pindex->nHeight);
             return true;
@@ -119,114 +208,180 @@ bool WouldViolateHuFinality(const CBlockIndex* pindexNew, const CBlockIndex* pin
     return false;
 }
 
+// ============================================================================
+// CHuFinalityHandler Implementation
+// ============================================================================
+
+CHuFinalityHandler::CHuFinalityHandler() : vSlots(HU_FINALITY_CACHE_HEIGHTS)
+{
+}
+
+CHuFinalityHandler::HeightSlot* CHuFinalityHandler::GetSlot(int nHeight)
+{
+    HeightSlot& slot = vSlots[nHeight % HU_FINALITY_CACHE_HEIGHTS];
+    return slot.nHeight == nHeight ? &slot : nullptr;
+}
+
+const CHuFinalityHandler::HeightSlot* CHuFinalityHandler::GetSlot(int nHeight) const
+{
+    const HeightSlot& slot = vSlots[nHeight % HU_FINALITY_CACHE_HEIGHTS];
+    return slot.nHeight == nHeight ? &slot : nullptr;
+}
+
+const CHuFinality* CHuFinalityHandler::Find(const uint256& blockHash) const
+{
+    auto it = mapBlockHeights.find(blockHash);
+    if (it == mapBlockHeights.end()) {
+        return nullptr;
+    }
+    const HeightSlot* slot = GetSlot(it->second);
+    if (!slot) {
+        return nullptr;
+    }
+    for (const CHuFinality& finality : slot->vBlocks) {
+        if (finality.blockHash == blockHash) return &finality;
+    }
+    return nullptr;
+}
+
+CHuFinalityHandler::HeightSlot* CHuFinalityHandler::ClaimSlot(int nHeight)
+{
+    if (nHeight < 0 || nHeight <= nBestHeight - HU_FINALITY_CACHE_HEIGHTS) {
+        return nullptr;
+    }
+    nBestHeight = std::max(nBestHeight, nHeight);
+
+    HeightSlot& slot = vSlots[nHeight % HU_FINALITY_CACHE_HEIGHTS];
+    if (slot.nHeight != nHeight) {
+        // Recycle the slot of the height that left the ring
+        for (const CHuFinality& finality : slot.vBlocks) {
+            mapBlockHeights.erase(finality.blockHash);
+        }
+        slot = HeightSlot();
+        slot.nHeight = nHeight;
+
+        // Start from the persisted record if the height was already finalized
+        CHuFinality finality;
+        if (pHuFinalityDB && pHuFinalityDB->ReadFinalizedBlock(nHeight, slot.hashFinal) &&
+            pHuFinalityDB->ReadFinality(slot.hashFinal, finality)) {
+            mapBlockHeights[slot.hashFinal] = nHeight;
+            slot.vBlocks.push_back(std::move(finality));
+        }
+    }
+    return &slot;
+}
+
 bool CHuFinalityHandler::HasFinality(int nHeight, const uint256& blockHash) const
 {
     LOCK(cs);
 
-    // Check if we have finality data for this block
-    auto it = mapFinality.find(blockHash);
-    if (it == mapFinality.end()) {
+    if (nHeight < 0) {
         return false;
     }
 
-    // Verify height matches
-    if (it->second.nHeight != nHeight) {
-        LogPrint(BCLog::HU, "HU Finality: Height mismatch for %s (expected %d, got %d)\n",
-                 blockHash.ToString().substr(0, 16), nHeight, it->second.nHeight);
-        return false;
+    const HeightSlot* slot = GetSlot(nHeight);
+    if (slot) {
+        return slot->hashFinal == blockHash;
     }
 
-    return it->second.HasFinality();
+    // Height not in memory: finalized blocks are on disk
+    uint256 hashFinal;
+    return pHuFinalityDB && pHuFinalityDB->ReadFinalizedBlock(nHeight, hashFinal) && hashFinal == blockHash;
 }
 
 bool CHuFinalityHandler::HasConflictingFinality(int nHeight, const uint256& blockHash) const
 {
     LOCK(cs);
 
-    // Check if there's a different finalized block at this height
-    auto heightIt = mapHeightToBlock.find(nHeight);
-    if (heightIt == mapHeightToBlock.end()) {
-        return false; // No finalized block at this height
-    }
-
-    // If same hash, no conflict
-    if (heightIt->second == blockHash) {
+    if (nHeight < 0) {
         return false;
     }
 
-    // Check if the other block actually has finality
-    auto finalityIt = mapFinality.find(heightIt->second);
-    if (finalityIt == mapFinality.end()) {
-        return false;
+    uint256 hashFinal;
+    const HeightSlot* slot = GetSlot(nHeight);
+    if (slot) {
+        hashFinal = slot->hashFinal;
+    } else if (pHuFinalityDB) {
+        pHuFinalityDB->ReadFinalizedBlock(nHeight, hashFinal);
     }
 
-    if (finalityIt->second.HasFinality()) {
-        LogPrint(BCLog::HU, "HU Finality: Conflicting block at height %d. Finalized: %s, Attempted: %s\n",
-                 nHeight,
-                 heightIt->second.ToString().substr(0, 16),
-                 blockHash.ToString().substr(0, 16));
-        return true;
+    // No finalized block at this height, or the same one
+    if (hashFinal.IsNull() || hashFinal == blockHash) {
+        return false;
     }
 
-    return false;
+    LogPrint(BCLog::HU, "HU Finality: Conflicting block at height %d. Finalized: %s, Attempted: %s\n",
+             nHeight,
+             hashFinal.ToString().substr(0, 16),
+             blockHash.ToString().substr(0, 16));
+    return true;
 }
 
-bool CHuFinalityHandler::AddSignature(const CHuSignature& sig)
+bool CHuFinalityHandler::AddSignature(const CHuSignature& sig, int nHeight, int nQuorumIndex)
 {
     LOCK(cs);
 
+    HeightSlot* slot = ClaimSlot(nHeight);
+    if (!slot) {
+        LogPrint(BCLog::HU, "HU Finality: Signature for block %s at height %d is too old (best %d)\n",
+                 sig.blockHash.ToString().substr(0, 16), nHeight, nBestHeight);
+        return false;
+    }
+
     // Get or create finality entry
-    auto& finality = mapFinality[sig.blockHash];
-    if (finality.blockHash.IsNull()) {
-        finality.blockHash = sig.blockHash;
-        // Note: nHeight should be set by caller via MarkBlockFinal or separate method
+    auto it = std::find_if(slot->vBlocks.begin(), slot->vBlocks.end(),
+                           [&](const CHuFinality& f) { return f.blockHash == sig.blockHash; });
+    if (it == slot->vBlocks.end()) {
+        slot->vBlocks.emplace_back(sig.blockHash, nHeight);
+        mapBlockHeights[sig.blockHash] = nHeight;
+        it = std::prev(slot->vBlocks.end());
     }
+    CHuFinality& finality = *it;
 
     // Check if we already have this signature
-    if (finality.mapSignatures.count(sig.proTxHash)) {
-        LogPrint(BCLog::HU, "HU Finality: Duplicate signature from %s for block %s\n",
-                 sig.proTxHash.ToString().substr(0, 16),
+    if (!finality.AddSigner(nQuorumIndex, sig.vchSig)) {
+        LogPrint(BCLog::HU, "HU Finality: Duplicate signature from %s (quorum index %d) for block %s\n",
+                 sig.proTxHash.ToString().substr(0, 16), nQuorumIndex,
                  sig.blockHash.ToString().substr(0, 16));
         return false;
     }
 
-    // Add signature
-    finality.mapSignatures[sig.proTxHash] = sig.vchSig;
-
     const Consensus::Params& consensus = Params().GetConsensus();
     const int nThreshold = consensus.nHuQuorumThreshold;
+    const int nCount = static_cast<int>(finality.GetSignatureCount());
 
-    LogPrint(BCLog::HU, "HU Finality: Added signature %zu/%d from %s for block %s\n",
-             finality.mapSignatures.size(), nThreshold,
+    LogPrint(BCLog::HU, "HU Finality: Added signature %d/%d from %s for block %s\n",
+             nCount, nThreshold,
              sig.proTxHash.ToString().substr(0, 16),
              sig.blockHash.ToString().substr(0, 16));
 
+    if (nCount < nThreshold) {
+        return true;
+    }
+
+    // Persist finalized blocks (rewritten with the late signatures too)
+    if (pHuFinalityDB && !pHuFinalityDB->WriteFinality(finality)) {
+        LogPrintf("HU Finality: ERROR - Failed to write finality for block %s\n",
+                  sig.blockHash.ToString().substr(0, 16));
+    }
+
     // Check if we just reached finality
-    if (static_cast<int>(finality.mapSignatures.size()) == nThreshold) {
-        // Get block height from mapBlockIndex if not set
-        int nHeight = finality.nHeight;
-        if (nHeight <= 0) {
-            LOCK(cs_main);
-            auto it = mapBlockIndex.find(sig.blockHash);
-            if (it != mapBlockIndex.end()) {
-                nHeight = it->second->nHeight;
-                finality.nHeight = nHeight;
-            }
+    if (nCount == nThreshold) {
+        if (!slot->hashFinal.IsNull() && slot->hashFinal != sig.blockHash) {
+            LogPrintf("HU Finality: WARNING - Second block %s finalized at height %d (first %s)\n",
+                      sig.blockHash.ToString().substr(0, 16), nHeight, slot->hashFinal.ToString().substr(0, 16));
+            return true;
         }
+        slot->hashFinal = sig.blockHash;
 
         LogPrintf("HU Finality: Block %s at height %d reached finality (%d signatures)\n",
                   sig.blockHash.ToString().substr(0, 16), nHeight, nThreshold);
 
-        // Update height->block mapping if we have the height
-        if (nHeight > 0) {
-            mapHeightToBlock[nHeight] = sig.blockHash;
-
-            // PIV2: Notify sync state that we have a finalized block
-            // This is critical for DMM to know it can produce the next block
-            g_tiertwo_sync_state.OnFinalizedBlock(nHeight, GetTime());
-            LogPrint(BCLog::HU, "HU Finality: Notified sync state of finalized block at height %d\n",
-                     nHeight);
-        }
+        // PIV2: Notify sync state that we have a finalized block
+        // This is critical for DMM to know it can produce the next block
+        g_tiertwo_sync_state.OnFinalizedBlock(nHeight, GetTime());
+        LogPrint(BCLog::HU, "HU Finality: Notified sync state of finalized block at height %d\n",
+                 nHeight);
     }
 
     return true;
@@ -236,25 +391,27 @@ bool CHuFinalityHandler::GetFinality(const uint256& blockHash, CHuFinality& fina
 {
     LOCK(cs);
 
-    auto it = mapFinality.find(blockHash);
-    if (it == mapFinality.end()) {
-        return false;
+    const CHuFinality* finality = Find(blockHash);
+    if (finality) {
+        finalityOut = *finality;
+        return true;
     }
 
-    finalityOut = it->second;
-    return true;
+    return pHuFinalityDB && pHuFinalityDB->ReadFinality(blockHash, finalityOut);
 }
 
 void CHuFinalityHandler::MarkBlockFinal(int nHeight, const uint256& blockHash)
 {
     LOCK(cs);
 
-    auto& finality = mapFinality[blockHash];
-    finality.blockHash = blockHash;
-    finality.nHeight = nHeight;
-
-    // Update height mapping
-    mapHeightToBlock[nHeight] = blockHash;
+    HeightSlot* slot = ClaimSlot(nHeight);
+    if (!slot) {
+        return;
+    }
+    if (!Find(blockHash)) {
+        slot->vBlocks.emplace_back(blockHash, nHeight);
+        mapBlockHeights[blockHash] = nHeight;
+    }
 
     LogPrint(BCLog::HU, "HU Finality: Marked block %s at height %d as final candidate\n",
              blockHash.ToString().substr(0, 16), nHeight);
@@ -262,21 +419,62 @@ void CHuFinalityHandler::MarkBlockFinal(int nHeight, const uint256& blockHash)
 
 int CHuFinalityHandler::GetSignatureCount(const uint256& blockHash) const
 {
-    LOCK(cs);
-
-    auto it = mapFinality.find(blockHash);
-    if (it == mapFinality.end()) {
+    CHuFinality finality;
+    if (!GetFinality(blockHash, finality)) {
         return 0;
     }
 
-    return static_cast<int>(it->second.mapSignatures.size());
+    return static_cast<int>(finality.GetSignatureCount());
+}
+
+bool CHuFinalityHandler::GetFinalityCert(const uint256& blockHash, int nThreshold, CBlockFinalityCert& certOut) const
+{
+    CHuFinality finality;
+    if (!GetFinality(blockHash, finality) || !finality.HasFinality(nThreshold)) {
+        return false;
+    }
+
+    certOut.SetNull();
+    size_t nSig = 0;
+    for (int i = 0; i < MAX_HU_QUORUM_SIZE && (int)certOut.vSigs.size() < nThreshold; i++) {
+        if (!finality.HasSigner(i)) continue;
+        certOut.nSigners |= uint64_t{1} << i;
+        certOut.vSigs.push_back(finality.vSigs[nSig++]);
+    }
+    return true;
+}
+
+void CHuFinalityHandler::Prune(int nTipHeight)
+{
+    LOCK(cs);
+
+    nBestHeight = std::max(nBestHeight, nTipHeight);
+
+    if (!pHuFinalityDB) {
+        return;
+    }
+    const int nPruneTo = nTipHeight - HU_FINALITY_DB_KEEP_HEIGHTS;
+    if (!fPrunedHeightRead) {
+        // Records are only written close to the tip (Prune runs on every
+        // connected block), an unpruned DB has nothing below the cutoff
+        nPrunedHeight = std::max(pHuFinalityDB->ReadPrunedHeight(), nPruneTo - 1);
+        fPrunedHeightRead = true;
+    }
+    if (nPruneTo > nPrunedHeight) {
+        if (pHuFinalityDB->PruneFinality(nPrunedHeight, nPruneTo)) {
+            nPrunedHeight = nPruneTo;
+        }
+    }
 }
 
 void CHuFinalityHandler::Clear()
 {
     LOCK(cs);
-    mapFinality.clear();
-    mapHeightToBlock.clear();
+    vSlots.assign(HU_FINALITY_CACHE_HEIGHTS, HeightSlot());
+    mapBlockHeights.clear();
+    nBestHeight = -1;
+    nPrunedHeight = -1;
+    fPrunedHeightRead = false;
 }
 
 } // namespace hu
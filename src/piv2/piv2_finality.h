@@ -6,11 +6,17 @@
 #define PIVHU_HU_FINALITY_H
 
 #include "dbwrapper.h"
+#include "hash.h"
+#include "primitives/block.h"
+#include "pubkey.h"
+#include "saltedhasher.h"
 #include "serialize.h"
 #include "sync.h"
 #include "uint256.h"
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 class CBlockIndex;
@@ -55,55 +61,106 @@ struct CHuSignature {
     {
         READWRITE(obj.blockHash, obj.proTxHash, obj.vchSig);
     }
+
+    /** Inventory hash: a member signs a block once, so (block, signer) identifies the signature */
+    uint256 GetHash() const
+    {
+        CHashWriter ss(SER_GETHASH, 0);
+        ss << blockHash << proTxHash;
+        return ss.GetHash();
+    }
 };
 
+/** Largest quorum a signer bitmap can describe */
+static const int MAX_HU_QUORUM_SIZE = 64;
+/** Heights of finality data kept in memory (ring buffer below the highest signed height) */
+static const int HU_FINALITY_CACHE_HEIGHTS = 1000;
+/** Heights of finality records kept on disk below the tip */
+static const int HU_FINALITY_DB_KEEP_HEIGHTS = 100000;
+
 /**
  * HU Finality data for a block
- * Stores all collected signatures
+ *
+ * Signers are recorded as a bitmap over the positions of the cycle's quorum
+ * (bit i = i-th member of GetHuQuorum), the signatures themselves are kept in
+ * the order of the set bits.
  */
 class CHuFinality {
 public:
     uint256 blockHash;
     int nHeight{0};
-    std::map<uint256, std::vector<unsigned char>> mapSignatures; // proTxHash -> sig
+    uint64_t nSigners{0};
+    std::vector<std::vector<unsigned char>> vSigs;
 
     CHuFinality() = default;
     explicit CHuFinality(const uint256& hash, int height) : blockHash(hash), nHeight(height) {}
 
+    bool HasSigner(int nIndex) const
+    {
+        return nIndex >= 0 && nIndex < MAX_HU_QUORUM_SIZE && (nSigners >> nIndex) & 1;
+    }
+
+    /**
+     * Record the signature of the quorum member at nIndex
+     * @return false if out of range or already signed
+     */
+    bool AddSigner(int nIndex, const std::vector<unsigned char>& vchSig);
+
     /**
      * Check if block has reached finality threshold
      * @param nThreshold - from consensus.nHuQuorumThreshold (8/2/1 per network)
      */
     bool HasFinality(int nThreshold) const {
-        return static_cast<int>(mapSignatures.size()) >= nThreshold;
+        return GetSignatureCount() >= static_cast<size_t>(nThreshold);
     }
 
     // Backward compatibility - uses default threshold (mainnet)
     bool HasFinality() const { return HasFinality(HU_FINALITY_THRESHOLD_DEFAULT); }
 
-    size_t GetSignatureCount() const { return mapSignatures.size(); }
+    size_t GetSignatureCount() const { return vSigs.size(); }
 
     SERIALIZE_METHODS(CHuFinality, obj)
     {
-        READWRITE(obj.blockHash, obj.nHeight, obj.mapSignatures);
+        READWRITE(obj.blockHash, obj.nHeight, obj.nSigners, obj.vSigs);
     }
 };
 
 /**
  * HU Finality Handler
  * Manages finality signatures and enforcement
+ *
+ * The last HU_FINALITY_CACHE_HEIGHTS heights live in a ring buffer indexed by
+ * height, so that lookups by height are O(1) and memory stays bounded: a slot
+ * is recycled when a signature for a height HU_FINALITY_CACHE_HEIGHTS above
+ * it arrives. Finalized blocks are written to CHuFinalityDB, which answers
+ * for the heights that left the ring.
  */
 class CHuFinalityHandler {
 private:
+    struct HeightSlot {
+        int nHeight{-1};
+        uint256 hashFinal;                 // block that reached the threshold at this height
+        std::vector<CHuFinality> vBlocks;  // blocks signed at this height (forks are rare)
+    };
+
     mutable RecursiveMutex cs;
-    std::map<uint256, CHuFinality> mapFinality;  // blockHash -> finality data
-    std::map<int, uint256> mapHeightToBlock;     // height -> blockHash (for quick lookup)
+    std::vector<HeightSlot> vSlots;
+    std::unordered_map<uint256, int, StaticSaltedHasher> mapBlockHeights; // blocks in the ring -> height
+    int nBestHeight{-1};                   // highest height seen (signature or tip)
+    int nPrunedHeight{-1};                 // DB records at or below this height are gone
+    bool fPrunedHeightRead{false};
+
+    HeightSlot* GetSlot(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    const HeightSlot* GetSlot(int nHeight) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+    const CHuFinality* Find(const uint256& blockHash) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Slot for nHeight, recycled if it held an older height (nullptr if nHeight left the ring) */
+    HeightSlot* ClaimSlot(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
 public:
-    CHuFinalityHandler() = default;
+    CHuFinalityHandler();
 
     /**
-     * Check if a block has HU finality (≥8 signatures)
+     * Check if a block has HU finality (consensus threshold reached)
      */
     bool HasFinality(int nHeight, const uint256& blockHash) const;
 
@@ -115,9 +172,11 @@ public:
 
     /**
      * Add a signature to a block's finality data
-     * @return true if signature was new and valid
+     * @param nHeight - height of the signed block
+     * @param nQuorumIndex - position of the signer in the cycle's quorum
+     * @return true if signature was new and within the cached heights
      */
-    bool AddSignature(const CHuSignature& sig);
+    bool AddSignature(const CHuSignature& sig, int nHeight, int nQuorumIndex);
 
     /**
      * Get finality data for a block
@@ -134,6 +193,19 @@ public:
      */
     int GetSignatureCount(const uint256& blockHash) const;
 
+    /**
+     * Finality certificate of a final block, for the block built on it
+     * (the first nThreshold signers only)
+     * @return false if the block hasn't reached nThreshold signatures
+     */
+    bool GetFinalityCert(const uint256& blockHash, int nThreshold, CBlockFinalityCert& certOut) const;
+
+    /**
+     * New tip: advance the ring and prune the DB records older than
+     * HU_FINALITY_DB_KEEP_HEIGHTS
+     */
+    void Prune(int nTipHeight);
+
     /**
      * Clear all finality data (for testing)
      */
@@ -154,10 +226,16 @@ public:
     CHuFinalityDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
     /**
-     * Write finality data for a block
+     * Write finality data for a block (and index it by height)
      */
     bool WriteFinality(const CHuFinality& finality);
 
+    /**
+     * Read the finalized block at a height
+     * @return true if found, false otherwise
+     */
+    bool ReadFinalizedBlock(int nHeight, uint256& blockHash) const;
+
     /**
      * Read finality data for a block
      * @return true if found, false otherwise
@@ -179,6 +257,14 @@ public:
      * @param nThreshold - from consensus.nHuQuorumThreshold
      */
     bool IsBlockFinal(const uint256& blockHash, int nThreshold) const;
+
+    /**
+     * Erase the records of the heights in (nFromHeight, nToHeight]
+     */
+    bool PruneFinality(int nFromHeight, int nToHeight);
+
+    /** Highest height pruned so far (-1 if never) */
+    int ReadPrunedHeight() const;
 };
 
 // Global DB instance
@@ -202,6 +288,22 @@ void ShutdownHuFinality();
  */
 bool IsBlockHuFinal(const uint256& blockHash);
 
+/**
+ * Message signed by the quorum members: "HUSIG" || blockHash
+ */
+uint256 GetHuSignatureHash(const uint256& blockHash);
+
+/**
+ * Check the finality certificate of a block against its quorum
+ * @param vQuorum - (proTxHash, operator pubkey) of the quorum members, by position
+ * @param vSigsOut - the certificate signatures and the quorum position of their signer
+ * @return false if the certificate is malformed (signer bitmap and signatures
+ *         don't match, signer outside of the quorum) or a signature is invalid
+ */
+bool CheckFinalityCert(const CBlockFinalityCert& cert, const uint256& blockHash,
+                       const std::vector<std::pair<uint256, CPubKey>>& vQuorum,
+                       std::vector<std::pair<CHuSignature, int>>& vSigsOut);
+
 /**
  * Check if a reorg to newTip would violate HU finality
  * @param pindexNew - proposed new tip
@@ -11,6 +11,7 @@
 #include "piv2/piv2_coins.h"
 #include "piv2/piv2_utxo.h"
 #include "piv2/piv2_validation.h"
+#include "piv2/piv2_yield.h"
 #include "piv2/zkpiv2_db.h"
 #include "piv2/zkpiv2_memo.h"
 #include "piv2/zkpiv2_note.h"
@@ -174,6 +175,11 @@ bool ApplyHULock(
         return error("%s: failed to write nullifier mapping", __func__);
     }
 
+    // 7b. Register principal in its maturity bucket (yield accumulator)
+    if (!khu_yield::AddNoteToYieldIndex(noteData, state)) {
+        return error("%s: failed to register note with yield index", __func__);
+    }
+
     // ═══════════════════════════════════════════════════════════════════════
     // K-POOL VALIDATION MODEL — PAS DE MERKLE TREE SAPLING
     // ═══════════════════════════════════════════════════════════════════════
@@ -199,7 +205,7 @@ bool ApplyHULock(
     // Voir: docs/SPEC.md section "Modèle Sapling HU — S vs K"
     // ═══════════════════════════════════════════════════════════════════════
 
-    // 8. ✅ CRITICAL: Spend KHU inputs from mapKHUUTXOs
+    // 8. ✅ CRITICAL: Spend KHU inputs from the KHU coins view
     // LOCK tx has KHU_T inputs that need to be spent in consensus tracking
     for (const auto& in : tx.vin) {
         CKHUUTXO khuCoin;
@@ -212,10 +218,10 @@ bool ApplyHULock(
                      __func__, in.prevout.hash.ToString().substr(0,16).c_str(), in.prevout.n,
                      FormatMoney(khuCoin.amount));
         }
-        // Non-KHU inputs (PIV fee) are skipped - they're not in mapKHUUTXOs
+        // Non-KHU inputs (PIV fee) are skipped - they're not in the KHU coins view
     }
 
-    // 9. ✅ CRITICAL: Add KHU_T change output to mapKHUUTXOs (if any)
+    // 9. ✅ CRITICAL: Add KHU_T change output to the KHU coins view (if any)
     // LOCK tx may have a KHU change output at index 0 (before Sapling outputs)
     // The wallet's khulock creates: output[0] = KHU change, then Sapling data
     for (size_t i = 0; i < tx.vout.size(); ++i) {
@@ -319,7 +325,10 @@ bool UndoKHULock(
     // fully restored here. The standard UTXO view restores them via ApplyTxInUndo(),
     // and subsequent operations should use wallet data for KHU selection.
 
-    // 5. Erase ZKHU note from database
+    // 5. Unregister principal from its maturity bucket, then erase ZKHU note
+    if (!khu_yield::RemoveNoteFromYieldIndex(noteData, state)) {
+        return error("%s: failed to unregister note from yield index", __func__);
+    }
     if (!zkhuDB->EraseNote(cm)) {
         return error("%s: failed to erase note", __func__);
     }
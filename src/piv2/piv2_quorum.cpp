@@ -9,11 +9,19 @@
 #include "chainparams.h"
 #include "hash.h"
 #include "logging.h"
+#include "saltedhasher.h"
+#include "sync.h"
+#include "unordered_lru_cache.h"
 
 #include <algorithm>
 
 namespace hu {
 
+// Quorum cache: hash(seed, cycle, mnList block hash, quorum size) -> quorum
+static Mutex cs_quorumSchedules;
+static unordered_lru_cache<uint256, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher>
+    quorumSchedules(HU_QUORUM_SCHEDULE_CACHE_SIZE);
+
 uint256 ComputeHuQuorumSeed(const uint256& prevCycleBlockHash, int cycleIndex)
 {
     // seed = SHA256(prevCycleBlockHash || cycleIndex || "HU_QUORUM")
@@ -33,10 +41,11 @@ uint256 ComputeHuQuorumMemberScore(const uint256& seed, const uint256& proTxHash
     return ss.GetHash();
 }
 
-std::vector<CDeterministicMNCPtr> GetHuQuorum(
+static std::vector<CDeterministicMNCPtr> ComputeHuQuorum(
     const CDeterministicMNList& mnList,
     int cycleIndex,
-    const uint256& prevCycleBlockHash)
+    const uint256& prevCycleBlockHash,
+    size_t nQuorumSize)
 {
     std::vector<CDeterministicMNCPtr> result;
 
@@ -46,6 +55,7 @@ std::vector<CDeterministicMNCPtr> GetHuQuorum(
     // Collect all valid, confirmed MNs with their scores
     // Using arith_uint256 for comparison operators
     std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scoredMns;
+    scoredMns.reserve(mnList.GetAllMNsCount());
 
     mnList.ForEachMN(true /* onlyValid */, [&](const CDeterministicMNCPtr& dmn) {
         // Skip unconfirmed MNs
@@ -63,8 +73,9 @@ std::vector<CDeterministicMNCPtr> GetHuQuorum(
         return result;
     }
 
-    // Sort by score (descending)
-    std::sort(scoredMns.begin(), scoredMns.end(),
+    // Top nQuorumSize by score (descending), the rest is never looked at
+    size_t quorumSize = std::min(nQuorumSize, scoredMns.size());
+    std::partial_sort(scoredMns.begin(), scoredMns.begin() + quorumSize, scoredMns.end(),
         [](const auto& a, const auto& b) {
             if (a.first == b.first) {
                 // Tie-breaker: proTxHash lexicographically
@@ -73,11 +84,7 @@ std::vector<CDeterministicMNCPtr> GetHuQuorum(
             return a.first > b.first;
         });
 
-    // Take top nHuQuorumSize MNs (from consensus params)
-    const Consensus::Params& consensus = Params().GetConsensus();
-    size_t quorumSize = std::min(static_cast<size_t>(consensus.nHuQuorumSize), scoredMns.size());
     result.reserve(quorumSize);
-
     for (size_t i = 0; i < quorumSize; i++) {
         result.push_back(scoredMns[i].second);
     }
@@ -88,6 +95,47 @@ std::vector<CDeterministicMNCPtr> GetHuQuorum(
     return result;
 }
 
+std::vector<CDeterministicMNCPtr> GetHuQuorum(
+    const CDeterministicMNList& mnList,
+    int cycleIndex,
+    const uint256& prevCycleBlockHash)
+{
+    // Take top nHuQuorumSize MNs (from consensus params)
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const size_t nQuorumSize = static_cast<size_t>(consensus.nHuQuorumSize);
+
+    if (mnList.GetBlockHash().IsNull()) {
+        return ComputeHuQuorum(mnList, cycleIndex, prevCycleBlockHash, nQuorumSize);
+    }
+
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << prevCycleBlockHash;
+    ss << cycleIndex;
+    ss << mnList.GetBlockHash();
+    ss << (uint64_t)nQuorumSize;
+    const uint256 key = ss.GetHash();
+
+    std::vector<CDeterministicMNCPtr> result;
+    {
+        LOCK(cs_quorumSchedules);
+        if (quorumSchedules.get(key, result)) {
+            return result;
+        }
+    }
+
+    result = ComputeHuQuorum(mnList, cycleIndex, prevCycleBlockHash, nQuorumSize);
+
+    LOCK(cs_quorumSchedules);
+    quorumSchedules.insert(key, result);
+    return result;
+}
+
+void ClearHuQuorumCache()
+{
+    LOCK(cs_quorumSchedules);
+    quorumSchedules.clear();
+}
+
 bool IsInHuQuorum(
     const CDeterministicMNList& mnList,
     int cycleIndex,
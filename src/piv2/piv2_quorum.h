@@ -67,9 +67,16 @@ inline int GetHuCycleStartHeight(int cycleIndex, int nCycleLength = HU_CYCLE_LEN
  */
 uint256 ComputeHuQuorumSeed(const uint256& seedBlockHash, int cycleIndex);
 
+/** Number of memoized quorums (one per seed / cycle / MN list) */
+static const size_t HU_QUORUM_SCHEDULE_CACHE_SIZE = 64;
+
 /**
  * Select the HU quorum for a given cycle
  *
+ * Memoized per (seed, cycle, mnList block hash); only the top nHuQuorumSize
+ * scores are ranked (partial selection). Lists not bound to a block are not
+ * cached.
+ *
  * @param mnList Deterministic MN list at the cycle start
  * @param cycleIndex Cycle index
  * @param prevCycleBlockHash Hash of last block in previous cycle
@@ -80,6 +87,11 @@ std::vector<CDeterministicMNCPtr> GetHuQuorum(
     int cycleIndex,
     const uint256& prevCycleBlockHash);
 
+/**
+ * Drop every memoized quorum (MN list undo / reorg)
+ */
+void ClearHuQuorumCache();
+
 /**
  * Check if a masternode is in the HU quorum for a given cycle
  *
@@ -71,7 +71,7 @@ bool CheckKHURedeem(const CTransaction& tx, CValidationState& state, const CCoin
 
     // 4. Vérifier inputs KHU_T suffisants
     // NOTE: Per CLAUDE.md §2.1, REDEEM tx has KHU inputs + optional PIV input for fee.
-    // Only count inputs that are actually KHU coins (exist in mapKHUUTXOs).
+    // Only count inputs that are actually KHU coins (exist in the KHU coins view).
     // PIV fee inputs are NOT in the KHU tracking and should be skipped.
     CAmount total_input = 0;
     for (const auto& in : tx.vin) {
@@ -168,7 +168,7 @@ bool ApplyHURedeem(const CTransaction& tx, HuGlobalState& state, CCoinsViewCache
 
     // 6. Dépenser UTXO KHU_T
     // NOTE: Per CLAUDE.md §2.1, REDEEM tx has KHU inputs + 1 PIV input for fee.
-    // Only spend inputs that are actually KHU coins (exist in mapKHUUTXOs).
+    // Only spend inputs that are actually KHU coins (exist in the KHU coins view).
     // PIV fee inputs are NOT in the KHU tracking and should be skipped.
 
     LogPrint(BCLog::HU, "%s: processing tx %s with %zu inputs\n",
@@ -190,7 +190,7 @@ bool ApplyHURedeem(const CTransaction& tx, HuGlobalState& state, CCoinsViewCache
                      __func__, in.prevout.hash.ToString().substr(0,16).c_str(), in.prevout.n,
                      FormatMoney(khuCoin.amount));
         }
-        // PIV fee inputs are silently skipped - they're not in mapKHUUTXOs
+        // PIV fee inputs are silently skipped - they're not in the KHU coins view
     }
 
     LogPrint(BCLog::HU, "%s: totalKHUSpent=%s, required=%s\n",
@@ -14,22 +14,51 @@
 #include "netmessagemaker.h"
 #include "piv2/piv2_quorum.h"
 #include "protocol.h"
+#include "tiertwo/net_masternodes.h"
 #include "util/system.h"
 #include "utiltime.h"
 #include "validation.h"
+#include "version.h"
+
+#include <algorithm>
 
 namespace hu {
 
 std::unique_ptr<CHuSignalingManager> huSignalingManager;
 
+static void MergeStageStats(CHuSigStageStats& to, const CHuSigStageStats& from)
+{
+    to.nCount += from.nCount;
+    to.nTotalMicros += from.nTotalMicros;
+    to.nMaxMicros = std::max(to.nMaxMicros, from.nMaxMicros);
+}
+
+void CHuSigStageStats::Add(int64_t nMicros)
+{
+    nCount++;
+    nTotalMicros += nMicros;
+    nMaxMicros = std::max(nMaxMicros, nMicros);
+}
+
 // ============================================================================
 // Initialization
 // ============================================================================
 
 void InitHuSignaling()
 {
+    int nThreads = gArgs.GetArg("-husigthreads", DEFAULT_HU_SIG_THREADS);
+    nThreads = std::max(0, std::min(nThreads, MAX_HU_SIG_THREADS));
+
     huSignalingManager = std::make_unique<CHuSignalingManager>();
-    LogPrintf("HU Signaling: Initialized\n");
+    huSignalingManager->StartWorkers(nThreads);
+    LogPrintf("HU Signaling: Initialized (%d verification threads)\n", nThreads);
+}
+
+void StopHuSignaling()
+{
+    if (huSignalingManager) {
+        huSignalingManager->StopWorkers();
+    }
 }
 
 void ShutdownHuSignaling()
@@ -42,6 +71,116 @@ void ShutdownHuSignaling()
 // CHuSignalingManager Implementation
 // ============================================================================
 
+CHuSignalingManager::~CHuSignalingManager()
+{
+    StopWorkers();
+}
+
+void CHuSignalingManager::StartWorkers(int nThreads)
+{
+    assert(vWorkers.empty());
+    {
+        LOCK(cs_stats);
+        stats.nThreads = nThreads;
+    }
+    for (int i = 0; i < nThreads; i++) {
+        vWorkers.emplace_back(&TraceThread<std::function<void()> >, strprintf("husig.%d", i),
+                              std::function<void()>(std::bind(&CHuSignalingManager::ThreadSigVerify, this)));
+    }
+}
+
+void CHuSignalingManager::StopWorkers()
+{
+    {
+        LOCK(cs_queue);
+        fStopWorkers = true;
+        queuePending.clear();
+        queueCerts.clear();
+    }
+    cvQueue.notify_all();
+    for (std::thread& t : vWorkers) {
+        if (t.joinable()) t.join();
+    }
+    vWorkers.clear();
+}
+
+void CHuSignalingManager::ThreadSigVerify()
+{
+    while (true) {
+        std::vector<PendingSig> vBatch;
+        std::vector<PendingCert> vCerts;
+        {
+            WAIT_LOCK(cs_queue, lock);
+            cvQueue.wait(lock, [this] { return fStopWorkers || !queuePending.empty() || !queueCerts.empty(); });
+            if (fStopWorkers) {
+                return;
+            }
+            // Take a batch, leave the rest to the other workers. Signatures first:
+            // they decide the finality of the tip, certificates that of older blocks
+            if (!queuePending.empty()) {
+                size_t nTake = std::min(queuePending.size(), HU_SIG_BATCH_SIZE);
+                vBatch.reserve(nTake);
+                for (size_t i = 0; i < nTake; i++) {
+                    vBatch.push_back(std::move(queuePending.front()));
+                    queuePending.pop_front();
+                }
+            } else {
+                size_t nTake = std::min(queueCerts.size(), HU_CERT_BATCH_SIZE);
+                vCerts.reserve(nTake);
+                for (size_t i = 0; i < nTake; i++) {
+                    vCerts.push_back(std::move(queueCerts.front()));
+                    queueCerts.pop_front();
+                }
+            }
+        }
+        if (!vBatch.empty()) {
+            ProcessBatch(vBatch);
+        } else {
+            ProcessCertBatch(vCerts);
+        }
+    }
+}
+
+std::shared_ptr<const HuQuorumOperators> CHuSignalingManager::GetQuorumOperators(const CBlockIndex* pindex)
+{
+    if (!pindex || !pindex->pprev) {
+        return nullptr;
+    }
+
+    const Consensus::Params& consensus = Params().GetConsensus();
+    int cycleIndex = GetHuCycleIndex(pindex->nHeight, consensus.nHuQuorumRotationBlocks);
+    uint256 prevCycleHash = pindex->pprev->GetBlockHash();
+    const auto key = std::make_pair(prevCycleHash, cycleIndex);
+
+    std::shared_ptr<const HuQuorumOperators> operators;
+    {
+        LOCK(cs_quorumCache);
+        if (quorumCache.get(key, operators)) {
+            WITH_LOCK(cs_stats, stats.nQuorumCacheHits++);
+            return operators;
+        }
+    }
+
+    // Get the MN list at the block's height
+    CDeterministicMNList mnList = deterministicMNManager->GetListForBlock(pindex->pprev);
+    auto quorum = GetHuQuorum(mnList, cycleIndex, prevCycleHash);
+
+    auto newOperators = std::make_shared<HuQuorumOperators>();
+    for (size_t i = 0; i < quorum.size() && i < (size_t)MAX_HU_QUORUM_SIZE; i++) {
+        // The operator pubkey is stored directly in the DMN state as CPubKey
+        const auto& dmn = quorum[i];
+        newOperators->emplace(dmn->proTxHash, CHuQuorumMember{(int)i, dmn->pdmnState->pubKeyOperator});
+    }
+    operators = newOperators;
+
+    {
+        LOCK(cs_quorumCache);
+        quorumCache.insert(key, operators);
+    }
+    WITH_LOCK(cs_stats, stats.nQuorumCacheMisses++);
+    return operators;
+}
+
 bool CHuSignalingManager::OnNewBlock(const CBlockIndex* pindex, CConnman* connman)
 {
     if (!pindex || !connman) {
@@ -63,18 +202,17 @@ bool CHuSignalingManager::OnNewBlock(const CBlockIndex* pindex, CConnman* connma
         }
     }
 
-    // Check if we're in the quorum for this block
-    const Consensus::Params& consensus = Params().GetConsensus();
-    CDeterministicMNList mnList = deterministicMNManager->GetListForBlock(pindex->pprev);
-
-    int cycleIndex = GetHuCycleIndex(pindex->nHeight, consensus.nHuQuorumRotationBlocks);
-    uint256 prevCycleHash = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
-
-    if (!IsInHuQuorum(mnList, cycleIndex, prevCycleHash, activeMasternodeManager->GetProTx())) {
+    // Check if we're in the quorum for this block (the quorum is cached for the
+    // signatures of the other members that follow)
+    auto operators = GetQuorumOperators(pindex);
+    auto itSelf = operators ? operators->find(activeMasternodeManager->GetProTx()) : HuQuorumOperators::const_iterator();
+    if (!operators || itSelf == operators->end()) {
         LogPrint(BCLog::HU, "HU Signaling: Not in quorum for block %s at height %d\n",
                  blockHash.ToString().substr(0, 16), pindex->nHeight);
+        UpdateQuorumRelayMembers(nullptr, connman);
         return false;
     }
+    UpdateQuorumRelayMembers(operators.get(), connman);
 
     // Sign the block
     CHuSignature sig;
@@ -89,15 +227,16 @@ bool CHuSignalingManager::OnNewBlock(const CBlockIndex* pindex, CConnman* connma
 
         // Add to local cache
         mapSigCache[blockHash][sig.proTxHash] = sig.vchSig;
+        mapBlocksByHeight[pindex->nHeight].insert(blockHash);
     }
 
     // Add to finality handler
     if (huFinalityHandler) {
-        huFinalityHandler->AddSignature(sig);
+        huFinalityHandler->AddSignature(sig, pindex->nHeight, itSelf->second.nIndex);
     }
 
     // Broadcast to network
-    BroadcastSignature(sig, connman);
+    BroadcastSignature(sig, operators.get(), connman);
 
     LogPrintf("HU Signaling: Signed and broadcast signature for block %s at height %d\n",
               blockHash.ToString().substr(0, 16), pindex->nHeight);
@@ -123,34 +262,194 @@ bool CHuSignalingManager::ProcessHuSignature(const CHuSignature& sig, CNode* pfr
         }
     }
 
-    // Get the block index
-    const CBlockIndex* pindex = nullptr;
+    PendingSig pending{sig, pfrom ? pfrom->GetId() : -1, connman, GetTimeMicros()};
+
+    if (vWorkers.empty()) {
+        return ProcessBatch({pending}) > 0;
+    }
+
+    {
+        LOCK(cs_queue);
+        if (fStopWorkers || queuePending.size() >= MAX_HU_SIG_QUEUE_SIZE) {
+            WITH_LOCK(cs_stats, stats.nDropped++);
+            return false;
+        }
+        queuePending.push_back(std::move(pending));
+    }
+    cvQueue.notify_one();
+    return true;
+}
+
+int CHuSignalingManager::ProcessBatch(const std::vector<PendingSig>& vBatch)
+{
+    CHuSigStats batchStats;
+    const int64_t nTimeStart = GetTimeMicros();
+
+    // Get the block indexes (once per block, most of a batch signs the same block)
+    std::map<uint256, const CBlockIndex*> mapIndexes;
     {
         LOCK(cs_main);
-        auto it = mapBlockIndex.find(sig.blockHash);
-        if (it == mapBlockIndex.end()) {
+        for (const PendingSig& pending : vBatch) {
+            if (mapIndexes.count(pending.sig.blockHash)) continue;
+            auto it = mapBlockIndex.find(pending.sig.blockHash);
+            mapIndexes.emplace(pending.sig.blockHash, it != mapBlockIndex.end() ? it->second : nullptr);
+        }
+    }
+
+    int nAccepted = 0;
+    uint256 lastBlockHash;
+    uint256 msgHash;
+    std::shared_ptr<const HuQuorumOperators> operators;
+    for (const PendingSig& pending : vBatch) {
+        const CHuSignature& sig = pending.sig;
+        batchStats.queueWait.Add(nTimeStart - pending.nTimeReceived);
+
+        // Quorum of the block (and the signed message), reused while the block doesn't change
+        int64_t nTime1 = GetTimeMicros();
+        const CBlockIndex* pindex = mapIndexes[sig.blockHash];
+        if (!pindex) {
             LogPrint(BCLog::HU, "HU Signaling: Unknown block %s for signature\n",
                      sig.blockHash.ToString().substr(0, 16));
-            return false;
+            batchStats.nRejected++;
+            continue;
+        }
+        if (lastBlockHash.IsNull() || sig.blockHash != lastBlockHash) {
+            operators = GetQuorumOperators(pindex);
+            msgHash = GetHuSignatureHash(sig.blockHash);
+            lastBlockHash = sig.blockHash;
+        }
+        auto itOperator = operators ? operators->find(sig.proTxHash) : HuQuorumOperators::const_iterator();
+        const bool fMember = operators && itOperator != operators->end();
+        int64_t nTime2 = GetTimeMicros();
+        batchStats.quorum.Add(nTime2 - nTime1);
+
+        if (!fMember) {
+            LogPrint(BCLog::HU, "HU Signaling: Signer %s not in quorum for height %d\n",
+                     sig.proTxHash.ToString().substr(0, 16), pindex->nHeight);
+            batchStats.nRejected++;
+            continue;
         }
-        pindex = it->second;
+
+        // Check against the operator pubkey (no key recovery)
+        const bool fValid = itOperator->second.pubKeyOperator.VerifyCompact(msgHash, sig.vchSig);
+        int64_t nTime3 = GetTimeMicros();
+        batchStats.verify.Add(nTime3 - nTime2);
+
+        if (!fValid) {
+            LogPrint(BCLog::HU, "HU Signaling: Invalid signature from %s for block %s\n",
+                     sig.proTxHash.ToString().substr(0, 16), sig.blockHash.ToString().substr(0, 16));
+            batchStats.nRejected++;
+            continue;
+        }
+
+        if (AcceptSignature(sig, pindex->nHeight, itOperator->second.nIndex, operators.get(), pending.nodeFrom, pending.connman)) {
+            nAccepted++;
+            batchStats.nAccepted++;
+        }
+        batchStats.accept.Add(GetTimeMicros() - nTime3);
+    }
+
+    LOCK(cs_stats);
+    stats.nAccepted += batchStats.nAccepted;
+    stats.nRejected += batchStats.nRejected;
+    MergeStageStats(stats.queueWait, batchStats.queueWait);
+    MergeStageStats(stats.quorum, batchStats.quorum);
+    MergeStageStats(stats.verify, batchStats.verify);
+    MergeStageStats(stats.accept, batchStats.accept);
+    return nAccepted;
+}
+
+bool CHuSignalingManager::ProcessFinalityCert(const CBlockFinalityCert& cert, const CBlockIndex* pindexCertified)
+{
+    if (cert.IsNull() || !pindexCertified) {
+        return false;
     }
 
-    // Validate the signature
-    if (!ValidateSignature(sig, pindex)) {
-        LogPrint(BCLog::HU, "HU Signaling: Invalid signature from %s for block %s\n",
-                 sig.proTxHash.ToString().substr(0, 16), sig.blockHash.ToString().substr(0, 16));
+    // Nothing to learn if the signatures gossip already finalized it (usual case at the tip)
+    if (huFinalityHandler && huFinalityHandler->HasFinality(pindexCertified->nHeight, pindexCertified->GetBlockHash())) {
         return false;
     }
 
-    // Add to cache and finality handler
+    PendingCert pending{cert, pindexCertified->GetBlockHash()};
+
+    if (vWorkers.empty()) {
+        return ProcessCertBatch({pending}) > 0;
+    }
+
+    {
+        LOCK(cs_queue);
+        if (fStopWorkers || queueCerts.size() >= MAX_HU_SIG_QUEUE_SIZE) {
+            WITH_LOCK(cs_stats, stats.nDropped++);
+            return false;
+        }
+        queueCerts.push_back(std::move(pending));
+    }
+    cvQueue.notify_one();
+    return true;
+}
+
+int CHuSignalingManager::ProcessCertBatch(const std::vector<PendingCert>& vBatch)
+{
+    std::map<uint256, const CBlockIndex*> mapIndexes;
+    {
+        LOCK(cs_main);
+        for (const PendingCert& pending : vBatch) {
+            auto it = mapBlockIndex.find(pending.blockHash);
+            mapIndexes.emplace(pending.blockHash, it != mapBlockIndex.end() ? it->second : nullptr);
+        }
+    }
+
+    int nAccepted = 0;
+    int nRejected = 0;
+    std::vector<std::pair<CHuSignature, int>> vSigs;
+    for (const PendingCert& pending : vBatch) {
+        const CBlockIndex* pindex = mapIndexes[pending.blockHash];
+        auto operators = pindex ? GetQuorumOperators(pindex) : nullptr;
+        if (!operators) {
+            nRejected++;
+            continue;
+        }
+
+        // Quorum members by position (the positions of the signer bitmap)
+        std::vector<std::pair<uint256, CPubKey>> vQuorum(operators->size());
+        for (const auto& it : *operators) {
+            vQuorum[it.second.nIndex] = std::make_pair(it.first, it.second.pubKeyOperator);
+        }
+        if (!CheckFinalityCert(pending.cert, pending.blockHash, vQuorum, vSigs)) {
+            LogPrint(BCLog::HU, "HU Signaling: Invalid finality certificate for block %s at height %d\n",
+                     pending.blockHash.ToString().substr(0, 16), pindex->nHeight);
+            nRejected++;
+            continue;
+        }
+
+        // Not relayed: the peers get the certificate with the block
+        for (const auto& sig : vSigs) {
+            AcceptSignature(sig.first, pindex->nHeight, sig.second, operators.get(), -1, nullptr);
+        }
+        nAccepted++;
+    }
+
+    LOCK(cs_stats);
+    stats.nCertsAccepted += nAccepted;
+    stats.nCertsRejected += nRejected;
+    return nAccepted;
+}
+
+bool CHuSignalingManager::AcceptSignature(const CHuSignature& sig, int nHeight, int nQuorumIndex, const HuQuorumOperators* operators, NodeId nodeFrom, CConnman* connman)
+{
+    // Add to cache and finality handler (another worker may have been faster)
     {
         LOCK(cs);
-        mapSigCache[sig.blockHash][sig.proTxHash] = sig.vchSig;
+        auto& mapBlockSigs = mapSigCache[sig.blockHash];
+        if (!mapBlockSigs.emplace(sig.proTxHash, sig.vchSig).second) {
+            return false;
+        }
+        mapBlocksByHeight[nHeight].insert(sig.blockHash);
     }
 
-    if (huFinalityHandler) {
-        huFinalityHandler->AddSignature(sig);
+    // Signatures that left the cache but are still in the finality store are not relayed again
+    if (huFinalityHandler && !huFinalityHandler->AddSignature(sig, nHeight, nQuorumIndex)) {
+        return false;
     }
 
     // Check if we just reached quorum
@@ -159,10 +458,14 @@ bool CHuSignalingManager::ProcessHuSignature(const CHuSignature& sig, CNode* pfr
     if (sigCount == consensus.nHuQuorumThreshold) {
         LogPrintf("HU Signaling: Block %s reached quorum (%d/%d signatures)\n",
                   sig.blockHash.ToString().substr(0, 16), sigCount, consensus.nHuQuorumSize);
+        // Finality event: let the block producer re-evaluate its slot
+        if (activeMasternodeManager) {
+            activeMasternodeManager->WakeDMMScheduler();
+        }
     }
 
     // Relay to other peers
-    BroadcastSignature(sig, connman, pfrom);
+    BroadcastSignature(sig, operators, connman, nodeFrom);
 
     LogPrint(BCLog::HU, "HU Signaling: Accepted signature %d/%d from %s for block %s\n",
              sigCount, consensus.nHuQuorumThreshold,
@@ -187,10 +490,7 @@ bool CHuSignalingManager::SignBlock(const uint256& blockHash, CHuSignature& sigO
     }
 
     // Create message to sign: "HUSIG" || blockHash
-    CHashWriter ss(SER_GETHASH, 0);
-    ss << std::string("HUSIG");
-    ss << blockHash;
-    uint256 msgHash = ss.GetHash();
+    uint256 msgHash = GetHuSignatureHash(blockHash);
 
     // Sign with ECDSA
     std::vector<unsigned char> vchSig;
@@ -206,85 +506,96 @@ bool CHuSignalingManager::SignBlock(const uint256& blockHash, CHuSignature& sigO
     return true;
 }
 
-bool CHuSignalingManager::ValidateSignature(const CHuSignature& sig, const CBlockIndex* pindex) const
+void CHuSignalingManager::UpdateQuorumRelayMembers(const HuQuorumOperators* operators, CConnman* connman)
 {
-    if (!pindex || !pindex->pprev) {
-        return false;
-    }
-
-    const Consensus::Params& consensus = Params().GetConsensus();
-
-    // Get the MN list at the block's height
-    CDeterministicMNList mnList = deterministicMNManager->GetListForBlock(pindex->pprev);
-
-    // Check if the signer is in the quorum
-    int cycleIndex = GetHuCycleIndex(pindex->nHeight, consensus.nHuQuorumRotationBlocks);
-    uint256 prevCycleHash = pindex->pprev->GetBlockHash();
-
-    if (!IsInHuQuorum(mnList, cycleIndex, prevCycleHash, sig.proTxHash)) {
-        LogPrint(BCLog::HU, "HU Signaling: Signer %s not in quorum for height %d\n",
-                 sig.proTxHash.ToString().substr(0, 16), pindex->nHeight);
-        return false;
-    }
-
-    // Get the MN's operator pubkey
-    CDeterministicMNCPtr dmn = mnList.GetMN(sig.proTxHash);
-    if (!dmn) {
-        LogPrint(BCLog::HU, "HU Signaling: Unknown MN %s\n", sig.proTxHash.ToString().substr(0, 16));
-        return false;
+    std::set<uint256> setMembers;
+    if (operators) {
+        for (const auto& it : *operators) {
+            setMembers.emplace(it.first);
+        }
     }
 
-    // Recreate the message hash
-    CHashWriter ss(SER_GETHASH, 0);
-    ss << std::string("HUSIG");
-    ss << sig.blockHash;
-    uint256 msgHash = ss.GetHash();
-
-    // Recover pubkey from compact signature
-    CPubKey recoveredPubKey;
-    if (!recoveredPubKey.RecoverCompact(msgHash, sig.vchSig)) {
-        LogPrint(BCLog::HU, "HU Signaling: Failed to recover pubkey from signature\n");
-        return false;
+    {
+        LOCK(cs);
+        if (setMembers == setQuorumRelayMembers) {
+            return;
+        }
+        setQuorumRelayMembers = setMembers;
     }
 
-    // Verify it matches the operator pubkey
-    // The operator pubkey is stored directly in the DMN state as CPubKey
-    if (recoveredPubKey != dmn->pdmnState->pubKeyOperator) {
-        LogPrint(BCLog::HU, "HU Signaling: Signature pubkey mismatch for MN %s\n",
-                 sig.proTxHash.ToString().substr(0, 16));
-        return false;
+    if (connman && connman->GetTierTwoConnMan()) {
+        connman->GetTierTwoConnMan()->setQuorumRelayMembers(setMembers);
     }
-
-    return true;
 }
 
-void CHuSignalingManager::BroadcastSignature(const CHuSignature& sig, CConnman* connman, CNode* pfrom)
+void CHuSignalingManager::BroadcastSignature(const CHuSignature& sig, const HuQuorumOperators* operators, CConnman* connman, NodeId nodeFrom)
 {
     if (!connman) {
         return;
     }
 
+    const uint256 invHash = sig.GetHash();
     {
         LOCK(cs);
         // Track relayed signatures to avoid spam
-        if (mapRelayedSigs[sig.blockHash].count(sig.proTxHash)) {
+        if (!mapRelayedSigs[sig.blockHash].insert(invHash).second) {
             return;  // Already relayed this signature
         }
-        mapRelayedSigs[sig.blockHash].insert(sig.proTxHash);
+        mapRelayedSigsByInv.emplace(invHash, sig);
     }
 
-    // Broadcast to all peers except the one we received it from
+    const CInv inv(MSG_HU_SIGNATURE, invHash);
+    uint64_t nPushed = 0;
+    uint64_t nAnnounced = 0;
     connman->ForEachNode([&](CNode* pnode) {
-        if (pnode == pfrom) {
+        if (pnode->GetId() == nodeFrom) {
             return;  // Don't send back to sender
         }
         if (!pnode->fSuccessfullyConnected || pnode->fDisconnect) {
             return;
         }
 
+        // Quorum members get the signature itself: they are the ones counting it
+        // towards finality. Peers that don't know MSG_HU_SIGNATURE too.
+        const uint256 proTxHash = WITH_LOCK(pnode->cs_mnauth, return pnode->verifiedProRegTxHash);
+        const bool fQuorumPeer = operators && !proTxHash.IsNull() && operators->count(proTxHash);
+        if (!fQuorumPeer && pnode->nVersion >= HUSIG_INV_VERSION) {
+            pnode->PushInventory(inv);
+            nAnnounced++;
+            return;
+        }
+        {
+            LOCK(pnode->cs_inventory);
+            if (pnode->filterInventoryKnown.contains(invHash)) {
+                return;
+            }
+            pnode->filterInventoryKnown.insert(invHash);
+        }
         CNetMsgMaker msgMaker(pnode->GetSendVersion());
         connman->PushMessage(pnode, msgMaker.Make(NetMsgType::HUSIG, sig));
+        nPushed++;
     });
+
+    LOCK(cs_stats);
+    stats.nRelayPushed += nPushed;
+    stats.nRelayAnnounced += nAnnounced;
+}
+
+bool CHuSignalingManager::AlreadyHave(const uint256& invHash) const
+{
+    LOCK(cs);
+    return mapRelayedSigsByInv.count(invHash) > 0;
+}
+
+bool CHuSignalingManager::GetSignatureByInv(const uint256& invHash, CHuSignature& sigOut) const
+{
+    LOCK(cs);
+    auto it = mapRelayedSigsByInv.find(invHash);
+    if (it == mapRelayedSigsByInv.end()) {
+        return false;
+    }
+    sigOut = it->second;
+    return true;
 }
 
 bool CHuSignalingManager::HasSigned(const uint256& blockHash) const
@@ -313,34 +624,24 @@ void CHuSignalingManager::Cleanup(int nCurrentHeight)
 {
     LOCK(cs);
 
-    // Only cleanup every 100 blocks
-    if (nCurrentHeight - nLastCleanupHeight < 100) {
+    // Oldest heights first, everything at or above the cutoff stays
+    const int nCutoff = nCurrentHeight - HU_SIG_CACHE_DEPTH;
+    if (mapBlocksByHeight.empty() || mapBlocksByHeight.begin()->first >= nCutoff) {
         return;
     }
-    nLastCleanupHeight = nCurrentHeight;
-
-    // We need block heights to clean up properly
-    // For now, just limit cache size
-    const size_t nMaxCacheSize = 500;
-
-    if (mapSigCache.size() > nMaxCacheSize) {
-        // Remove oldest entries (this is a simple approach)
-        while (mapSigCache.size() > nMaxCacheSize / 2) {
-            mapSigCache.erase(mapSigCache.begin());
-        }
-    }
-
-    if (mapRelayedSigs.size() > nMaxCacheSize) {
-        while (mapRelayedSigs.size() > nMaxCacheSize / 2) {
-            mapRelayedSigs.erase(mapRelayedSigs.begin());
-        }
-    }
-
-    if (setSignedBlocks.size() > nMaxCacheSize) {
-        auto it = setSignedBlocks.begin();
-        while (setSignedBlocks.size() > nMaxCacheSize / 2 && it != setSignedBlocks.end()) {
-            it = setSignedBlocks.erase(it);
+    while (!mapBlocksByHeight.empty() && mapBlocksByHeight.begin()->first < nCutoff) {
+        for (const uint256& blockHash : mapBlocksByHeight.begin()->second) {
+            mapSigCache.erase(blockHash);
+            auto itRelayed = mapRelayedSigs.find(blockHash);
+            if (itRelayed != mapRelayedSigs.end()) {
+                for (const uint256& invHash : itRelayed->second) {
+                    mapRelayedSigsByInv.erase(invHash);
+                }
+                mapRelayedSigs.erase(itRelayed);
+            }
+            setSignedBlocks.erase(blockHash);
         }
+        mapBlocksByHeight.erase(mapBlocksByHeight.begin());
     }
 
     LogPrint(BCLog::HU, "HU Signaling: Cleanup complete. Cache sizes: sigs=%zu, relayed=%zu, signed=%zu\n",
@@ -352,20 +653,40 @@ void CHuSignalingManager::Clear()
     LOCK(cs);
     setSignedBlocks.clear();
     mapRelayedSigs.clear();
+    mapRelayedSigsByInv.clear();
+    setQuorumRelayMembers.clear();
     mapSigCache.clear();
-    nLastCleanupHeight = 0;
+    mapBlocksByHeight.clear();
+    WITH_LOCK(cs_quorumCache, quorumCache.clear());
+}
+
+CHuSigStats CHuSignalingManager::GetStats() const
+{
+    CHuSigStats ret = WITH_LOCK(cs_stats, return stats);
+    LOCK(cs_queue);
+    ret.nQueueSize = queuePending.size();
+    ret.nCertQueueSize = queueCerts.size();
+    return ret;
 }
 
 // ============================================================================
 // Global Functions
 // ============================================================================
 
-void NotifyBlockConnected(const CBlockIndex* pindex, CConnman* connman)
+void NotifyBlockConnected(const CBlock& block, const CBlockIndex* pindex, CConnman* connman)
 {
+    if (huFinalityHandler) {
+        huFinalityHandler->Prune(pindex->nHeight);
+    }
+
     if (!huSignalingManager) {
         return;
     }
 
+    if (!block.finalityCert.IsNull()) {
+        huSignalingManager->ProcessFinalityCert(block.finalityCert, pindex->pprev);
+    }
+
     huSignalingManager->OnNewBlock(pindex, connman);
     huSignalingManager->Cleanup(pindex->nHeight);
 }
@@ -7,12 +7,20 @@
 
 #include "piv2/piv2_finality.h"
 #include "net.h"
+#include "pubkey.h"
+#include "saltedhasher.h"
 #include "sync.h"
 #include "uint256.h"
+#include "unordered_lru_cache.h"
 
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <set>
 #include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class CBlockIndex;
 class CConnman;
@@ -20,31 +28,145 @@ class CNode;
 
 namespace hu {
 
+/** Default number of HU signature verification threads (0 = verify on the message handler thread) */
+static const int DEFAULT_HU_SIG_THREADS = 2;
+/** Maximum number of HU signature verification threads */
+static const int MAX_HU_SIG_THREADS = 16;
+/** Maximum number of signatures a worker takes from the queue at once */
+static const size_t HU_SIG_BATCH_SIZE = 64;
+/** Signatures received while the queue holds this many are dropped */
+static const size_t MAX_HU_SIG_QUEUE_SIZE = 10000;
+/** Maximum number of finality certificates a worker takes from the queue at once */
+static const size_t HU_CERT_BATCH_SIZE = 16;
+/** Number of (block, cycle) quorums kept with their operator pubkeys */
+static const size_t HU_QUORUM_CACHE_SIZE = 64;
+/** Signatures, relays and own signings are forgotten this many blocks below the tip */
+static const int HU_SIG_CACHE_DEPTH = 100;
+
+/** A quorum member: its position in the cycle's quorum (signer bitmap bit) and operator pubkey */
+struct CHuQuorumMember {
+    int nIndex;
+    CPubKey pubKeyOperator;
+};
+
+/** Quorum members for one block (proTxHash -> member) */
+typedef std::unordered_map<uint256, CHuQuorumMember, StaticSaltedHasher> HuQuorumOperators;
+
+/** Latency of one stage of the signature pipeline, in microseconds */
+struct CHuSigStageStats {
+    uint64_t nCount{0};
+    int64_t nTotalMicros{0};
+    int64_t nMaxMicros{0};
+
+    void Add(int64_t nMicros);
+    double AverageMicros() const { return nCount ? (double)nTotalMicros / nCount : 0.0; }
+};
+
+/** Snapshot of the signature pipeline counters (gethusigstats) */
+struct CHuSigStats {
+    int nThreads{0};
+    size_t nQueueSize{0};
+    uint64_t nAccepted{0};
+    uint64_t nRejected{0};
+    uint64_t nDropped{0};
+    uint64_t nQuorumCacheHits{0};
+    uint64_t nQuorumCacheMisses{0};
+    uint64_t nRelayPushed{0};    // full HUSIG messages sent (quorum members, old peers)
+    uint64_t nRelayAnnounced{0}; // MSG_HU_SIGNATURE invs queued
+    size_t nCertQueueSize{0};
+    uint64_t nCertsAccepted{0};  // block finality certificates
+    uint64_t nCertsRejected{0};
+
+    CHuSigStageStats queueWait; // received -> taken by a worker
+    CHuSigStageStats quorum;    // block lookup + quorum membership
+    CHuSigStageStats verify;    // ECDSA check against the operator key
+    CHuSigStageStats accept;    // finality handler + relay
+};
+
 /**
  * HU Signaling Manager
  *
  * Handles the automatic signing and propagation of HU finality signatures.
  * When a MN in the quorum receives a valid block, it signs and broadcasts.
  * When enough signatures (2/3) are collected, the block is final.
+ *
+ * Received signatures are queued and verified by a pool of worker threads,
+ * a batch at a time, so that the message handler never waits on a quorum
+ * computation or an ECDSA check. Quorums are computed once per (block, cycle)
+ * and cached together with the operator pubkeys of their members, which lets
+ * each signature be checked with a plain verify instead of a key recovery.
+ *
+ * Signatures are pushed in full only to the members of the block's quorum
+ * (kept connected through TierTwoConnMan) and to peers older than
+ * HUSIG_INV_VERSION. Every other peer gets a MSG_HU_SIGNATURE inv and
+ * requests the signature with getdata if it doesn't know it yet; the
+ * inventory-known filter of each peer keeps a signature from being announced
+ * twice to the same peer.
+ *
+ * Blocks carry the finality certificate of their parent. The certificates of
+ * connected blocks are verified by the same workers (after the signatures
+ * received from the network), so a syncing node learns the finality of the
+ * blocks it downloads without any signature gossip.
  */
 class CHuSignalingManager {
 private:
+    struct PendingSig {
+        CHuSignature sig;
+        NodeId nodeFrom;
+        CConnman* connman;
+        int64_t nTimeReceived;
+    };
+
+    struct PendingCert {
+        CBlockFinalityCert cert;
+        uint256 blockHash;          // certified block
+    };
+
     mutable RecursiveMutex cs;
 
     // Track which blocks we've already signed (to avoid duplicate signatures)
     std::set<uint256> setSignedBlocks;
 
     // Track which signatures we've already relayed (to avoid spam)
-    std::map<uint256, std::set<uint256>> mapRelayedSigs;  // blockHash -> set of proTxHashes
+    std::map<uint256, std::set<uint256>> mapRelayedSigs;  // blockHash -> set of inv hashes
+
+    // Relayed signatures by inv hash, to answer getdata
+    std::unordered_map<uint256, CHuSignature, StaticSaltedHasher> mapRelayedSigsByInv;
+
+    // Members of the last quorum we were part of, passed to TierTwoConnMan
+    std::set<uint256> setQuorumRelayMembers;
 
     // Signature cache: blockHash -> (proTxHash -> signature)
     std::map<uint256, std::map<uint256, std::vector<unsigned char>>> mapSigCache;
 
-    // Height tracking for cleanup
-    int nLastCleanupHeight{0};
+    // Heights of the blocks in the caches above, for cleanup (height -> blockHashes)
+    std::map<int, std::set<uint256>> mapBlocksByHeight;
+
+    // Quorum cache: (prev block hash, cycle) -> quorum operator pubkeys
+    Mutex cs_quorumCache;
+    unordered_lru_cache<std::pair<uint256, int>, std::shared_ptr<const HuQuorumOperators>, StaticSaltedHasher> quorumCache{HU_QUORUM_CACHE_SIZE};
+
+    // Verification queue and worker pool
+    mutable Mutex cs_queue;
+    std::condition_variable cvQueue;
+    std::deque<PendingSig> queuePending;
+    std::deque<PendingCert> queueCerts;
+    std::vector<std::thread> vWorkers;
+    bool fStopWorkers{false};
+
+    // Pipeline statistics
+    mutable Mutex cs_stats;
+    CHuSigStats stats;
 
 public:
     CHuSignalingManager() = default;
+    ~CHuSignalingManager();
+
+    /** Start nThreads verification workers (0 = verify inline) */
+    void StartWorkers(int nThreads);
+
+    /** Stop and join the workers, dropping the signatures still queued */
+    void StopWorkers();
 
     /**
      * Called when we receive a new valid block.
@@ -58,16 +180,40 @@ public:
 
     /**
      * Process a received HU signature from the network.
-     * Validates the signature and adds it to the finality handler.
-     * Relays to other peers if valid and new.
+     * Queues the signature for the verification workers (or verifies it
+     * right away when no worker runs). Valid new signatures are added to the
+     * finality handler and relayed to the other peers.
      *
      * @param sig The received signature
      * @param pfrom The peer that sent it
      * @param connman Connection manager for relaying
-     * @return true if signature was valid and new
+     * @return true if signature was queued (or, inline, valid and new)
      */
     bool ProcessHuSignature(const CHuSignature& sig, CNode* pfrom, CConnman* connman);
 
+    /**
+     * Process the finality certificate carried by a connected block.
+     * Queues it for the verification workers (or verifies it right away when
+     * no worker runs), unless the certified block is already final. The
+     * signatures of a valid certificate are added like received ones, but
+     * not relayed.
+     *
+     * @param cert The certificate of the connected block
+     * @param pindexCertified The parent of the connected block
+     * @return true if the certificate was queued (or, inline, valid)
+     */
+    bool ProcessFinalityCert(const CBlockFinalityCert& cert, const CBlockIndex* pindexCertified);
+
+    /**
+     * Whether a signature announced with MSG_HU_SIGNATURE is known (no need to request it)
+     */
+    bool AlreadyHave(const uint256& invHash) const;
+
+    /**
+     * Get a relayed signature by inv hash (getdata)
+     */
+    bool GetSignatureByInv(const uint256& invHash, CHuSignature& sigOut) const;
+
     /**
      * Check if we've already signed a block
      */
@@ -84,7 +230,7 @@ public:
     bool HasQuorum(const uint256& blockHash) const;
 
     /**
-     * Cleanup old data for blocks that are now deeply buried
+     * Cleanup data for blocks more than HU_SIG_CACHE_DEPTH below the tip
      */
     void Cleanup(int nCurrentHeight);
 
@@ -93,6 +239,11 @@ public:
      */
     void Clear();
 
+    /**
+     * Pipeline counters and per-stage latencies
+     */
+    CHuSigStats GetStats() const;
+
 private:
     /**
      * Sign a block with our operator key
@@ -101,25 +252,58 @@ private:
     bool SignBlock(const uint256& blockHash, CHuSignature& sigOut);
 
     /**
-     * Validate a signature against the quorum for the block
-     * @return true if signature is from a valid quorum member
+     * Quorum members of a block and their operator pubkeys (cached)
+     * @return nullptr for blocks without a quorum (genesis)
+     */
+    std::shared_ptr<const HuQuorumOperators> GetQuorumOperators(const CBlockIndex* pindex);
+
+    /**
+     * Verify a batch of signatures against their block quorums and accept
+     * the ones signed by a quorum member
+     * @return number of signatures accepted
      */
-    bool ValidateSignature(const CHuSignature& sig, const CBlockIndex* pindex) const;
+    int ProcessBatch(const std::vector<PendingSig>& vBatch);
 
     /**
-     * Broadcast a signature to all peers
+     * Verify a batch of finality certificates against the quorums of the
+     * certified blocks and accept the signatures of the valid ones
+     * @return number of certificates accepted
      */
-    void BroadcastSignature(const CHuSignature& sig, CConnman* connman, CNode* pfrom = nullptr);
+    int ProcessCertBatch(const std::vector<PendingCert>& vBatch);
+
+    /**
+     * Add a verified signature to the cache and finality handler, then relay it
+     * @param nQuorumIndex - position of the signer in the block's quorum
+     * @return false if the signature was already known (or too old)
+     */
+    bool AcceptSignature(const CHuSignature& sig, int nHeight, int nQuorumIndex, const HuQuorumOperators* operators, NodeId nodeFrom, CConnman* connman);
+
+    void ThreadSigVerify();
+
+    /**
+     * Keep connections to the other members of our quorum (nullptr: not in a quorum)
+     */
+    void UpdateQuorumRelayMembers(const HuQuorumOperators* operators, CConnman* connman);
+
+    /**
+     * Relay a signature: pushed to the quorum members of its block, announced to the other peers
+     */
+    void BroadcastSignature(const CHuSignature& sig, const HuQuorumOperators* operators, CConnman* connman, NodeId nodeFrom = -1);
 };
 
 // Global signaling manager instance
 extern std::unique_ptr<CHuSignalingManager> huSignalingManager;
 
 /**
- * Initialize the HU signaling system
+ * Initialize the HU signaling system (and start the verification workers)
  */
 void InitHuSignaling();
 
+/**
+ * Stop the verification workers (before the connection manager goes away)
+ */
+void StopHuSignaling();
+
 /**
  * Shutdown the HU signaling system
  */
@@ -127,9 +311,9 @@ void ShutdownHuSignaling();
 
 /**
  * Called from validation when a new block is connected.
- * Triggers signature if we're in the quorum.
+ * Processes its finality certificate, and triggers signature if we're in the quorum.
  */
-void NotifyBlockConnected(const CBlockIndex* pindex, CConnman* connman);
+void NotifyBlockConnected(const CBlock& block, const CBlockIndex* pindex, CConnman* connman);
 
 /**
  * Check if the previous block has reached quorum.
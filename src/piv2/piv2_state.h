@@ -55,6 +55,11 @@ struct HuGlobalState
     uint32_t last_yield_update_height;  // Last block where daily yield was applied
     CAmount last_yield_amount;          // Last yield amount applied (for exact undo)
 
+    // Yield accumulator (Phase 6.1) - see khu_yield::ApplyDailyYield
+    // A note's bonus = amount × (yield_index - index at its first mature epoch)
+    uint64_t yield_index;               // Cumulative yield per locked satoshi (× YIELD_INDEX_PRECISION)
+    CAmount yield_mature_amount;        // Principal of unspent notes counted by yield_index
+
     // DOMC Governance (Phase 6.2) - Scalaires uniquement
     uint32_t domc_cycle_start;           // Height where current DOMC cycle started
     uint32_t domc_cycle_length;          // 172800 blocks (constant)
@@ -87,6 +92,8 @@ struct HuGlobalState
         R_MAX_dynamic = 0;
         last_yield_update_height = 0;
         last_yield_amount = 0;
+        yield_index = 0;
+        yield_mature_amount = 0;
         domc_cycle_start = 0;
         domc_cycle_length = 0;
         domc_commit_phase_start = 0;
@@ -155,6 +162,8 @@ struct HuGlobalState
         READWRITE(obj.R_MAX_dynamic);
         READWRITE(obj.last_yield_update_height);
         READWRITE(obj.last_yield_amount);
+        READWRITE(obj.yield_index);
+        READWRITE(obj.yield_mature_amount);
         READWRITE(obj.domc_cycle_start);
         READWRITE(obj.domc_cycle_length);
         READWRITE(obj.domc_commit_phase_start);
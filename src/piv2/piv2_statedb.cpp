@@ -5,36 +5,228 @@
 #include "piv2/piv2_statedb.h"
 #include "piv2/piv2_domc.h"
 
-#include "util/system.h"
+#include "clientversion.h"
 #include "streams.h"
+#include "util/system.h"
+
+#include <algorithm>
 
 static const char DB_KHU_STATE = 'K';
 static const char DB_KHU_STATE_PREFIX = 'S';
+static const char DB_KHU_STATE_DIFF_PREFIX = 'D';
 static const char DB_KHU_UTXO_PREFIX = 'U';
 
+static std::pair<char, std::pair<char, int>> StateSnapshotKey(int nHeight)
+{
+    return std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_PREFIX, nHeight));
+}
+
+static std::pair<char, std::pair<char, int>> StateDiffKey(int nHeight)
+{
+    return std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_DIFF_PREFIX, nHeight));
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// KHU state diffs
+// ═══════════════════════════════════════════════════════════════════════════
+
+static std::vector<unsigned char> SerializeKHUState(const HuGlobalState& state)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << state;
+    return std::vector<unsigned char>(ss.begin(), ss.end());
+}
+
+/** State at height+1 if the block changed nothing but the chain linkage */
+static HuGlobalState GetDiffBase(const HuGlobalState& prev)
+{
+    HuGlobalState base = prev;
+    base.nHeight = prev.nHeight + 1;
+    base.hashPrevState = prev.GetHash();
+    return base;
+}
+
+CKHUStateDiff CKHUStateDiff::Make(const HuGlobalState& prev, const HuGlobalState& state)
+{
+    const std::vector<unsigned char> vBase = SerializeKHUState(GetDiffBase(prev));
+    const std::vector<unsigned char> vState = SerializeKHUState(state);
+    assert(vBase.size() == vState.size()); // HuGlobalState serializes to a fixed size
+
+    CKHUStateDiff diff;
+    size_t i = 0;
+    while (i < vState.size()) {
+        if (vBase[i] == vState[i]) {
+            i++;
+            continue;
+        }
+        // Bridge gaps of up to 2 equal bytes (cheaper than a new run header)
+        size_t nLast = i;
+        for (size_t j = i + 1; j < vState.size() && j - nLast <= 2; j++) {
+            if (vBase[j] != vState[j]) nLast = j;
+        }
+        Run run;
+        run.nOffset = i;
+        run.vch.assign(vState.begin() + i, vState.begin() + nLast + 1);
+        diff.vRuns.push_back(std::move(run));
+        i = nLast + 1;
+    }
+    return diff;
+}
+
+bool CKHUStateDiff::Apply(const HuGlobalState& prev, HuGlobalState& state) const
+{
+    std::vector<unsigned char> v = SerializeKHUState(GetDiffBase(prev));
+    for (const Run& run : vRuns) {
+        if (run.nOffset > v.size() || run.vch.size() > v.size() - run.nOffset) {
+            return false;
+        }
+        std::copy(run.vch.begin(), run.vch.end(), v.begin() + run.nOffset);
+    }
+    try {
+        CDataStream ss(v, SER_DISK, CLIENT_VERSION);
+        ss >> state;
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// CKHUStateDB
+// ═══════════════════════════════════════════════════════════════════════════
+
 CKHUStateDB::CKHUStateDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    CDBWrapper(GetDataDir() / "khu" / "state", nCacheSize, fMemory, fWipe)
+    CKHUTransactionalDB(GetDataDir() / "khu" / "state", nCacheSize, fMemory, fWipe)
+{
+}
+
+bool CKHUStateDB::GetCachedState(int nHeight, HuGlobalState& state)
+{
+    AssertLockHeld(cs);
+    if (nHeight == nTipHeight) {
+        state = tipState;
+        return true;
+    }
+    return stateCache.get(nHeight, state);
+}
+
+void CKHUStateDB::CacheState(int nHeight, const HuGlobalState& state)
 {
+    AssertLockHeld(cs);
+    stateCache.insert(nHeight, state);
+}
+
+void CKHUStateDB::UncacheState(int nHeight)
+{
+    AssertLockHeld(cs);
+    stateCache.erase(nHeight);
+    if (nHeight == nTipHeight) {
+        nTipHeight = -1;
+    }
+}
+
+void CKHUStateDB::CommitCurTransaction()
+{
+    LOCK(cs);
+    setPendingHeights.clear();
+    CKHUTransactionalDB::CommitCurTransaction();
+}
+
+void CKHUStateDB::RollbackCurTransaction()
+{
+    LOCK(cs);
+    if (!setPendingHeights.empty()) {
+        // States rebuilt on top of dropped writes may be cached too: start over
+        stateCache.clear();
+        nTipHeight = -1;
+        setPendingHeights.clear();
+    }
+    CKHUTransactionalDB::RollbackCurTransaction();
 }
 
 bool CKHUStateDB::WriteKHUState(int nHeight, const HuGlobalState& state)
 {
-    return Write(std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_PREFIX, nHeight)), state);
+    LOCK(cs);
+
+    HuGlobalState prev;
+    const bool fSnapshot = nHeight <= 0 ||
+                           nHeight % KHU_STATE_SNAPSHOT_INTERVAL == 0 ||
+                           !ReadKHUState(nHeight - 1, prev);
+    if (fSnapshot) {
+        Erase(StateDiffKey(nHeight));
+        Write(StateSnapshotKey(nHeight), state);
+    } else {
+        // Diffs are read before snapshots: a stale snapshot here is never used
+        Write(StateDiffKey(nHeight), CKHUStateDiff::Make(prev, state));
+    }
+
+    CacheState(nHeight, state);
+    tipState = state;
+    nTipHeight = nHeight;
+    setPendingHeights.insert(nHeight);
+    return true;
 }
 
 bool CKHUStateDB::ReadKHUState(int nHeight, HuGlobalState& state)
 {
-    return Read(std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_PREFIX, nHeight)), state);
+    LOCK(cs);
+
+    if (GetCachedState(nHeight, state)) {
+        return true;
+    }
+
+    // Walk down to a snapshot (or a cached state), then replay the diffs up
+    std::vector<CKHUStateDiff> vDiffs;
+    HuGlobalState base;
+    for (int h = nHeight; ; h--) {
+        if (h < 0) {
+            return error("%s: no KHU state snapshot below height %d", __func__, nHeight);
+        }
+        if (h != nHeight && GetCachedState(h, base)) {
+            break;
+        }
+        CKHUStateDiff diff;
+        if (Read(StateDiffKey(h), diff)) {
+            vDiffs.push_back(std::move(diff));
+            continue;
+        }
+        if (Read(StateSnapshotKey(h), base)) {
+            break;
+        }
+        if (h == nHeight) {
+            return false; // No state at this height
+        }
+        return error("%s: KHU state missing at height %d (rebuilding height %d)", __func__, h, nHeight);
+    }
+
+    for (auto it = vDiffs.rbegin(); it != vDiffs.rend(); ++it) {
+        HuGlobalState next;
+        if (!it->Apply(base, next)) {
+            return error("%s: corrupt KHU state diff below height %d", __func__, nHeight);
+        }
+        base = next;
+    }
+
+    state = base;
+    CacheState(nHeight, state);
+    return true;
 }
 
 bool CKHUStateDB::ExistsKHUState(int nHeight)
 {
-    return Exists(std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_PREFIX, nHeight)));
+    LOCK(cs);
+    HuGlobalState state;
+    return GetCachedState(nHeight, state) ||
+           Exists(StateDiffKey(nHeight)) ||
+           Exists(StateSnapshotKey(nHeight));
 }
 
 bool CKHUStateDB::EraseKHUState(int nHeight)
 {
-    return Erase(std::make_pair(DB_KHU_STATE, std::make_pair(DB_KHU_STATE_PREFIX, nHeight)));
+    LOCK(cs);
+    UncacheState(nHeight);
+    Erase(StateDiffKey(nHeight));
+    return Erase(StateSnapshotKey(nHeight));
 }
 
 HuGlobalState CKHUStateDB::LoadKHUState_OrGenesis(int nHeight)
@@ -91,26 +283,3 @@ bool CKHUStateDB::ExistsKHUUTXO(const COutPoint& outpoint)
 {
     return Exists(std::make_pair(DB_KHU_UTXO_PREFIX, outpoint));
 }
-
-bool CKHUStateDB::LoadAllKHUUTXOs(std::vector<std::pair<COutPoint, CKHUUTXO>>& utxos)
-{
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    // Seek to start of UTXO prefix
-    pcursor->Seek(std::make_pair(DB_KHU_UTXO_PREFIX, COutPoint()));
-
-    while (pcursor->Valid()) {
-        std::pair<char, COutPoint> key;
-        if (pcursor->GetKey(key) && key.first == DB_KHU_UTXO_PREFIX) {
-            CKHUUTXO utxo;
-            if (pcursor->GetValue(utxo)) {
-                utxos.emplace_back(key.second, utxo);
-            }
-            pcursor->Next();
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
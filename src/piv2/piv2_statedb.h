@@ -5,24 +5,57 @@
 #ifndef HU_HU_STATEDB_H
 #define HU_HU_STATEDB_H
 
-#include "dbwrapper.h"
+#include "piv2/piv2_dbtransaction.h"
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_coins.h"
 #include "primitives/transaction.h"
+#include "unordered_lru_cache.h"
 
+#include <set>
 #include <stdint.h>
 #include <vector>
 
+//! A full state snapshot is stored every N heights, compact diffs in between
+static const int KHU_STATE_SNAPSHOT_INTERVAL = 1000;
+//! Recently read/written states kept in memory
+static const size_t KHU_STATE_CACHE_SIZE = 1000;
+
+/**
+ * CKHUStateDiff - Byte runs that turn the state at height-1 into the state at height
+ *
+ * The base is the previous state with nHeight+1 and hashPrevState set to its
+ * hash, so a block that only moves the chain forward stores hashBlock alone.
+ */
+struct CKHUStateDiff
+{
+    struct Run {
+        uint32_t nOffset;
+        std::vector<unsigned char> vch;
+
+        SERIALIZE_METHODS(Run, obj) { READWRITE(VARINT(obj.nOffset), obj.vch); }
+    };
+
+    std::vector<Run> vRuns;
+
+    SERIALIZE_METHODS(CKHUStateDiff, obj) { READWRITE(obj.vRuns); }
+
+    static CKHUStateDiff Make(const HuGlobalState& prev, const HuGlobalState& state);
+    bool Apply(const HuGlobalState& prev, HuGlobalState& state) const;
+};
+
 /**
  * CKHUStateDB - LevelDB persistence layer for KHU global state
  *
  * Database keys:
- * - 'K' + 'S' + height -> HuGlobalState
+ * - 'K' + 'S' + height -> HuGlobalState (snapshot, every KHU_STATE_SNAPSHOT_INTERVAL)
+ * - 'K' + 'D' + height -> CKHUStateDiff (against the state at height-1)
  *
- * The database stores KHU state snapshots at each block height.
- * This allows for efficient state retrieval and reorg handling.
+ * Any height is rebuilt by replaying diffs from the closest snapshot below it
+ * (at most KHU_STATE_SNAPSHOT_INTERVAL reads). The tip state and an LRU of
+ * recent states are kept in memory, so block connect reads no state from disk.
+ * Databases written with a snapshot at every height are read as-is.
  */
-class CKHUStateDB : public CDBWrapper
+class CKHUStateDB : public CKHUTransactionalDB
 {
 public:
     explicit CKHUStateDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -31,10 +64,26 @@ private:
     CKHUStateDB(const CKHUStateDB&);
     void operator=(const CKHUStateDB&);
 
+    int nTipHeight{-1};
+    HuGlobalState tipState;
+    unordered_lru_cache<int, HuGlobalState, std::hash<int>> stateCache{KHU_STATE_CACHE_SIZE};
+    //! Heights written by the current block transaction (evicted on rollback)
+    std::set<int> setPendingHeights;
+
+    bool GetCachedState(int nHeight, HuGlobalState& state);
+    void CacheState(int nHeight, const HuGlobalState& state);
+    void UncacheState(int nHeight);
+
 public:
+    void CommitCurTransaction() override;
+    void RollbackCurTransaction() override;
+
     /**
      * WriteKHUState - Persist KHU state for a given height
      *
+     * Writes a snapshot at multiples of KHU_STATE_SNAPSHOT_INTERVAL (or when
+     * the state at height-1 is unknown), a diff otherwise.
+     *
      * @param nHeight Block height
      * @param state KHU state to write
      * @return true on success, false on failure
@@ -79,7 +128,8 @@ public:
 
     // ═══════════════════════════════════════════════════════════════════════
     // KHU UTXO Persistence (Phase 2)
-    // Database keys: 'K' + 'U' + outpoint -> CKHUUTXO
+    // Database keys: 'U' + outpoint -> CKHUUTXO
+    // Accessed through CKHUCoinsViewCache (piv2_utxo.h), one coin at a time
     // ═══════════════════════════════════════════════════════════════════════
 
     /**
@@ -115,16 +165,6 @@ public:
      * @return true if UTXO exists
      */
     bool ExistsKHUUTXO(const COutPoint& outpoint);
-
-    /**
-     * LoadAllKHUUTXOs - Load all UTXOs into memory cache
-     *
-     * Called at startup to populate the in-memory cache.
-     *
-     * @param utxos Output vector for all UTXOs
-     * @return true on success
-     */
-    bool LoadAllKHUUTXOs(std::vector<std::pair<COutPoint, CKHUUTXO>>& utxos);
 };
 
 #endif // HU_HU_STATEDB_H
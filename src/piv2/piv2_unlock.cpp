@@ -131,8 +131,12 @@ bool CheckKHUUnlock(
                         REJECT_INVALID, "bad-unlock-maturity");
     }
 
-    // 9. bonus = noteData.Ur_accumulated >= 0
-    CAmount bonus = noteData.Ur_accumulated;  // ✅ PER-NOTE (NOT Ur_now - Ur_at_lock)
+    // 9. bonus = amount × Δyield_index since maturity >= 0
+    CAmount bonus = 0;
+    if (!khu_yield::GetNoteYield(noteData, huState, bonus)) {
+        return state.DoS(100, error("%s: failed to compute bonus for cm=%s", __func__, cm.GetHex().substr(0, 16)),
+                        REJECT_INVALID, "bad-unlock-bonus");
+    }
     if (bonus < 0) {
         return state.DoS(100, error("%s: negative bonus", __func__),
                         REJECT_INVALID, "bad-unlock-bonus-negative");
@@ -234,8 +238,12 @@ bool ApplyHUUnlock(
     }
 
     // 7. ✅ CRITICAL: Extract P (principal) and Y (yield) from note
+    // Y is derived from the global yield index (O(1), no per-note yield writes)
     CAmount P = noteData.amount;              // Principal lockd
-    CAmount Y = noteData.Ur_accumulated;      // Yield accumulated
+    CAmount Y = 0;                            // Yield accumulated
+    if (!khu_yield::GetNoteYield(noteData, state, Y)) {
+        return error("%s: failed to compute yield for cm=%s", __func__, cm.ToString());
+    }
 
     // ═══════════════════════════════════════════════════════════════════════
     // 5 MUTATIONS ATOMIQUES — ORDRE CRITIQUE (préserve invariants C==U+Z, Cr==Ur)
@@ -311,8 +319,12 @@ bool ApplyHUUnlock(
     // ═══════════════════════════════════════════════════════════════════════
 
     // 10. Mark note as spent in database (prevents double-unlock and yield calculation on spent notes)
-    // This prevents yield from being calculated for spent notes
+    // Its principal leaves the yield accumulator; the paid bonus is recorded for exact undo
+    if (!khu_yield::RemoveNoteFromYieldIndex(noteData, state)) {
+        return error("%s: failed to unregister note from yield index", __func__);
+    }
     noteData.bSpent = true;
+    noteData.Ur_accumulated = Y;
     if (!zkhuDB->WriteNote(cm, noteData)) {
         return error("%s: failed to mark note as spent", __func__);
     }
@@ -337,9 +349,9 @@ bool ApplyHUUnlock(
                     __func__, expectedOutput, totalOutput, nKHUOutputs, tx.vout.size());
     }
 
-    // 11b. ✅ CRITICAL: Add only the first 2 KHU_T outputs to mapKHUUTXOs for consensus tracking
+    // 11b. ✅ CRITICAL: Add only the first 2 KHU_T outputs to the KHU coins view for consensus tracking
     // NOTE: Standard AddCoins() only adds to CCoinsViewCache (PIV view).
-    // For KHU_T coins, we MUST also add to mapKHUUTXOs so that REDEEM can find them.
+    // For KHU_T coins, we MUST also add to the KHU coins view so that REDEEM can find them.
     // This is symmetric with ApplyHUMint which also calls AddKHUCoin().
     // With privacy split, we have 2 KHU outputs (outputs beyond 2 are PIV change)
     for (size_t i = 0; i < nKHUOutputs; ++i) {
@@ -407,7 +419,10 @@ bool UndoKHUUnlock(
         return error("%s: note data not found for cm=%s", __func__, cm.ToString());
     }
 
-    // 6. Extract P (principal) and Y (yield) from note
+    // 6. Extract P (principal) and Y (yield paid, recorded by ApplyHUUnlock)
+    if (!noteData.bSpent) {
+        return error("%s: note %s is not spent", __func__, cm.ToString());
+    }
     CAmount P = noteData.amount;
     CAmount Y = noteData.Ur_accumulated;
 
@@ -446,6 +461,10 @@ bool UndoKHUUnlock(
 
     // 7. Unmark note as spent (restore for yield calculation during reorg)
     noteData.bSpent = false;
+    noteData.Ur_accumulated = 0;
+    if (!khu_yield::AddNoteToYieldIndex(noteData, state)) {
+        return error("%s: failed to re-register note with yield index", __func__);
+    }
     if (!zkhuDB->WriteNote(cm, noteData)) {
         return error("%s: failed to unmark note as spent", __func__);
     }
@@ -460,7 +479,7 @@ bool UndoKHUUnlock(
         return error("%s: failed to unspend Sapling nullifier", __func__);
     }
 
-    // 9b. ✅ CRITICAL: Remove only first 2 KHU_T coins from mapKHUUTXOs
+    // 9b. ✅ CRITICAL: Remove only first 2 KHU_T coins from the KHU coins view
     // This is symmetric with the AddKHUCoin() in ApplyHUUnlock.
     // With privacy split, we have 2 KHU outputs (outputs beyond 2 are PIV change)
     size_t nKHUOutputs = std::min(tx.vout.size(), (size_t)2);  // Privacy split = 2 KHU outputs
@@ -69,7 +69,7 @@ bool GetUnlockKHUPayload(const CTransaction& tx, CUnlockKHUPayload& payload);
  * 4. zk-proof Sapling valide
  * 5. Décoder memo ZKHU → ZKHUMemo
  * 6. ⚠️ MATURITY: nHeight - memo.nLockStartHeight >= 4320 (sinon reject)
- * 7. bonus = note.Ur_accumulated >= 0
+ * 7. bonus = khu_yield::GetNoteYield(note, huState) >= 0
  * 8. huState.Cr >= bonus && huState.Ur >= bonus
  * 9. vout[0].nValue == amount + bonus
  *
@@ -93,7 +93,7 @@ bool CheckKHUUnlock(
  * ApplyHUUnlock - Application UNLOCK (Consensus Critical)
  *
  * RÈGLE ATOMIQUE CRITIQUE — DOUBLE FLUX:
- *   CAmount bonus = noteData.Ur_accumulated;  // ✅ Per-note (NOT Ur_now - Ur_at_lock)
+ *   CAmount bonus = GetNoteYield(noteData);  // ✅ amount × Δyield_index since maturity
  *
  *   state.U += bonus;   // Supply increases
  *   state.C += bonus;   // Collateral increases
@@ -124,7 +124,7 @@ bool ApplyHUUnlock(
  * UndoKHUUnlock - Undo UNLOCK during reorg (Consensus Critical)
  *
  * RÈGLE CRITIQUE — SYMÉTRIE DOUBLE FLUX:
- *   CAmount bonus = noteData.Ur_accumulated;  // Same bonus as Apply
+ *   CAmount bonus = noteData.Ur_accumulated;  // Bonus recorded by Apply
  *
  *   state.U -= bonus;   // Supply decreases
  *   state.C -= bonus;   // Collateral decreases
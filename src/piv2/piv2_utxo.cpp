@@ -10,76 +10,263 @@
 #include "util/system.h"
 #include "utilmoneystr.h"
 
-#include <unordered_map>
+#include <memory>
 
 // External function to get DB (defined in khu_validation.cpp)
 extern CKHUStateDB* GetKHUStateDB();
 
-// Phase 2: KHU UTXO tracking with LevelDB persistence
-// In-memory cache for performance, backed by LevelDB for persistence
+// ═══════════════════════════════════════════════════════════════════════════
+// CKHUCoinsViewCache
+// ═══════════════════════════════════════════════════════════════════════════
+
+CKHUCoinsViewCache::CKHUCoinsViewCache(CKHUStateDB* dbIn) : db(dbIn), parent(nullptr) {}
+
+CKHUCoinsViewCache::CKHUCoinsViewCache(CKHUCoinsViewCache* parentIn) : db(nullptr), parent(parentIn) {}
+
+bool CKHUCoinsViewCache::ReadFromBase(const COutPoint& outpoint, CKHUUTXO& coin) const
+{
+    if (parent) {
+        return parent->GetCoin(outpoint, coin);
+    }
+    return db && db->ReadKHUUTXO(outpoint, coin) && !coin.IsSpent();
+}
+
+CKHUCoinsMap::iterator CKHUCoinsViewCache::FetchCoin(const COutPoint& outpoint) const
+{
+    CKHUCoinsMap::iterator it = cacheCoins.find(outpoint);
+    if (it != cacheCoins.end())
+        return it;
+    CKHUUTXO tmp;
+    if (!ReadFromBase(outpoint, tmp))
+        return cacheCoins.end();
+    CKHUCoinsMap::iterator ret = cacheCoins.emplace(outpoint, CKHUCoinsCacheEntry()).first;
+    ret->second.coin = std::move(tmp);
+    cachedCoinsUsage += ret->second.coin.DynamicMemoryUsage();
+    return ret;
+}
+
+bool CKHUCoinsViewCache::GetCoin(const COutPoint& outpoint, CKHUUTXO& coin) const
+{
+    CKHUCoinsMap::const_iterator it = FetchCoin(outpoint);
+    if (it == cacheCoins.end() || it->second.coin.IsSpent()) {
+        return false;
+    }
+    coin = it->second.coin;
+    return true;
+}
+
+bool CKHUCoinsViewCache::HaveCoin(const COutPoint& outpoint) const
+{
+    CKHUCoinsMap::const_iterator it = FetchCoin(outpoint);
+    return it != cacheCoins.end() && !it->second.coin.IsSpent();
+}
+
+bool CKHUCoinsViewCache::AddCoin(const COutPoint& outpoint, const CKHUUTXO& coin, bool fPossibleOverwrite)
+{
+    assert(!coin.IsSpent());
+    CKHUCoinsMap::iterator it = fPossibleOverwrite ? cacheCoins.find(outpoint) : FetchCoin(outpoint);
+    bool fresh = false;
+    if (it == cacheCoins.end()) {
+        it = cacheCoins.emplace(outpoint, CKHUCoinsCacheEntry()).first;
+        // Unknown to the parent (checked above) unless we are overwriting blindly
+        fresh = !fPossibleOverwrite;
+    } else {
+        if (!fPossibleOverwrite && !it->second.coin.IsSpent()) {
+            return false;
+        }
+        // A spent but DIRTY entry still has to reach the parent: not FRESH
+        fresh = !fPossibleOverwrite && !(it->second.flags & CKHUCoinsCacheEntry::DIRTY);
+        cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    }
+    it->second.coin = coin;
+    it->second.flags |= CKHUCoinsCacheEntry::DIRTY | (fresh ? CKHUCoinsCacheEntry::FRESH : 0);
+    cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    return true;
+}
+
+bool CKHUCoinsViewCache::SpendCoin(const COutPoint& outpoint)
+{
+    CKHUCoinsMap::iterator it = FetchCoin(outpoint);
+    if (it == cacheCoins.end() || it->second.coin.IsSpent()) {
+        return false;
+    }
+    cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    if (it->second.flags & CKHUCoinsCacheEntry::FRESH) {
+        cacheCoins.erase(it);
+    } else {
+        it->second.flags |= CKHUCoinsCacheEntry::DIRTY;
+        it->second.coin.Clear();
+    }
+    return true;
+}
+
+void CKHUCoinsViewCache::BatchWrite(CKHUCoinsMap& mapCoins)
+{
+    for (CKHUCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); it = mapCoins.erase(it)) {
+        if (!(it->second.flags & CKHUCoinsCacheEntry::DIRTY)) {
+            continue;
+        }
+        CKHUCoinsMap::iterator itUs = cacheCoins.find(it->first);
+        if (itUs == cacheCoins.end()) {
+            // FRESH and spent in the child: nothing to tell the parent
+            if (!(it->second.flags & CKHUCoinsCacheEntry::FRESH && it->second.coin.IsSpent())) {
+                CKHUCoinsCacheEntry& entry = cacheCoins[it->first];
+                entry.coin = std::move(it->second.coin);
+                cachedCoinsUsage += entry.coin.DynamicMemoryUsage();
+                entry.flags = CKHUCoinsCacheEntry::DIRTY;
+                if (it->second.flags & CKHUCoinsCacheEntry::FRESH) {
+                    entry.flags |= CKHUCoinsCacheEntry::FRESH;
+                }
+            }
+        } else {
+            if ((it->second.flags & CKHUCoinsCacheEntry::FRESH) && !itUs->second.coin.IsSpent()) {
+                throw std::logic_error("FRESH flag misapplied to KHU coin cache entry with unspent coin");
+            }
+            cachedCoinsUsage -= itUs->second.coin.DynamicMemoryUsage();
+            if ((itUs->second.flags & CKHUCoinsCacheEntry::FRESH) && it->second.coin.IsSpent()) {
+                // Never reached the DB: just forget it
+                cacheCoins.erase(itUs);
+            } else {
+                itUs->second.coin = std::move(it->second.coin);
+                cachedCoinsUsage += itUs->second.coin.DynamicMemoryUsage();
+                itUs->second.flags |= CKHUCoinsCacheEntry::DIRTY;
+            }
+        }
+    }
+}
+
+bool CKHUCoinsViewCache::Flush()
+{
+    if (parent) {
+        parent->BatchWrite(cacheCoins);
+    } else {
+        if (!db) {
+            return false;
+        }
+        for (const auto& it : cacheCoins) {
+            if (!(it.second.flags & CKHUCoinsCacheEntry::DIRTY)) {
+                continue;
+            }
+            if (it.second.coin.IsSpent()) {
+                if (!(it.second.flags & CKHUCoinsCacheEntry::FRESH) && !db->EraseKHUUTXO(it.first)) {
+                    return false;
+                }
+            } else if (!db->WriteKHUUTXO(it.first, it.second.coin)) {
+                return false;
+            }
+        }
+        cacheCoins.clear();
+    }
+    cachedCoinsUsage = 0;
+    return true;
+}
+
+size_t CKHUCoinsViewCache::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
+}
+
+unsigned int CKHUCoinsViewCache::GetCacheSize() const
+{
+    return cacheCoins.size();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Global KHU coins views
+// ═══════════════════════════════════════════════════════════════════════════
+
 static RecursiveMutex cs_khu_utxos;
-static std::unordered_map<COutPoint, CKHUUTXO, SaltedOutpointHasher> mapKHUUTXOs GUARDED_BY(cs_khu_utxos);
-static bool fKHUUTXOsLoaded = false;
+// Tip view: every connected block since the last chainstate flush
+static std::unique_ptr<CKHUCoinsViewCache> pkhucoinsTip GUARDED_BY(cs_khu_utxos);
+// Block view: mutations of the block being connected/disconnected
+static std::unique_ptr<CKHUCoinsViewCache> pkhucoinsBlock GUARDED_BY(cs_khu_utxos);
 
-// Initialize UTXO cache from database (called at startup)
-static void LoadKHUUTXOsFromDB()
+/** View that KHU operations read and write (block view if one is open) */
+static CKHUCoinsViewCache* ActiveKHUCoinsView() EXCLUSIVE_LOCKS_REQUIRED(cs_khu_utxos)
 {
     AssertLockHeld(cs_khu_utxos);
+    if (pkhucoinsBlock) return pkhucoinsBlock.get();
+    if (!pkhucoinsTip) {
+        // Not initialized through InitKHUStateDB (unit tests): bind lazily
+        CKHUStateDB* db = GetKHUStateDB();
+        if (!db) return nullptr;
+        pkhucoinsTip = std::make_unique<CKHUCoinsViewCache>(db);
+    }
+    return pkhucoinsTip.get();
+}
+
+void InitKHUCoinsCache(CKHUStateDB* db)
+{
+    LOCK(cs_khu_utxos);
+    pkhucoinsBlock.reset();
+    pkhucoinsTip = std::make_unique<CKHUCoinsViewCache>(db);
+}
 
-    if (fKHUUTXOsLoaded) return;
+void BeginKHUCoinsBlock()
+{
+    LOCK(cs_khu_utxos);
+    CKHUCoinsViewCache* tip = ActiveKHUCoinsView();
+    assert(!pkhucoinsBlock);
+    if (tip) {
+        pkhucoinsBlock = std::make_unique<CKHUCoinsViewCache>(tip);
+    }
+}
 
-    CKHUStateDB* db = GetKHUStateDB();
-    if (!db) {
-        LogPrintf("%s: WARNING - KHU DB not available yet\n", __func__);
-        return;
+void CommitKHUCoinsBlock()
+{
+    LOCK(cs_khu_utxos);
+    if (pkhucoinsBlock) {
+        pkhucoinsBlock->Flush();
+        pkhucoinsBlock.reset();
     }
+}
 
-    std::vector<std::pair<COutPoint, CKHUUTXO>> utxos;
-    if (db->LoadAllKHUUTXOs(utxos)) {
-        for (const auto& pair : utxos) {
-            mapKHUUTXOs[pair.first] = pair.second;
-        }
-        LogPrint(BCLog::HU, "%s: Loaded %zu KHU UTXOs from database\n", __func__, utxos.size());
-        fKHUUTXOsLoaded = true;
+void RollbackKHUCoinsBlock()
+{
+    LOCK(cs_khu_utxos);
+    pkhucoinsBlock.reset();
+}
+
+bool FlushKHUCoins()
+{
+    LOCK(cs_khu_utxos);
+    assert(!pkhucoinsBlock);
+    if (!pkhucoinsTip) {
+        return true;
     }
+    const unsigned int nCoins = pkhucoinsTip->GetCacheSize();
+    if (!pkhucoinsTip->Flush()) {
+        return error("%s: failed to write KHU coins", __func__);
+    }
+    LogPrint(BCLog::HU, "%s: flushed %u cached KHU coins\n", __func__, nCoins);
+    return true;
 }
 
-bool AddKHUCoin(CCoinsViewCache& view, const COutPoint& outpoint, const CKHUUTXO& coin)
+size_t GetKHUCoinsCacheUsage()
 {
     LOCK(cs_khu_utxos);
+    size_t nUsage = 0;
+    if (pkhucoinsTip) nUsage += pkhucoinsTip->DynamicMemoryUsage();
+    if (pkhucoinsBlock) nUsage += pkhucoinsBlock->DynamicMemoryUsage();
+    return nUsage;
+}
 
-    // Ensure cache is loaded
-    LoadKHUUTXOsFromDB();
+bool AddKHUCoin(CCoinsViewCache& view, const COutPoint& outpoint, const CKHUUTXO& coin)
+{
+    LOCK(cs_khu_utxos);
 
     LogPrint(BCLog::HU, "%s: adding %s KHU at %s:%d (height %d)\n",
              __func__, FormatMoney(coin.amount), outpoint.hash.ToString().substr(0,16).c_str(),
              outpoint.n, coin.nHeight);
 
-    // Vérifier que le coin n'existe pas déjà
-    auto it = mapKHUUTXOs.find(outpoint);
-    if (it != mapKHUUTXOs.end()) {
-        bool isSpent = it->second.IsSpent();
-        LogPrint(BCLog::HU, "%s: outpoint=%s already exists (spent=%d)\n",
-                 __func__, outpoint.ToString(), isSpent);
-        if (!isSpent) {
-            return error("%s: coin already exists and not spent at %s", __func__, outpoint.ToString());
-        }
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    if (!khuView) {
+        return error("%s: KHU StateDB not available", __func__);
     }
 
-    // Ajouter le coin à la cache
-    mapKHUUTXOs[outpoint] = coin;
-
-    // Persister dans LevelDB
-    CKHUStateDB* db = GetKHUStateDB();
-    if (db) {
-        if (!db->WriteKHUUTXO(outpoint, coin)) {
-            LogPrintf("ERROR: %s: Failed to persist UTXO to database\n", __func__);
-            // Continue anyway - in-memory cache is updated
-        } else {
-            LogPrint(BCLog::HU, "%s: Persisted UTXO to LevelDB at %s\n", __func__, outpoint.ToString());
-        }
-    } else {
-        LogPrintf("WARNING: %s: KHU StateDB not available for UTXO persistence\n", __func__);
+    // Vérifier que le coin n'existe pas déjà (non dépensé)
+    if (!khuView->AddCoin(outpoint, coin, false /* fPossibleOverwrite */)) {
+        return error("%s: coin already exists and not spent at %s", __func__, outpoint.ToString());
     }
 
     LogPrint(BCLog::HU, "%s: added %s KHU at %s\n",
@@ -92,39 +279,18 @@ bool SpendKHUCoin(CCoinsViewCache& view, const COutPoint& outpoint)
 {
     LOCK(cs_khu_utxos);
 
-    // Ensure cache is loaded
-    LoadKHUUTXOsFromDB();
-
     LogPrint(BCLog::HU, "%s: looking for %s:%d\n",
               __func__, outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
 
-    auto it = mapKHUUTXOs.find(outpoint);
-    if (it == mapKHUUTXOs.end()) {
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    if (!khuView || !khuView->SpendCoin(outpoint)) {
         LogPrint(BCLog::HU, "%s: coin not found for %s:%d\n",
                  __func__, outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
-        return error("%s: coin not found at %s", __func__, outpoint.ToString());
+        return error("%s: coin not found or already spent at %s", __func__, outpoint.ToString());
     }
 
-    if (it->second.IsSpent()) {
-        LogPrint(BCLog::HU, "SpendKHUCoin: coin already spent for %s:%d\n",
-                 outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
-        return error("SpendKHUCoin: coin already spent at %s", outpoint.ToString());
-    }
-
-    LogPrint(BCLog::HU, "SpendKHUCoin: spending %s:%d value=%s\n",
-             outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n, FormatMoney(it->second.amount));
-
-    // Supprimer de la cache
-    mapKHUUTXOs.erase(it);
-
-    // Supprimer de LevelDB
-    CKHUStateDB* db = GetKHUStateDB();
-    if (db) {
-        if (!db->EraseKHUUTXO(outpoint)) {
-            LogPrintf("ERROR: %s: Failed to erase UTXO from database\n", __func__);
-            // Continue anyway - in-memory cache is updated
-        }
-    }
+    LogPrint(BCLog::HU, "SpendKHUCoin: spent %s:%d\n",
+             outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
 
     return true;
 }
@@ -133,27 +299,14 @@ bool GetKHUCoin(const CCoinsViewCache& view, const COutPoint& outpoint, CKHUUTXO
 {
     LOCK(cs_khu_utxos);
 
-    // Ensure cache is loaded
-    LoadKHUUTXOsFromDB();
-
-    LogPrint(BCLog::HU, "%s: looking for %s:%d\n",
-              __func__, outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
-
-    auto it = mapKHUUTXOs.find(outpoint);
-    if (it == mapKHUUTXOs.end()) {
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    if (!khuView || !khuView->GetCoin(outpoint, coin)) {
         // Not found is normal for PIV inputs - only log at debug level
         LogPrint(BCLog::HU, "%s: coin not found for %s:%d\n",
                  __func__, outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
         return false;
     }
 
-    if (it->second.IsSpent()) {
-        LogPrint(BCLog::HU, "GetKHUCoin: coin spent for %s:%d\n",
-                 outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
-        return false;
-    }
-
-    coin = it->second;
     LogPrint(BCLog::HU, "GetKHUCoin: found %s:%d value=%s\n",
              outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n, FormatMoney(coin.amount));
     return true;
@@ -163,35 +316,16 @@ bool HaveKHUCoin(const CCoinsViewCache& view, const COutPoint& outpoint)
 {
     LOCK(cs_khu_utxos);
 
-    // Ensure cache is loaded
-    LoadKHUUTXOsFromDB();
-
-    auto it = mapKHUUTXOs.find(outpoint);
-    if (it == mapKHUUTXOs.end()) {
-        return false;
-    }
-
-    return !it->second.IsSpent();
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    return khuView && khuView->HaveCoin(outpoint);
 }
 
 bool GetKHUCoinFromTracking(const COutPoint& outpoint, CKHUUTXO& coin)
 {
     LOCK(cs_khu_utxos);
 
-    // Ensure cache is loaded
-    LoadKHUUTXOsFromDB();
-
-    auto it = mapKHUUTXOs.find(outpoint);
-    if (it == mapKHUUTXOs.end()) {
-        return false;
-    }
-
-    if (it->second.IsSpent()) {
-        return false;
-    }
-
-    coin = it->second;
-    return true;
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    return khuView && khuView->GetCoin(outpoint, coin);
 }
 
 // Restore a spent KHU UTXO (used during reorg/undo)
@@ -202,16 +336,9 @@ bool RestoreKHUCoin(const COutPoint& outpoint, const CKHUUTXO& coin)
     LogPrint(BCLog::HU, "%s: restoring %s KHU at %s:%d\n",
              __func__, FormatMoney(coin.amount), outpoint.hash.ToString().substr(0,16).c_str(), outpoint.n);
 
-    // Ajouter à la cache
-    mapKHUUTXOs[outpoint] = coin;
-
-    // Persister dans LevelDB
-    CKHUStateDB* db = GetKHUStateDB();
-    if (db) {
-        if (!db->WriteKHUUTXO(outpoint, coin)) {
-            LogPrintf("ERROR: %s: Failed to persist restored UTXO to database\n", __func__);
-        }
+    CKHUCoinsViewCache* khuView = ActiveKHUCoinsView();
+    if (!khuView) {
+        return error("%s: KHU StateDB not available", __func__);
     }
-
-    return true;
+    return khuView->AddCoin(outpoint, coin, true /* fPossibleOverwrite */);
 }
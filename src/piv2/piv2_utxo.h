@@ -5,10 +5,98 @@
 #ifndef HU_HU_UTXO_H
 #define HU_HU_UTXO_H
 
+#include "coins.h"
 #include "piv2/piv2_coins.h"
 #include "primitives/transaction.h"
 
-class CCoinsViewCache;
+#include <unordered_map>
+
+class CKHUStateDB;
+
+/**
+ * CKHUCoinsCacheEntry - KHU_T coin cached in memory (same flags as CCoinsCacheEntry)
+ */
+struct CKHUCoinsCacheEntry {
+    CKHUUTXO coin; // coin.IsSpent() once spent in this view
+    unsigned char flags;
+
+    enum Flags {
+        DIRTY = (1 << 0), // Potentially different from the version in the parent view
+        FRESH = (1 << 1), // The parent view does not have this coin
+    };
+
+    CKHUCoinsCacheEntry() : flags(0) {}
+};
+
+typedef std::unordered_map<COutPoint, CKHUCoinsCacheEntry, SaltedOutpointHasher> CKHUCoinsMap;
+
+/**
+ * CKHUCoinsViewCache - Write-back KHU_T UTXO cache (modelled on CCoinsViewCache)
+ *
+ * Two layers are stacked at runtime:
+ * - tip view:   backed by CKHUStateDB ('K'+'U'), flushed by FlushKHUDBs()
+ *               together with the chainstate
+ * - block view: backed by the tip view, created by BeginKHUTransaction(),
+ *               pushed into the tip on commit, dropped on rollback
+ *
+ * Coins are fetched from the parent on first access only: the KHU UTXO set
+ * is never loaded as a whole.
+ */
+class CKHUCoinsViewCache
+{
+private:
+    CKHUStateDB* db;                    // base of the tip view
+    CKHUCoinsViewCache* parent;         // base of a block view
+    mutable CKHUCoinsMap cacheCoins;
+    mutable size_t cachedCoinsUsage{0}; // dynamic memory of the cached coins
+
+    CKHUCoinsMap::iterator FetchCoin(const COutPoint& outpoint) const;
+    bool ReadFromBase(const COutPoint& outpoint, CKHUUTXO& coin) const;
+    void BatchWrite(CKHUCoinsMap& mapCoins);
+
+public:
+    explicit CKHUCoinsViewCache(CKHUStateDB* dbIn);
+    explicit CKHUCoinsViewCache(CKHUCoinsViewCache* parentIn);
+    CKHUCoinsViewCache(const CKHUCoinsViewCache&) = delete;
+
+    /** Unspent coin at outpoint (false if missing or spent) */
+    bool GetCoin(const COutPoint& outpoint, CKHUUTXO& coin) const;
+    bool HaveCoin(const COutPoint& outpoint) const;
+
+    /** Add a coin. Fails if an unspent coin exists, unless fPossibleOverwrite (undo) */
+    bool AddCoin(const COutPoint& outpoint, const CKHUUTXO& coin, bool fPossibleOverwrite);
+
+    /** Spend a coin. Fails if it is missing or already spent */
+    bool SpendCoin(const COutPoint& outpoint);
+
+    /** Push DIRTY entries to the parent view (or the DB buffer) and empty the cache */
+    bool Flush();
+
+    size_t DynamicMemoryUsage() const;
+    unsigned int GetCacheSize() const;
+};
+
+/**
+ * InitKHUCoinsCache - (Re)create the tip view on top of the KHU state DB
+ *
+ * Called by InitKHUStateDB(). No coin is read from disk here.
+ */
+void InitKHUCoinsCache(CKHUStateDB* db);
+
+/** Open / commit / drop the block view (driven by CKHUDBScopedCommitter) */
+void BeginKHUCoinsBlock();
+void CommitKHUCoinsBlock();
+void RollbackKHUCoinsBlock();
+
+/**
+ * FlushKHUCoins - Write the tip view into the KHU state DB buffer
+ *
+ * Called by FlushKHUDBs() before the DB batches are written.
+ */
+bool FlushKHUCoins();
+
+/** Memory used by the KHU coins views, counted in the -dbcache budget */
+size_t GetKHUCoinsCacheUsage();
 
 /**
  * KHU UTXO Tracking Extensions for CCoinsViewCache
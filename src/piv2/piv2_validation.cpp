@@ -5,12 +5,14 @@
 #include "piv2/piv2_validation.h"
 
 #include "chain.h"
+#include "dao/dao_db.h"        // CDAODB
 #include "dao/dao_proposal.h"  // CDAOManager, g_daoManager
 #include "consensus/params.h"
 #include "key_io.h"  // EncodeDestination
 #include "piv2/piv2_commitment.h"
 #include "piv2/piv2_commitmentdb.h"
 #include "piv2/piv2_dao.h"
+#include "piv2/piv2_dbtransaction.h"
 #include "piv2/piv2_domc.h"
 #include "piv2/piv2_domcdb.h"
 #include "piv2/piv2_domc_tx.h"
@@ -20,14 +22,21 @@
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_statedb.h"
 #include "piv2/piv2_unlock.h"
+#include "piv2/piv2_utxo.h"
 #include "piv2/piv2_yield.h"
 #include "piv2/zkpiv2_db.h"
+#include "piv2/zkpiv2_witness.h"
 #include "primitives/block.h"
 #include "sync.h"
 #include "util/system.h"
 #include "validation.h"
 
 #include <memory>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
 
 // Global KHU state database
 static std::unique_ptr<CKHUStateDB> pkhustatedb;
@@ -41,6 +50,22 @@ static std::unique_ptr<CZKHUTreeDB> pzkhudb;
 // KHU state lock (protects state transitions)
 static RecursiveMutex cs_khu;
 
+/** Peak resident set size of the process in kB (0 if unavailable), for -debug=bench */
+static int64_t GetPeakRSSKB()
+{
+#ifndef WIN32
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef MAC_OSX
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
 bool InitKHUStateDB(size_t nCacheSize, bool fReindex)
 {
     LOCK(cs_khu);
@@ -48,6 +73,7 @@ bool InitKHUStateDB(size_t nCacheSize, bool fReindex)
     try {
         pkhustatedb.reset();
         pkhustatedb = std::make_unique<CKHUStateDB>(nCacheSize, false, fReindex);
+        InitKHUCoinsCache(pkhustatedb.get());
         return true;
     } catch (const std::exception& e) {
         LogPrintf("ERROR: Failed to initialize KHU state database: %s\n", e.what());
@@ -60,9 +86,9 @@ bool InitKHUStateDB(size_t nCacheSize, bool fReindex)
  *
  * THREAD-SAFETY MODEL:
  * - The database pointer is initialized once at startup (protected by cs_khu)
- * - LevelDB (CDBWrapper) is internally thread-safe for individual read/write ops
+ * - Each KHU DB guards its pending-write buffer with its own lock (CKHUTransactionalDB::cs)
  * - All HU state mutation operations (ApplyHU*, UndoKHU*) MUST hold cs_khu
- * - Read operations can be performed without lock (LevelDB handles internally)
+ * - Read operations can be performed without cs_khu (they see pending writes)
  *
  * IMPORTANT: For state mutations that require atomicity across multiple
  * database operations, the caller MUST hold cs_khu. Use AssertLockHeld(cs_khu)
@@ -73,7 +99,7 @@ bool InitKHUStateDB(size_t nCacheSize, bool fReindex)
 CKHUStateDB* GetKHUStateDB()
 {
     // Database is initialized once at startup, pointer is stable
-    // No lock needed for read access (LevelDB is thread-safe)
+    // No cs_khu needed for read access (the DB locks its own write buffer)
     return pkhustatedb.get();
 }
 
@@ -97,13 +123,13 @@ CHUCommitmentDB* GetKHUCommitmentDB()
     return pkhucommitmentdb.get();
 }
 
-bool InitZKHUDB(size_t nCacheSize, bool fReindex)
+bool InitZKHUDB(size_t nCacheSize, bool fReindex, bool fMemory)
 {
     LOCK(cs_khu);
 
     try {
         pzkhudb.reset();
-        pzkhudb = std::make_unique<CZKHUTreeDB>(nCacheSize, false, fReindex);
+        pzkhudb = std::make_unique<CZKHUTreeDB>(nCacheSize, fMemory, fReindex);
         LogPrint(BCLog::HU, "KHU: Initialized ZKHU database (Phase 4/5 Sapling)\n");
         return true;
     } catch (const std::exception& e) {
@@ -117,6 +143,73 @@ CZKHUTreeDB* GetZKHUDB()
     return pzkhudb.get();
 }
 
+/** All initialized KHU databases, in a fixed order */
+static std::vector<CKHUTransactionalDB*> GetKHUDBs()
+{
+    std::vector<CKHUTransactionalDB*> vDBs;
+    if (pkhustatedb) vDBs.push_back(pkhustatedb.get());
+    if (pkhucommitmentdb) vDBs.push_back(pkhucommitmentdb.get());
+    if (pzkhudb) vDBs.push_back(pzkhudb.get());
+    if (GetKHUDomcDB()) vDBs.push_back(GetKHUDomcDB());
+    if (g_daoManager && g_daoManager->GetDB()) vDBs.push_back(g_daoManager->GetDB());
+    return vDBs;
+}
+
+std::unique_ptr<CKHUDBScopedCommitter> BeginKHUTransaction()
+{
+    LOCK(cs_khu);
+    BeginKHUCoinsBlock();
+    return std::make_unique<CKHUDBScopedCommitter>(GetKHUDBs());
+}
+
+bool FlushKHUDBs(const uint256& hashBestBlock)
+{
+    LOCK(cs_khu);
+
+    const int64_t nTimeStart = GetTimeMicros();
+    const size_t nMemoryUsage = GetKHUDBMemoryUsage() + GetKHUCoinsCacheUsage();
+
+    // Write-back KHU coins land in the state DB buffer first
+    if (!FlushKHUCoins()) {
+        return error("%s: failed to flush KHU coins", __func__);
+    }
+    if (pkhustatedb) {
+        pkhustatedb->CommitCurTransaction();
+    }
+
+    for (CKHUTransactionalDB* db : GetKHUDBs()) {
+        if (!db->CommitRootTransaction(hashBestBlock)) {
+            return error("%s: failed to write KHU database batch", __func__);
+        }
+    }
+    LogPrint(BCLog::BENCHMARK, "    - KHU flush: %.2fms (%.1fMiB)\n",
+             (GetTimeMicros() - nTimeStart) * 0.001, nMemoryUsage * (1.0 / (1 << 20)));
+    return true;
+}
+
+size_t GetKHUDBMemoryUsage()
+{
+    size_t nUsage = 0;
+    for (CKHUTransactionalDB* db : GetKHUDBs()) {
+        nUsage += db->GetMemoryUsage();
+    }
+    return nUsage;
+}
+
+bool VerifyKHUBestBlock(const uint256& hashBestBlock)
+{
+    LOCK(cs_khu);
+
+    for (CKHUTransactionalDB* db : GetKHUDBs()) {
+        uint256 hashKHUBestBlock;
+        if (db->ReadBestBlock(hashKHUBestBlock) && hashKHUBestBlock != hashBestBlock) {
+            return error("%s: KHU database flushed at %s, chainstate at %s", __func__,
+                         hashKHUBestBlock.ToString(), hashBestBlock.ToString());
+        }
+    }
+    return true;
+}
+
 bool GetCurrentKHUState(HuGlobalState& state)
 {
     LOCK(cs_main);
@@ -251,7 +344,7 @@ bool ProcessHUBlock(const CBlock& block,
     // STEP 0: Update R_MAX_dynamic (year-based decay)
     // STEP 1: DOMC cycle boundary (R% activation, reveal instant)
     // STEP 2: DAO Treasury accumulation
-    // STEP 3: Daily Yield (per-note Ur_accumulated + global Cr/Ur)
+    // STEP 3: Daily Yield (global yield_index + Cr/Ur, O(1) per block)
     // STEP 4: KHU Transactions (MINT/REDEEM/LOCK/UNLOCK/DOMC)
     // STEP 5: Block Reward (= 0 post-V6)
     // STEP 6: CheckInvariants()
@@ -337,15 +430,18 @@ bool ProcessHUBlock(const CBlock& block,
     // Apply daily yield to all mature lockd notes (every 1440 blocks)
     // This updates Cr += total_yield, Ur += total_yield (invariant Cr==Ur preserved)
     // CRITICAL: Only apply when !fJustCheck to avoid double DB writes
-    // ApplyDailyYield writes to ZKHU note DB, so must skip during fJustCheck=true
+    // ApplyDailyYield writes the yield epoch to ZKHU DB, so must skip during fJustCheck=true
     // Note: V6_activation already defined above (STEP 1)
     if (!fJustCheck && khu_yield::ShouldApplyDailyYield(nHeight, V6_activation, newState.last_yield_update_height)) {
+        const int64_t nTimeYieldStart = GetTimeMicros();
         if (!khu_yield::ApplyDailyYield(newState, nHeight, V6_activation)) {
             return validationState.Error("daily-yield-failed");
         }
 
         LogPrint(BCLog::HU, "ProcessHUBlock: Applied daily yield at height %u, Cr=%d Ur=%d\n",
                  nHeight, newState.Cr, newState.Ur);
+        LogPrint(BCLog::BENCHMARK, "    - KHU daily yield at height %u: %.2fms (peak RSS %d kB)\n",
+                 nHeight, (GetTimeMicros() - nTimeYieldStart) * 0.001, GetPeakRSSKB());
     }
 
     // STEP 4: Process KHU transactions
@@ -432,6 +528,11 @@ bool ProcessHUBlock(const CBlock& block,
     }
     LogPrint(BCLog::HU, "ProcessHUBlock: Processed %d KHU transactions at height %d\n", nKHUTxCount, nHeight);
 
+    // Sapling commitment / ZKHU note position index (witness service)
+    if (!fJustCheck && !IndexZKHUCommitments(block, pindex, view)) {
+        return validationState.Error(strprintf("Failed to index ZKHU commitments at height %d", nHeight));
+    }
+
     // STEP 5: DAO Proposal Payouts (Phase 6.4)
     // ═══════════════════════════════════════════════════════════════════════════
     // DAO payouts execute at payout height (last block of each DAO cycle)
@@ -490,7 +591,8 @@ bool ProcessHUBlock(const CBlock& block,
     LogPrint(BCLog::HU, "ProcessHUBlock: After processing - C=%d U=%d Cr=%d Ur=%d (height=%d, fJustCheck=%d)\n",
              newState.C, newState.U, newState.Cr, newState.Ur, nHeight, fJustCheck);
 
-    // Persist state to database ONLY when not just checking
+    // Persist state ONLY when not just checking (buffered in the block's KHU
+    // transaction, written to disk by FlushKHUDBs)
     if (!fJustCheck) {
         if (!db->WriteKHUState(nHeight, newState)) {
             LogPrint(BCLog::HU, "ProcessHUBlock: FAIL - Write state failed at height %d\n", nHeight);
@@ -613,10 +715,16 @@ bool DisconnectKHUBlock(const CBlock& block,
         }
     }
 
+    if (!UnindexZKHUCommitments(block, nHeight)) {
+        return validationState.Error(strprintf("Failed to unindex ZKHU commitments at height %d", nHeight));
+    }
+
     // PHASE 6: Undo Daily Yield (Phase 6.1)
     // Must be undone AFTER transactions, BEFORE DOMC/DAO (reverse order of Connect)
+    // huState is the state AFTER this block, so a yield was applied here iff
+    // last_yield_update_height == nHeight
     uint32_t V6_activation = consensusParams.vUpgrades[Consensus::UPGRADE_V6_0].nActivationHeight;
-    if (khu_yield::ShouldApplyDailyYield(nHeight, V6_activation, huState.last_yield_update_height)) {
+    if (nHeight > 0 && huState.last_yield_update_height == (uint32_t)nHeight) {
         if (!khu_yield::UndoDailyYield(huState, nHeight, V6_activation)) {
             return validationState.Invalid(false, REJECT_INVALID, "undo-daily-yield-failed",
                 strprintf("Failed to undo daily yield at height %d", nHeight));
@@ -658,7 +766,13 @@ bool DisconnectKHUBlock(const CBlock& block,
                  nHeight, huState.R_annual);
     }
 
-    // DAO T payments are handled via KHU DAO proposal system
+    // PHASE 6: Undo DAO Proposal Payouts (Phase 6.4)
+    // T itself comes back with the state of the previous height; the payout
+    // markers must go, so that the proposals are paid again on reconnect
+    if (g_daoManager && !g_daoManager->UndoPayouts(nHeight)) {
+        return validationState.Invalid(false, REJECT_INVALID, "undo-dao-payouts-failed",
+            strprintf("Failed to undo DAO payouts at height %d", nHeight));
+    }
 
     // PHASE 6: Undo DAO Treasury (Phase 6.3)
     // Must be undone AFTER DOMC (reverse order of Connect)
@@ -14,6 +14,8 @@ class CValidationState;
 class CKHUStateDB;
 class CHUCommitmentDB;
 class CZKHUTreeDB;
+class CKHUDBScopedCommitter;
+class uint256;
 struct HuGlobalState;
 
 namespace Consensus {
@@ -129,9 +131,10 @@ CHUCommitmentDB* GetKHUCommitmentDB();
  *
  * @param nCacheSize DB cache size
  * @param fReindex If true, wipe and recreate DB
+ * @param fMemory If true, keep the DB in memory (tests and benchmarks)
  * @return true on success
  */
-bool InitZKHUDB(size_t nCacheSize, bool fReindex);
+bool InitZKHUDB(size_t nCacheSize, bool fReindex, bool fMemory = false);
 
 /**
  * GetZKHUDB - Get global ZKHU database instance
@@ -142,4 +145,42 @@ bool InitZKHUDB(size_t nCacheSize, bool fReindex);
  */
 CZKHUTreeDB* GetZKHUDB();
 
+/**
+ * BeginKHUTransaction - Open a per-block transaction over all KHU databases
+ *
+ * Every KHU write of the block (state, UTXOs, ZKHU notes/nullifiers, DOMC
+ * votes, commitments) is buffered in memory. Commit() keeps it for the next
+ * FlushKHUDBs(); destruction without Commit() discards it.
+ *
+ * @return Scoped committer (rolls back unless Commit() is called)
+ */
+std::unique_ptr<CKHUDBScopedCommitter> BeginKHUTransaction();
+
+/**
+ * FlushKHUDBs - Write all committed KHU mutations to disk
+ *
+ * Called from FlushStateToDisk right after the coins flush: one LevelDB
+ * batch per KHU database, each tagged with the coins best block.
+ *
+ * @param hashBestBlock Best block of the flushed coins view
+ * @return true on success
+ */
+bool FlushKHUDBs(const uint256& hashBestBlock);
+
+/**
+ * GetKHUDBMemoryUsage - Memory held by KHU mutations not yet on disk
+ */
+size_t GetKHUDBMemoryUsage();
+
+/**
+ * VerifyKHUBestBlock - Check the KHU databases were flushed with the chainstate
+ *
+ * Databases that were never flushed with a marker (fresh or older datadir)
+ * are accepted.
+ *
+ * @param hashBestBlock Best block of the coins view
+ * @return false if any KHU database was flushed at a different block
+ */
+bool VerifyKHUBestBlock(const uint256& hashBestBlock);
+
 #endif // HU_HU_VALIDATION_H
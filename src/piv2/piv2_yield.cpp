@@ -10,9 +10,14 @@
 #include "piv2/zkpiv2_db.h"
 #include "piv2/zkpiv2_note.h"
 #include "logging.h"
+#include "util/system.h"
+#include "utiltime.h"
 
 #include <boost/multiprecision/cpp_int.hpp>
 
+#include <limits>
+#include <map>
+
 namespace khu_yield {
 
 // ============================================================================
@@ -33,150 +38,18 @@ uint32_t GetYieldInterval()
 // Internal Functions
 // ============================================================================
 
-/**
- * IterateLockedNotes - Stream all ZKHU notes from LevelDB and apply functor
- *
- * RÈGLE CONSENSUS-CRITICAL:
- * - LevelDB cursors provide deterministic lexicographic order
- * - All nodes will process notes in the same order
- * - No in-memory sorting required
- *
- * Uses CZKHUTreeDB::GetAllNotes() which provides correct key format and
- * deterministic iteration order matching the database key serialization.
- *
- * @param func Functor to apply to each note: bool(uint256 noteId, ZKHUNoteData& data)
- * @return true if iteration completed successfully
- */
-template<typename Func>
-static bool IterateLockedNotes(Func func)
-{
-    CZKHUTreeDB* zkhuDB = GetZKHUDB();
-    if (!zkhuDB) {
-        // DB not initialized (e.g., test environment or before ZKHU activation)
-        // This is valid - treat as empty note set, iteration succeeds with zero notes
-        LogPrint(BCLog::HU, "IterateLockedNotes: ZKHU DB not initialized (empty note set)\n");
-        return true;
-    }
-
-    LogPrint(BCLog::HU, "IterateLockedNotes: DB initialized, using GetAllNotes()...\n");
-
-    // Use GetAllNotes() for correct key format matching WriteNote() serialization
-    std::vector<std::pair<uint256, ZKHUNoteData>> allNotes = zkhuDB->GetAllNotes();
-
-    LogPrint(BCLog::HU, "IterateLockedNotes: GetAllNotes returned %zu notes\n", allNotes.size());
-
-    for (const auto& notePair : allNotes) {
-        const uint256& noteId = notePair.first;
-        ZKHUNoteData noteData = notePair.second;  // Copy for functor to modify
-
-        LogPrint(BCLog::HU, "IterateLockedNotes: processing note %s amount=%lld lockHeight=%u\n",
-                 noteId.GetHex().substr(0, 16).c_str(), (long long)noteData.amount, noteData.nLockStartHeight);
-
-        // Apply functor
-        if (!func(noteId, noteData)) {
-            return false;
-        }
-    }
-
-    LogPrint(BCLog::HU, "IterateLockedNotes: iteration complete, processed %zu notes\n", allNotes.size());
-
-    return true;
-}
+using int128_t = boost::multiprecision::int128_t;
 
 /**
- * CalculateAndAccumulateYield - Calculate yield for all mature notes AND update their Ur_accumulated
- *
- * ALGORITHME CONSENSUS-CRITICAL:
- * 1. Iterate all ZKHU notes via LevelDB cursor (deterministic order)
- * 2. For each mature note: calculate daily yield, update Ur_accumulated, write to DB
- * 3. Accumulate total yield for global state update
- * 4. Protect against overflow using int128_t
+ * IsNoteCounted - Whether a note is already included in yield_mature_amount
  *
- * Updates each note's Ur_accumulated in the ZKHU database (per-note tracking).
- * This ensures UNLOCK can retrieve the correct yield for each individual note.
- *
- * @param nHeight Current block height
- * @param R_annual Annual yield rate (basis points)
- * @param totalYield Output: total yield calculated (satoshis)
- * @return true on success, false on overflow or error
+ * A note is counted once an epoch at or after its maturity height has been
+ * applied; before that its principal sits in its maturity bucket.
  */
-static bool CalculateAndAccumulateYield(uint32_t nHeight, uint16_t R_annual, CAmount& totalYield)
+static bool IsNoteCounted(const ZKHUNoteData& note, const HuGlobalState& state)
 {
-    totalYield = 0;
-
-    CZKHUTreeDB* zkhuDB = GetZKHUDB();
-    if (!zkhuDB) {
-        // DB not initialized - no notes to process
-        LogPrint(BCLog::HU, "CalculateAndAccumulateYield: ZKHU DB not initialized\n");
-        return true;
-    }
-
-    // Use int128_t for overflow-safe accumulation
-    using int128_t = boost::multiprecision::int128_t;
-    int128_t totalYield128 = 0;
-
-    // Collect notes to update (we can't modify during iteration)
-    std::vector<std::pair<uint256, ZKHUNoteData>> notesToUpdate;
-
-    bool success = IterateLockedNotes([&](const uint256& noteId, const ZKHUNoteData& note) {
-        // Skip notes that have been spent (UNLOCK'd)
-        // Notes are kept in DB for undo support, but bSpent flag excludes from yield
-        if (note.bSpent) {
-            LogPrint(BCLog::HU, "CalculateAndAccumulateYield: Skipping spent note %s (bSpent=true)\n",
-                     noteId.GetHex().substr(0, 16).c_str());
-            return true; // Skip spent note, continue iteration
-        }
-
-        // Check note maturity
-        if (!IsNoteMature(note.nLockStartHeight, nHeight)) {
-            return true; // Skip immature note, continue iteration
-        }
-
-        // Calculate daily yield for this note
-        CAmount dailyYield = CalculateDailyYieldForNote(note.amount, R_annual);
-
-        // Accumulate with overflow protection
-        totalYield128 += dailyYield;
-
-        // Check for overflow (should never happen with realistic values)
-        if (totalYield128 > std::numeric_limits<CAmount>::max()) {
-            LogPrintf("ERROR: CalculateAndAccumulateYield: Overflow detected at note %s\n",
-                      noteId.GetHex());
-            return false; // Stop iteration
-        }
-
-        // Store note for per-note Ur_accumulated update
-        ZKHUNoteData updatedNote = note;
-        updatedNote.Ur_accumulated += dailyYield;
-        notesToUpdate.emplace_back(noteId, updatedNote);
-
-        LogPrint(BCLog::HU, "CalculateAndAccumulateYield: Note %s amount=%lld dailyYield=%lld newUr=%lld\n",
-                 noteId.GetHex().substr(0, 16).c_str(), (long long)note.amount,
-                 (long long)dailyYield, (long long)updatedNote.Ur_accumulated);
-
-        return true; // Continue iteration
-    });
-
-    if (!success) {
-        return false;
-    }
-
-    // Write updated notes with accumulated yield back to database
-    for (const auto& notePair : notesToUpdate) {
-        if (!zkhuDB->WriteNote(notePair.first, notePair.second)) {
-            LogPrintf("ERROR: CalculateAndAccumulateYield: Failed to write note %s\n",
-                      notePair.first.GetHex());
-            return false;
-        }
-    }
-
-    LogPrint(BCLog::HU, "CalculateAndAccumulateYield: Updated %zu notes with yield\n",
-             notesToUpdate.size());
-
-    // Safe cast to CAmount (overflow already checked)
-    totalYield = static_cast<CAmount>(totalYield128);
-
-    return true;
+    return state.last_yield_update_height > 0 &&
+           GetNoteMaturityHeight(note) <= state.last_yield_update_height;
 }
 
 // ============================================================================
@@ -212,10 +85,42 @@ bool ApplyDailyYield(HuGlobalState& state, uint32_t nHeight, uint32_t nV6Activat
         return false;
     }
 
-    // Calculate total yield AND update each note's per-note Ur_accumulated
-    CAmount totalYield = 0;
-    if (!CalculateAndAccumulateYield(nHeight, state.R_annual, totalYield)) {
-        LogPrintf("ERROR: ApplyDailyYield: Failed to calculate/accumulate yield at height %u\n", nHeight);
+    // Promote notes that reached maturity since the previous epoch
+    // Bounded by the number of distinct maturity heights in one interval
+    CAmount promoted = 0;
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (zkhuDB && !zkhuDB->SumMaturityBuckets(state.last_yield_update_height, nHeight, promoted)) {
+        LogPrintf("ERROR: ApplyDailyYield: Failed to read maturity buckets at height %u\n", nHeight);
+        return false;
+    }
+    if (state.yield_mature_amount > std::numeric_limits<CAmount>::max() - promoted) {
+        LogPrintf("ERROR: ApplyDailyYield: Overflow on mature amount at height %u\n", nHeight);
+        return false;
+    }
+
+    const ZKHUYieldEpoch epoch(state.yield_index, promoted, state.R_annual);
+    const uint64_t indexDelta = GetYieldIndexIncrement(state.R_annual);
+    if (state.yield_index > std::numeric_limits<uint64_t>::max() - indexDelta) {
+        LogPrintf("ERROR: ApplyDailyYield: Overflow on yield index at height %u\n", nHeight);
+        return false;
+    }
+
+    state.yield_mature_amount += promoted;
+    state.yield_index += indexDelta;
+
+    // Rounded up: per-note bonuses are rounded down at UNLOCK, so the pool
+    // always covers every claim (remainder dust stays in Cr/Ur)
+    const int128_t total128 = (static_cast<int128_t>(state.yield_mature_amount) * indexDelta +
+                               (YIELD_INDEX_PRECISION - 1)) / YIELD_INDEX_PRECISION;
+    if (total128 > std::numeric_limits<CAmount>::max() ||
+        state.Cr > std::numeric_limits<CAmount>::max() - static_cast<CAmount>(total128)) {
+        LogPrintf("ERROR: ApplyDailyYield: Overflow on total yield at height %u\n", nHeight);
+        return false;
+    }
+    const CAmount totalYield = static_cast<CAmount>(total128);
+
+    if (zkhuDB && !zkhuDB->WriteYieldEpoch(nHeight, epoch)) {
+        LogPrintf("ERROR: ApplyDailyYield: Failed to write yield epoch at height %u\n", nHeight);
         return false;
     }
 
@@ -232,8 +137,9 @@ bool ApplyDailyYield(HuGlobalState& state, uint32_t nHeight, uint32_t nV6Activat
     // Update last yield height
     state.last_yield_update_height = nHeight;
 
-    LogPrint(BCLog::HU, "ApplyDailyYield: height=%u R_annual=%u (%.2f%%) totalYield=%d Cr=%d Ur=%d\n",
-             nHeight, state.R_annual, state.R_annual / 100.0, totalYield, state.Cr, state.Ur);
+    LogPrint(BCLog::HU, "ApplyDailyYield: height=%u R_annual=%u (%.2f%%) promoted=%d mature=%d index=%u totalYield=%d Cr=%d Ur=%d\n",
+             nHeight, state.R_annual, state.R_annual / 100.0, promoted, state.yield_mature_amount,
+             state.yield_index, totalYield, state.Cr, state.Ur);
 
     return true;
 }
@@ -251,52 +157,28 @@ bool UndoDailyYield(HuGlobalState& state, uint32_t nHeight, uint32_t nV6Activati
     }
 
     // ═══════════════════════════════════════════════════════════
-    // Undo per-note Ur_accumulated updates (reverse of Apply)
+    // Restore accumulator from the epoch record (no per-note rewrite)
+    // Maturity buckets are never consumed by Apply, so nothing to restore there
     // ═══════════════════════════════════════════════════════════
     CZKHUTreeDB* zkhuDB = GetZKHUDB();
-    if (zkhuDB && totalYield > 0) {
-        // Collect notes to update
-        std::vector<std::pair<uint256, ZKHUNoteData>> notesToUpdate;
-
-        IterateLockedNotes([&](const uint256& noteId, const ZKHUNoteData& note) {
-            // Skip spent notes (same logic as CalculateAndAccumulateYield)
-            // Spent notes never had yield added, so nothing to undo
-            if (note.bSpent) {
-                return true; // Skip spent note
-            }
-
-            // Only process notes that were mature at this height
-            if (!IsNoteMature(note.nLockStartHeight, nHeight)) {
-                return true; // Skip immature note
-            }
-
-            // Calculate the yield that was added for this note
-            CAmount dailyYield = CalculateDailyYieldForNote(note.amount, state.R_annual);
-
-            // Prepare updated note with yield subtracted
-            ZKHUNoteData updatedNote = note;
-            if (updatedNote.Ur_accumulated >= dailyYield) {
-                updatedNote.Ur_accumulated -= dailyYield;
-            } else {
-                // Edge case: yield was already claimed via UNLOCK, skip
-                LogPrint(BCLog::HU, "UndoDailyYield: Note %s has Ur_accumulated=%lld < dailyYield=%lld, skipping\n",
-                         noteId.GetHex().substr(0, 16).c_str(),
-                         (long long)updatedNote.Ur_accumulated, (long long)dailyYield);
-            }
-            notesToUpdate.emplace_back(noteId, updatedNote);
-
-            return true;
-        });
-
-        // Write updated notes back to DB
-        for (const auto& notePair : notesToUpdate) {
-            if (!zkhuDB->WriteNote(notePair.first, notePair.second)) {
-                LogPrintf("ERROR: UndoDailyYield: Failed to write note %s\n", notePair.first.GetHex());
-                return false;
-            }
+    if (zkhuDB) {
+        ZKHUYieldEpoch epoch;
+        if (!zkhuDB->ReadYieldEpoch(nHeight, epoch)) {
+            LogPrintf("ERROR: UndoDailyYield: Missing yield epoch at height %u\n", nHeight);
+            return false;
         }
+        if (state.yield_mature_amount < epoch.promoted_amount) {
+            LogPrintf("ERROR: UndoDailyYield: Underflow mature=%d < promoted=%d at height %u\n",
+                      state.yield_mature_amount, epoch.promoted_amount, nHeight);
+            return false;
+        }
+        state.yield_mature_amount -= epoch.promoted_amount;
+        state.yield_index = epoch.index_before;
 
-        LogPrint(BCLog::HU, "UndoDailyYield: Reverted yield on %zu notes\n", notesToUpdate.size());
+        if (!zkhuDB->EraseYieldEpoch(nHeight)) {
+            LogPrintf("ERROR: UndoDailyYield: Failed to erase yield epoch at height %u\n", nHeight);
+            return false;
+        }
     }
 
     // ═══════════════════════════════════════════════════════════
@@ -328,8 +210,8 @@ bool UndoDailyYield(HuGlobalState& state, uint32_t nHeight, uint32_t nV6Activati
         state.last_yield_update_height = nV6ActivationHeight;
     }
 
-    LogPrint(BCLog::HU, "UndoDailyYield: height=%u totalYield=%d (stored) Cr=%d Ur=%d\n",
-             nHeight, totalYield, state.Cr, state.Ur);
+    LogPrint(BCLog::HU, "UndoDailyYield: height=%u totalYield=%d (stored) index=%u Cr=%d Ur=%d\n",
+             nHeight, totalYield, state.yield_index, state.Cr, state.Ur);
 
     return true;
 }
@@ -345,8 +227,6 @@ CAmount CalculateDailyYieldForNote(CAmount amount, uint16_t R_annual)
         return 0;
     }
 
-    using int128_t = boost::multiprecision::int128_t;
-
     // annual_yield = amount × R_annual / 10000
     int128_t annual128 = static_cast<int128_t>(amount) * R_annual / 10000;
 
@@ -375,4 +255,165 @@ bool IsNoteMature(uint32_t noteHeight, uint32_t currentHeight)
     return (currentHeight - noteHeight) >= GetMaturityBlocks();
 }
 
+uint64_t GetYieldIndexIncrement(uint32_t R_annual)
+{
+    // FORMULE CONSENSUS: Δindex = R_annual × PRECISION / 10000 / 365
+    const int128_t delta128 = static_cast<int128_t>(R_annual) * YIELD_INDEX_PRECISION / 10000 / DAYS_PER_YEAR;
+    return static_cast<uint64_t>(delta128);
+}
+
+uint32_t GetNoteMaturityHeight(const ZKHUNoteData& note)
+{
+    return note.nLockStartHeight + GetMaturityBlocks();
+}
+
+bool AddNoteToYieldIndex(const ZKHUNoteData& note, HuGlobalState& state)
+{
+    if (note.amount <= 0) {
+        return error("%s: invalid note amount %d", __func__, note.amount);
+    }
+
+    if (IsNoteCounted(note, state)) {
+        if (state.yield_mature_amount > std::numeric_limits<CAmount>::max() - note.amount) {
+            return error("%s: overflow on mature amount", __func__);
+        }
+        state.yield_mature_amount += note.amount;
+        return true;
+    }
+
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return true; // No DB (test environment): nothing to bucket
+    }
+
+    const uint32_t nMaturityHeight = GetNoteMaturityHeight(note);
+    CAmount bucket = 0;
+    zkhuDB->ReadMaturityBucket(nMaturityHeight, bucket);
+    if (bucket > std::numeric_limits<CAmount>::max() - note.amount) {
+        return error("%s: overflow on maturity bucket %u", __func__, nMaturityHeight);
+    }
+    return zkhuDB->WriteMaturityBucket(nMaturityHeight, bucket + note.amount);
+}
+
+bool RemoveNoteFromYieldIndex(const ZKHUNoteData& note, HuGlobalState& state)
+{
+    if (note.amount <= 0) {
+        return error("%s: invalid note amount %d", __func__, note.amount);
+    }
+
+    if (IsNoteCounted(note, state)) {
+        if (state.yield_mature_amount < note.amount) {
+            return error("%s: underflow on mature amount (mature=%d, amount=%d)",
+                         __func__, state.yield_mature_amount, note.amount);
+        }
+        state.yield_mature_amount -= note.amount;
+        return true;
+    }
+
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return true;
+    }
+
+    const uint32_t nMaturityHeight = GetNoteMaturityHeight(note);
+    CAmount bucket = 0;
+    if (!zkhuDB->ReadMaturityBucket(nMaturityHeight, bucket) || bucket < note.amount) {
+        return error("%s: maturity bucket %u underflow (bucket=%d, amount=%d)",
+                     __func__, nMaturityHeight, bucket, note.amount);
+    }
+    return zkhuDB->WriteMaturityBucket(nMaturityHeight, bucket - note.amount);
+}
+
+bool GetNoteYield(const ZKHUNoteData& note, const HuGlobalState& state, CAmount& yield)
+{
+    yield = 0;
+    if (!IsNoteCounted(note, state)) {
+        return true; // Not yet reached by any yield epoch
+    }
+
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return error("%s: ZKHU database not initialized", __func__);
+    }
+
+    uint32_t nEpochHeight = 0;
+    ZKHUYieldEpoch epoch;
+    if (!zkhuDB->FindYieldEpoch(GetNoteMaturityHeight(note), nEpochHeight, epoch) ||
+        nEpochHeight > state.last_yield_update_height ||
+        epoch.index_before > state.yield_index) {
+        return error("%s: no yield epoch for note %s (maturity=%u, last=%u)", __func__,
+                     note.cm.GetHex().substr(0, 16), GetNoteMaturityHeight(note), state.last_yield_update_height);
+    }
+
+    const int128_t yield128 = static_cast<int128_t>(note.amount) * (state.yield_index - epoch.index_before) /
+                              YIELD_INDEX_PRECISION;
+    if (yield128 > std::numeric_limits<CAmount>::max()) {
+        return error("%s: overflow (amount=%d)", __func__, note.amount);
+    }
+    yield = static_cast<CAmount>(yield128);
+    return true;
+}
+
+bool CheckYieldIndex(const HuGlobalState& state)
+{
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return true;
+    }
+
+    const int64_t nTimeStart = GetTimeMicros();
+    int128_t unspent = 0;
+    int128_t counted = 0;
+    std::map<uint32_t, CAmount> pending; // maturity height → uncounted principal
+    size_t nNotes = 0;
+
+    bool fDecoded = zkhuDB->IterateNotes([&](const uint256& noteId, const ZKHUNoteData& note) {
+        nNotes++;
+        if (note.bSpent) {
+            return true;
+        }
+        unspent += note.amount;
+        if (IsNoteCounted(note, state)) {
+            counted += note.amount;
+        } else {
+            pending[GetNoteMaturityHeight(note)] += note.amount;
+        }
+        return true;
+    });
+    if (!fDecoded) {
+        return error("%s: failed to decode ZKHU note", __func__);
+    }
+
+    if (unspent != state.Z) {
+        return error("%s: Z=%d does not match unspent notes=%s", __func__,
+                     state.Z, unspent.str());
+    }
+    if (counted != state.yield_mature_amount) {
+        return error("%s: yield_mature_amount=%d does not match counted notes=%s", __func__,
+                     state.yield_mature_amount, counted.str());
+    }
+
+    // Every non-empty bucket must match a pending maturity height, and vice versa
+    size_t nBuckets = 0;
+    bool fBucketsOk = zkhuDB->IterateMaturityBuckets([&](uint32_t nMaturityHeight, const CAmount& amount) {
+        if (nMaturityHeight <= state.last_yield_update_height) {
+            return true; // Already promoted, kept for epoch undo
+        }
+        nBuckets++;
+        auto it = pending.find(nMaturityHeight);
+        if (it == pending.end() || it->second != amount) {
+            return error("%s: maturity bucket %u=%d does not match notes", __func__, nMaturityHeight, amount);
+        }
+        return true;
+    });
+    if (!fBucketsOk || nBuckets != pending.size()) {
+        return error("%s: maturity buckets inconsistent (%u buckets, %u pending heights)", __func__,
+                     nBuckets, pending.size());
+    }
+
+    LogPrint(BCLog::BENCHMARK, "%s: checked %u notes, %u pending maturity heights: %.2fms\n", __func__,
+             nNotes, pending.size(), (GetTimeMicros() - nTimeStart) * 0.001);
+    return true;
+}
+
 } // namespace khu_yield
@@ -10,17 +10,21 @@
 
 #include <stdint.h>
 
+struct ZKHUNoteData;
+
 /**
  * KHU Phase 6.1 — Daily Yield Engine
  *
  * RÈGLES ARCHITECTURALES (consensus-critical):
  * - Aucune note stockée dans HuGlobalState
- * - Lecture streaming LevelDB via curseur (ordre déterministe)
+ * - Accumulateur global: yield_index (yield par satoshi locké, cumulatif)
+ * - Notes groupées par hauteur de maturité (buckets 'K'+'M' dans la DB ZKHU)
  * - Yield pour notes stakées + matures (≥ 4320 blocks)
  * - Intervalle 1440 blocks
- * - Formule: daily = (amount × R_annual / 10000) / 365
+ * - Formule: Δindex = R_annual × PRECISION / 10000 / 365 par epoch
  * - Total yield → Cr += daily_total, Ur += daily_total (invariant Cr==Ur)
- * - Undo par recalcul et soustraction
+ * - Bonus d'une note calculé à l'UNLOCK: amount × (index - index_maturité)
+ * - Coût O(1) par bloc de yield, par UNLOCK et par undo (aucune réécriture de note)
  * - Protection overflow avec int128_t
  */
 
@@ -42,6 +46,9 @@ static constexpr uint32_t MATURITY_BLOCKS_REGTEST = 1260;
 /** Days per year for yield calculation */
 static constexpr uint32_t DAYS_PER_YEAR = 365;
 
+/** Fixed-point precision of HuGlobalState::yield_index (yield per locked satoshi) */
+static constexpr uint64_t YIELD_INDEX_PRECISION = 1000000000000000ULL; // 1e15
+
 /**
  * GetMaturityBlocks - Get network-aware maturity period
  *
@@ -86,13 +93,14 @@ bool ShouldApplyDailyYield(uint32_t nHeight, uint32_t nV6ActivationHeight, uint3
 /**
  * ApplyDailyYield - Apply daily yield to all mature locked notes
  *
- * ALGORITHME CONSENSUS-CRITICAL:
- * 1. Iterate all ZKHU notes via LevelDB cursor (deterministic order)
- * 2. For each note:
- *    - Check maturity: height_current - note.nLockStartHeight >= MATURITY_BLOCKS
- *    - Calculate daily yield: (amount × R_annual / 10000) / 365
- *    - Accumulate total_yield (with overflow protection)
- * 3. Update global state: Cr += total_yield, Ur += total_yield
+ * ALGORITHME CONSENSUS-CRITICAL (accumulator, no per-note rewrite):
+ * 1. Promote maturity buckets with height in (last_yield_update_height, nHeight]
+ *    into state.yield_mature_amount
+ * 2. Record epoch (index_before, promoted amount, R_annual) at nHeight
+ * 3. yield_index += GetYieldIndexIncrement(R_annual)
+ * 4. total_yield = ceil(yield_mature_amount × Δindex / PRECISION)
+ *    (rounded up so that the sum of per-note bonuses never exceeds Cr/Ur)
+ * 5. Update global state: Cr += total_yield, Ur += total_yield
  *    (BOTH must be updated to maintain invariant Cr == Ur)
  *
  * @param state KHU global state (will be modified: Cr += total_yield, Ur += total_yield)
@@ -107,7 +115,8 @@ bool ApplyDailyYield(HuGlobalState& state, uint32_t nHeight, uint32_t nV6Activat
  *
  * ALGORITHME:
  * 1. Use stored yield amount from state.last_yield_amount
- * 2. Subtract from BOTH: Cr -= total_yield, Ur -= total_yield
+ * 2. Restore yield_index / yield_mature_amount from the epoch record and erase it
+ * 3. Subtract from BOTH: Cr -= total_yield, Ur -= total_yield
  *    (BOTH must be updated to maintain invariant Cr == Ur)
  *
  * @param state KHU global state (will be modified: Cr -= total_yield, Ur -= total_yield)
@@ -151,6 +160,73 @@ CAmount CalculateDailyYieldForNote(CAmount amount, uint16_t R_annual);
  */
 bool IsNoteMature(uint32_t noteHeight, uint32_t currentHeight);
 
+/**
+ * GetYieldIndexIncrement - Yield index increment for one daily epoch
+ *
+ * FORMULE CONSENSUS: Δindex = R_annual × YIELD_INDEX_PRECISION / 10000 / 365
+ *
+ * @param R_annual Annual yield rate (basis points)
+ * @return Index increment (yield per locked satoshi × YIELD_INDEX_PRECISION)
+ */
+uint64_t GetYieldIndexIncrement(uint32_t R_annual);
+
+/**
+ * GetNoteMaturityHeight - First height at which a note earns yield
+ *
+ * @return note.nLockStartHeight + GetMaturityBlocks()
+ */
+uint32_t GetNoteMaturityHeight(const ZKHUNoteData& note);
+
+/**
+ * AddNoteToYieldIndex - Register an unspent note with the yield accumulator
+ *
+ * Notes already counted by an epoch (maturity <= last_yield_update_height)
+ * go to state.yield_mature_amount, others to their maturity bucket.
+ * Called by ApplyHULock and UndoKHUUnlock.
+ *
+ * @param note Note being registered
+ * @param state KHU global state (yield_mature_amount may be modified)
+ * @return true on success, false on DB error or overflow
+ */
+bool AddNoteToYieldIndex(const ZKHUNoteData& note, HuGlobalState& state);
+
+/**
+ * RemoveNoteFromYieldIndex - Reverse of AddNoteToYieldIndex
+ *
+ * Called by ApplyHUUnlock and UndoKHULock.
+ */
+bool RemoveNoteFromYieldIndex(const ZKHUNoteData& note, HuGlobalState& state);
+
+/**
+ * GetNoteYield - Yield accrued by an unspent note (UNLOCK bonus)
+ *
+ * FORMULE CONSENSUS:
+ *   bonus = amount × (state.yield_index - epoch.index_before) / PRECISION
+ * where epoch is the first yield epoch at or after the note's maturity height.
+ * Notes not yet counted by any epoch have bonus = 0.
+ *
+ * @param note Note data (from ZKHU DB)
+ * @param state KHU global state at the UNLOCK height
+ * @param yield Output: accrued yield (satoshis)
+ * @return true on success, false on missing epoch or overflow
+ */
+bool GetNoteYield(const ZKHUNoteData& note, const HuGlobalState& state, CAmount& yield);
+
+/**
+ * CheckYieldIndex - Full consistency check of the yield accumulator
+ *
+ * Streams every ZKHU note through a cursor (never materialized) and checks:
+ * - Z == sum of unspent note principal
+ * - yield_mature_amount == principal of unspent notes already counted
+ * - each maturity bucket == principal of uncounted notes maturing there
+ * Memory is bounded by the number of pending maturity heights.
+ * Used by CVerifyDB; not part of block connection.
+ *
+ * @param state KHU global state at the chain tip
+ * @return true if the note set matches the state
+ */
+bool CheckYieldIndex(const HuGlobalState& state);
+
 } // namespace khu_yield
 
 #endif // HU_HU_YIELD_H
@@ -6,17 +6,10 @@
 
 #include "util/system.h"
 
-// ZKHU namespace key prefixes
-static constexpr char DB_ZKHU_ANCHOR = 'A';      // 'K' + 'A' + anchor → SaplingMerkleTree
-static constexpr char DB_ZKHU_NULLIFIER = 'N';  // 'K' + 'N' + nullifier → bool
-static constexpr char DB_ZKHU_NOTE = 'T';       // 'K' + 'T' + note_id → ZKHUNoteData
-static constexpr char DB_ZKHU_LOOKUP = 'L';     // 'K' + 'L' + nullifier → cm
-
-// Master namespace for all ZKHU data
-static constexpr char DB_ZKHU_NAMESPACE = 'K';
+#include <limits>
 
 CZKHUTreeDB::CZKHUTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    CDBWrapper(GetDataDir() / "khu" / "zkhu", nCacheSize, fMemory, fWipe)
+    CKHUTransactionalDB(GetDataDir() / "khu" / "zkhu", nCacheSize, fMemory, fWipe)
 {
 }
 
@@ -85,40 +78,145 @@ bool CZKHUTreeDB::EraseNullifierMapping(const uint256& nullifier)
     return Erase(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_LOOKUP, nullifier)));
 }
 
-// ========== Note Iteration Operations ==========
+// ========== Maturity Bucket Operations ==========
 
-std::vector<std::pair<uint256, ZKHUNoteData>> CZKHUTreeDB::GetAllNotes()
+bool CZKHUTreeDB::WriteMaturityBucket(uint32_t nMaturityHeight, CAmount amount)
 {
-    std::vector<std::pair<uint256, ZKHUNoteData>> result;
+    const auto key = std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_MATURITY, ZKHUHeightKey(nMaturityHeight)));
+    if (amount == 0) {
+        return Erase(key);
+    }
+    return Write(key, amount);
+}
 
-    // Create iterator using CDBWrapper's NewIterator
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+bool CZKHUTreeDB::ReadMaturityBucket(uint32_t nMaturityHeight, CAmount& amount) const
+{
+    amount = 0;
+    return Read(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_MATURITY, ZKHUHeightKey(nMaturityHeight))), amount);
+}
+
+bool CZKHUTreeDB::SumMaturityBuckets(uint32_t nFromHeight, uint32_t nToHeight, CAmount& total)
+{
+    total = 0;
+    if (nToHeight <= nFromHeight) {
+        return true;
+    }
 
-    // Seek to start of note namespace: 'K' + 'T' + zero-hash
-    pcursor->Seek(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_NOTE, uint256())));
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_MATURITY, ZKHUHeightKey(nFromHeight + 1))));
 
     while (pcursor->Valid()) {
-        // Read key
-        std::pair<char, std::pair<char, uint256>> key;
-        if (!pcursor->GetKey(key)) {
+        std::pair<char, std::pair<char, ZKHUHeightKey>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ZKHU_NAMESPACE || key.second.first != DB_ZKHU_MATURITY) {
+            break; // End of maturity buckets
+        }
+        if (key.second.second.nHeight > nToHeight) {
             break;
         }
 
-        // Check if still in ZKHU note namespace ('K' + 'T')
-        if (key.first != DB_ZKHU_NAMESPACE || key.second.first != DB_ZKHU_NOTE) {
-            break; // End of notes
+        CAmount amount = 0;
+        if (!pcursor->GetValue(amount) || amount < 0 ||
+            total > std::numeric_limits<CAmount>::max() - amount) {
+            return error("%s: invalid maturity bucket at height %u", __func__, key.second.second.nHeight);
         }
+        total += amount;
+
+        pcursor->Next();
+    }
+
+    return true;
+}
 
-        const uint256& noteId = key.second.second;
+// ========== Yield Epoch Operations ==========
+
+bool CZKHUTreeDB::WriteYieldEpoch(uint32_t nHeight, const ZKHUYieldEpoch& epoch)
+{
+    return Write(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_EPOCH, ZKHUHeightKey(nHeight))), epoch);
+}
+
+bool CZKHUTreeDB::ReadYieldEpoch(uint32_t nHeight, ZKHUYieldEpoch& epoch) const
+{
+    return Read(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_EPOCH, ZKHUHeightKey(nHeight))), epoch);
+}
+
+bool CZKHUTreeDB::EraseYieldEpoch(uint32_t nHeight)
+{
+    return Erase(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_EPOCH, ZKHUHeightKey(nHeight))));
+}
+
+bool CZKHUTreeDB::FindYieldEpoch(uint32_t nMinHeight, uint32_t& nHeight, ZKHUYieldEpoch& epoch)
+{
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_EPOCH, ZKHUHeightKey(nMinHeight))));
+    if (!pcursor->Valid()) {
+        return false;
+    }
+
+    std::pair<char, std::pair<char, ZKHUHeightKey>> key;
+    if (!pcursor->GetKey(key) || key.first != DB_ZKHU_NAMESPACE || key.second.first != DB_ZKHU_EPOCH) {
+        return false;
+    }
+
+    nHeight = key.second.second.nHeight;
+    return pcursor->GetValue(epoch);
+}
+
+// ========== Commitment Position Index ==========
+
+bool CZKHUTreeDB::WriteNotePosition(const uint256& cm, const ZKHUNotePosition& pos)
+{
+    return Write(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_POSITION, cm)), pos);
+}
+
+bool CZKHUTreeDB::ReadNotePosition(const uint256& cm, ZKHUNotePosition& pos) const
+{
+    return Read(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_POSITION, cm)), pos);
+}
+
+bool CZKHUTreeDB::EraseNotePosition(const uint256& cm)
+{
+    return Erase(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_POSITION, cm)));
+}
+
+bool CZKHUTreeDB::WriteBlockCommitments(uint32_t nHeight, const ZKHUBlockCommitments& cms)
+{
+    return Write(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_BLOCK_CMS, ZKHUHeightKey(nHeight))), cms);
+}
+
+bool CZKHUTreeDB::EraseBlockCommitments(uint32_t nHeight)
+{
+    return Erase(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_BLOCK_CMS, ZKHUHeightKey(nHeight))));
+}
+
+bool CZKHUTreeDB::ReadBlockCommitmentsRange(uint32_t nFromHeight, uint32_t nToHeight, std::vector<ZKHUBlockCommitments>& vBlocks)
+{
+    vBlocks.clear();
+    if (nToHeight < nFromHeight) {
+        return true;
+    }
+
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(DB_ZKHU_BLOCK_CMS, ZKHUHeightKey(nFromHeight))));
+
+    while (pcursor->Valid()) {
+        std::pair<char, std::pair<char, ZKHUHeightKey>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ZKHU_NAMESPACE || key.second.first != DB_ZKHU_BLOCK_CMS) {
+            break; // End of block commitments
+        }
+        if (key.second.second.nHeight > nToHeight) {
+            break;
+        }
 
-        // Read note data
-        ZKHUNoteData noteData;
-        if (pcursor->GetValue(noteData)) {
-            result.emplace_back(noteId, noteData);
+        vBlocks.emplace_back();
+        if (!pcursor->GetValue(vBlocks.back())) {
+            return error("%s: invalid commitment record at height %u", __func__, key.second.second.nHeight);
         }
 
         pcursor->Next();
     }
 
-    return result;
+    return true;
 }
@@ -5,11 +5,63 @@
 #ifndef HU_HU_ZKHU_DB_H
 #define HU_HU_ZKHU_DB_H
 
-#include "dbwrapper.h"
+#include "piv2/piv2_dbtransaction.h"
 #include "piv2/zkpiv2_note.h"
 #include "sapling/incrementalmerkletree.h"
 #include "uint256.h"
 
+#include <memory>
+#include <vector>
+
+// ZKHU namespace key prefixes
+static constexpr char DB_ZKHU_NAMESPACE = 'K';  // Master namespace for all ZKHU data
+static constexpr char DB_ZKHU_ANCHOR = 'A';     // 'K' + 'A' + anchor → SaplingMerkleTree
+static constexpr char DB_ZKHU_NULLIFIER = 'N';  // 'K' + 'N' + nullifier → bool
+static constexpr char DB_ZKHU_NOTE = 'T';       // 'K' + 'T' + note_id → ZKHUNoteData
+static constexpr char DB_ZKHU_LOOKUP = 'L';     // 'K' + 'L' + nullifier → cm
+static constexpr char DB_ZKHU_MATURITY = 'M';   // 'K' + 'M' + height (BE) → CAmount
+static constexpr char DB_ZKHU_EPOCH = 'I';      // 'K' + 'I' + height (BE) → ZKHUYieldEpoch
+static constexpr char DB_ZKHU_POSITION = 'P';   // 'K' + 'P' + cm → ZKHUNotePosition
+static constexpr char DB_ZKHU_BLOCK_CMS = 'C';  // 'K' + 'C' + height (BE) → ZKHUBlockCommitments
+
+/** Height serialized big-endian so that cursor order is numeric order */
+struct ZKHUHeightKey
+{
+    uint32_t nHeight;
+
+    explicit ZKHUHeightKey(uint32_t nHeightIn = 0) : nHeight(nHeightIn) {}
+
+    SERIALIZE_METHODS(ZKHUHeightKey, obj)
+    {
+        READWRITE(Using<BigEndianFormatter<4>>(obj.nHeight));
+    }
+};
+
+/** Position of a ZKHU note in the Sapling commitment tree */
+struct ZKHUNotePosition
+{
+    uint32_t nHeight{0};          // Block containing the note
+    uint64_t nPosition{0};        // Leaf index in the Sapling tree
+    SaplingMerkleTree tree;       // Tree frontier right after the note was appended
+
+    SERIALIZE_METHODS(ZKHUNotePosition, obj)
+    {
+        READWRITE(obj.nHeight, obj.nPosition, obj.tree);
+    }
+};
+
+/** Sapling commitments of one block, in tree order */
+struct ZKHUBlockCommitments
+{
+    uint64_t nStartPosition{0};   // Leaf index of the first commitment
+    std::vector<uint256> vCommitments;
+
+    SERIALIZE_METHODS(ZKHUBlockCommitments, obj)
+    {
+        READWRITE(obj.nStartPosition, obj.vCommitments);
+    }
+};
+
 /**
  * CZKHUTreeDB - ZKHU Database (namespace 'K')
  *
@@ -24,8 +76,14 @@
  * - 'K' + 'N' + nullifier → bool (ZKHU nullifier spent flag)
  * - 'K' + 'T' + note_id → ZKHUNoteData (ZKHU note metadata)
  * - 'K' + 'L' + nullifier → cm (nullifier→commitment mapping for UNLOCK)
+ * - 'K' + 'M' + maturity_height (BE) → CAmount (principal maturing at height)
+ * - 'K' + 'I' + yield_height (BE) → ZKHUYieldEpoch (yield index history)
+ * - 'K' + 'P' + cm → ZKHUNotePosition (Sapling tree position of a ZKHU note)
+ * - 'K' + 'C' + height (BE) → ZKHUBlockCommitments (Sapling commitments of a block)
+ *
+ * Heights in 'M'/'I'/'C' keys are big-endian so that cursor order is numeric.
  */
-class CZKHUTreeDB : public CDBWrapper
+class CZKHUTreeDB : public CKHUTransactionalDB
 {
 public:
     explicit CZKHUTreeDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -64,20 +122,111 @@ public:
     bool EraseNullifierMapping(const uint256& nullifier);
 
     /**
-     * Iterate all ZKHU notes (for yield calculation)
-     * Bug #8 Fix: Uses encapsulated iteration with correct key format
-     * @param func Functor: bool(uint256 noteId, ZKHUNoteData& data) - return false to stop
-     * @return true if iteration completed, false on error
+     * Maturity buckets (yield accumulator engine)
+     * Sum of unspent principal whose maturity height is nMaturityHeight and
+     * which has not yet been promoted into HuGlobalState::yield_mature_amount.
+     * Writing a zero amount erases the bucket.
+     */
+    bool WriteMaturityBucket(uint32_t nMaturityHeight, CAmount amount);
+    bool ReadMaturityBucket(uint32_t nMaturityHeight, CAmount& amount) const;
+
+    /**
+     * Sum all maturity buckets with height in (nFromHeight, nToHeight]
+     * Cost is bounded by the number of distinct maturity heights in range.
+     */
+    bool SumMaturityBuckets(uint32_t nFromHeight, uint32_t nToHeight, CAmount& total);
+
+    /**
+     * Yield epochs (one record per yield height)
+     */
+    bool WriteYieldEpoch(uint32_t nHeight, const ZKHUYieldEpoch& epoch);
+    bool ReadYieldEpoch(uint32_t nHeight, ZKHUYieldEpoch& epoch) const;
+    bool EraseYieldEpoch(uint32_t nHeight);
+
+    /**
+     * Find the first yield epoch at or after nMinHeight (single cursor seek)
+     * @return false if no such epoch exists
+     */
+    bool FindYieldEpoch(uint32_t nMinHeight, uint32_t& nHeight, ZKHUYieldEpoch& epoch);
+
+    /**
+     * Commitment position index (ZKHU witness service, zkpiv2_witness.h)
+     */
+    bool WriteNotePosition(const uint256& cm, const ZKHUNotePosition& pos);
+    bool ReadNotePosition(const uint256& cm, ZKHUNotePosition& pos) const;
+    bool EraseNotePosition(const uint256& cm);
+
+    bool WriteBlockCommitments(uint32_t nHeight, const ZKHUBlockCommitments& cms);
+    bool EraseBlockCommitments(uint32_t nHeight);
+
+    /**
+     * Read the commitment records of the blocks in [nFromHeight, nToHeight]
+     * (single cursor pass, blocks without Sapling outputs have no record)
+     */
+    bool ReadBlockCommitmentsRange(uint32_t nFromHeight, uint32_t nToHeight, std::vector<ZKHUBlockCommitments>& vBlocks);
+
+    /**
+     * Stream all ZKHU notes through a LevelDB cursor (deterministic key order)
+     * Notes are decoded one at a time; the note set is never held in memory.
+     * @param func Functor: bool(const uint256& noteId, const ZKHUNoteData& data) - return false to stop
+     * @return true if iteration completed, false if stopped by func or on a decode error
      */
     template<typename Func>
-    bool IterateNotes(Func func) const;
+    bool IterateNotes(Func func);
 
     /**
-     * Get all ZKHU notes as a vector (convenience function)
-     * Note: Not const because NewIterator() is non-const in CDBWrapper
-     * @return vector of (noteId, noteData) pairs
+     * Stream all maturity buckets in ascending height order
+     * @param func Functor: bool(uint32_t nMaturityHeight, CAmount amount) - return false to stop
      */
-    std::vector<std::pair<uint256, ZKHUNoteData>> GetAllNotes();
+    template<typename Func>
+    bool IterateMaturityBuckets(Func func);
+
+private:
+    /** Typed cursor loop over one 'K' + prefix sub-namespace */
+    template<typename KeyType, typename ValueType, typename Func>
+    bool IteratePrefix(char prefix, const KeyType& start, Func func);
 };
 
+template<typename KeyType, typename ValueType, typename Func>
+bool CZKHUTreeDB::IteratePrefix(char prefix, const KeyType& start, Func func)
+{
+    LOCK(cs);
+    auto pcursor = NewIterator();
+    pcursor->Seek(std::make_pair(DB_ZKHU_NAMESPACE, std::make_pair(prefix, start)));
+
+    while (pcursor->Valid()) {
+        std::pair<char, std::pair<char, KeyType>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ZKHU_NAMESPACE || key.second.first != prefix) {
+            break; // End of sub-namespace
+        }
+
+        ValueType value;
+        if (!pcursor->GetValue(value)) {
+            return false;
+        }
+        if (!func(key.second.second, value)) {
+            return false;
+        }
+
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+template<typename Func>
+bool CZKHUTreeDB::IterateNotes(Func func)
+{
+    return IteratePrefix<uint256, ZKHUNoteData>(DB_ZKHU_NOTE, uint256(), func);
+}
+
+template<typename Func>
+bool CZKHUTreeDB::IterateMaturityBuckets(Func func)
+{
+    return IteratePrefix<ZKHUHeightKey, CAmount>(DB_ZKHU_MATURITY, ZKHUHeightKey(0),
+        [&func](const ZKHUHeightKey& key, const CAmount& amount) {
+            return func(key.nHeight, amount);
+        });
+}
+
 #endif // HU_HU_ZKHU_DB_H
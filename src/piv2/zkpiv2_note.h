@@ -19,14 +19,14 @@
  *
  * RÈGLE CRITIQUE:
  * - Ur_accumulated est PER-NOTE (pas global Ur_at_lock)
- * - Phase 4: Ur_accumulated = 0 (no yield yet)
- * - Phase 5+: Ur_accumulated > 0 (incremented by yield engine)
+ * - Unspent notes: Ur_accumulated = 0 (yield derived from HuGlobalState::yield_index)
+ * - Spent notes: Ur_accumulated = bonus paid at UNLOCK (for exact undo)
  */
 struct ZKHUNoteData
 {
     CAmount  amount;              // KHU amount lockd (satoshis)
     uint32_t nLockStartHeight;   // Lock start height
-    CAmount  Ur_accumulated;      // Phase 4: always 0, Phase 5: per-note yield
+    CAmount  Ur_accumulated;      // Bonus paid at UNLOCK (0 while unspent)
     uint256  nullifier;           // Nullifier of the note
     uint256  cm;                  // Commitment (cmu)
     bool     bSpent;              // True if note was spent via UNLOCK (excludes from yield calc)
@@ -51,4 +51,31 @@ struct ZKHUNoteData
     }
 };
 
+/**
+ * ZKHUYieldEpoch - Record of one daily yield application
+ *
+ * Written at each yield height by the accumulator engine (khu_yield).
+ * A note's bonus is derived at UNLOCK from the delta between the global
+ * yield index and the index_before of the first epoch where it was mature.
+ */
+struct ZKHUYieldEpoch
+{
+    uint64_t index_before;        // Global yield index before this epoch's increment
+    CAmount  promoted_amount;     // Principal that reached maturity for this epoch
+    uint32_t R_annual;            // R% applied at this epoch (basis points)
+
+    ZKHUYieldEpoch()
+        : index_before(0), promoted_amount(0), R_annual(0)
+    {}
+
+    ZKHUYieldEpoch(uint64_t indexIn, CAmount promotedIn, uint32_t rIn)
+        : index_before(indexIn), promoted_amount(promotedIn), R_annual(rIn)
+    {}
+
+    SERIALIZE_METHODS(ZKHUYieldEpoch, obj)
+    {
+        READWRITE(obj.index_before, obj.promoted_amount, obj.R_annual);
+    }
+};
+
 #endif // HU_HU_ZKHU_NOTE_H
@@ -0,0 +1,204 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "piv2/zkpiv2_witness.h"
+
+#include "chain.h"
+#include "chainparams.h"
+#include "coins.h"
+#include "logging.h"
+#include "piv2/piv2_validation.h"
+#include "piv2/zkpiv2_db.h"
+#include "primitives/block.h"
+#include "saltedhasher.h"
+#include "sync.h"
+#include "unordered_lru_cache.h"
+#include "util/system.h"
+
+#include <vector>
+
+namespace {
+
+struct CachedWitness {
+    SaplingWitness witness;
+    int nHeight{0};               // Last block appended
+    uint64_t nNextPosition{0};    // Leaf index of the next commitment to append
+};
+
+Mutex cs_witnessCache;
+unordered_lru_cache<uint256, CachedWitness, StaticSaltedHasher> witnessCache GUARDED_BY(cs_witnessCache){ZKHU_WITNESS_CACHE_SIZE};
+
+bool IsZKHUNoteOutput(const CTransaction& tx, size_t nOutput)
+{
+    // A KHU_LOCK creates its ZKHU note in the first Sapling output (ApplyHULock)
+    return tx.nType == CTransaction::TxType::KHU_LOCK && nOutput == 0;
+}
+
+// Witness right after the note: its frontier plus the rest of its block
+bool StartWitness(CZKHUTreeDB* zkhuDB, const ZKHUNotePosition& pos, CachedWitness& cached)
+{
+    std::vector<ZKHUBlockCommitments> vBlocks;
+    if (!zkhuDB->ReadBlockCommitmentsRange(pos.nHeight, pos.nHeight, vBlocks) || vBlocks.size() != 1) {
+        return error("%s: commitments of block %u not indexed", __func__, pos.nHeight);
+    }
+    const ZKHUBlockCommitments& block = vBlocks[0];
+    if (pos.nPosition < block.nStartPosition || pos.nPosition >= block.nStartPosition + block.vCommitments.size()) {
+        return error("%s: note position %u outside block %u", __func__, pos.nPosition, pos.nHeight);
+    }
+
+    cached.witness = pos.tree.witness();
+    for (size_t i = pos.nPosition - block.nStartPosition + 1; i < block.vCommitments.size(); i++) {
+        cached.witness.append(block.vCommitments[i]);
+    }
+    cached.nHeight = pos.nHeight;
+    cached.nNextPosition = block.nStartPosition + block.vCommitments.size();
+    return true;
+}
+
+// Append the commitments of the blocks in (cached.nHeight, nTipHeight]
+bool AdvanceWitness(CZKHUTreeDB* zkhuDB, int nTipHeight, CachedWitness& cached)
+{
+    if (cached.nHeight >= nTipHeight) {
+        return true;
+    }
+
+    // Read under the DB lock, hash outside of it
+    std::vector<ZKHUBlockCommitments> vBlocks;
+    if (!zkhuDB->ReadBlockCommitmentsRange(cached.nHeight + 1, nTipHeight, vBlocks)) {
+        return false;
+    }
+    for (const ZKHUBlockCommitments& block : vBlocks) {
+        if (block.nStartPosition != cached.nNextPosition) {
+            return error("%s: commitment index gap (expected position %u, got %u)",
+                         __func__, cached.nNextPosition, block.nStartPosition);
+        }
+        for (const uint256& cmu : block.vCommitments) {
+            cached.witness.append(cmu);
+        }
+        cached.nNextPosition += block.vCommitments.size();
+    }
+    cached.nHeight = nTipHeight;
+    return true;
+}
+
+} // namespace
+
+bool IndexZKHUCommitments(const CBlock& block, const CBlockIndex* pindex, const CCoinsViewCache& view)
+{
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB || !pindex->pprev) {
+        return true;
+    }
+
+    ZKHUBlockCommitments cms;
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsShieldedTx() || !tx->sapData) continue;
+        for (const OutputDescription& output : tx->sapData->vShieldedOutput) {
+            cms.vCommitments.push_back(output.cmu);
+        }
+    }
+    if (cms.vCommitments.empty()) {
+        return true;
+    }
+
+    // Sapling tree before this block (same anchor DisconnectBlock restores)
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const uint256 prevRoot = consensus.NetworkUpgradeActive(pindex->pprev->nHeight, Consensus::UPGRADE_V5_0) ?
+                             pindex->pprev->hashFinalSaplingRoot : SaplingMerkleTree::empty_root();
+    SaplingMerkleTree tree;
+    if (!view.GetSaplingAnchorAt(prevRoot, tree)) {
+        // Not a block validity matter: the notes of this block are served by the RPC fallback
+        LogPrintf("%s: Sapling anchor %s of block %d not found, block %d not indexed\n",
+                  __func__, prevRoot.ToString(), pindex->pprev->nHeight, pindex->nHeight);
+        return true;
+    }
+    cms.nStartPosition = tree.size();
+
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsShieldedTx() || !tx->sapData) continue;
+        for (size_t i = 0; i < tx->sapData->vShieldedOutput.size(); i++) {
+            const uint256& cmu = tx->sapData->vShieldedOutput[i].cmu;
+            tree.append(cmu);
+            if (!IsZKHUNoteOutput(*tx, i)) continue;
+
+            ZKHUNotePosition pos;
+            pos.nHeight = pindex->nHeight;
+            pos.nPosition = tree.size() - 1;
+            pos.tree = tree;
+            if (!zkhuDB->WriteNotePosition(cmu, pos)) {
+                return error("%s: failed to write position of note %s", __func__, cmu.ToString());
+            }
+            LogPrint(BCLog::HU, "%s: ZKHU note %s at position %u (height %d)\n",
+                     __func__, cmu.ToString().substr(0, 16), pos.nPosition, pindex->nHeight);
+        }
+    }
+
+    return zkhuDB->WriteBlockCommitments(pindex->nHeight, cms);
+}
+
+bool UnindexZKHUCommitments(const CBlock& block, int nHeight)
+{
+    ClearZKHUWitnessCache();
+
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return true;
+    }
+
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsShieldedTx() || !tx->sapData) continue;
+        for (size_t i = 0; i < tx->sapData->vShieldedOutput.size(); i++) {
+            if (IsZKHUNoteOutput(*tx, i) && !zkhuDB->EraseNotePosition(tx->sapData->vShieldedOutput[i].cmu)) {
+                return false;
+            }
+        }
+    }
+
+    return zkhuDB->EraseBlockCommitments(nHeight);
+}
+
+bool GetZKHUNoteWitness(const uint256& cm, int nTipHeight, const uint256& expectedRoot, SaplingWitness& witnessOut)
+{
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    if (!zkhuDB) {
+        return false;
+    }
+
+    ZKHUNotePosition pos;
+    if (!zkhuDB->ReadNotePosition(cm, pos) || (int)pos.nHeight > nTipHeight) {
+        return false;
+    }
+
+    CachedWitness cached;
+    bool fCached = WITH_LOCK(cs_witnessCache, return witnessCache.get(cm, cached)) && cached.nHeight <= nTipHeight;
+
+    // A cached witness that followed a block which was not accepted in the
+    // end gives the wrong root: start once more from the note
+    for (int nTry = 0; nTry < 2; nTry++) {
+        if (!fCached && !StartWitness(zkhuDB, pos, cached)) {
+            return false;
+        }
+        if (!AdvanceWitness(zkhuDB, nTipHeight, cached)) {
+            return false;
+        }
+        if (cached.witness.root() == expectedRoot) {
+            WITH_LOCK(cs_witnessCache, witnessCache.insert(cm, cached));
+            witnessOut = cached.witness;
+            return true;
+        }
+        if (!fCached) {
+            break;
+        }
+        fCached = false;
+    }
+
+    WITH_LOCK(cs_witnessCache, witnessCache.erase(cm));
+    return error("%s: witness root of note %s does not match block %d", __func__, cm.ToString(), nTipHeight);
+}
+
+void ClearZKHUWitnessCache()
+{
+    LOCK(cs_witnessCache);
+    witnessCache.clear();
+}
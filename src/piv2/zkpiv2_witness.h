@@ -0,0 +1,64 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HU_HU_ZKHU_WITNESS_H
+#define HU_HU_ZKHU_WITNESS_H
+
+#include "sapling/incrementalmerkletree.h"
+#include "uint256.h"
+
+#include <stddef.h>
+
+class CBlock;
+class CBlockIndex;
+class CCoinsViewCache;
+
+/**
+ * ZKHU witness service
+ *
+ * Every connected KHU block records its Sapling commitments in the ZKHU DB,
+ * together with the tree position (and tree frontier) of each ZKHU note it
+ * creates. A witness for a note is then its frontier plus the commitments of
+ * the following blocks, all read from the ZKHU DB: no block is read from
+ * disk and cs_main is not needed.
+ *
+ * Served witnesses are cached and advanced from the height they were last
+ * served at, the same way the wallet's IncrementNoteWitnesses follows the
+ * chain. The cache is dropped on every disconnected block.
+ */
+
+/** Number of ZKHU note witnesses kept between requests */
+static const size_t ZKHU_WITNESS_CACHE_SIZE = 1000;
+
+/**
+ * Record the Sapling commitments of a connected block and the position of
+ * its ZKHU notes (KHU_LOCK outputs). Writes go to the block's KHU DB
+ * transaction.
+ * @param view - coins view of the block (Sapling anchors)
+ */
+bool IndexZKHUCommitments(const CBlock& block, const CBlockIndex* pindex, const CCoinsViewCache& view);
+
+/**
+ * Erase the records of a disconnected block
+ */
+bool UnindexZKHUCommitments(const CBlock& block, int nHeight);
+
+/**
+ * Witness of a ZKHU note against the Sapling tree at nTipHeight
+ *
+ * @param cm - note commitment
+ * @param nTipHeight - height the witness must be advanced to
+ * @param expectedRoot - Sapling root of the block at nTipHeight
+ * @param witnessOut - witness whose root() is expectedRoot
+ * @return false if the note is not indexed (confirmed before the index
+ *         existed) or the index does not reach nTipHeight
+ */
+bool GetZKHUNoteWitness(const uint256& cm, int nTipHeight, const uint256& expectedRoot, SaplingWitness& witnessOut);
+
+/**
+ * Drop every cached witness (reorg)
+ */
+void ClearZKHUWitnessCache();
+
+#endif // HU_HU_ZKHU_WITNESS_H
@@ -11,6 +11,7 @@
 #include "keystore.h"
 #include "serialize.h"
 #include "uint256.h"
+#include "version.h"
 
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
@@ -23,7 +24,7 @@ class CBlockHeader
 {
 public:
     // header
-    static const int32_t CURRENT_VERSION=11;    // since v5.2.99
+    static const int32_t CURRENT_VERSION=12;    // since DMM finality certificates
     int32_t nVersion;
     uint256 hashPrevBlock;
     uint256 hashMerkleRoot;
@@ -76,6 +77,33 @@ public:
 };
 
 
+/** Block version since which blocks carry a finality certificate for their parent */
+static const int32_t FINALITY_CERT_BLOCK_VERSION = 12;
+
+/**
+ * DMM: HU quorum signatures on the previous block, so that a syncing node can
+ * establish its finality from block data alone. Like the producer signature it
+ * is not covered by the block hash: it is checked against the quorum of the
+ * previous block and only feeds the finality handler, a missing or bad
+ * certificate never makes the block invalid.
+ */
+class CBlockFinalityCert
+{
+public:
+    uint64_t nSigners{0};                           // bit i set: i-th quorum member signed
+    std::vector<std::vector<unsigned char>> vSigs;  // signatures, in the order of the set bits
+
+    void SetNull()
+    {
+        nSigners = 0;
+        vSigs.clear();
+    }
+
+    bool IsNull() const { return nSigners == 0 && vSigs.empty(); }
+
+    SERIALIZE_METHODS(CBlockFinalityCert, obj) { READWRITE(obj.nSigners, obj.vSigs); }
+};
+
 class CBlock : public CBlockHeader
 {
 public:
@@ -85,6 +113,9 @@ public:
     // ppcoin: block signature - signed by one of the coin base txout[N]'s owner
     std::vector<unsigned char> vchBlockSig;
 
+    // DMM: finality certificate of the previous block (version 12+)
+    CBlockFinalityCert finalityCert;
+
     // memory only
     mutable bool fChecked{false};
 
@@ -104,6 +135,9 @@ public:
         READWRITEAS(CBlockHeader, obj);
         READWRITE(obj.vtx);
         READWRITE(obj.vchBlockSig);  // DMM: MN block signature
+        // Peers from before FINALITY_CERT_VERSION neither send nor expect it
+        if (obj.nVersion >= FINALITY_CERT_BLOCK_VERSION && s.GetVersion() >= FINALITY_CERT_VERSION)
+            READWRITE(obj.finalityCert);
     }
 
     void SetNull()
@@ -112,6 +146,7 @@ public:
         vtx.clear();
         fChecked = false;
         vchBlockSig.clear();
+        finalityCert.SetNull();
     }
 
     CBlockHeader GetBlockHeader() const
@@ -219,6 +219,32 @@ extern const char* FILTERCLEAR;
  * @see https://bitcoin.org/en/developer-reference#sendheaders
  */
 extern const char* SENDHEADERS;
+/**
+ * Contains a 1-byte bool and 8-byte LE version number.
+ * Indicates that a node is willing to provide blocks via "cmpctblock" messages.
+ * May indicate that a node prefers to receive new block announcements via a
+ * "cmpctblock" message rather than an "inv", depending on message contents.
+ * @since protocol version SHORT_IDS_BLOCKS_VERSION, as described by BIP152.
+ */
+extern const char* SENDCMPCT;
+/**
+ * Contains a CBlockHeaderAndShortTxIDs object - providing a header, the
+ * producer signature and a list of "short txids".
+ * @since protocol version SHORT_IDS_BLOCKS_VERSION, as described by BIP152.
+ */
+extern const char* CMPCTBLOCK;
+/**
+ * Contains a BlockTransactionsRequest
+ * Peer should respond with "blocktxn" message.
+ * @since protocol version SHORT_IDS_BLOCKS_VERSION, as described by BIP152.
+ */
+extern const char* GETBLOCKTXN;
+/**
+ * Contains a BlockTransactions.
+ * Sent in response to a "getblocktxn" message.
+ * @since protocol version SHORT_IDS_BLOCKS_VERSION, as described by BIP152.
+ */
+extern const char* BLOCKTXN;
 /**
  * The spork message is used to send spork values to connected
  * peers
@@ -446,7 +472,9 @@ enum GetDataMsg {
     MSG_CLSIG,                    // Deprecated
     // PIVHU: New HU finality message type
     MSG_HU_SIGNATURE,             // HU finality signature (ECDSA, 8/12 quorum)
-    MSG_TYPE_MAX = MSG_HU_SIGNATURE,
+    // Defined in BIP152, only used in getdata (never in inv)
+    MSG_CMPCT_BLOCK,
+    MSG_TYPE_MAX = MSG_CMPCT_BLOCK,
 };
 
 /** inv message data */
@@ -185,6 +185,29 @@ bool CPubKey::Verify(const uint256& hash, const std::vector<unsigned char>& vchS
     return secp256k1_ecdsa_verify(secp256k1_context_verify, &sig, hash.begin(), &pubkey);
 }
 
+bool CPubKey::VerifyCompact(const uint256& hash, const std::vector<unsigned char>& vchSig) const
+{
+    if (!IsValid() || vchSig.size() != COMPACT_SIGNATURE_SIZE)
+        return false;
+    int recid = (vchSig[0] - 27) & 3;
+    bool fComp = ((vchSig[0] - 27) & 4) != 0;
+    if (fComp != IsCompressed())
+        return false;
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_recoverable_signature rsig;
+    secp256k1_ecdsa_signature sig;
+    assert(secp256k1_context_verify && "secp256k1_context_verify must be initialized to use CPubKey.");
+    if (!secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkey, vch, size())) {
+        return false;
+    }
+    if (!secp256k1_ecdsa_recoverable_signature_parse_compact(secp256k1_context_verify, &rsig, &vchSig[1], recid)) {
+        return false;
+    }
+    secp256k1_ecdsa_recoverable_signature_convert(secp256k1_context_verify, &sig, &rsig);
+    secp256k1_ecdsa_signature_normalize(secp256k1_context_verify, &sig, &sig);
+    return secp256k1_ecdsa_verify(secp256k1_context_verify, &sig, hash.begin(), &pubkey);
+}
+
 bool CPubKey::RecoverCompact(const uint256& hash, const std::vector<unsigned char>& vchSig)
 {
     if (vchSig.size() != COMPACT_SIGNATURE_SIZE)
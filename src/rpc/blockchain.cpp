@@ -703,15 +703,15 @@ UniValue getsupplyinfo(const JSONRPCRequest& request)
     if (request.fHelp || request.params.size() > 1)
         throw std::runtime_error(
             "getsupplyinfo ( force_update )\n"
-            "\nIf force_update=false (default if no argument is given): return the last cached money supply"
-            "\n(sum of spendable transaction outputs) and the height of the chain when it was last updated"
-            "\n(it is updated periodically, whenever the chainstate is flushed)."
+            "\nIf force_update=false (default if no argument is given): return the money supply"
+            "\n(sum of spendable transaction outputs) at the current chain height. It is maintained as"
+            "\nblocks are connected and disconnected."
             "\n"
-            "\nIf force_update=true: Flush the chainstate to disk and return the money supply updated to"
-            "\nthe current chain height.\n"
+            "\nIf force_update=true: check the money supply against a full scan of the UTXO set (this"
+            "\ncan take a while; block processing is not stopped during the scan) and correct it.\n"
 
             "\nArguments:\n"
-            "1. force_update       (boolean, optional, default=false) flush chainstate to disk and update cache\n"
+            "1. force_update       (boolean, optional, default=false) recompute the supply from the UTXO set\n"
 
             "\nResult:\n"
             "{\n"
@@ -728,8 +728,9 @@ UniValue getsupplyinfo(const JSONRPCRequest& request)
     const bool fForceUpdate = request.params.size() > 0 ? request.params[0].get_bool() : false;
 
     if (fForceUpdate) {
-        // Flush state to disk (which updates the cached supply)
-        FlushStateToDisk();
+        VerifyMoneySupply();
+    } else if (!MoneySupply.IsValid()) {
+        throw JSONRPCError(RPC_IN_WARMUP, "Money supply is being computed from the UTXO set");
     }
 
     UniValue ret(UniValue::VOBJ);
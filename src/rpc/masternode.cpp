@@ -259,6 +259,66 @@ UniValue getmasternodestatus(const JSONRPCRequest& request)
     return mnObj;
 }
 
+static UniValue DMMLatencyToJson(const CDMMLatencyHistogram& hist)
+{
+    UniValue buckets(UniValue::VOBJ);
+    for (size_t i = 0; i < hist.vCounts.size(); i++) {
+        const std::string strBucket = i < DMM_LATENCY_BUCKETS_MS.size() ?
+                                      strprintf("le_%d", DMM_LATENCY_BUCKETS_MS[i]) : "inf";
+        buckets.pushKV(strBucket, (int64_t)hist.vCounts[i]);
+    }
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("count", (int64_t)hist.nCount);
+    obj.pushKV("avg_ms", hist.nCount ? (double)hist.nTotalMs / hist.nCount : 0.0);
+    obj.pushKV("max_ms", hist.nMaxMs);
+    obj.pushKV("buckets", buckets);
+    return obj;
+}
+
+UniValue getdmmschedulerstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || (request.params.size() != 0))
+        throw std::runtime_error(
+            "getdmmschedulerstats\n"
+            "\nReturns the block producer scheduler statistics of the local masternode.\n"
+            "Latencies are measured from the opening of the local masternode's producer slot.\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"wakeups\": n,              (numeric) Scheduler evaluations (tip, finality or deadline)\n"
+            "  \"blocks_produced\": n,      (numeric) Blocks produced and accepted locally\n"
+            "  \"templates_prepared\": n,   (numeric) Block templates pre-assembled before a slot\n"
+            "  \"templates_used\": n,       (numeric) Pre-assembled templates used at the slot\n"
+            "  \"wake\": {                  (object) Slot open -> production started\n"
+            "    \"count\": n,              (numeric) Samples\n"
+            "    \"avg_ms\": x.xx,          (numeric) Average latency (ms)\n"
+            "    \"max_ms\": n,             (numeric) Maximum latency (ms)\n"
+            "    \"buckets\": { \"le_10\": n, ..., \"inf\": n }  (object) Histogram\n"
+            "  },\n"
+            "  \"submit\": { ... }          (object) Slot open -> block accepted locally, same fields\n"
+            "}\n"
+
+            "\nExamples:\n" +
+            HelpExampleCli("getdmmschedulerstats", "") + HelpExampleRpc("getdmmschedulerstats", ""));
+
+    if (!fMasterNode)
+        throw JSONRPCError(RPC_MISC_ERROR, _("This is not a masternode."));
+
+    if (!activeMasternodeManager) {
+        throw JSONRPCError(RPC_MISC_ERROR, _("Active Masternode not initialized."));
+    }
+
+    const CDMMSchedulerStats stats = activeMasternodeManager->GetDMMSchedulerStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("wakeups", (int64_t)stats.nWakeups);
+    obj.pushKV("blocks_produced", (int64_t)stats.nBlocksProduced);
+    obj.pushKV("templates_prepared", (int64_t)stats.nTemplatesPrepared);
+    obj.pushKV("templates_used", (int64_t)stats.nTemplatesUsed);
+    obj.pushKV("wake", DMMLatencyToJson(stats.wake));
+    obj.pushKV("submit", DMMLatencyToJson(stats.submit));
+    return obj;
+}
+
 // clang-format off
 // PIV2-Core: Only DMN/DIP3 compatible RPC commands
 // Legacy masternode commands removed (startmasternode, createmasternodebroadcast, etc.)
@@ -268,6 +328,7 @@ static const CRPCCommand commands[] =
   //  --------------------- ---------------------------  --------------------------  ------ --------
     { "masternode",         "getmasternodecount",        &getmasternodecount,        true,  {} },
     { "masternode",         "getmasternodestatus",       &getmasternodestatus,       true,  {} },
+    { "masternode",         "getdmmschedulerstats",      &getdmmschedulerstats,      true,  {} },
     { "masternode",         "initmasternode",            &initmasternode,            true,  {"privkey","address"} },
     { "masternode",         "listmasternodes",           &listmasternodes,           true,  {"filter"} },
 
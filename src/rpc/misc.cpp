@@ -9,6 +9,7 @@
 #include "httpserver.h"
 #include "key_io.h"
 #include "sapling/key_io_sapling.h"
+#include "sapling/sapling_proofcache.h"
 #include "messagesigner.h"
 #include "net.h"
 #include "netbase.h"
@@ -705,6 +706,16 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCShieldedProofCacheInfo()
+{
+    ShieldedProofCacheStats stats = GetShieldedProofCacheStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("elements", uint64_t(stats.nElems));
+    obj.pushKV("hits", stats.nHits);
+    obj.pushKV("misses", stats.nMisses);
+    return obj;
+}
+
 UniValue getmemoryinfo(const JSONRPCRequest& request)
 {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
@@ -723,6 +734,11 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"shieldedproofcache\": {   (json object) Cache of verified Sapling proofs\n"
+            "    \"elements\": xxxxx,      (numeric) Number of entries the cache can hold\n"
+            "    \"hits\": xxxxx,          (numeric) Proof checks skipped since startup\n"
+            "    \"misses\": xxxxx,        (numeric) Proof checks performed since startup\n"
             "  }\n"
             "}\n"
             "\nExamples:\n"
@@ -731,6 +747,7 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
         );
     UniValue obj(UniValue::VOBJ);
     obj.pushKV("locked", RPCLockedMemoryInfo());
+    obj.pushKV("shieldedproofcache", RPCShieldedProofCacheInfo());
     return obj;
 }
 
@@ -409,6 +409,16 @@ UniValue getnetworkinfo(const JSONRPCRequest& request)
             "  ],\n"
             "  \"relayfee\": x.xxxxxxxx,                (numeric) minimum relay fee for transactions in " + CURRENCY_UNIT + "/kB\n"
             "  \"incrementalfee\": x.xxxxxxxx,          (numeric) minimum fee increment for mempool limiting or BIP 125 replacement in " + CURRENCY_UNIT + "/kB\n"
+            "  \"messagelanes\": [                      (array) message processing lanes\n"
+            "  {\n"
+            "    \"name\": \"xxx\",                     (string) lane (priority or general)\n"
+            "    \"queued\": xxx,                       (numeric) messages waiting to be processed\n"
+            "    \"processed\": xxx,                    (numeric) messages processed since startup\n"
+            "    \"avglatency\": xxx,                   (numeric) average time from receipt to processing, in microseconds\n"
+            "    \"maxlatency\": xxx                    (numeric) largest time from receipt to processing, in microseconds\n"
+            "  }\n"
+            "  ,...\n"
+            "  ],\n"
             "  \"localaddresses\": [                    (array) list of local addresses\n"
             "  {\n"
             "    \"address\": \"xxxx\",                 (string) network address\n"
@@ -437,6 +447,20 @@ UniValue getnetworkinfo(const JSONRPCRequest& request)
     }
     obj.pushKV("networks", GetNetworksInfo());
     obj.pushKV("relayfee", ValueFromAmount(::minRelayTxFee.GetFeePerK()));
+    if (g_connman) {
+        UniValue lanes(UniValue::VARR);
+        for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+            const CMsgLaneStats stats = g_connman->GetMsgLaneStats((MsgLane)lane);
+            UniValue rec(UniValue::VOBJ);
+            rec.pushKV("name", GetMsgLaneName((MsgLane)lane));
+            rec.pushKV("queued", stats.nQueued);
+            rec.pushKV("processed", stats.nProcessed);
+            rec.pushKV("avglatency", stats.nProcessed ? stats.nLatencyTotal / (int64_t)stats.nProcessed : 0);
+            rec.pushKV("maxlatency", stats.nLatencyMax);
+            lanes.push_back(rec);
+        }
+        obj.pushKV("messagelanes", lanes);
+    }
     UniValue localAddresses(UniValue::VARR);
     {
         LOCK(cs_mapLocalHost);
@@ -14,6 +14,7 @@
 #include "piv2/piv2_domc.h"
 #include "piv2/piv2_domc_tx.h"
 #include "piv2/piv2_domcdb.h"
+#include "piv2/piv2_signaling.h"
 #include "piv2/piv2_state.h"
 #include "masternodeman.h"
 #include "primitives/transaction.h"
@@ -79,6 +80,8 @@ static UniValue getkhustate(const JSONRPCRequest& request)
             "  \"R_next_pct\": x.xx,    (numeric) Next R% (percentage)\n"
             "  \"R_MAX_dynamic\": n,    (numeric) Maximum R% allowed by DOMC (decreases yearly)\n"
             "  \"last_yield_update_height\": n, (numeric) Last yield update block\n"
+            "  \"yield_index\": n,      (numeric) Cumulative yield per locked satoshi (x 1e15)\n"
+            "  \"yield_mature_amount\": n, (numeric) Locked principal currently earning yield\n"
             "  \"domc_cycle_start\": n, (numeric) Current DOMC cycle start\n"
             "  \"invariants_ok\": true|false,  (boolean) Are invariants satisfied (C=U+Z, Cr=Ur)?\n"
             "  \"hashState\": \"hash\",   (string) Hash of this state\n"
@@ -124,6 +127,8 @@ static UniValue getkhustate(const JSONRPCRequest& request)
     result.pushKV("R_next_pct", state.R_next / 100.0);
     result.pushKV("R_MAX_dynamic", (int64_t)state.R_MAX_dynamic);
     result.pushKV("last_yield_update_height", (int64_t)state.last_yield_update_height);
+    result.pushKV("yield_index", (uint64_t)state.yield_index);
+    result.pushKV("yield_mature_amount", ValueFromAmount(state.yield_mature_amount));
     result.pushKV("domc_cycle_start", (int64_t)state.domc_cycle_start);
     result.pushKV("domc_cycle_length", (int64_t)state.domc_cycle_length);
     result.pushKV("domc_commit_phase_start", (int64_t)state.domc_commit_phase_start);
@@ -577,6 +582,84 @@ static UniValue khudaoinfo(const JSONRPCRequest& request)
     return result;
 }
 
+static UniValue HuSigStageToJSON(const hu::CHuSigStageStats& stage)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("count", (int64_t)stage.nCount);
+    obj.pushKV("avg_us", stage.AverageMicros());
+    obj.pushKV("max_us", stage.nMaxMicros);
+    return obj;
+}
+
+/**
+ * gethusigstats - HU finality signature verification pipeline statistics
+ *
+ * Each received signature goes through: queue (message handler -> worker),
+ * quorum (block lookup + cached quorum membership), verify (ECDSA against the
+ * operator key) and accept (finality handler + relay).
+ */
+static UniValue gethusigstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0) {
+        throw std::runtime_error(
+            "gethusigstats\n"
+            "\nReturns counters and per-stage latencies of the HU finality signature verification pipeline.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"threads\": n,               (numeric) Verification threads (0 = message handler thread)\n"
+            "  \"queue_size\": n,            (numeric) Signatures waiting for verification\n"
+            "  \"accepted\": n,              (numeric) Valid new signatures\n"
+            "  \"rejected\": n,              (numeric) Signatures of unknown blocks, non-members or invalid\n"
+            "  \"dropped\": n,               (numeric) Signatures dropped because the queue was full\n"
+            "  \"quorum_cache_hits\": n,     (numeric) Quorum lookups served from the cache\n"
+            "  \"quorum_cache_misses\": n,   (numeric) Quorums computed from the MN list\n"
+            "  \"relay_pushed\": n,          (numeric) Signatures sent in full (quorum members, old peers)\n"
+            "  \"relay_announced\": n,       (numeric) Signatures announced with an inv\n"
+            "  \"cert_queue_size\": n,       (numeric) Block finality certificates waiting for verification\n"
+            "  \"certs_accepted\": n,        (numeric) Valid block finality certificates\n"
+            "  \"certs_rejected\": n,        (numeric) Invalid certificates, or of blocks without a quorum\n"
+            "  \"stages\": {                 (object) Latency of each stage\n"
+            "    \"queue\"|\"quorum\"|\"verify\"|\"accept\": {\n"
+            "      \"count\": n,             (numeric) Signatures timed\n"
+            "      \"avg_us\": x.xx,         (numeric) Average latency (microseconds)\n"
+            "      \"max_us\": n             (numeric) Maximum latency (microseconds)\n"
+            "    }, ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("gethusigstats", "")
+            + HelpExampleRpc("gethusigstats", "")
+        );
+    }
+
+    if (!hu::huSignalingManager) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "HU signaling not initialized");
+    }
+    const hu::CHuSigStats stats = hu::huSignalingManager->GetStats();
+
+    UniValue stages(UniValue::VOBJ);
+    stages.pushKV("queue", HuSigStageToJSON(stats.queueWait));
+    stages.pushKV("quorum", HuSigStageToJSON(stats.quorum));
+    stages.pushKV("verify", HuSigStageToJSON(stats.verify));
+    stages.pushKV("accept", HuSigStageToJSON(stats.accept));
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("threads", stats.nThreads);
+    result.pushKV("queue_size", (int64_t)stats.nQueueSize);
+    result.pushKV("accepted", (int64_t)stats.nAccepted);
+    result.pushKV("rejected", (int64_t)stats.nRejected);
+    result.pushKV("dropped", (int64_t)stats.nDropped);
+    result.pushKV("quorum_cache_hits", (int64_t)stats.nQuorumCacheHits);
+    result.pushKV("quorum_cache_misses", (int64_t)stats.nQuorumCacheMisses);
+    result.pushKV("relay_pushed", (int64_t)stats.nRelayPushed);
+    result.pushKV("relay_announced", (int64_t)stats.nRelayAnnounced);
+    result.pushKV("cert_queue_size", (int64_t)stats.nCertQueueSize);
+    result.pushKV("certs_accepted", (int64_t)stats.nCertsAccepted);
+    result.pushKV("certs_rejected", (int64_t)stats.nCertsRejected);
+    result.pushKV("stages", stages);
+    return result;
+}
+
 // ============================================================================
 // RPC Command Registration
 // ============================================================================
@@ -602,6 +685,8 @@ static const CRPCCommand commands[] = {
     { "piv2",         "domcreveal",             &domcreveal,                false,  {"R_proposal", "salt", "mn_outpoint"} },
     // DAO Treasury info (integrates with existing budget system)
     { "piv2",         "getdaoinfo",             &khudaoinfo,                true,   {} },
+    // HU finality signatures
+    { "piv2",         "gethusigstats",          &gethusigstats,             true,   {} },
 };
 
 void RegisterHURPCCommands(CRPCTable& t)
@@ -119,7 +119,8 @@ Optional<SaplingNotePlaintext> SaplingNotePlaintext::decrypt(
     const uint256& cmu
 )
 {
-    auto pt = AttemptSaplingEncDecryption(ciphertext, ivk, epk);
+    // Any other lead byte fails to deserialize below: reject it early
+    auto pt = TrialSaplingEncDecryption(ciphertext, ivk, epk, 0x01);
     if (!pt) {
         return nullopt;
     }
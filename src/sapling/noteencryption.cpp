@@ -160,10 +160,11 @@ Optional<SaplingEncCiphertext> SaplingNoteEncryption::encrypt_to_recipient(
     return ciphertext;
 }
 
-Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
+static Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
     const SaplingEncCiphertext &ciphertext,
     const uint256 &ivk,
-    const uint256 &epk
+    const uint256 &epk,
+    const unsigned char* pLeadByte
 )
 {
     uint256 dhsecret;
@@ -179,6 +180,18 @@ Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
     // The nonce is zero because we never reuse keys
     unsigned char cipher_nonce[crypto_aead_chacha20poly1305_IETF_NPUBBYTES] = {};
 
+    // With the wrong ivk the lead byte is random. Decrypting it alone takes
+    // one ChaCha20 block (the message starts at block 1, block 0 keys
+    // Poly1305) and rejects 255/256 of the wrong keys before the tag is
+    // computed over the whole ciphertext.
+    if (pLeadByte) {
+        unsigned char leadByte;
+        crypto_stream_chacha20_ietf_xor_ic(&leadByte, ciphertext.begin(), 1, cipher_nonce, 1, K);
+        if (leadByte != *pLeadByte) {
+            return nullopt;
+        }
+    }
+
     SaplingEncPlaintext plaintext;
 
     if (crypto_aead_chacha20poly1305_ietf_decrypt(
@@ -195,6 +208,25 @@ Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
     return plaintext;
 }
 
+Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
+    const SaplingEncCiphertext &ciphertext,
+    const uint256 &ivk,
+    const uint256 &epk
+)
+{
+    return AttemptSaplingEncDecryption(ciphertext, ivk, epk, nullptr);
+}
+
+Optional<SaplingEncPlaintext> TrialSaplingEncDecryption(
+    const SaplingEncCiphertext &ciphertext,
+    const uint256 &ivk,
+    const uint256 &epk,
+    unsigned char leadByte
+)
+{
+    return AttemptSaplingEncDecryption(ciphertext, ivk, epk, &leadByte);
+}
+
 Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption (
     const SaplingEncCiphertext &ciphertext,
     const uint256 &epk,
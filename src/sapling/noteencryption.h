@@ -76,6 +76,16 @@ Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption(
     const uint256 &epk
 );
 
+// Like AttemptSaplingEncDecryption, but rejects the ciphertext early when
+// the first byte of the plaintext is not leadByte. Meant for trial
+// decryption with the wallet's ivks, where almost every attempt fails.
+Optional<SaplingEncPlaintext> TrialSaplingEncDecryption(
+    const SaplingEncCiphertext &ciphertext,
+    const uint256 &ivk,
+    const uint256 &epk,
+    unsigned char leadByte
+);
+
 // Attempts to decrypt a Sapling note using outgoing plaintext.
 // This will not check that the contents of the ciphertext are correct.
 Optional<SaplingEncPlaintext> AttemptSaplingEncDecryption (
@@ -0,0 +1,125 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sapling/sapling_proofcache.h"
+
+#include "crypto/sha256.h"
+#include "cuckoocache.h"
+#include "primitives/transaction.h"
+#include "random.h"
+#include "script/sigcache.h" // for SignatureCacheHasher
+#include "util/system.h"
+
+#include <atomic>
+
+#include <boost/thread/shared_mutex.hpp>
+
+namespace {
+/**
+ * Valid Sapling bundle cache.
+ *
+ * Entries are SHA256(nonce || txid || Sapling signature hash). The txid
+ * commits to every spend and output description and to the binding
+ * signature, so the proof data does not need hashing a second time.
+ *
+ * Unlike the signature cache, block validation does not erase the entries
+ * it hits: a block producer checks its own block in TestBlockValidity right
+ * before AcceptBlock, and disconnected blocks are checked again on reorg.
+ * The cuckoo cache ages stale entries out on its own.
+ */
+class CShieldedProofCache
+{
+private:
+    uint256 nonce;
+    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+    size_t nElems{0};
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+
+public:
+    CShieldedProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void ComputeEntry(uint256& entry, const uint256& txid, const uint256& dataToBeSigned)
+    {
+        CSHA256().Write(nonce.begin(), 32).Write(txid.begin(), 32).Write(dataToBeSigned.begin(), 32).Finalize(entry.begin());
+    }
+
+    bool Get(const uint256& entry)
+    {
+        bool fFound;
+        {
+            boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+            // Not set up (tools and benchmarks that never call InitShieldedProofCache)
+            if (nElems == 0) return false;
+            fFound = setValid.contains(entry, false);
+        }
+        (fFound ? nHits : nMisses)++;
+        return fFound;
+    }
+
+    void Set(uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        if (nElems == 0) return;
+        setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        nElems = setValid.setup_bytes(n);
+        return nElems;
+    }
+
+    ShieldedProofCacheStats GetStats()
+    {
+        ShieldedProofCacheStats stats;
+        {
+            boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+            stats.nElems = nElems;
+        }
+        stats.nHits = nHits;
+        stats.nMisses = nMisses;
+        return stats;
+    }
+};
+
+static CShieldedProofCache shieldedProofCache;
+}
+
+// To be called once in AppInitMain/BasicTestingSetup to initialize the
+// shieldedProofCache.
+void InitShieldedProofCache()
+{
+    // If -maxshieldedsigcachesize is set to zero, setup_bytes creates the
+    // minimum possible cache (2 elements).
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxshieldedsigcachesize", DEFAULT_MAX_SHIELDED_SIG_CACHE_SIZE)), MAX_MAX_SHIELDED_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = shieldedProofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for shielded proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+bool IsShieldedProofCached(const CTransaction& tx, const uint256& dataToBeSigned)
+{
+    uint256 entry;
+    shieldedProofCache.ComputeEntry(entry, tx.GetHash(), dataToBeSigned);
+    return shieldedProofCache.Get(entry);
+}
+
+void AddShieldedProofToCache(const CTransaction& tx, const uint256& dataToBeSigned)
+{
+    uint256 entry;
+    shieldedProofCache.ComputeEntry(entry, tx.GetHash(), dataToBeSigned);
+    shieldedProofCache.Set(entry);
+}
+
+ShieldedProofCacheStats GetShieldedProofCacheStats()
+{
+    return shieldedProofCache.GetStats();
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HU_SAPLING_SAPLING_PROOFCACHE_H
+#define HU_SAPLING_SAPLING_PROOFCACHE_H
+
+#include "uint256.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Same budget as the signature cache: Sapling bundles are far fewer than
+// script signatures, but each entry saves milliseconds of proof verification
+static const unsigned int DEFAULT_MAX_SHIELDED_SIG_CACHE_SIZE = 32;
+// Maximum shielded proof cache size allowed
+static const int64_t MAX_MAX_SHIELDED_SIG_CACHE_SIZE = 16384;
+
+class CTransaction;
+
+/**
+ * Cache of the Sapling bundles (spend/output proofs and binding signature)
+ * that passed verification, so that a shielded transaction accepted to the
+ * memory pool is not verified again when its block arrives.
+ * Entries are salted like the signature cache entries.
+ */
+struct ShieldedProofCacheStats {
+    size_t nElems{0};
+    uint64_t nHits{0};
+    uint64_t nMisses{0};
+};
+
+void InitShieldedProofCache();
+
+/** Whether the Sapling bundle of tx, signed over dataToBeSigned, was already verified */
+bool IsShieldedProofCached(const CTransaction& tx, const uint256& dataToBeSigned);
+
+/** Record a successful verification of the Sapling bundle of tx */
+void AddShieldedProofToCache(const CTransaction& tx, const uint256& dataToBeSigned);
+
+ShieldedProofCacheStats GetShieldedProofCacheStats();
+
+#endif // HU_SAPLING_SAPLING_PROOFCACHE_H
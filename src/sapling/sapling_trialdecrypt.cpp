@@ -0,0 +1,82 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sapling/sapling_trialdecrypt.h"
+
+#include "sync.h"
+#include "util/threadnames.h"
+
+#include <algorithm>
+#include <memory>
+
+bool CSaplingTrialDecryptCheck::operator()()
+{
+    for (size_t i = nBegin; i < nEnd; i++) {
+        if (pfFound->load(std::memory_order_relaxed)) {
+            break; // Decrypted by another chunk
+        }
+        auto notePt = libzcash::SaplingNotePlaintext::decrypt(output->encCiphertext, (*vIvks)[i], output->ephemeralKey, output->cmu);
+        if (!notePt) {
+            continue;
+        }
+        bool fExpected = false;
+        if (pfFound->compare_exchange_strong(fExpected, true)) {
+            *pResult = SaplingTrialDecryptResult{i, *notePt};
+        }
+        break;
+    }
+    return true;
+}
+
+std::vector<Optional<SaplingTrialDecryptResult>> TrialDecryptSaplingOutputs(
+        const std::vector<OutputDescription>& vOutputs,
+        const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks,
+        CCheckQueue<CSaplingTrialDecryptCheck>* pqueue)
+{
+    std::vector<Optional<SaplingTrialDecryptResult>> vResults(vOutputs.size());
+    if (vOutputs.empty() || vIvks.empty()) {
+        return vResults;
+    }
+
+    std::unique_ptr<std::atomic<bool>[]> vFound(new std::atomic<bool>[vOutputs.size()]);
+    std::vector<CSaplingTrialDecryptCheck> vChecks;
+    vChecks.reserve(vOutputs.size() * ((vIvks.size() + SAPLING_TRIAL_DECRYPT_IVK_CHUNK - 1) / SAPLING_TRIAL_DECRYPT_IVK_CHUNK));
+    for (size_t n = 0; n < vOutputs.size(); n++) {
+        vFound[n] = false;
+        for (size_t i = 0; i < vIvks.size(); i += SAPLING_TRIAL_DECRYPT_IVK_CHUNK) {
+            const size_t nEnd = std::min(i + SAPLING_TRIAL_DECRYPT_IVK_CHUNK, vIvks.size());
+            vChecks.emplace_back(vOutputs[n], vIvks, i, nEnd, vFound[n], vResults[n]);
+        }
+    }
+
+    if (pqueue) {
+        CCheckQueueControl<CSaplingTrialDecryptCheck> control(pqueue);
+        control.Add(vChecks);
+        control.Wait();
+    } else {
+        for (CSaplingTrialDecryptCheck& check : vChecks) {
+            check();
+        }
+    }
+    return vResults;
+}
+
+// Trial decryptions take tens of microseconds each: small batches keep the
+// workers busy until the end of the job
+static CCheckQueue<CSaplingTrialDecryptCheck> saplingdecryptqueue(8);
+static Mutex cs_saplingdecryptqueue;
+
+std::vector<Optional<SaplingTrialDecryptResult>> TrialDecryptSaplingOutputs(
+        const std::vector<OutputDescription>& vOutputs,
+        const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks)
+{
+    LOCK(cs_saplingdecryptqueue);
+    return TrialDecryptSaplingOutputs(vOutputs, vIvks, &saplingdecryptqueue);
+}
+
+void ThreadSaplingTrialDecrypt()
+{
+    util::ThreadRename("pivx-saplingdec");
+    saplingdecryptqueue.Thread();
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HU_SAPLING_SAPLING_TRIALDECRYPT_H
+#define HU_SAPLING_SAPLING_TRIALDECRYPT_H
+
+#include "checkqueue.h"
+#include "optional.h"
+#include "sapling/address.h"
+#include "sapling/note.h"
+#include "sapling/sapling_transaction.h"
+
+#include <atomic>
+#include <vector>
+
+//! Number of ivks tried against an output by one check
+static const size_t SAPLING_TRIAL_DECRYPT_IVK_CHUNK = 16;
+
+/** An output decrypted by one of the ivks: its index in the ivk list and the plaintext */
+struct SaplingTrialDecryptResult
+{
+    size_t nIvk;
+    libzcash::SaplingNotePlaintext notePt;
+};
+
+/**
+ * Closure trying a chunk of ivks against one shielded output, the unit of
+ * work of the batched trial decryption. The checks of the same output share
+ * a flag: once an ivk decrypted the output the other chunks stop trying it.
+ * A check never fails, the result is written to the slot of the output.
+ */
+class CSaplingTrialDecryptCheck
+{
+private:
+    const OutputDescription* output{nullptr};
+    const std::vector<libzcash::SaplingIncomingViewingKey>* vIvks{nullptr};
+    size_t nBegin{0};
+    size_t nEnd{0};
+    std::atomic<bool>* pfFound{nullptr};
+    Optional<SaplingTrialDecryptResult>* pResult{nullptr};
+
+public:
+    CSaplingTrialDecryptCheck() {}
+    CSaplingTrialDecryptCheck(const OutputDescription& outputIn,
+                              const std::vector<libzcash::SaplingIncomingViewingKey>& vIvksIn,
+                              size_t nBeginIn, size_t nEndIn,
+                              std::atomic<bool>& fFoundIn,
+                              Optional<SaplingTrialDecryptResult>& resultIn) :
+        output(&outputIn), vIvks(&vIvksIn), nBegin(nBeginIn), nEnd(nEndIn), pfFound(&fFoundIn), pResult(&resultIn) {}
+
+    bool operator()();
+
+    void swap(CSaplingTrialDecryptCheck& check)
+    {
+        std::swap(output, check.output);
+        std::swap(vIvks, check.vIvks);
+        std::swap(nBegin, check.nBegin);
+        std::swap(nEnd, check.nEnd);
+        std::swap(pfFound, check.pfFound);
+        std::swap(pResult, check.pResult);
+    }
+};
+
+/**
+ * Trial-decrypt every output with every ivk (Protocol Spec 4.19). The
+ * (output, chunk of ivks) pairs are spread over the workers of pqueue, or
+ * run on the calling thread if pqueue is null. The caller must be the only
+ * master of pqueue.
+ * @return for each output, the ivk that decrypted it and the note plaintext
+ */
+std::vector<Optional<SaplingTrialDecryptResult>> TrialDecryptSaplingOutputs(
+        const std::vector<OutputDescription>& vOutputs,
+        const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks,
+        CCheckQueue<CSaplingTrialDecryptCheck>* pqueue);
+
+/** Same, on the shared wallet trial decryption queue (one caller at a time) */
+std::vector<Optional<SaplingTrialDecryptResult>> TrialDecryptSaplingOutputs(
+        const std::vector<OutputDescription>& vOutputs,
+        const std::vector<libzcash::SaplingIncomingViewingKey>& vIvks);
+
+/** Worker of the shared trial decryption queue (started with the -par threads) */
+void ThreadSaplingTrialDecrypt();
+
+#endif // HU_SAPLING_SAPLING_TRIALDECRYPT_H
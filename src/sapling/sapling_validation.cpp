@@ -10,11 +10,68 @@
 #include "consensus/validation.h" // for CValidationState
 #include "util/system.h" // for error()
 #include "consensus/upgrades.h" // for CurrentEpochBranchId()
+#include "sapling/sapling_proofcache.h"
 
 #include <librustzcash.h>
 
 namespace SaplingValidation {
 
+bool CProofCheck::operator()()
+{
+    const SaplingTxData& sapData = *ptx->sapData;
+
+    // Already verified when the transaction entered the mempool
+    if (IsShieldedProofCached(*ptx, dataToBeSigned)) {
+        return true;
+    }
+
+    // Sapling verification process
+    auto ctx = librustzcash_sapling_verification_ctx_init();
+
+    for (const SpendDescription &spend : sapData.vShieldedSpend) {
+        if (!librustzcash_sapling_check_spend(
+                ctx,
+                spend.cv.begin(),
+                spend.anchor.begin(),
+                spend.nullifier.begin(),
+                spend.rk.begin(),
+                spend.zkproof.begin(),
+                spend.spendAuthSig.begin(),
+                dataToBeSigned.begin())) {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            error = ProofError::SPEND;
+            return false;
+        }
+    }
+
+    for (const OutputDescription &output : sapData.vShieldedOutput) {
+        if (!librustzcash_sapling_check_output(
+                ctx,
+                output.cv.begin(),
+                output.cmu.begin(),
+                output.ephemeralKey.begin(),
+                output.zkproof.begin())) {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            error = ProofError::OUTPUT;
+            return false;
+        }
+    }
+
+    if (!librustzcash_sapling_final_check(
+            ctx,
+            sapData.valueBalance,
+            sapData.bindingSig.begin(),
+            dataToBeSigned.begin())) {
+        librustzcash_sapling_verification_ctx_free(ctx);
+        error = ProofError::BINDING_SIG;
+        return false;
+    }
+
+    librustzcash_sapling_verification_ctx_free(ctx);
+    AddShieldedProofToCache(*ptx, dataToBeSigned);
+    return true;
+}
+
 // Verifies that Shielded txs are properly formed and performs content-independent checks
 bool CheckTransaction(const CTransaction& tx, CValidationState& state, CAmount& nValueOut)
 {
@@ -116,7 +173,8 @@ bool ContextualCheckTransaction(
         const CChainParams& chainparams,
         const int nHeight,
         const bool isMined,
-        bool isInitBlockDownload)
+        bool isInitBlockDownload,
+        std::vector<CProofCheck>* pvChecks)
 {
     const int DOS_LEVEL_BLOCK = 100;
     // DoS level set to 10 to be more forgiving.
@@ -177,56 +235,32 @@ bool ContextualCheckTransaction(
                              REJECT_INVALID, "error-computing-signature-hash");
         }
 
-        // Sapling verification process
-        auto ctx = librustzcash_sapling_verification_ctx_init();
-
-        for (const SpendDescription &spend : tx.sapData->vShieldedSpend) {
-            if (!librustzcash_sapling_check_spend(
-                    ctx,
-                    spend.cv.begin(),
-                    spend.anchor.begin(),
-                    spend.nullifier.begin(),
-                    spend.rk.begin(),
-                    spend.zkproof.begin(),
-                    spend.spendAuthSig.begin(),
-                    dataToBeSigned.begin())) {
-                librustzcash_sapling_verification_ctx_free(ctx);
+        if (pvChecks) {
+            pvChecks->emplace_back(tx, dataToBeSigned);
+            return true;
+        }
+
+        CProofCheck check(tx, dataToBeSigned);
+        if (!check()) {
+            switch (check.GetError()) {
+            case ProofError::SPEND:
                 return state.DoS(
                         dosLevelPotentiallyRelaxing,
                         error("%s: Sapling spend description invalid", __func__ ),
                         REJECT_INVALID, "bad-txns-sapling-spend-description-invalid");
-            }
-        }
-
-        for (const OutputDescription &output : tx.sapData->vShieldedOutput) {
-            if (!librustzcash_sapling_check_output(
-                    ctx,
-                    output.cv.begin(),
-                    output.cmu.begin(),
-                    output.ephemeralKey.begin(),
-                    output.zkproof.begin())) {
-                librustzcash_sapling_verification_ctx_free(ctx);
+            case ProofError::OUTPUT:
                 // This should be a non-contextual check, but we check it here
                 // as we need to pass over the outputs anyway in order to then
                 // call librustzcash_sapling_final_check().
                 return state.DoS(100, error("%s: Sapling output description invalid", __func__ ),
                                  REJECT_INVALID, "bad-txns-sapling-output-description-invalid");
+            default:
+                return state.DoS(
+                        dosLevelPotentiallyRelaxing,
+                        error("%s: Sapling binding signature invalid", __func__ ),
+                        REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
             }
         }
-
-        if (!librustzcash_sapling_final_check(
-                ctx,
-                tx.sapData->valueBalance,
-                tx.sapData->bindingSig.begin(),
-                dataToBeSigned.begin())) {
-            librustzcash_sapling_verification_ctx_free(ctx);
-            return state.DoS(
-                    dosLevelPotentiallyRelaxing,
-                    error("%s: Sapling binding signature invalid", __func__ ),
-                    REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
-        }
-
-        librustzcash_sapling_verification_ctx_free(ctx);
     }
     return true;
 }
@@ -7,12 +7,54 @@
 #define HU_SAPLING_SAPLING_VALIDATION_H
 
 #include "chainparams.h"
+#include "uint256.h"
+
+#include <vector>
 
 class CTransaction;
 class CValidationState;
 
 namespace SaplingValidation {
 
+enum class ProofError {
+    NONE,
+    SPEND,
+    OUTPUT,
+    BINDING_SIG,
+};
+
+/**
+ * Closure representing the Sapling proof and binding signature verification
+ * of one transaction, the expensive part of ContextualCheckTransaction.
+ * Like CScriptCheck, it is created while the block is checked and run on a
+ * CCheckQueue, each job with its own verification context.
+ */
+class CProofCheck
+{
+private:
+    const CTransaction* ptx;
+    uint256 dataToBeSigned;
+    ProofError error;
+
+public:
+    CProofCheck() : ptx(nullptr), error(ProofError::NONE) {}
+    CProofCheck(const CTransaction& txIn, const uint256& dataToBeSignedIn) :
+        ptx(&txIn),
+        dataToBeSigned(dataToBeSignedIn),
+        error(ProofError::NONE) {}
+
+    bool operator()();
+
+    void swap(CProofCheck& check)
+    {
+        std::swap(ptx, check.ptx);
+        std::swap(dataToBeSigned, check.dataToBeSigned);
+        std::swap(error, check.error);
+    }
+
+    ProofError GetError() const { return error; }
+};
+
 /** Context-independent validity checks */
 // Note: for v3+, if the tx has no shielded data, this method returns true.
 // Note2: This function only performs shielded data related checks, it does NOT checks regular inputs and outputs.
@@ -21,9 +63,10 @@ bool CheckTransactionWithoutProofVerification(const CTransaction& tx, CValidatio
 
 /** Check a transaction contextually against a set of consensus rules */
 // Note: if v5 upgrade wasn't enforced, this method returns true without performing any check.
+// Note2: if pvChecks is not nullptr, the proof verification is appended to it instead of being run.
 bool ContextualCheckTransaction(const CTransaction &tx, CValidationState &state,
                                 const CChainParams &chainparams, int nHeight, bool isMined,
-                                bool sInitBlockDownload);
+                                bool sInitBlockDownload, std::vector<CProofCheck>* pvChecks = nullptr);
 
 }; // End SaplingValidation namespace
 
@@ -10,6 +10,7 @@
 #include "consensus/params.h"
 #include "primitives/block.h"
 #include "sapling/incrementalmerkletree.h"
+#include "sapling/sapling_trialdecrypt.h"
 #include "uint256.h"
 #include "validation.h" // for ReadBlockFromDisk()
 #include "wallet/wallet.h"
@@ -535,76 +536,86 @@ std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> SaplingScriptPubKe
         return {};
     }
 
-    LOCK(wallet->cs_KeyStore);
     const uint256& hash = tx.GetHash();
 
     mapSaplingNoteData_t noteData;
     SaplingIncomingViewingKeyMap viewingKeysToAdd;
 
     // Protocol Spec: 4.19 Block Chain Scanning (Sapling)
-    for (uint32_t i = 0; i < tx.sapData->vShieldedOutput.size(); ++i) {
-        const OutputDescription output = tx.sapData->vShieldedOutput[i];
-        for (auto it = wallet->mapSaplingFullViewingKeys.begin(); it != wallet->mapSaplingFullViewingKeys.end(); ++it) {
-            libzcash::SaplingIncomingViewingKey ivk = it->first;
-            auto result = libzcash::SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cmu);
-            if (!result) {
-                continue;
-            }
+    // Outputs x ivks are tried on the trial decryption workers, without cs_KeyStore
+    const std::vector<libzcash::SaplingIncomingViewingKey> vIvks = GetSaplingIvks();
+    const auto vResults = TrialDecryptSaplingOutputs(tx.sapData->vShieldedOutput, vIvks);
 
-            // Check if we already have it.
-            Optional<libzcash::SaplingPaymentAddress> address = ivk.address(result.get().d);
-            if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) == 0) {
-                viewingKeysToAdd[address.get()] = ivk;
-            }
-            // We don't cache the nullifier here as computing it requires knowledge of the note position
-            // in the commitment tree, which can only be determined when the transaction has been mined.
-            SaplingOutPoint op {hash, i};
-            SaplingNoteData nd;
-            nd.ivk = ivk;
-            nd.amount = result->value();
-            nd.address = address;
-            const auto& memo = result->memo();
-            // don't save empty memo (starting with 0xF6)
-            if (memo[0] < 0xF6) {
-                nd.memo = memo;
-            }
+    LOCK(wallet->cs_KeyStore);
+    for (uint32_t i = 0; i < vResults.size(); ++i) {
+        if (!vResults[i]) {
+            continue;
+        }
+        const libzcash::SaplingIncomingViewingKey& ivk = vIvks[vResults[i]->nIvk];
+        const libzcash::SaplingNotePlaintext& notePt = vResults[i]->notePt;
 
-            // Tag KHU_LOCK notes for the standard Sapling witness pipeline
-            // This allows IncrementNoteWitnesses to maintain witnesses for ZKHU lock notes
-            if (tx.nType == CTransaction::TxType::KHU_LOCK) {
-                nd.khu_lock_meta.is_khu_lock = true;
-                nd.khu_lock_meta.lock_height = 0;  // Will be set when tx is confirmed
-                nd.khu_lock_meta.is_mature = false;
-                LogPrint(BCLog::HU, "FindMySaplingNotes: detected KHU_LOCK note, txid=%s, op.n=%d\n",
-                         hash.ToString().substr(0, 16), i);
-            }
+        // Check if we already have it.
+        Optional<libzcash::SaplingPaymentAddress> address = ivk.address(notePt.d);
+        if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) == 0) {
+            viewingKeysToAdd[address.get()] = ivk;
+        }
+        // We don't cache the nullifier here as computing it requires knowledge of the note position
+        // in the commitment tree, which can only be determined when the transaction has been mined.
+        SaplingOutPoint op {hash, i};
+        SaplingNoteData nd;
+        nd.ivk = ivk;
+        nd.amount = notePt.value();
+        nd.address = address;
+        const auto& memo = notePt.memo();
+        // don't save empty memo (starting with 0xF6)
+        if (memo[0] < 0xF6) {
+            nd.memo = memo;
+        }
 
-            noteData.insert(std::make_pair(op, nd));
-            break;
+        // Tag KHU_LOCK notes for the standard Sapling witness pipeline
+        // This allows IncrementNoteWitnesses to maintain witnesses for ZKHU lock notes
+        if (tx.nType == CTransaction::TxType::KHU_LOCK) {
+            nd.khu_lock_meta.is_khu_lock = true;
+            nd.khu_lock_meta.lock_height = 0;  // Will be set when tx is confirmed
+            nd.khu_lock_meta.is_mature = false;
+            LogPrint(BCLog::HU, "FindMySaplingNotes: detected KHU_LOCK note, txid=%s, op.n=%d\n",
+                     hash.ToString().substr(0, 16), i);
         }
+
+        noteData.insert(std::make_pair(op, nd));
     }
 
     return std::make_pair(noteData, viewingKeysToAdd);
 }
 
-std::vector<libzcash::SaplingPaymentAddress> SaplingScriptPubKeyMan::FindMySaplingAddresses(const CTransaction& tx) const
+std::vector<libzcash::SaplingIncomingViewingKey> SaplingScriptPubKeyMan::GetSaplingIvks() const
 {
     LOCK(wallet->cs_KeyStore);
+    std::vector<libzcash::SaplingIncomingViewingKey> vIvks;
+    vIvks.reserve(wallet->mapSaplingFullViewingKeys.size());
+    for (const auto& it : wallet->mapSaplingFullViewingKeys) {
+        vIvks.emplace_back(it.first);
+    }
+    return vIvks;
+}
+
+std::vector<libzcash::SaplingPaymentAddress> SaplingScriptPubKeyMan::FindMySaplingAddresses(const CTransaction& tx) const
+{
     std::vector<libzcash::SaplingPaymentAddress> ret;
     if (!tx.sapData) return ret;
 
     // Protocol Spec: 4.19 Block Chain Scanning (Sapling)
-    for (const OutputDescription& output : tx.sapData->vShieldedOutput) {
-        for (auto it = wallet->mapSaplingFullViewingKeys.begin(); it != wallet->mapSaplingFullViewingKeys.end(); ++it) {
-            libzcash::SaplingIncomingViewingKey ivk = it->first;
-            auto result = libzcash::SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cmu);
-            if (!result) {
-                continue;
-            }
-            Optional<libzcash::SaplingPaymentAddress> address = ivk.address(result.get().d);
-            if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) != 0) {
-                ret.emplace_back(address.get());
-            }
+    const std::vector<libzcash::SaplingIncomingViewingKey> vIvks = GetSaplingIvks();
+    const auto vResults = TrialDecryptSaplingOutputs(tx.sapData->vShieldedOutput, vIvks);
+
+    LOCK(wallet->cs_KeyStore);
+    for (const auto& result : vResults) {
+        if (!result) {
+            continue;
+        }
+        Optional<libzcash::SaplingPaymentAddress> address = vIvks[result->nIvk].address(result->notePt.d);
+        if (address && wallet->mapSaplingIncomingViewingKeys.count(address.get()) != 0) {
+            ret.emplace_back(address.get());
         }
     }
     return ret;
@@ -676,19 +687,17 @@ void SaplingScriptPubKeyMan::GetFilteredNotes(
 {
     LOCK(wallet->cs_wallet);
 
-    for (auto& p : wallet->mapWallet) {
-        const CWalletTx& wtx = p.second;
-
+    const auto filterTx = [&](const CWalletTx& wtx) {
         // Filter coinbase transactions that don't have Sapling outputs
         if (wtx.IsCoinBase() && wtx.mapSaplingNoteData.empty()) {
-            continue;
+            return;
         }
 
         // Filter the transactions before checking for notes
         const int depth = wtx.GetDepthInMainChain();
         if (!IsFinalTx(wtx.tx, wallet->GetLastBlockHeight() + 1, GetAdjustedTime()) ||
             depth < minDepth || depth > maxDepth) {
-            continue;
+            return;
         }
 
         for (const auto& it : wtx.mapSaplingNoteData) {
@@ -727,6 +736,15 @@ void SaplingScriptPubKeyMan::GetFilteredNotes(
 
             saplingEntries.emplace_back(op, pa, note, notePt.memo(), depth);
         }
+    };
+
+    if (ignoreSpent) {
+        // Fully spent transactions have no note to return
+        wallet->ForEachUnspentTx(filterTx);
+    } else {
+        for (auto& p : wallet->mapWallet) {
+            filterTx(p.second);
+        }
     }
 }
 
@@ -309,6 +309,9 @@ public:
     //! Return the spending key for the payment address (nullopt if the wallet has no spending key for such address)
     Optional<libzcash::SaplingExtendedSpendingKey> GetSpendingKeyForPaymentAddress(const libzcash::SaplingPaymentAddress &addr) const;
 
+    //! Snapshot of the wallet's incoming viewing keys, for trial decryption
+    std::vector<libzcash::SaplingIncomingViewingKey> GetSaplingIvks() const;
+
     //! Finds all output notes in the given tx that have been sent to a
     //! SaplingPaymentAddress in this wallet
     std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> FindMySaplingNotes(const CTransaction& tx) const;
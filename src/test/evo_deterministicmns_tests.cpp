@@ -0,0 +1,53 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_pivx.h"
+
+#include "evo/deterministicmns.h"
+#include "evo/evodb.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(evo_deterministicmns_tests, TestChain100Setup)
+
+static void CheckSameList(const CDeterministicMNList& a, const CDeterministicMNList& b)
+{
+    BOOST_CHECK(a.GetBlockHash() == b.GetBlockHash());
+    BOOST_CHECK_EQUAL(a.GetAllMNsCount(), b.GetAllMNsCount());
+    BOOST_CHECK(!a.BuildDiff(b).HasChanges());
+}
+
+BOOST_AUTO_TEST_CASE(dmn_list_snapshots)
+{
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return chainActive.Tip());
+
+    // The list of the connected block is published as the tip list
+    CDeterministicMNList tipList = deterministicMNManager->GetListAtChainTip();
+    BOOST_CHECK(tipList.GetBlockHash() == tip->GetBlockHash());
+    CheckSameList(deterministicMNManager->GetListForBlock(tip), tipList);
+
+    // A manager starting with empty caches rebuilds the lists from the diffs
+    // on disk, keeping snapshots along the way: same lists as the running one,
+    // from the tip down and again from the genesis up
+    CDeterministicMNManager coldManager(*evoDb);
+    coldManager.SetTipIndex(tip);
+    for (const CBlockIndex* pindex = tip; pindex; pindex = pindex->pprev) {
+        CheckSameList(coldManager.GetListForBlock(pindex), deterministicMNManager->GetListForBlock(pindex));
+    }
+    for (int nHeight = 0; nHeight <= tip->nHeight; nHeight++) {
+        const CBlockIndex* pindex = WITH_LOCK(cs_main, return chainActive[nHeight]);
+        CheckSameList(coldManager.GetListForBlock(pindex), deterministicMNManager->GetListForBlock(pindex));
+    }
+    CheckSameList(coldManager.GetListAtChainTip(), tipList);
+
+    // A new block moves the tip list, the previous one is still served
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    const CBlockIndex* newTip = WITH_LOCK(cs_main, return chainActive.Tip());
+    BOOST_CHECK(newTip->pprev == tip);
+    BOOST_CHECK(deterministicMNManager->GetListAtChainTip().GetBlockHash() == newTip->GetBlockHash());
+    CheckSameList(deterministicMNManager->GetListForBlock(tip), tipList);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
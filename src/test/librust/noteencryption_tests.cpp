@@ -13,9 +13,11 @@
 #include "sapling/note.h"
 #include "sapling/noteencryption.h"
 #include "sapling/prf.h"
+#include "sapling/sapling_trialdecrypt.h"
 #include "sapling/sapling_util.h"
 
 #include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
 #include <librustzcash.h>
 #include <sodium.h>
 
@@ -338,4 +340,65 @@ BOOST_AUTO_TEST_CASE(SaplingApi_test)
     ));
 }
 
+BOOST_AUTO_TEST_CASE(trial_decrypt_batch)
+{
+    // 40 ivks: the chunks of SAPLING_TRIAL_DECRYPT_IVK_CHUNK do not divide them
+    std::vector<libzcash::SaplingIncomingViewingKey> vIvks;
+    std::vector<libzcash::SaplingPaymentAddress> vAddrs;
+    for (int i = 0; i < 40; i++) {
+        const auto sk = libzcash::SaplingSpendingKey::random();
+        vIvks.emplace_back(sk.full_viewing_key().in_viewing_key());
+        vAddrs.emplace_back(sk.default_address());
+    }
+    const auto otherAddr = libzcash::SaplingSpendingKey::random().default_address();
+
+    std::array<unsigned char, ZC_MEMO_SIZE> memo = {{0xF6}};
+    auto makeOutput = [&](const libzcash::SaplingPaymentAddress& addr, uint64_t nValue) {
+        libzcash::SaplingNote note(addr, nValue);
+        auto res = libzcash::SaplingNotePlaintext(note, memo).encrypt(addr.pk_d);
+        BOOST_REQUIRE(res);
+        OutputDescription output;
+        output.cmu = *note.cmu();
+        output.ephemeralKey = res->second.get_epk();
+        output.encCiphertext = res->first;
+        return output;
+    };
+
+    // Outputs to the first, a middle, the last ivk, and to a foreign address
+    const std::vector<size_t> vRecipients = {0, 17, 39};
+    std::vector<OutputDescription> vOutputs;
+    for (size_t n : vRecipients) {
+        vOutputs.emplace_back(makeOutput(vAddrs[n], 1000 + n));
+    }
+    vOutputs.emplace_back(makeOutput(otherAddr, 5));
+
+    auto checkResults = [&](const std::vector<Optional<SaplingTrialDecryptResult>>& vResults) {
+        BOOST_REQUIRE_EQUAL(vResults.size(), vOutputs.size());
+        for (size_t n = 0; n < vRecipients.size(); n++) {
+            BOOST_REQUIRE(vResults[n]);
+            BOOST_CHECK_EQUAL(vResults[n]->nIvk, vRecipients[n]);
+            BOOST_CHECK_EQUAL(vResults[n]->notePt.value(), 1000 + vRecipients[n]);
+        }
+        BOOST_CHECK(!vResults.back());
+    };
+
+    // Inline, on a queue with workers, and on the shared queue (no workers here)
+    checkResults(TrialDecryptSaplingOutputs(vOutputs, vIvks, nullptr));
+
+    CCheckQueue<CSaplingTrialDecryptCheck> queue(2);
+    boost::thread_group tg;
+    for (int i = 0; i < 3; i++) {
+        tg.create_thread([&]{ queue.Thread(); });
+    }
+    checkResults(TrialDecryptSaplingOutputs(vOutputs, vIvks, &queue));
+    tg.interrupt_all();
+    tg.join_all();
+
+    checkResults(TrialDecryptSaplingOutputs(vOutputs, vIvks));
+
+    // Nothing to try
+    BOOST_CHECK(!TrialDecryptSaplingOutputs(vOutputs, {})[0]);
+    BOOST_CHECK(TrialDecryptSaplingOutputs({}, vIvks).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
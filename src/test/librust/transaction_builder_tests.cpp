@@ -7,6 +7,7 @@
 #include "test/librust/utiltest.h"
 
 #include "sapling/sapling.h"
+#include "sapling/sapling_proofcache.h"
 #include "sapling/transaction_builder.h"
 #include "sapling/sapling_validation.h"
 
@@ -101,6 +102,88 @@ BOOST_AUTO_TEST_CASE(SaplingToSapling)
     BOOST_CHECK_EQUAL(state.GetRejectReason(), "");
 }
 
+BOOST_AUTO_TEST_CASE(DeferredProofCheck)
+{
+    auto consensusParams = Params().GetConsensus();
+
+    auto sk = libzcash::SaplingSpendingKey::random();
+    auto expsk = sk.expanded_spending_key();
+    auto fvk = sk.full_viewing_key();
+    auto pa = sk.default_address();
+
+    auto testNote = GetTestSaplingNote(pa, 40000000);
+    auto builder = TransactionBuilder(consensusParams);
+    builder.AddSaplingSpend(expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+    builder.SetFee(10000000);
+    builder.AddSaplingOutput(fvk.ovk, pa, 29900000, {});
+    auto tx = builder.Build().GetTxOrThrow();
+
+    // Proofs are handed back instead of being verified
+    CValidationState state;
+    std::vector<SaplingValidation::CProofCheck> vChecks;
+    BOOST_CHECK(SaplingValidation::ContextualCheckTransaction(tx, state, Params(), 3, true, false, &vChecks));
+    BOOST_CHECK_EQUAL(vChecks.size(), 1);
+    BOOST_CHECK(vChecks[0]());
+    BOOST_CHECK(vChecks[0].GetError() == SaplingValidation::ProofError::NONE);
+
+    // Bad binding signature: the deferred check fails with the same error as the inline one
+    CMutableTransaction mtx(tx);
+    mtx.sapData->bindingSig[0] ^= 1;
+    CTransaction badTx(mtx);
+    vChecks.clear();
+    BOOST_CHECK(SaplingValidation::ContextualCheckTransaction(badTx, state, Params(), 3, true, false, &vChecks));
+    BOOST_CHECK_EQUAL(vChecks.size(), 1);
+    BOOST_CHECK(!vChecks[0]());
+    BOOST_CHECK(vChecks[0].GetError() == SaplingValidation::ProofError::BINDING_SIG);
+    BOOST_CHECK(!SaplingValidation::ContextualCheckTransaction(badTx, state, Params(), 3, true, false));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-sapling-binding-signature-invalid");
+}
+
+BOOST_AUTO_TEST_CASE(ProofCache)
+{
+    auto consensusParams = Params().GetConsensus();
+
+    auto sk = libzcash::SaplingSpendingKey::random();
+    auto expsk = sk.expanded_spending_key();
+    auto fvk = sk.full_viewing_key();
+    auto pa = sk.default_address();
+
+    auto testNote = GetTestSaplingNote(pa, 40000000);
+    auto builder = TransactionBuilder(consensusParams);
+    builder.AddSaplingSpend(expsk, testNote.note, testNote.tree.root(), testNote.tree.witness());
+    builder.SetFee(10000000);
+    builder.AddSaplingOutput(fvk.ovk, pa, 29900000, {});
+    auto tx = builder.Build().GetTxOrThrow();
+
+    // First check (mempool) verifies and caches the bundle
+    const ShieldedProofCacheStats stats0 = GetShieldedProofCacheStats();
+    BOOST_CHECK(stats0.nElems > 0);
+    CValidationState state;
+    BOOST_CHECK(SaplingValidation::ContextualCheckTransaction(tx, state, Params(), 3, false, false));
+    const ShieldedProofCacheStats stats1 = GetShieldedProofCacheStats();
+    BOOST_CHECK_EQUAL(stats1.nMisses, stats0.nMisses + 1);
+    BOOST_CHECK_EQUAL(stats1.nHits, stats0.nHits);
+
+    // Second check (block) is served by the cache, and the entry stays
+    for (int i = 0; i < 2; i++) {
+        std::vector<SaplingValidation::CProofCheck> vChecks;
+        BOOST_CHECK(SaplingValidation::ContextualCheckTransaction(tx, state, Params(), 3, true, false, &vChecks));
+        BOOST_CHECK_EQUAL(vChecks.size(), 1);
+        BOOST_CHECK(vChecks[0]());
+    }
+    const ShieldedProofCacheStats stats2 = GetShieldedProofCacheStats();
+    BOOST_CHECK_EQUAL(stats2.nHits, stats1.nHits + 2);
+    BOOST_CHECK_EQUAL(stats2.nMisses, stats1.nMisses);
+
+    // A bad binding signature changes the txid: verified again, and not cached
+    CMutableTransaction mtx(tx);
+    mtx.sapData->bindingSig[0] ^= 1;
+    CTransaction badTx(mtx);
+    BOOST_CHECK(!SaplingValidation::ContextualCheckTransaction(badTx, state, Params(), 3, true, false));
+    BOOST_CHECK(!SaplingValidation::ContextualCheckTransaction(badTx, state, Params(), 3, true, false));
+    BOOST_CHECK_EQUAL(GetShieldedProofCacheStats().nMisses, stats2.nMisses + 2);
+}
+
 BOOST_AUTO_TEST_CASE(ThrowsOnTransparentInputWithoutKeyStore)
 {
     auto builder = TransactionBuilder(Params().GetConsensus());
@@ -0,0 +1,174 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "fs.h"
+#include "logging.h"
+#include "test/test_pivx.h"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(logging_tests, BasicTestingSetup)
+
+static BCLog::LogEntry MakeEntry(const std::string& str)
+{
+    BCLog::LogEntry entry;
+    entry.str = str;
+    return entry;
+}
+
+BOOST_AUTO_TEST_CASE(log_ring_buffer)
+{
+    BCLog::LogRingBuffer buffer(3);
+    BOOST_CHECK_EQUAL(buffer.Capacity(), 4);
+
+    BCLog::LogEntry entry;
+    BOOST_CHECK(!buffer.TryPop(entry));
+
+    // Fill it up, the fifth push fails and leaves the entry alone
+    for (int i = 0; i < 4; i++) {
+        entry = MakeEntry(std::to_string(i));
+        BOOST_CHECK(buffer.TryPush(entry));
+    }
+    entry = MakeEntry("4");
+    BOOST_CHECK(!buffer.TryPush(entry));
+    BOOST_CHECK_EQUAL(entry.str, "4");
+
+    // A pop makes room for one more, the order is kept across the wrap
+    BOOST_CHECK(buffer.TryPop(entry));
+    BOOST_CHECK_EQUAL(entry.str, "0");
+    entry = MakeEntry("4");
+    BOOST_CHECK(buffer.TryPush(entry));
+    for (int i = 1; i <= 4; i++) {
+        BOOST_CHECK(buffer.TryPop(entry));
+        BOOST_CHECK_EQUAL(entry.str, std::to_string(i));
+    }
+    BOOST_CHECK(!buffer.TryPop(entry));
+}
+
+BOOST_AUTO_TEST_CASE(log_ring_buffer_producers)
+{
+    // Small buffer: the producers keep finding it full
+    BCLog::LogRingBuffer buffer(16);
+    const int nProducers = 4;
+    const int nEntries = 10000;
+
+    std::vector<std::thread> vProducers;
+    for (int p = 0; p < nProducers; p++) {
+        vProducers.emplace_back([&buffer, p] {
+            for (int i = 0; i < nEntries; i++) {
+                BCLog::LogEntry entry = MakeEntry(strprintf("%d %d", p, i));
+                while (!buffer.TryPush(entry)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Every entry comes out once, in the order of its producer
+    std::vector<int> vNext(nProducers, 0);
+    BCLog::LogEntry entry;
+    for (int n = 0; n < nProducers * nEntries;) {
+        if (!buffer.TryPop(entry)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p, i;
+        BOOST_REQUIRE(sscanf(entry.str.c_str(), "%d %d", &p, &i) == 2);
+        BOOST_CHECK_EQUAL(i, vNext[p]++);
+        n++;
+    }
+    for (std::thread& t : vProducers) {
+        t.join();
+    }
+    BOOST_CHECK(!buffer.TryPop(entry));
+}
+
+static std::vector<std::string> ReadLines(const fs::path& path)
+{
+    std::vector<std::string> ret;
+    fsbridge::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        ret.emplace_back(line);
+    }
+    return ret;
+}
+
+static void LogFromThreads(BCLog::Logger& logger, int nThreads, int nLines)
+{
+    std::vector<std::thread> vThreads;
+    for (int t = 0; t < nThreads; t++) {
+        vThreads.emplace_back([&logger, t, nLines] {
+            for (int i = 0; i < nLines; i++) {
+                logger.LogPrintStr(strprintf("thread %d line %d\n", t, i));
+            }
+        });
+    }
+    for (std::thread& t : vThreads) {
+        t.join();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(logger_async_block)
+{
+    BCLog::Logger logger;
+    logger.m_print_to_file = true;
+    logger.m_log_timestamps = false;
+    logger.m_file_path = SetDataDir("logger_async_block") / "debug.log";
+    BOOST_CHECK(logger.OpenDebugLog());
+
+    logger.LogPrintStr("sync\n");
+    logger.StartAsync(8, true);
+    BOOST_CHECK(logger.IsAsync());
+    LogFromThreads(logger, 4, 1000);
+    logger.StopAsync();
+    BOOST_CHECK(!logger.IsAsync());
+    logger.LogPrintStr("sync again\n");
+
+    // Nothing lost, the lines of a thread in order
+    const std::vector<std::string> vLines = ReadLines(logger.m_file_path);
+    BOOST_REQUIRE_EQUAL(vLines.size(), 4 * 1000 + 2);
+    BOOST_CHECK_EQUAL(vLines.front(), "sync");
+    BOOST_CHECK_EQUAL(vLines.back(), "sync again");
+    std::vector<int> vNext(4, 0);
+    for (size_t n = 1; n < vLines.size() - 1; n++) {
+        int t, i;
+        BOOST_REQUIRE(sscanf(vLines[n].c_str(), "thread %d line %d", &t, &i) == 2);
+        BOOST_CHECK_EQUAL(i, vNext[t]++);
+    }
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(logger_async_drop)
+{
+    BCLog::Logger logger;
+    logger.m_print_to_file = true;
+    logger.m_log_timestamps = false;
+    logger.m_file_path = SetDataDir("logger_async_drop") / "debug.log";
+    BOOST_CHECK(logger.OpenDebugLog());
+
+    logger.StartAsync(1, false);
+    LogFromThreads(logger, 4, 1000);
+    logger.StopAsync();
+
+    // Every line is either written or counted as dropped, and the drops are reported
+    size_t nWritten = 0;
+    uint64_t nReported = 0;
+    for (const std::string& line : ReadLines(logger.m_file_path)) {
+        unsigned int nDropped;
+        if (sscanf(line.c_str(), "Logger: %u messages dropped", &nDropped) == 1) {
+            nReported += nDropped;
+        } else {
+            nWritten++;
+        }
+    }
+    BOOST_CHECK_EQUAL(nWritten + logger.GetDroppedCount(), 4 * 1000);
+    BOOST_CHECK_EQUAL(nReported, logger.GetDroppedCount());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
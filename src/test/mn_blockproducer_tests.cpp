@@ -5,11 +5,36 @@
 #include "test/test_pivx.h"
 #include "evo/blockproducer.h"
 #include "arith_uint256.h"
+#include "chain.h"
+#include "piv2/piv2_quorum.h"
 #include "uint256.h"
 #include "hash.h"
 
 #include <boost/test/unit_test.hpp>
 
+// Confirmed MN list of nCount synthetic MNs, bound to listBlockHash
+static CDeterministicMNList MakeConfirmedMNList(size_t nCount, const uint256& listBlockHash)
+{
+    CDeterministicMNList mnList(listBlockHash, 100, 0);
+    for (size_t i = 0; i < nCount; i++) {
+        const uint256 seed = Hash(BEGIN(i), END(i));
+        auto state = std::make_shared<CDeterministicMNState>();
+        std::vector<unsigned char> vchPubKey(seed.begin(), seed.end());
+        vchPubKey.insert(vchPubKey.begin(), 0x02);
+        state->pubKeyOperator = CPubKey(vchPubKey);
+        state->keyIDOwner = CKeyID(uint160(std::vector<unsigned char>(seed.begin(), seed.begin() + 20)));
+        state->UpdateConfirmedHash(seed, listBlockHash);
+
+        auto dmn = std::make_shared<CDeterministicMN>(i);
+        dmn->proTxHash = seed;
+        dmn->collateralOutpoint = COutPoint(seed, 0);
+        dmn->nOperatorReward = 0;
+        dmn->pdmnState = state;
+        mnList.AddMN(dmn);
+    }
+    return mnList;
+}
+
 BOOST_FIXTURE_TEST_SUITE(mn_blockproducer_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(score_computation_deterministic)
@@ -169,4 +194,51 @@ BOOST_AUTO_TEST_CASE(different_blocks_different_winners)
     BOOST_CHECK_EQUAL(wins1 + wins2 + wins3, 100);
 }
 
+BOOST_AUTO_TEST_CASE(memoized_schedules_match_full_ranking)
+{
+    // More MNs than reachable fallback slots: only the top ones are ranked
+    const uint256 prevHash = uint256S("0xabcdef1234567890abcdef1234567890abcdef1234567890abcdef1234567890");
+    const CDeterministicMNList mnList = MakeConfirmedMNList(500, prevHash);
+    CBlockIndex indexPrev;
+    indexPrev.phashBlock = &prevHash;
+    indexPrev.nHeight = 100;
+
+    mn_consensus::ClearBlockProducerScheduleCache();
+    auto full = mn_consensus::CalculateBlockProducerScores(&indexPrev, mnList);
+    auto schedule = mn_consensus::GetBlockProducerSchedule(&indexPrev, mnList);
+    BOOST_CHECK_EQUAL(full.size(), 500U);
+    BOOST_CHECK_EQUAL(schedule->nCandidates, full.size());
+    BOOST_CHECK(schedule->vRanked.size() < full.size());
+    for (size_t i = 0; i < schedule->vRanked.size(); i++) {
+        BOOST_CHECK(schedule->vRanked[i].second->proTxHash == full[i].second->proTxHash);
+    }
+
+    // Second lookup is served from the cache, until it is cleared
+    BOOST_CHECK(mn_consensus::GetBlockProducerSchedule(&indexPrev, mnList) == schedule);
+    mn_consensus::ClearBlockProducerScheduleCache();
+    BOOST_CHECK(mn_consensus::GetBlockProducerSchedule(&indexPrev, mnList) != schedule);
+
+    CDeterministicMNCPtr producer;
+    BOOST_CHECK(mn_consensus::GetBlockProducer(&indexPrev, mnList, producer));
+    BOOST_CHECK(producer->proTxHash == full[0].second->proTxHash);
+
+    // HU quorum: top nHuQuorumSize of the full sort
+    const int nCycle = 7;
+    const uint256 seed = hu::ComputeHuQuorumSeed(prevHash, nCycle);
+    std::vector<std::pair<arith_uint256, uint256>> quorumScores;
+    mnList.ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
+        quorumScores.emplace_back(UintToArith256(hu::ComputeHuQuorumMemberScore(seed, dmn->proTxHash)), dmn->proTxHash);
+    });
+    std::sort(quorumScores.begin(), quorumScores.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    hu::ClearHuQuorumCache();
+    for (int nRound = 0; nRound < 2; nRound++) { // computed, then cached
+        auto quorum = hu::GetHuQuorum(mnList, nCycle, prevHash);
+        BOOST_CHECK_EQUAL(quorum.size(), (size_t)Params().GetConsensus().nHuQuorumSize);
+        for (size_t i = 0; i < quorum.size(); i++) {
+            BOOST_CHECK(quorum[i]->proTxHash == quorumScores[i].second);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -193,6 +193,24 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+BOOST_AUTO_TEST_CASE(message_lanes)
+{
+    // Consensus-critical traffic is served first
+    for (const char* cmd : {NetMsgType::BLOCK, NetMsgType::CMPCTBLOCK, NetMsgType::BLOCKTXN,
+                            NetMsgType::HEADERS, NetMsgType::HUSIG, NetMsgType::MNAUTH}) {
+        BOOST_CHECK_EQUAL(GetMsgLane(cmd), MSG_LANE_PRIORITY);
+    }
+    // Relay, gossip and the requests that must stay in order with their answers
+    for (const char* cmd : {NetMsgType::TX, NetMsgType::INV, NetMsgType::ADDR, NetMsgType::ADDRV2,
+                            NetMsgType::GETDATA, NetMsgType::GETHEADERS, NetMsgType::VERSION,
+                            NetMsgType::VERACK, NetMsgType::PING, NetMsgType::SPORK, NetMsgType::MNPING}) {
+        BOOST_CHECK_EQUAL(GetMsgLane(cmd), MSG_LANE_GENERAL);
+    }
+    BOOST_CHECK_EQUAL(GetMsgLane("unknowncmd"), MSG_LANE_GENERAL);
+    BOOST_CHECK_EQUAL(GetMsgLaneName(MSG_LANE_PRIORITY), "priority");
+    BOOST_CHECK_EQUAL(GetMsgLaneName(MSG_LANE_GENERAL), "general");
+}
+
 BOOST_AUTO_TEST_CASE(cnetaddr_basic)
 {
     CNetAddr addr;
@@ -11,16 +11,21 @@
  *   3. R% change via DOMC voting
  *   4. R% bounds (1-10%)
  *   5. Voting power based on ZKHU holdings
+ *   6. DOMC cycle, reveal tally and vote storage
  */
 
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_dao.h"
 #include "piv2/piv2_domc.h"
+#include "piv2/piv2_domcdb.h"
+#include "dao/dao_db.h"
 #include "amount.h"
 #include "test/test_pivx.h"
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+
 // Constants
 static const uint32_t T_DIVISOR = 8;         // Treasury gets 1/8 of yield rate
 static const uint32_t DAYS_PER_YEAR = 365;
@@ -268,4 +273,176 @@ BOOST_AUTO_TEST_CASE(domc_cycle_blocks)
     BOOST_CHECK_EQUAL(COMMIT_PHASE_BLOCKS + REVEAL_PHASE_BLOCKS, DOMC_CYCLE_BLOCKS);
 }
 
+BOOST_AUTO_TEST_CASE(domc_reveal_tally_median)
+{
+    CDomcRevealTally tally;
+    std::vector<uint16_t> proposals;
+
+    for (int i = 0; i < 1000; i++) {
+        // Edges of the range included
+        uint16_t nR = (i % 100 == 0) ? (i % 200 == 0 ? 0 : 0xffff) : InsecureRand16() % (khu_domc::R_MAX + 1);
+        tally.Add(nR);
+        proposals.push_back(nR);
+
+        if (i % 7 == 3) {
+            // Remove a random earlier proposal
+            size_t pos = InsecureRandRange(proposals.size());
+            tally.Remove(proposals[pos]);
+            proposals.erase(proposals.begin() + pos);
+        }
+        if (proposals.empty()) continue;
+
+        std::vector<uint16_t> sorted(proposals);
+        std::sort(sorted.begin(), sorted.end());
+        BOOST_CHECK_EQUAL(tally.Size(), sorted.size());
+        BOOST_CHECK_EQUAL(tally.Median(), sorted[sorted.size() / 2]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(domc_db_cycle_votes)
+{
+    CKHUDomcDB db(1 << 20, true, true);
+    const uint32_t nCycle1 = 1000, nCycle2 = 2000;
+
+    auto makeReveal = [](const COutPoint& mn, uint32_t cycleId, uint16_t nR) {
+        khu_domc::DomcReveal reveal;
+        reveal.nRProposal = nR;
+        reveal.salt = InsecureRand256();
+        reveal.mnOutpoint = mn;
+        reveal.nCycleId = cycleId;
+        return reveal;
+    };
+
+    std::vector<COutPoint> mns;
+    for (int i = 0; i < 5; i++) {
+        mns.emplace_back(InsecureRand256(), i);
+        khu_domc::DomcCommit commit;
+        commit.hashCommit = InsecureRand256();
+        commit.mnOutpoint = mns.back();
+        commit.nCycleId = nCycle1;
+        BOOST_CHECK(db.WriteCommit(commit));
+    }
+    // Cycle 1: 1000, 3000, 2000, 500, 4000 -> median 2000
+    const uint16_t vR[] = {1000, 3000, 2000, 500, 4000};
+    for (int i = 0; i < 5; i++) {
+        BOOST_CHECK(db.WriteReveal(makeReveal(mns[i], nCycle1, vR[i])));
+    }
+    // Cycle 2 shares the masternodes but must not leak into cycle 1
+    BOOST_CHECK(db.WriteReveal(makeReveal(mns[0], nCycle2, 100)));
+    db.CommitCurTransaction();
+
+    std::vector<khu_domc::DomcReveal> reveals;
+    BOOST_CHECK(db.GetRevealsForCycle(nCycle1, reveals));
+    BOOST_CHECK_EQUAL(reveals.size(), 5U);
+    BOOST_CHECK(db.GetRevealsForCycle(nCycle2, reveals));
+    BOOST_CHECK_EQUAL(reveals.size(), 1U);
+
+    uint16_t nMedian = 0;
+    size_t nVotes = 0;
+    BOOST_CHECK(db.GetRevealMedian(nCycle1, nMedian, nVotes));
+    BOOST_CHECK_EQUAL(nVotes, 5U);
+    BOOST_CHECK_EQUAL(nMedian, 2000);
+
+    // A dropped block transaction leaves the tally untouched
+    BOOST_CHECK(db.EraseReveal(mns[2], nCycle1));
+    BOOST_CHECK(db.WriteReveal(makeReveal(mns[3], nCycle1, 3500)));
+    BOOST_CHECK(db.GetRevealMedian(nCycle1, nMedian, nVotes));
+    BOOST_CHECK_EQUAL(nVotes, 4U);
+    BOOST_CHECK_EQUAL(nMedian, 3500);
+    db.RollbackCurTransaction();
+    BOOST_CHECK(db.GetRevealMedian(nCycle1, nMedian, nVotes));
+    BOOST_CHECK_EQUAL(nVotes, 5U);
+    BOOST_CHECK_EQUAL(nMedian, 2000);
+
+    // Undo of the whole cycle
+    BOOST_CHECK(db.EraseCycleData(nCycle1));
+    db.CommitCurTransaction();
+    BOOST_CHECK(!db.GetRevealMedian(nCycle1, nMedian, nVotes));
+    BOOST_CHECK(!db.GetRevealsForCycle(nCycle1, reveals));
+    BOOST_CHECK(!db.HaveCommit(mns[0], nCycle1));
+    BOOST_CHECK(db.GetRevealMedian(nCycle2, nMedian, nVotes));
+    BOOST_CHECK_EQUAL(nMedian, 100);
+}
+
+BOOST_AUTO_TEST_CASE(dao_db_proposals_votes)
+{
+    CDAODB db(1 << 20, true, true);
+    const uint32_t nCycle1 = 43200, nCycle2 = 86400;
+
+    auto makeProposal = [](const std::string& name, uint32_t nCycleStart) {
+        CDAOProposal proposal;
+        proposal.strName = name;
+        proposal.nAmount = 1000 * COIN;
+        proposal.nSubmitHeight = nCycleStart + 1;
+        proposal.nCycleStart = nCycleStart;
+        proposal.hash = proposal.GetHash();
+        return proposal;
+    };
+
+    const CDAOProposal prop1 = makeProposal("one", nCycle1);
+    const CDAOProposal prop2 = makeProposal("two", nCycle1);
+    const CDAOProposal prop3 = makeProposal("three", nCycle2);
+    BOOST_CHECK(db.WriteProposal(prop1));
+    BOOST_CHECK(db.WriteProposal(prop2));
+    BOOST_CHECK(db.WriteProposal(prop3));
+
+    CDAOProposal read;
+    BOOST_CHECK(db.ReadProposal(prop3.hash, read));
+    BOOST_CHECK(read.hash == prop3.hash);
+    BOOST_CHECK_EQUAL(read.nCycleStart, nCycle2);
+
+    // Proposals of the next cycle must not leak into the first one
+    std::vector<uint256> vHashes;
+    BOOST_CHECK(db.ForEachProposal(nCycle1, [&](const CDAOProposal& p) {
+        vHashes.push_back(p.hash);
+        return true;
+    }));
+    BOOST_CHECK_EQUAL(vHashes.size(), 2U);
+    BOOST_CHECK(std::find(vHashes.begin(), vHashes.end(), prop3.hash) == vHashes.end());
+
+    std::vector<uint32_t> vCycles;
+    BOOST_CHECK(db.ForEachCycle([&](uint32_t nCycleStart) {
+        vCycles.push_back(nCycleStart);
+        return true;
+    }));
+    BOOST_CHECK(vCycles == std::vector<uint32_t>({nCycle1, nCycle2}));
+
+    // A masternode changing its vote moves its count, it does not add one
+    const uint256 mn1 = InsecureRand256(), mn2 = InsecureRand256();
+    BOOST_CHECK(db.WriteVote(CDAOVote(prop1.hash, mn1, DAOVote::YES, nCycle1 + 10)));
+    BOOST_CHECK(db.WriteVote(CDAOVote(prop1.hash, mn2, DAOVote::YES, nCycle1 + 10)));
+    BOOST_CHECK(db.WriteVote(CDAOVote(prop1.hash, mn2, DAOVote::NO, nCycle1 + 11)));
+    CDAOTally tally;
+    BOOST_CHECK(db.ReadTally(prop1.hash, tally));
+    BOOST_CHECK_EQUAL(tally.nYes, 1);
+    BOOST_CHECK_EQUAL(tally.nNo, 1);
+    BOOST_CHECK(!db.WriteVote(CDAOVote(InsecureRand256(), mn1, DAOVote::YES, nCycle1 + 10)));
+
+    // Payout markers follow the block transaction
+    const int nPayoutHeight = nCycle1 + GetDAOPayoutHeight() - 1;
+    BOOST_CHECK(db.WritePaid(nCycle1, prop1.hash, nPayoutHeight));
+    BOOST_CHECK(db.IsPaid(nCycle1, prop1.hash));
+    db.RollbackCurTransaction();
+    BOOST_CHECK(!db.IsPaid(nCycle1, prop1.hash));
+    BOOST_CHECK(db.WritePaid(nCycle1, prop1.hash, nPayoutHeight));
+    BOOST_CHECK(db.WritePaid(nCycle1, prop2.hash, nPayoutHeight));
+    db.CommitCurTransaction();
+    BOOST_CHECK(db.UndoPaid(nCycle1, nPayoutHeight));
+    db.CommitCurTransaction();
+    BOOST_CHECK(!db.IsPaid(nCycle1, prop1.hash));
+    BOOST_CHECK(!db.IsPaid(nCycle1, prop2.hash));
+
+    // Erasing a proposal drops its tally and votes
+    BOOST_CHECK(db.EraseProposal(prop1.hash));
+    BOOST_CHECK(!db.HaveProposal(prop1.hash));
+    BOOST_CHECK(!db.ReadTally(prop1.hash, tally));
+    size_t nVotes = 0;
+    BOOST_CHECK(db.ForEachVote(prop1.hash, [&](const CDAOVote&) {
+        nVotes++;
+        return true;
+    }));
+    BOOST_CHECK_EQUAL(nVotes, 0U);
+    BOOST_CHECK(db.HaveProposal(prop2.hash));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,256 @@
+// Copyright (c) 2025 The PIV2 developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/**
+ * HU Finality Tests - height-indexed finality store
+ *
+ * Tests:
+ *   1. Signer bitmap: duplicates rejected, signatures in quorum order
+ *   2. Threshold reached: finality, conflicts and persistence
+ *   3. Ring buffer: old heights leave memory, finalized ones stay on disk
+ *   4. DB pruning by height
+ */
+
+#include "piv2/piv2_finality.h"
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "key.h"
+#include "streams.h"
+#include "test/test_pivx.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace hu;
+
+static CHuSignature MakeSig(const uint256& blockHash, int nIndex)
+{
+    CHuSignature sig;
+    sig.blockHash = blockHash;
+    sig.proTxHash = ArithToUint256(arith_uint256(1000 + nIndex));
+    sig.vchSig = std::vector<unsigned char>(65, (unsigned char)nIndex);
+    return sig;
+}
+
+static void SignBlock(CHuFinalityHandler& handler, const uint256& blockHash, int nHeight, int nSigners)
+{
+    for (int i = 0; i < nSigners; i++) {
+        BOOST_CHECK(handler.AddSignature(MakeSig(blockHash, i), nHeight, i));
+    }
+}
+
+struct FinalityTestingSetup : public BasicTestingSetup {
+    FinalityTestingSetup()
+    {
+        pHuFinalityDB = std::make_unique<CHuFinalityDB>(1 << 20, true, true);
+    }
+    ~FinalityTestingSetup()
+    {
+        pHuFinalityDB.reset();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(piv2_finality_tests, FinalityTestingSetup)
+
+// =============================================================================
+// Test 1: Signer bitmap
+// =============================================================================
+BOOST_AUTO_TEST_CASE(signer_bitmap)
+{
+    CHuFinality finality(uint256S("01"), 10);
+    BOOST_CHECK(finality.AddSigner(5, {5}));
+    BOOST_CHECK(finality.AddSigner(0, {0}));
+    BOOST_CHECK(finality.AddSigner(63, {63}));
+    BOOST_CHECK(finality.AddSigner(2, {2}));
+    BOOST_CHECK(!finality.AddSigner(5, {55}));
+    BOOST_CHECK(!finality.AddSigner(64, {64}));
+    BOOST_CHECK(!finality.AddSigner(-1, {1}));
+
+    BOOST_CHECK_EQUAL(finality.GetSignatureCount(), 4U);
+    BOOST_CHECK(finality.HasSigner(0) && finality.HasSigner(2) && finality.HasSigner(5) && finality.HasSigner(63));
+    BOOST_CHECK(!finality.HasSigner(1));
+
+    // Signatures follow the quorum order
+    const std::vector<unsigned char> vOrder{0, 2, 5, 63};
+    for (size_t i = 0; i < vOrder.size(); i++) {
+        BOOST_CHECK(finality.vSigs[i] == std::vector<unsigned char>{vOrder[i]});
+    }
+
+    // Round trip
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << finality;
+    CHuFinality finality2;
+    ss >> finality2;
+    BOOST_CHECK(finality2.blockHash == finality.blockHash);
+    BOOST_CHECK_EQUAL(finality2.nHeight, 10);
+    BOOST_CHECK_EQUAL(finality2.nSigners, finality.nSigners);
+    BOOST_CHECK(finality2.vSigs == finality.vSigs);
+}
+
+// =============================================================================
+// Test 2: Threshold, conflicts and persistence
+// =============================================================================
+BOOST_AUTO_TEST_CASE(threshold_conflicts_persistence)
+{
+    const int nThreshold = Params().GetConsensus().nHuQuorumThreshold;
+    CHuFinalityHandler handler;
+    const uint256 hashA = uint256S("aa");
+    const uint256 hashB = uint256S("bb");
+
+    SignBlock(handler, hashA, 100, nThreshold - 1);
+    BOOST_CHECK(!handler.HasFinality(100, hashA));
+    BOOST_CHECK(!handler.HasConflictingFinality(100, hashB));
+    BOOST_CHECK(!pHuFinalityDB->HasFinality(hashA));
+
+    // Duplicate signer
+    BOOST_CHECK(!handler.AddSignature(MakeSig(hashA, 0), 100, 0));
+
+    BOOST_CHECK(handler.AddSignature(MakeSig(hashA, nThreshold - 1), 100, nThreshold - 1));
+    BOOST_CHECK(handler.HasFinality(100, hashA));
+    BOOST_CHECK(!handler.HasFinality(101, hashA));
+    BOOST_CHECK(handler.HasConflictingFinality(100, hashB));
+    BOOST_CHECK(!handler.HasConflictingFinality(100, hashA));
+    BOOST_CHECK_EQUAL(handler.GetSignatureCount(hashA), nThreshold);
+
+    // Persisted with its height
+    BOOST_CHECK(pHuFinalityDB->IsBlockFinal(hashA, nThreshold));
+    uint256 hashFinal;
+    BOOST_CHECK(pHuFinalityDB->ReadFinalizedBlock(100, hashFinal));
+    BOOST_CHECK(hashFinal == hashA);
+
+    // A fresh handler (restart) answers from disk and keeps counting from there
+    CHuFinalityHandler handler2;
+    BOOST_CHECK(handler2.HasFinality(100, hashA));
+    BOOST_CHECK(handler2.HasConflictingFinality(100, hashB));
+    BOOST_CHECK(!handler2.AddSignature(MakeSig(hashA, 0), 100, 0));
+    BOOST_CHECK(handler2.AddSignature(MakeSig(hashA, nThreshold), 100, nThreshold));
+    BOOST_CHECK(handler2.HasFinality(100, hashA));
+    BOOST_CHECK_EQUAL(handler2.GetSignatureCount(hashA), nThreshold + 1);
+}
+
+// =============================================================================
+// Test 3: Ring buffer bounds
+// =============================================================================
+BOOST_AUTO_TEST_CASE(ring_buffer_bounds)
+{
+    const int nThreshold = Params().GetConsensus().nHuQuorumThreshold;
+    CHuFinalityHandler handler;
+    const uint256 hashFinal = uint256S("f1");
+    const uint256 hashPending = uint256S("f2");
+
+    SignBlock(handler, hashFinal, 10, nThreshold);
+    SignBlock(handler, hashPending, 11, 1);
+
+    // Move HU_FINALITY_CACHE_HEIGHTS heights up: both slots get recycled
+    const int nNewHeight = 11 + HU_FINALITY_CACHE_HEIGHTS;
+    SignBlock(handler, uint256S("f3"), nNewHeight - 1, 1);
+    SignBlock(handler, uint256S("f4"), nNewHeight, 1);
+
+    // The pending block is forgotten, the finalized one still answers from disk
+    BOOST_CHECK_EQUAL(handler.GetSignatureCount(hashPending), 0);
+    BOOST_CHECK(handler.HasFinality(10, hashFinal));
+    BOOST_CHECK(handler.HasConflictingFinality(10, hashPending));
+
+    // Signatures below the ring are refused
+    BOOST_CHECK(!handler.AddSignature(MakeSig(hashPending, 1), nNewHeight - HU_FINALITY_CACHE_HEIGHTS, 1));
+    BOOST_CHECK(handler.AddSignature(MakeSig(hashPending, 1), nNewHeight - HU_FINALITY_CACHE_HEIGHTS + 1, 1));
+}
+
+// =============================================================================
+// Test 4: DB pruning by height
+// =============================================================================
+BOOST_AUTO_TEST_CASE(db_pruning)
+{
+    const int nThreshold = Params().GetConsensus().nHuQuorumThreshold;
+    CHuFinalityHandler handler;
+    const uint256 hashOld = uint256S("01");
+    const uint256 hashNew = uint256S("02");
+
+    SignBlock(handler, hashOld, 5, nThreshold);
+    SignBlock(handler, hashNew, 500, nThreshold);
+
+    handler.Prune(HU_FINALITY_DB_KEEP_HEIGHTS + 5);
+    BOOST_CHECK(!pHuFinalityDB->HasFinality(hashOld));
+    BOOST_CHECK(pHuFinalityDB->HasFinality(hashNew));
+    BOOST_CHECK_EQUAL(pHuFinalityDB->ReadPrunedHeight(), 5);
+
+    handler.Prune(HU_FINALITY_DB_KEEP_HEIGHTS + 500);
+    BOOST_CHECK(!pHuFinalityDB->HasFinality(hashNew));
+    BOOST_CHECK_EQUAL(pHuFinalityDB->ReadPrunedHeight(), 500);
+}
+
+// =============================================================================
+// Test 5: Signature inventory hash
+// =============================================================================
+BOOST_AUTO_TEST_CASE(signature_inv_hash)
+{
+    const CHuSignature sig = MakeSig(uint256S("01"), 1);
+
+    // One inv per (block, signer): the signature bytes don't change it
+    CHuSignature sigOtherBytes = sig;
+    sigOtherBytes.vchSig[0] ^= 0xff;
+    BOOST_CHECK(sig.GetHash() == sigOtherBytes.GetHash());
+
+    BOOST_CHECK(sig.GetHash() != MakeSig(uint256S("01"), 2).GetHash());
+    BOOST_CHECK(sig.GetHash() != MakeSig(uint256S("02"), 1).GetHash());
+}
+
+// =============================================================================
+// Test 6: Block finality certificate
+// =============================================================================
+BOOST_AUTO_TEST_CASE(finality_certificate)
+{
+    const int nThreshold = Params().GetConsensus().nHuQuorumThreshold;
+    const uint256 blockHash = uint256S("c1");
+    const uint256 msgHash = GetHuSignatureHash(blockHash);
+
+    // A quorum of nThreshold + 2 members, all but the second one sign
+    std::vector<std::pair<uint256, CPubKey>> vQuorum;
+    CHuFinalityHandler handler;
+    for (int i = 0; i < nThreshold + 2; i++) {
+        CKey key;
+        key.MakeNewKey(true);
+        vQuorum.emplace_back(ArithToUint256(arith_uint256(1000 + i)), key.GetPubKey());
+        if (i == 1) continue;
+        CHuSignature sig;
+        sig.blockHash = blockHash;
+        sig.proTxHash = vQuorum.back().first;
+        BOOST_CHECK(key.SignCompact(msgHash, sig.vchSig));
+        BOOST_CHECK(handler.AddSignature(sig, 50, i));
+    }
+
+    // Trimmed to the threshold, in quorum order
+    CBlockFinalityCert cert;
+    BOOST_CHECK(!handler.GetFinalityCert(uint256S("c2"), nThreshold, cert));
+    BOOST_CHECK(handler.GetFinalityCert(blockHash, nThreshold, cert));
+    BOOST_CHECK_EQUAL((int)cert.vSigs.size(), nThreshold);
+    BOOST_CHECK(cert.nSigners & 1);
+    BOOST_CHECK(!(cert.nSigners & 2));
+
+    std::vector<std::pair<CHuSignature, int>> vSigs;
+    BOOST_CHECK(CheckFinalityCert(cert, blockHash, vQuorum, vSigs));
+    BOOST_CHECK_EQUAL((int)vSigs.size(), nThreshold);
+    BOOST_CHECK_EQUAL(vSigs[0].second, 0);
+    BOOST_CHECK(vSigs[0].first.proTxHash == vQuorum[0].first);
+    if (nThreshold > 1) {
+        BOOST_CHECK_EQUAL(vSigs[1].second, 2);
+    }
+
+    // Signed another block
+    BOOST_CHECK(!CheckFinalityCert(cert, uint256S("c2"), vQuorum, vSigs));
+    BOOST_CHECK(vSigs.empty());
+
+    // Bitmap and signatures don't match
+    CBlockFinalityCert certBad = cert;
+    certBad.vSigs.pop_back();
+    BOOST_CHECK(!CheckFinalityCert(certBad, blockHash, vQuorum, vSigs));
+
+    // Signer outside of the quorum
+    certBad = cert;
+    certBad.nSigners |= uint64_t{1} << vQuorum.size();
+    certBad.vSigs.push_back(cert.vSigs.back());
+    BOOST_CHECK(!CheckFinalityCert(certBad, blockHash, vQuorum, vSigs));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
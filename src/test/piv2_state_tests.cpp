@@ -11,13 +11,25 @@
  *   3. Invariant Cr == Ur
  *   4. Invariant T >= 0
  *   5. State serialization/deserialization
+ *   6. Large values (no overflow)
+ *   7. Buffered DB writes: per-block commit/rollback, flush with best block
+ *   8. Write-back KHU coins cache: block view -> tip view -> DB
+ *   9. State snapshots + per-block diffs: historical reads rebuilt exactly
+ *  10. ZKHU commitment index: witnesses served without a chain rescan
  */
 
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_statedb.h"
+#include "piv2/piv2_utxo.h"
+#include "piv2/piv2_validation.h"
+#include "piv2/zkpiv2_db.h"
+#include "piv2/zkpiv2_witness.h"
 #include "amount.h"
+#include "arith_uint256.h"
 #include "test/test_pivx.h"
 
+#include <map>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(hu_state_tests, BasicTestingSetup)
@@ -171,4 +183,240 @@ BOOST_AUTO_TEST_CASE(large_values_no_overflow)
     BOOST_CHECK(state.CheckInvariants());
 }
 
+// =============================================================================
+// Test 7: Buffered DB writes - block commit/rollback, flush with best block
+// =============================================================================
+BOOST_AUTO_TEST_CASE(statedb_transaction_commit_rollback)
+{
+    CKHUStateDB db(1 << 20, true /* fMemory */, true /* fWipe */);
+
+    HuGlobalState state;
+    state.SetNull();
+    state.nHeight = 1;
+    state.T = 500 * COIN;
+
+    // Accepted block: visible right away, on disk only after the root commit
+    {
+        CKHUDBScopedCommitter khuTx({&db});
+        BOOST_CHECK(db.WriteKHUState(1, state));
+        BOOST_CHECK(db.ExistsKHUState(1));
+        khuTx.Commit();
+    }
+    HuGlobalState loaded;
+    BOOST_CHECK(db.ReadKHUState(1, loaded));
+    BOOST_CHECK_EQUAL(loaded.T, state.T);
+    BOOST_CHECK(db.GetMemoryUsage() > 0);
+
+    uint256 hashBestBlock;
+    BOOST_CHECK(!db.ReadBestBlock(hashBestBlock));
+
+    // Rejected block: its writes and erases are dropped
+    {
+        CKHUDBScopedCommitter khuTx({&db});
+        state.nHeight = 2;
+        BOOST_CHECK(db.WriteKHUState(2, state));
+        BOOST_CHECK(db.EraseKHUState(1));
+        BOOST_CHECK(!db.ExistsKHUState(1));
+    }
+    BOOST_CHECK(db.ExistsKHUState(1));
+    BOOST_CHECK(!db.ExistsKHUState(2));
+
+    // Flush: one batch, tagged with the best block
+    const uint256 hashBlock = uint256S("0x01");
+    BOOST_CHECK(db.CommitRootTransaction(hashBlock));
+    BOOST_CHECK_EQUAL(db.GetMemoryUsage(), 0U);
+    BOOST_CHECK(db.ReadBestBlock(hashBestBlock));
+    BOOST_CHECK(hashBestBlock == hashBlock);
+    BOOST_CHECK(db.ReadKHUState(1, loaded));
+    BOOST_CHECK_EQUAL(loaded.T, state.T);
+}
+
+// =============================================================================
+// Test 8: Write-back KHU coins cache - block view -> tip view -> DB
+// =============================================================================
+BOOST_AUTO_TEST_CASE(khu_coins_cache_write_back)
+{
+    CKHUStateDB db(1 << 20, true /* fMemory */, true /* fWipe */);
+    const COutPoint onDisk(uint256S("0xaa"), 0);
+    const COutPoint minted(uint256S("0xbb"), 1);
+    const COutPoint transient(uint256S("0xcc"), 2);
+    const CKHUUTXO coin(100 * COIN, CScript() << OP_TRUE, 10);
+
+    BOOST_CHECK(db.WriteKHUUTXO(onDisk, coin));
+
+    CKHUCoinsViewCache tip(&db);
+    BOOST_CHECK_EQUAL(tip.GetCacheSize(), 0U); // nothing loaded up front
+    {
+        CKHUCoinsViewCache block(&tip);
+        BOOST_CHECK(block.HaveCoin(onDisk));
+        BOOST_CHECK(!block.AddCoin(onDisk, coin, false)); // unspent coin exists
+        BOOST_CHECK(block.SpendCoin(onDisk));
+        BOOST_CHECK(!block.SpendCoin(onDisk));
+        BOOST_CHECK(block.AddCoin(minted, coin, false));
+        BOOST_CHECK(block.AddCoin(transient, coin, false));
+        BOOST_CHECK(block.SpendCoin(transient)); // FRESH: dropped, never written
+        BOOST_CHECK(block.DynamicMemoryUsage() > 0);
+
+        // Rolled back block: the tip is untouched (only the fetched coin is cached)
+    }
+    BOOST_CHECK(tip.HaveCoin(onDisk));
+    BOOST_CHECK(!tip.HaveCoin(minted));
+
+    {
+        CKHUCoinsViewCache block(&tip);
+        BOOST_CHECK(block.SpendCoin(onDisk));
+        BOOST_CHECK(block.AddCoin(minted, coin, false));
+        BOOST_CHECK(block.AddCoin(transient, coin, false));
+        BOOST_CHECK(block.SpendCoin(transient));
+        BOOST_CHECK(block.Flush());
+        BOOST_CHECK_EQUAL(block.GetCacheSize(), 0U);
+    }
+    BOOST_CHECK(!tip.HaveCoin(onDisk));
+    BOOST_CHECK(tip.HaveCoin(minted));
+    BOOST_CHECK(!tip.HaveCoin(transient));
+
+    // Nothing reached the DB before the tip flush
+    CKHUUTXO read;
+    BOOST_CHECK(db.ReadKHUUTXO(onDisk, read));
+    BOOST_CHECK(!db.ReadKHUUTXO(minted, read));
+
+    BOOST_CHECK(tip.Flush());
+    BOOST_CHECK_EQUAL(tip.GetCacheSize(), 0U);
+    BOOST_CHECK(!db.ExistsKHUUTXO(onDisk));
+    BOOST_CHECK(!db.ExistsKHUUTXO(transient));
+    BOOST_CHECK(db.ReadKHUUTXO(minted, read));
+    BOOST_CHECK_EQUAL(read.amount, coin.amount);
+    BOOST_CHECK(tip.HaveCoin(minted)); // re-fetched on demand
+}
+
+// =============================================================================
+// Test 9: State snapshots + diffs - any height is rebuilt exactly from disk
+// =============================================================================
+BOOST_AUTO_TEST_CASE(statedb_snapshots_and_diffs)
+{
+    CKHUStateDB db(1 << 22, true /* fMemory */, true /* fWipe */);
+    const int nBlocks = KHU_STATE_SNAPSHOT_INTERVAL * 2 + 50;
+
+    std::vector<HuGlobalState> vStates;
+    HuGlobalState state;
+    state.SetNull();
+    for (int nHeight = 0; nHeight <= nBlocks; nHeight++) {
+        HuGlobalState prev = state;
+        state.nHeight = nHeight;
+        state.hashBlock = uint256S(strprintf("%x", nHeight + 1));
+        state.hashPrevState = nHeight > 0 ? prev.GetHash() : uint256();
+        state.C += COIN;
+        state.U += COIN;
+        if (nHeight % 7 == 0) state.T += nHeight;
+        if (nHeight % 100 == 0) state.yield_index += 12345;
+        vStates.push_back(state);
+
+        CKHUDBScopedCommitter khuTx({&db});
+        BOOST_CHECK(db.WriteKHUState(nHeight, state));
+        khuTx.Commit();
+    }
+    BOOST_CHECK(db.CommitRootTransaction(uint256S("0x01")));
+
+    // A rolled back block evicts every cached state: reads below come from disk
+    {
+        CKHUDBScopedCommitter khuTx({&db});
+        BOOST_CHECK(db.WriteKHUState(nBlocks + 1, state));
+    }
+    BOOST_CHECK(!db.ExistsKHUState(nBlocks + 1));
+
+    for (int nHeight : {nBlocks, 0, 1, KHU_STATE_SNAPSHOT_INTERVAL - 1, KHU_STATE_SNAPSHOT_INTERVAL,
+                        KHU_STATE_SNAPSHOT_INTERVAL + 1, nBlocks - 1, 1234}) {
+        HuGlobalState loaded;
+        BOOST_CHECK(db.ReadKHUState(nHeight, loaded));
+        BOOST_CHECK(loaded.GetHash() == vStates[nHeight].GetHash());
+        BOOST_CHECK_EQUAL(loaded.nHeight, (uint32_t)nHeight);
+        BOOST_CHECK_EQUAL(loaded.T, vStates[nHeight].T);
+    }
+
+    // Reorg: the erased tip is gone, its parent still reads back
+    {
+        CKHUDBScopedCommitter khuTx({&db});
+        BOOST_CHECK(db.EraseKHUState(nBlocks));
+        khuTx.Commit();
+    }
+    HuGlobalState loaded;
+    BOOST_CHECK(!db.ReadKHUState(nBlocks, loaded));
+    BOOST_CHECK(db.ReadKHUState(nBlocks - 1, loaded));
+    BOOST_CHECK(loaded.GetHash() == vStates[nBlocks - 1].GetHash());
+}
+
+
+// =============================================================================
+// Test 10: ZKHU commitment index - witnesses match a full tree rebuild
+// =============================================================================
+BOOST_AUTO_TEST_CASE(zkhu_witness_index)
+{
+    BOOST_REQUIRE(InitZKHUDB(1 << 20, true, true /* fMemory */));
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+    ClearZKHUWitnessCache();
+
+    // Blocks 100..107 with 3 commitments each (none at 104), the note is
+    // the second commitment of block 101
+    const uint32_t nFirstHeight = 100;
+    const uint32_t nLastHeight = 107;
+    const uint32_t nNoteHeight = 101;
+    SaplingMerkleTree refTree;
+    SaplingWitness refWitness;
+    bool fNoteSeen = false;
+    uint256 cmNote;
+    std::map<uint32_t, uint256> mapRoots;
+    uint64_t nNextCm = 1;
+    for (uint32_t nHeight = nFirstHeight; nHeight <= nLastHeight; nHeight++) {
+        ZKHUBlockCommitments cms;
+        cms.nStartPosition = refTree.size();
+        for (int i = 0; nHeight != 104 && i < 3; i++) {
+            const uint256 cm = ArithToUint256(arith_uint256(nNextCm++));
+            cms.vCommitments.push_back(cm);
+            refTree.append(cm);
+            if (fNoteSeen) refWitness.append(cm);
+            if (nHeight == nNoteHeight && i == 1) {
+                cmNote = cm;
+                refWitness = refTree.witness();
+                fNoteSeen = true;
+                ZKHUNotePosition pos;
+                pos.nHeight = nHeight;
+                pos.nPosition = refTree.size() - 1;
+                pos.tree = refTree;
+                BOOST_CHECK(zkhuDB->WriteNotePosition(cm, pos));
+            }
+        }
+        if (!cms.vCommitments.empty()) {
+            BOOST_CHECK(zkhuDB->WriteBlockCommitments(nHeight, cms));
+        }
+        mapRoots[nHeight] = refTree.root();
+    }
+    BOOST_CHECK(refWitness.root() == refTree.root());
+
+    // Unknown note, or tip below the note
+    SaplingWitness witness;
+    BOOST_CHECK(!GetZKHUNoteWitness(ArithToUint256(arith_uint256(999)), nLastHeight, mapRoots[nLastHeight], witness));
+    BOOST_CHECK(!GetZKHUNoteWitness(cmNote, nFirstHeight, mapRoots[nFirstHeight], witness));
+
+    // From the note, then advanced from the cache
+    BOOST_CHECK(GetZKHUNoteWitness(cmNote, 103, mapRoots[103], witness));
+    BOOST_CHECK(witness.root() == mapRoots[103]);
+    BOOST_CHECK_EQUAL(witness.position(), 4U);
+    BOOST_CHECK(witness.element() == cmNote);
+    BOOST_CHECK(GetZKHUNoteWitness(cmNote, nLastHeight, mapRoots[nLastHeight], witness));
+    BOOST_CHECK(witness == refWitness);
+
+    // A wrong root is refused
+    BOOST_CHECK(!GetZKHUNoteWitness(cmNote, nLastHeight, mapRoots[106], witness));
+
+    // A hole in the index is detected
+    BOOST_CHECK(zkhuDB->EraseBlockCommitments(105));
+    ClearZKHUWitnessCache();
+    BOOST_CHECK(!GetZKHUNoteWitness(cmNote, nLastHeight, mapRoots[nLastHeight], witness));
+    BOOST_CHECK(GetZKHUNoteWitness(cmNote, 104, mapRoots[104], witness));
+
+    // Reset the in-memory ZKHU DB for other suites
+    ClearZKHUWitnessCache();
+    BOOST_CHECK(InitZKHUDB(1 << 20, true, true));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
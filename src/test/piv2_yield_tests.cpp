@@ -11,14 +11,19 @@
  *   3. R% rate application
  *   4. Cr/Ur accumulation
  *   5. No yield before maturity
+ *   6. Yield accumulator (global index, maturity buckets, undo)
  *
  * Key formula:
  *   daily_yield = (principal * R_annual) / 10000 / 365
  */
 
 #include "piv2/piv2_state.h"
+#include "piv2/piv2_validation.h"
 #include "piv2/piv2_yield.h"
+#include "piv2/zkpiv2_db.h"
+#include "piv2/zkpiv2_note.h"
 #include "amount.h"
+#include "random.h"
 #include "test/test_pivx.h"
 
 #include <boost/test/unit_test.hpp>
@@ -235,4 +240,122 @@ BOOST_AUTO_TEST_CASE(yield_with_different_rates)
     BOOST_CHECK(yield10pct <= yield1pct * 10 + 10);
 }
 
+// =============================================================================
+// Test 7: Yield accumulator - O(1) epochs, per-note bonus at UNLOCK, undo
+// =============================================================================
+BOOST_AUTO_TEST_CASE(yield_accumulator_index)
+{
+    BOOST_REQUIRE(InitZKHUDB(1 << 20, true, true /* fMemory */));
+
+    const uint32_t interval = khu_yield::GetYieldInterval();
+    const uint32_t maturity = khu_yield::GetMaturityBlocks();
+    const uint32_t V6 = interval;
+    const uint32_t R_annual = 4000;
+
+    HuGlobalState state;
+    state.SetNull();
+    state.R_annual = R_annual;
+
+    // Note A matures before note B by one interval
+    ZKHUNoteData noteA(1000 * COIN, V6 + 1, 0, GetRandHash(), GetRandHash());
+    ZKHUNoteData noteB(250 * COIN, V6 + 1 + interval, 0, GetRandHash(), GetRandHash());
+    BOOST_CHECK(khu_yield::AddNoteToYieldIndex(noteA, state));
+    BOOST_CHECK(khu_yield::AddNoteToYieldIndex(noteB, state));
+    state.Z = state.C = noteA.amount + noteB.amount;
+    BOOST_CHECK_EQUAL(state.yield_mature_amount, 0);
+
+    // 10 epochs: V6, V6 + interval, ..., V6 + 9 * interval
+    const int nEpochs = 10;
+    uint32_t nHeight = V6;
+    for (int i = 0; i < nEpochs; i++, nHeight += interval) {
+        BOOST_CHECK(khu_yield::ApplyDailyYield(state, nHeight, V6));
+        BOOST_CHECK(state.CheckInvariants());
+    }
+    const uint32_t nLastYield = nHeight - interval;
+    BOOST_CHECK_EQUAL(state.last_yield_update_height, nLastYield);
+    BOOST_CHECK_EQUAL(state.yield_mature_amount, noteA.amount + noteB.amount);
+
+    // Epochs counted: first epoch at or after maturity through the last one
+    const int nEpochsA = (nLastYield - khu_yield::GetNoteMaturityHeight(noteA)) / interval + 1;
+    const int nEpochsB = (nLastYield - khu_yield::GetNoteMaturityHeight(noteB)) / interval + 1;
+    BOOST_CHECK_EQUAL(nEpochsA, nEpochsB + 1);
+    BOOST_CHECK_EQUAL(nEpochsA, nEpochs - (int)(maturity / interval) - 1);
+
+    CAmount yieldA = 0, yieldB = 0;
+    BOOST_CHECK(khu_yield::GetNoteYield(noteA, state, yieldA));
+    BOOST_CHECK(khu_yield::GetNoteYield(noteB, state, yieldB));
+
+    // Matches the per-note daily formula up to rounding (1 satoshi per epoch)
+    const CAmount dailyA = khu_yield::CalculateDailyYieldForNote(noteA.amount, R_annual);
+    const CAmount dailyB = khu_yield::CalculateDailyYieldForNote(noteB.amount, R_annual);
+    BOOST_CHECK(std::abs(yieldA - dailyA * nEpochsA) <= nEpochsA);
+    BOOST_CHECK(std::abs(yieldB - dailyB * nEpochsB) <= nEpochsB);
+
+    // The pool always covers every claim; only rounding dust remains
+    BOOST_CHECK(yieldA + yieldB <= state.Cr);
+    BOOST_CHECK(state.Cr - (yieldA + yieldB) <= nEpochs);
+
+    // UNLOCK of B removes its principal from the index
+    BOOST_CHECK(khu_yield::RemoveNoteFromYieldIndex(noteB, state));
+    BOOST_CHECK_EQUAL(state.yield_mature_amount, noteA.amount);
+
+    // Undo of the last epoch restores the index: A loses exactly one epoch
+    const uint64_t indexBefore = state.yield_index;
+    BOOST_CHECK(khu_yield::UndoDailyYield(state, nLastYield, V6));
+    BOOST_CHECK_EQUAL(state.yield_index, indexBefore - khu_yield::GetYieldIndexIncrement(R_annual));
+    BOOST_CHECK_EQUAL(state.last_yield_update_height, nLastYield - interval);
+
+    CAmount yieldAUndo = 0;
+    BOOST_CHECK(khu_yield::GetNoteYield(noteA, state, yieldAUndo));
+    BOOST_CHECK(std::abs(yieldAUndo - dailyA * (nEpochsA - 1)) <= nEpochsA - 1);
+
+    // A note that never reached an epoch earns nothing
+    ZKHUNoteData noteC(500 * COIN, nLastYield, 0, GetRandHash(), GetRandHash());
+    BOOST_CHECK(khu_yield::AddNoteToYieldIndex(noteC, state));
+    CAmount yieldC = -1;
+    BOOST_CHECK(khu_yield::GetNoteYield(noteC, state, yieldC));
+    BOOST_CHECK_EQUAL(yieldC, 0);
+    BOOST_CHECK(khu_yield::RemoveNoteFromYieldIndex(noteC, state));
+
+    // Reset the in-memory ZKHU DB for other suites
+    BOOST_CHECK(InitZKHUDB(1 << 20, true, true));
+}
+
+BOOST_AUTO_TEST_CASE(yield_accumulator_consistency_check)
+{
+    BOOST_REQUIRE(InitZKHUDB(1 << 20, true, true /* fMemory */));
+    CZKHUTreeDB* zkhuDB = GetZKHUDB();
+
+    const uint32_t interval = khu_yield::GetYieldInterval();
+    const uint32_t V6 = interval;
+
+    HuGlobalState state;
+    state.SetNull();
+    state.R_annual = 4000;
+
+    // Notes maturing at various heights, streamed back by CheckYieldIndex
+    for (uint32_t i = 0; i < 50; i++) {
+        ZKHUNoteData note((100 + i) * COIN, V6 + 1 + i * 97, 0, GetRandHash(), GetRandHash());
+        BOOST_CHECK(zkhuDB->WriteNote(note.cm, note));
+        BOOST_CHECK(khu_yield::AddNoteToYieldIndex(note, state));
+        state.Z += note.amount;
+    }
+    state.C = state.Z;
+    BOOST_CHECK(khu_yield::CheckYieldIndex(state));
+
+    for (uint32_t nHeight = V6; nHeight <= V6 + 6 * interval; nHeight += interval) {
+        BOOST_CHECK(khu_yield::ApplyDailyYield(state, nHeight, V6));
+        BOOST_CHECK(khu_yield::CheckYieldIndex(state));
+    }
+    BOOST_CHECK(state.yield_mature_amount > 0);
+    BOOST_CHECK(state.yield_mature_amount < state.Z);
+
+    // A mismatch between state and note set is detected
+    HuGlobalState badState = state;
+    badState.yield_mature_amount -= 1;
+    BOOST_CHECK(!khu_yield::CheckYieldIndex(badState));
+
+    BOOST_CHECK(InitZKHUDB(1 << 20, true, true));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 
 #include "blockassembler.h"
 #include "consensus/merkle.h"
+#include "crypto/sha256.h"
 #include "guiinterface.h"
 #include "evo/deterministicmns.h"
 #include "evo/evodb.h"
@@ -17,6 +18,7 @@
 #include "rpc/server.h"
 #include "rpc/register.h"
 #include "piv2_chainwork.h"
+#include "sapling/sapling_proofcache.h"
 #include "script/sigcache.h"
 #include "sporkdb.h"
 #include "streams.h"
@@ -67,9 +69,11 @@ std::ostream& operator<<(std::ostream& os, const uint256& num)
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
     : m_path_root{fs::temp_directory_path() / "test_pivx" / std::to_string(g_insecure_rand_ctx_temp_path.rand32())}
 {
+    SHA256AutoDetect();
     ECC_Start();
     SetupEnvironment();
     InitSignatureCache();
+    InitShieldedProofCache();
     fCheckBlockIndex = true;
     SelectParams(chainName);
     SeedInsecureRand();
@@ -121,6 +125,7 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
         pblocktree.reset(new CBlockTreeDB(1 << 20, true));
         pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
         pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
+        LoadMoneySupply();
         if (!LoadGenesisBlock()) {
             throw std::runtime_error("Error initializing block database");
         }
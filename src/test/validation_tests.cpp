@@ -4,6 +4,7 @@
 
 #include "test/test_pivx.h"
 #include "blockassembler.h"
+#include "moneysupply.h"
 #include "primitives/transaction.h"
 #include "sapling/sapling_validation.h"
 #include "test/librust/utiltest.h"
@@ -95,4 +96,39 @@ BOOST_FIXTURE_TEST_CASE(test_simple_shielded_invalid, TestingSetup)
 }
 
 
+BOOST_FIXTURE_TEST_CASE(money_supply_incremental, TestChain100Setup)
+{
+    // Maintained by block connection, equal to a full scan of the flushed UTXO set
+    FlushStateToDisk();
+    BOOST_CHECK(MoneySupply.IsValid());
+    BOOST_CHECK_EQUAL(MoneySupply.GetCacheHeight(), 100);
+    const CAmount nSupplyTip = MoneySupply.Get();
+    BOOST_CHECK_EQUAL(nSupplyTip, pcoinsTip->GetTotalAmount());
+
+    // Written with the chainstate, for its best block
+    uint256 hashSupplyBlock;
+    CAmount nStoredSupply = 0;
+    BOOST_CHECK(pcoinsdbview->ReadMoneySupply(hashSupplyBlock, nStoredSupply));
+    BOOST_CHECK(hashSupplyBlock == pcoinsTip->GetBestBlock());
+    BOOST_CHECK_EQUAL(nStoredSupply, nSupplyTip);
+    BOOST_CHECK(LoadMoneySupply());
+
+    // Disconnecting the tip takes its coinbase out
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    FlushStateToDisk();
+    BOOST_CHECK_EQUAL(MoneySupply.GetCacheHeight(), 99);
+    BOOST_CHECK_EQUAL(MoneySupply.Get(), nSupplyTip - coinbaseTxns.back().GetValueOut());
+    BOOST_CHECK_EQUAL(MoneySupply.Get(), pcoinsTip->GetTotalAmount());
+
+    // Full scan check: agrees, then corrects a drift
+    BOOST_CHECK(VerifyMoneySupply());
+    MoneySupply.Adjust(1);
+    BOOST_CHECK(!VerifyMoneySupply());
+    BOOST_CHECK_EQUAL(MoneySupply.Get(), pcoinsTip->GetTotalAmount());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -70,7 +70,9 @@ void InitTierTwoPreChainLoad(bool fReindex)
 
     // Initialize DAO manager
     g_daoManager = std::make_unique<CDAOManager>();
-    g_daoManager->Load();
+    if (!g_daoManager->Load(1 << 20, fReindex)) { // 1 MB cache
+        g_daoManager.reset();
+    }
 }
 
 void InitTierTwoPostCoinsCacheLoad(CScheduler* scheduler)
@@ -273,11 +275,8 @@ void DeleteTierTwo()
     deterministicMNManager.reset();
     evoDb.reset();
 
-    // Cleanup DAO manager
-    if (g_daoManager) {
-        g_daoManager->Save();
-        g_daoManager.reset();
-    }
+    // Cleanup DAO manager (payout markers were flushed with the KHU databases)
+    g_daoManager.reset();
 }
 
 void InterruptTierTwo()
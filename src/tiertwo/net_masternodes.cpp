@@ -32,11 +32,43 @@ void TierTwoConnMan::addPendingProbeConnections(const std::set<uint256>& proTxHa
     masternodePendingProbes.insert(proTxHashes.begin(), proTxHashes.end());
 }
 
+void TierTwoConnMan::setQuorumRelayMembers(const std::set<uint256>& proTxHashes)
+{
+    // Open the missing connections, the peers already connected through MNAUTH are kept as they are
+    // (gathered before taking cs_vPendingMasternodes, the maintenance locks it inside ForEachNode)
+    std::set<uint256> connected;
+    connman->ForEachNode([&](const CNode* pnode) {
+        LOCK(pnode->cs_mnauth);
+        if (!pnode->verifiedProRegTxHash.IsNull() && !pnode->fDisconnect) {
+            connected.emplace(pnode->verifiedProRegTxHash);
+        }
+    });
+
+    LOCK(cs_vPendingMasternodes);
+    masternodeQuorumRelayMembers = proTxHashes;
+    if (local_dmn_pro_tx_hash) {
+        masternodeQuorumRelayMembers.erase(*local_dmn_pro_tx_hash);
+    }
+    for (const uint256& proTxHash : masternodeQuorumRelayMembers) {
+        if (!connected.count(proTxHash) &&
+            std::find(vPendingMasternodes.begin(), vPendingMasternodes.end(), proTxHash) == vPendingMasternodes.end()) {
+            vPendingMasternodes.emplace_back(proTxHash);
+        }
+    }
+}
+
+bool TierTwoConnMan::isQuorumRelayMember(const uint256& proTxHash) const
+{
+    LOCK(cs_vPendingMasternodes);
+    return masternodeQuorumRelayMembers.count(proTxHash) > 0;
+}
+
 void TierTwoConnMan::clear()
 {
     LOCK(cs_vPendingMasternodes);
     vPendingMasternodes.clear();
     masternodePendingProbes.clear();
+    masternodeQuorumRelayMembers.clear();
 }
 
 void TierTwoConnMan::start(CScheduler& scheduler, const TierTwoConnMan::Options& options)
@@ -230,6 +262,9 @@ static void ProcessMasternodeConnections(CConnman& connman, TierTwoConnMan& tier
         if (pnode->fInbound) return;
         // we're not disconnecting masternode probes for at least a few seconds
         if (pnode->m_masternode_probe_connection && GetSystemTimeInSeconds() - pnode->nTimeConnected < 5) return;
+        // we're keeping the connections to the members of our HU quorum (signature relay)
+        if (!pnode->m_masternode_probe_connection &&
+            tierTwoConnMan.isQuorumRelayMember(WITH_LOCK(pnode->cs_mnauth, return pnode->verifiedProRegTxHash))) return;
 
         if (fLogIPs) {
             LogPrintf("Closing Masternode connection: peer=%d, addr=%s\n", pnode->GetId(), pnode->addr.ToString());
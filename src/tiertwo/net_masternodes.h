@@ -11,6 +11,7 @@
 #include "threadinterrupt.h"
 #include "uint256.h"
 
+#include <set>
 #include <thread>
 
 class CAddress;
@@ -35,6 +36,13 @@ public:
     // Adds the DMNs to the pending to probe list
     void addPendingProbeConnections(const std::set<uint256>& proTxHashes);
 
+    // Set the members of the HU quorum the local DMN belongs to: connections to them are
+    // opened (if missing) and kept by the maintenance, signatures are pushed over them
+    void setQuorumRelayMembers(const std::set<uint256>& proTxHashes);
+
+    // Whether the DMN is a member of the local DMN's HU quorum
+    bool isQuorumRelayMember(const uint256& proTxHash) const;
+
     // Set the local DMN so the node does not try to connect to himself
     void setLocalDMN(const uint256& pro_tx_hash) { WITH_LOCK(cs_vPendingMasternodes, local_dmn_pro_tx_hash = pro_tx_hash;); }
 
@@ -54,6 +62,7 @@ private:
     mutable RecursiveMutex cs_vPendingMasternodes;
     std::vector<uint256> vPendingMasternodes GUARDED_BY(cs_vPendingMasternodes);
     std::set<uint256> masternodePendingProbes GUARDED_BY(cs_vPendingMasternodes);
+    std::set<uint256> masternodeQuorumRelayMembers GUARDED_BY(cs_vPendingMasternodes);
 
     // The local DMN
     Optional<uint256> local_dmn_pro_tx_hash GUARDED_BY(cs_vPendingMasternodes){nullopt};
@@ -29,6 +29,7 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 // static const char DB_MONEY_SUPPLY = 'M';
+static const char DB_UTXO_SUPPLY = 'U';
 
 namespace {
 
@@ -181,6 +182,22 @@ bool CBlockTreeDB::ReadLastBlockFile(int& nFile)
     return Read(DB_LAST_BLOCK, nFile);
 }
 
+bool CCoinsViewDB::WriteMoneySupply(const uint256& hashBlock, const CAmount& nSupply)
+{
+    return db.Write(DB_UTXO_SUPPLY, std::make_pair(hashBlock, nSupply));
+}
+
+bool CCoinsViewDB::ReadMoneySupply(uint256& hashBlock, CAmount& nSupply) const
+{
+    std::pair<uint256, CAmount> supply;
+    if (!db.Read(DB_UTXO_SUPPLY, supply)) {
+        return false;
+    }
+    hashBlock = supply.first;
+    nSupply = supply.second;
+    return true;
+}
+
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
 {
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper&>(db).NewIterator(), GetBestBlock());
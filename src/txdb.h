@@ -83,6 +83,10 @@ public:
     bool Upgrade();
     size_t EstimateSize() const override;
 
+    //! Money supply (see CMoneySupply) at the given best block
+    bool WriteMoneySupply(const uint256& hashBlock, const CAmount& nSupply);
+    bool ReadMoneySupply(uint256& hashBlock, CAmount& nSupply) const;
+
     bool BatchWrite(CCoinsMap& mapCoins,
                     const uint256& hashBlock,
                     const uint256& hashSaplingAnchor,
@@ -29,7 +29,9 @@
 #include "invalid.h"
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_statedb.h"
+#include "piv2/piv2_utxo.h"
 #include "piv2/piv2_validation.h"
+#include "piv2/piv2_yield.h"
 #include "piv2/piv2_domc_tx.h"
 #include "piv2/piv2_finality.h"
 #include "piv2/piv2_signaling.h"
@@ -38,6 +40,7 @@
 #include "policy/policy.h"
 #include "piv2_chainwork.h"
 #include "reverse_iterate.h"
+#include "sapling/sapling_validation.h"
 #include "script/sigcache.h"
 #include "shutdown.h"
 #include "spork.h"
@@ -1295,7 +1298,7 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  When FAILED is returned, view is left in an indeterminate state. */
-DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false)
+DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false, CAmount* pnSupplyDelta = nullptr)
 {
     AssertLockHeld(cs_main);
 
@@ -1308,6 +1311,7 @@ DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoin
     }
 
     bool fClean = true;
+    CAmount nSupplyDelta = 0;
 
     CBlockUndo blockUndo;
     FlatFilePos pos = pindex->GetUndoPos();
@@ -1347,6 +1351,7 @@ DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoin
                 if (tx.vout[o] != coin.out) {
                     fClean = false; // transaction output mismatch
                 }
+                if (!coin.IsSpent()) nSupplyDelta -= coin.out.nValue;
             }
         }
 
@@ -1366,6 +1371,7 @@ DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoin
         }
         for (unsigned int j = tx.vin.size(); j-- > 0;) {
             const COutPoint& out = tx.vin[j].prevout;
+            nSupplyDelta += txundo.vprevout[j].out.nValue;
             int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
             if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
             fClean = fClean && res != DISCONNECT_UNCLEAN;
@@ -1413,6 +1419,7 @@ DisconnectResult DisconnectBlock(CBlock& block, const CBlockIndex* pindex, CCoin
         }
     }
 
+    if (pnSupplyDelta) *pnSupplyDelta = nSupplyDelta;
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
@@ -1441,6 +1448,15 @@ void ThreadScriptCheck()
     scriptcheckqueue.Thread();
 }
 
+// Sapling proofs take milliseconds each: hand them out in small batches
+static CCheckQueue<SaplingValidation::CProofCheck> saplingcheckqueue(4);
+
+void ThreadSaplingCheck()
+{
+    util::ThreadRename("pivx-saplingch");
+    saplingcheckqueue.Thread();
+}
+
 static int64_t nTimeVerify = 0;
 static int64_t nTimeProcessSpecial = 0;
 static int64_t nTimeConnect = 0;
@@ -1450,7 +1466,7 @@ static int64_t nTimeTotal = 0;
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
-static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false, CAmount* pnSupplyDelta = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     AssertLockHeld(cs_main);
     // Check it again in case a previous version let a bad block in
@@ -1580,6 +1596,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
     CAmount nValueOut = 0;
     CAmount nValueIn = 0;
+    CAmount nSupplyDelta = 0;
     unsigned int nMaxBlockSigOps = MAX_BLOCK_SIGOPS_CURRENT;
 
     // Sapling
@@ -1656,7 +1673,19 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
             blockundo.vtxundo.emplace_back();
         }
         const bool fSkipInvalid = SkipInvalidUTXOS(pindex->nHeight);
-        UpdateCoins(tx, view, i == 0 ? undoDummy : blockundo.vtxundo.back(), pindex->nHeight, fSkipInvalid);
+        CTxUndo& txundo = i == 0 ? undoDummy : blockundo.vtxundo.back();
+        UpdateCoins(tx, view, txundo, pindex->nHeight, fSkipInvalid);
+
+        // Money supply: value added to the UTXO set (as in AddCoins) minus value spent
+        for (size_t o = 0; o < tx.vout.size(); o++) {
+            if (!tx.vout[o].scriptPubKey.IsUnspendable() &&
+                !(fSkipInvalid && invalid_out::ContainsOutPoint(COutPoint(tx.GetHash(), o)))) {
+                nSupplyDelta += tx.vout[o].nValue;
+            }
+        }
+        for (const Coin& coin : txundo.vprevout) {
+            nSupplyDelta -= coin.out.nValue;
+        }
 
         // Sapling update tree
         if (tx.IsShieldedTx() && !tx.sapData->vShieldedOutput.empty()) {
@@ -1773,6 +1802,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
     evoDb->WriteBestBlock(pindex->GetBlockHash());
+    if (pnSupplyDelta) *pnSupplyDelta = nSupplyDelta;
 
     int64_t nTime4 = GetTimeMicros();
     nTimeIndex += nTime4 - nTime3;
@@ -1816,7 +1846,8 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode)
             nLastSetChain = nNow;
         }
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
+        // KHU_T coins share the -dbcache budget with the coins tip
+        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() + GetKHUCoinsCacheUsage();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now
         // (not in the middle of a block processing).
@@ -1826,13 +1857,15 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode)
         bool fCacheCritical = mode == FLUSH_STATE_IF_NEEDED && (unsigned) cacheSize > nCoinCacheUsage;
         // The evoDB cache is too large, time to write
         bool fEvoDbCacheCritical = mode == FLUSH_STATE_IF_NEEDED && evoDb != nullptr && evoDb->GetMemoryUsage() >= (64 << 20);
+        // The buffered KHU writes are too large, time to write
+        bool fKHUDbCacheCritical = mode == FLUSH_STATE_IF_NEEDED && GetKHUDBMemoryUsage() >= (64 << 20);
         // It's been a while since we wrote the block index to disk.
         // Do this frequently, so we don't need to redownload after a crash.
         bool fPeriodicWrite = mode == FLUSH_STATE_PERIODIC && nNow > nLastWrite + (int64_t)DATABASE_WRITE_INTERVAL * 1000000;
         // It's been very long since we flushed the cache. Do this infrequently, to optimize cache usage.
         bool fPeriodicFlush = mode == FLUSH_STATE_PERIODIC && nNow > nLastFlush + (int64_t)DATABASE_FLUSH_INTERVAL * 1000000;
         // Combine all conditions that result in a full cache flush.
-        bool fDoFullFlush = (mode == FLUSH_STATE_ALWAYS) || fCacheLarge || fCacheCritical || fEvoDbCacheCritical || fPeriodicFlush;
+        bool fDoFullFlush = (mode == FLUSH_STATE_ALWAYS) || fCacheLarge || fCacheCritical || fEvoDbCacheCritical || fKHUDbCacheCritical || fPeriodicFlush;
         // Write blocks and block index to disk.
         if (fDoFullFlush || fPeriodicWrite) {
             // Depend on nMinDiskSpace to ensure we can write block index
@@ -1879,10 +1912,14 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode)
             if (!evoDb->CommitRootTransaction()) {
                 return AbortNode(state, "Failed to commit EvoDB");
             }
+            if (!FlushKHUDBs(pcoinsTip->GetBestBlock())) {
+                return AbortNode(state, "Failed to commit KHU databases");
+            }
             nLastFlush = nNow;
-            // Update money supply on memory, reading data from disk
-            if (!ShutdownRequested() && !IsInitialBlockDownload()) {
-                MoneySupply.Update(pcoinsTip->GetTotalAmount(), chainActive.Height());
+            // Money supply of the flushed chainstate (not yet known while the first UTXO scan runs)
+            if (MoneySupply.IsValid() && !pcoinsTip->GetBestBlock().IsNull() &&
+                !pcoinsdbview->WriteMoneySupply(pcoinsTip->GetBestBlock(), MoneySupply.Get())) {
+                return AbortNode(state, "Failed to write money supply");
             }
         }
         if ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) && nNow > nLastSetChain + (int64_t)DATABASE_WRITE_INTERVAL * 1000000) {
@@ -1903,6 +1940,71 @@ void FlushStateToDisk()
     FlushStateToDisk(state, FLUSH_STATE_ALWAYS);
 }
 
+bool LoadMoneySupply()
+{
+    LOCK(cs_main);
+    const uint256& hashBestBlock = pcoinsTip->GetBestBlock();
+    if (hashBestBlock.IsNull()) {
+        // Empty chainstate (-reindex): every block is counted as it connects
+        MoneySupply.Update(0, 0);
+        return true;
+    }
+    uint256 hashSupplyBlock;
+    CAmount nSupply;
+    if (!pcoinsdbview->ReadMoneySupply(hashSupplyBlock, nSupply) || hashSupplyBlock != hashBestBlock) {
+        return false;
+    }
+    MoneySupply.Update(nSupply, chainActive.Height());
+    return true;
+}
+
+bool VerifyMoneySupply()
+{
+    // One scan at a time: each corrects the supply relative to its own snapshot
+    static Mutex cs_verify;
+    LOCK(cs_verify);
+
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    CAmount nExpected;
+    int nHeight;
+    {
+        LOCK(cs_main);
+        // The chainstate on disk, and a cursor over it, match the supply at the tip
+        FlushStateToDisk();
+        pcursor.reset(pcoinsdbview->Cursor());
+        nExpected = MoneySupply.Get();
+        nHeight = chainActive.Height();
+    }
+
+    // Scan the snapshot without cs_main
+    CAmount nTotal = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (ShutdownRequested()) return false;
+        Coin coin;
+        if (pcursor->GetValue(coin) && !coin.IsSpent()) {
+            nTotal += coin.out.nValue;
+        }
+        pcursor->Next();
+    }
+
+    const bool fWasValid = MoneySupply.IsValid();
+    MoneySupply.Adjust(nTotal - nExpected);
+    if (fWasValid && nTotal != nExpected) {
+        LogPrintf("%s: money supply at height %d was %s, UTXO set holds %s. Corrected.\n",
+                  __func__, nHeight, FormatMoney(nExpected), FormatMoney(nTotal));
+        return false;
+    }
+    LogPrintf("%s: money supply at height %d: %s\n", __func__, nHeight, FormatMoney(nTotal));
+    return true;
+}
+
+void ThreadVerifyMoneySupply()
+{
+    util::ThreadRename("pivx-supply");
+    VerifyMoneySupply();
+}
+
 /** Update chainActive and related internal data structures. */
 void static UpdateTip(CBlockIndex* pindexNew)
 {
@@ -1987,14 +2089,18 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     int64_t nStart = GetTimeMicros();
     {
         auto dbTx = evoDb->BeginTransaction();
+        auto khuTx = BeginKHUTransaction();
 
         CCoinsViewCache view(pcoinsTip.get());
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
-        if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK)
+        CAmount nSupplyDelta = 0;
+        if (DisconnectBlock(block, pindexDelete, view, false, &nSupplyDelta) != DISCONNECT_OK)
             return error("DisconnectTip() : DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
         bool flushed = view.Flush();
         assert(flushed);
+        MoneySupply.Add(nSupplyDelta, pindexDelete->nHeight - 1);
         dbTx->Commit();
+        khuTx->Commit();
     }
     LogPrint(BCLog::BENCHMARK, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     const uint256& saplingAnchorAfterDisconnect = pcoinsTip->GetBestAnchor();
@@ -2117,9 +2223,11 @@ bool static ConnectTip(CValidationState& state, CBlockIndex* pindexNew, const st
     LogPrint(BCLog::BENCHMARK, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * 0.001, nTimeReadFromDisk * 0.000001);
     {
         auto dbTx = evoDb->BeginTransaction();
+        auto khuTx = BeginKHUTransaction();
 
         CCoinsViewCache view(pcoinsTip.get());
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, false);
+        CAmount nSupplyDelta = 0;
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, false, &nSupplyDelta);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -2131,7 +2239,9 @@ bool static ConnectTip(CValidationState& state, CBlockIndex* pindexNew, const st
         LogPrint(BCLog::BENCHMARK, "  - Connect total: %.2fms [%.2fs]\n", (nTime3 - nTime2) * 0.001, nTimeConnectTotal * 0.000001);
         bool flushed = view.Flush();
         assert(flushed);
+        MoneySupply.Add(nSupplyDelta, pindexNew->nHeight);
         dbTx->Commit();
+        khuTx->Commit();
     }
     int64_t nTime4 = GetTimeMicros();
     nTimeFlush += nTime4 - nTime3;
@@ -2167,10 +2277,9 @@ bool static ConnectTip(CValidationState& state, CBlockIndex* pindexNew, const st
 
     connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
 
-    // HU Signaling: Notify that block was connected (triggers MN signing if in quorum)
-    if (g_connman) {
-        hu::NotifyBlockConnected(pindexNew, g_connman.get());
-    }
+    // HU Signaling: Notify that block was connected (finality certificate of the parent,
+    // MN signing if in quorum)
+    hu::NotifyBlockConnected(blockConnecting, pindexNew, g_connman.get());
 
     return true;
 }
@@ -2958,11 +3067,18 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, CBlockIn
     const int nHeight = pindexPrev == nullptr ? 0 : pindexPrev->nHeight + 1;
     const CChainParams& chainparams = Params();
 
+    const bool fIBD = IsInitialBlockDownload();
+
+    // Sapling proofs are verified on the Sapling check threads (callers hold cs_main,
+    // so the queue is never shared between two blocks)
+    std::vector<SaplingValidation::CProofCheck> vSaplingChecks;
+    std::vector<SaplingValidation::CProofCheck>* pvSaplingChecks = nScriptCheckThreads ? &vSaplingChecks : nullptr;
+
     // Check that all transactions are finalized
     for (const auto& tx : block.vtx) {
 
         // Check transaction contextually against consensus rules at block height
-        if (!ContextualCheckTransaction(tx, state, chainparams, nHeight, true /* isMined */, IsInitialBlockDownload())) {
+        if (!ContextualCheckTransaction(tx, state, chainparams, nHeight, true /* isMined */, fIBD, pvSaplingChecks)) {
             return false;
         }
 
@@ -2971,6 +3087,22 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, CBlockIn
         }
     }
 
+    if (!vSaplingChecks.empty()) {
+        CCheckQueueControl<SaplingValidation::CProofCheck> control(&saplingcheckqueue);
+        control.Add(vSaplingChecks);
+        if (!control.Wait()) {
+            // Invalid block: check the proofs again serially for the exact reject reason
+            for (const auto& tx : block.vtx) {
+                if (tx->hasSaplingData() &&
+                    !SaplingValidation::ContextualCheckTransaction(*tx, state, chainparams, nHeight, true /* isMined */, fIBD)) {
+                    return false;
+                }
+            }
+            return state.DoS(100, error("%s: Sapling proof verification failed", __func__),
+                             REJECT_INVALID, "bad-txns-sapling-proof-invalid");
+        }
+    }
+
     // Enforce block.nVersion=2 rule that the coinbase starts with serialized block height
     if (pindexPrev) { // pindexPrev is only null on the first block which is a version 1 block.
         CScript expect = CScript() << nHeight;
@@ -3037,6 +3169,10 @@ bool AcceptBlockHeader(const CBlock& block, CValidationState& state, CBlockIndex
         return false;
     }
 
+    // Block validation via CheckWork (headers-first sync accepts headers without their block)
+    if (hash != Params().GetConsensus().hashGenesisBlock && !CheckWork(block, pindexPrev))
+        return state.DoS(100, false, REJECT_INVALID, "bad-diffbits");
+
     if (!ContextualCheckBlockHeader(block, state, pindexPrev))
         return error("%s: ContextualCheckBlockHeader failed for block %s: %s", __func__, hash.ToString(), FormatStateMessage(state));
 
@@ -3201,18 +3337,11 @@ static bool AcceptBlock(const CBlock& block, CValidationState& state, CBlockInde
     CBlockIndex* pindexDummy = nullptr;
     CBlockIndex*& pindex = ppindex ? *ppindex : pindexDummy;
 
-    const Consensus::Params& consensus = Params().GetConsensus();
-
     // Get prev block index
     CBlockIndex* pindexPrev = nullptr;
     if (!GetPrevIndex(block, &pindexPrev, state))
         return false;
 
-    // Block validation via CheckWork (genesis and standard blocks)
-    if (block.GetHash() != consensus.hashGenesisBlock && !CheckWork(block, pindexPrev))
-        return state.DoS(100, false, REJECT_INVALID);
-
-
     if (!AcceptBlockHeader(block, state, &pindex, pindexPrev))
         return false;
 
@@ -3235,9 +3364,14 @@ static bool AcceptBlock(const CBlock& block, CValidationState& state, CBlockInde
 
     // MN-only - these checks apply to all blocks
     {
-        // Blocks arrives in order, so if prev block is not the tip then we are on a fork.
+        // Headers-first download fetches the blocks ahead of the tip in parallel, so they
+        // may arrive before their parent is connected. Their inputs are checked against the
+        // UTXO set by ConnectBlock; any other block whose prev is not the tip is on a fork.
         // Extra info: duplicated blocks are skipping this checks, so we don't have to worry about those here.
-        bool isBlockFromFork = pindexPrev != nullptr && chainActive.Tip() != pindexPrev;
+        const CBlockIndex* pindexTip = chainActive.Tip();
+        const bool isBlockAheadOfTip = pindexPrev != nullptr && pindexPrev->nHeight > pindexTip->nHeight &&
+                                       pindexPrev->GetAncestor(pindexTip->nHeight) == pindexTip;
+        bool isBlockFromFork = pindexPrev != nullptr && pindexTip != pindexPrev && !isBlockAheadOfTip;
 
         // Collect spent_outpoints and check for in-block double spends
         std::unordered_set<COutPoint, SaltedOutpointHasher> spent_outpoints;
@@ -3261,6 +3395,9 @@ static bool AcceptBlock(const CBlock& block, CValidationState& state, CBlockInde
         }
 
         // Check that all tx inputs were unspent on the active chain before the fork
+        if (isBlockAheadOfTip) {
+            spent_outpoints.clear();
+        }
         for (auto it = spent_outpoints.begin(); it != spent_outpoints.end(); /* no increment */) {
             const Coin& coin = pcoinsTip->AccessCoin(*it);
             if (!coin.IsSpent()) {
@@ -3374,6 +3511,7 @@ bool TestBlockValidity(CValidationState& state, const CBlock& block, CBlockIndex
 
     // begin tx and let it rollback
     auto dbTx = evoDb->BeginTransaction();
+    auto khuTx = BeginKHUTransaction();
 
     // NOTE: CheckBlockHeader is called by CheckBlock
     if (!ContextualCheckBlockHeader(block, state, pindexPrev))
@@ -3601,6 +3739,7 @@ bool CVerifyDB::VerifyDB(CCoinsView* coinsview, int nCheckLevel, int nCheckDepth
 
     // begin tx and let it rollback
     auto dbTx = evoDb->BeginTransaction();
+    auto khuTx = BeginKHUTransaction();
 
     // Verify blocks in the best chain
     if (nCheckDepth <= 0)
@@ -3680,6 +3819,12 @@ bool CVerifyDB::VerifyDB(CCoinsView* coinsview, int nCheckLevel, int nCheckDepth
                 return error("%s: *** found unconnectable block at %d, hash=%s", __func__, pindex->nHeight, pindex->GetBlockHash().ToString());
         }
     }
+    // KHU: the yield accumulator must match the ZKHU note set at the tip
+    HuGlobalState khuTipState;
+    if (nCheckLevel >= 2 && GetCurrentKHUState(khuTipState) && !khu_yield::CheckYieldIndex(khuTipState)) {
+        return error("%s: *** KHU yield index inconsistent with ZKHU notes at height %d", __func__, khuTipState.nHeight);
+    }
+
     LogPrintf("[DONE].\n");
     LogPrintf("No coin database inconsistencies in last %i blocks (%i transactions)\n", chainHeight - pindexState->nHeight, nGoodTransactions);
 
@@ -11,7 +11,7 @@
  * network protocol versioning
  */
 
-static const int PROTOCOL_VERSION = 70928;
+static const int PROTOCOL_VERSION = 70932;
 
 //! initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 209;
@@ -29,6 +29,18 @@ static const int MNAUTH_NODE_VER_VERSION = 70925;
 //! Version where HU ECDSA quorum was introduced
 static const int QUORUM_PROTO_VERSION = 70928;
 
+//! Version where headers-first block download (GETHEADERS/HEADERS) was introduced
+static const int HEADERS_FIRST_VERSION = 70929;
+
+//! Version where compact block relay (BIP152 cmpctblock/getblocktxn) was introduced
+static const int SHORT_IDS_BLOCKS_VERSION = 70930;
+
+//! Version where HU signatures are announced with inv (MSG_HU_SIGNATURE) instead of pushed
+static const int HUSIG_INV_VERSION = 70931;
+
+//! Version where blocks (v12+) carry the finality certificate of their parent
+static const int FINALITY_CERT_VERSION = 70932;
+
 // Make sure that none of the values above collide with
 // `ADDRV2_FORMAT`.
 
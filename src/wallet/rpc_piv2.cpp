@@ -30,8 +30,10 @@
 #include "piv2/piv2_state.h"
 #include "piv2/piv2_unlock.h"
 #include "piv2/piv2_validation.h"
+#include "piv2/piv2_yield.h"
 #include "piv2/zkpiv2_db.h"
 #include "piv2/zkpiv2_memo.h"
+#include "piv2/zkpiv2_witness.h"
 #include "streams.h"
 #include "primitives/transaction.h"
 #include "rpc/server.h"
@@ -52,11 +54,12 @@
 #include <univalue.h>
 
 /**
- * ComputeWitnessForZKHUNote - Compute witness by scanning blockchain (fallback)
+ * ComputeWitnessForZKHUNote - Compute witness outside of the wallet cache (fallback)
  *
  * When the wallet's witness cache is incomplete (e.g., after fast block generation
- * or wallet restart), this function rebuilds the witness from scratch by scanning
- * the blockchain and building the Sapling merkle tree.
+ * or wallet restart), the witness is served by the node's ZKHU commitment index
+ * (zkpiv2_witness.h). Notes confirmed before the index existed are rebuilt from
+ * the Sapling tree of the block before the note, scanning only the blocks since.
  *
  * @param targetCm Note commitment to find
  * @param targetHeight Block height where the note was created
@@ -70,15 +73,42 @@ static bool ComputeWitnessForZKHUNote(
     SaplingWitness& witnessOut,
     uint256& anchorOut)
 {
+    int nTipHeight;
+    uint256 tipRoot;
+    {
+        LOCK(cs_main);
+        nTipHeight = chainActive.Height();
+        tipRoot = chainActive.Tip()->hashFinalSaplingRoot;
+    }
+
+    if (GetZKHUNoteWitness(targetCm, nTipHeight, tipRoot, witnessOut)) {
+        anchorOut = witnessOut.root();
+        LogPrint(BCLog::HU, "ComputeWitnessForZKHUNote: Indexed witness - anchor=%s\n",
+                 anchorOut.GetHex().substr(0, 16).c_str());
+        return true;
+    }
+
     LOCK(cs_main);
 
-    // Build Sapling merkle tree from genesis up to current tip
+    // Sapling tree before the note's block (empty tree if the height is unknown)
     SaplingMerkleTree saplingTree;
+    int nStartHeight = 1;
+    if (targetHeight > 1 && targetHeight <= chainActive.Height()) {
+        const uint256& prevRoot = chainActive[targetHeight - 1]->hashFinalSaplingRoot;
+        if (!prevRoot.IsNull() && pcoinsTip->GetSaplingAnchorAt(prevRoot, saplingTree)) {
+            nStartHeight = targetHeight;
+        } else {
+            saplingTree = SaplingMerkleTree();
+        }
+    }
+    LogPrint(BCLog::HU, "ComputeWitnessForZKHUNote: Note not indexed, scanning blocks %d-%d\n",
+             nStartHeight, chainActive.Height());
+
     bool foundNote = false;
     int notePosition = -1;
 
-    // Scan blocks from beginning to find our note and build the tree
-    for (int height = 1; height <= chainActive.Height(); height++) {
+    // Scan blocks from the start height to find our note and build the tree
+    for (int height = nStartHeight; height <= chainActive.Height(); height++) {
         CBlockIndex* pindex = chainActive[height];
         if (!pindex) continue;
 
@@ -1652,8 +1682,11 @@ static UniValue khuunlock(const JSONRPCRequest& request)
     CZKHUTreeDB* zkhuDB = GetZKHUDB();
     if (zkhuDB) {
         ZKHUNoteData consensusNote;
-        if (zkhuDB->ReadNote(targetCm, consensusNote)) {
-            yieldBonus = consensusNote.Ur_accumulated;
+        HuGlobalState tipState;
+        if (zkhuDB->ReadNote(targetCm, consensusNote) && GetCurrentKHUState(tipState)) {
+            if (!khu_yield::GetNoteYield(consensusNote, tipState, yieldBonus)) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to compute note yield from consensus state");
+            }
             LogPrint(BCLog::HU, "khuunlock: Using consensus yield=%s for cm=%s\n",
                      FormatMoney(yieldBonus), targetCm.GetHex().substr(0, 16).c_str());
         } else {
@@ -1705,11 +1738,10 @@ static UniValue khuunlock(const JSONRPCRequest& request)
     SaplingWitness witness;
     bool usedFallback = false;
     if (witnesses.empty() || !witnesses[0]) {
-        // Fallback: compute witness by scanning blockchain
+        // Fallback: witness from the node's ZKHU commitment index
         // TODO: Realign ZKHU on standard Sapling note/witness pipeline
         //       (FindMySaplingNotes + IncrementNoteWitnesses)
-        //       This fallback is temporary for testing.
-        LogPrintf("khuunlock: WITNESS_SOURCE=FALLBACK (wallet cache miss), computing from blockchain...\n");
+        LogPrintf("khuunlock: WITNESS_SOURCE=FALLBACK (wallet cache miss), computing from commitment index...\n");
         usedFallback = true;
 
         if (!ComputeWitnessForZKHUNote(targetCm, targetNote->nConfirmedHeight, witness, anchor)) {
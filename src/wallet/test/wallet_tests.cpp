@@ -654,4 +654,64 @@ BOOST_AUTO_TEST_CASE(cached_balances_tests)
 
 }
 
+static std::set<uint256> GetUnspentTxs(const CWallet& wallet)
+{
+    std::set<uint256> ret;
+    wallet.ForEachUnspentTx([&](const CWalletTx& wtx) { ret.emplace(wtx.GetHash()); });
+    return ret;
+}
+
+/**
+ * Validates the index of the wallet transactions with unspent outputs:
+ * 1) A fully spent transaction is dropped from the index, the balances and
+ *    the available coins don't see it anymore.
+ * 2) Abandoning the spender brings it back.
+ */
+BOOST_AUTO_TEST_CASE(unspent_txs_index_tests)
+{
+    CAmount nCredit = 20 * COIN;
+
+    // Setup wallet
+    CWallet wallet("testWallet1", WalletDatabase::CreateMock());
+    bool fFirstRun;
+    BOOST_CHECK_EQUAL(wallet.LoadWallet(fFirstRun), DB_LOAD_OK);
+    LOCK2(cs_main, wallet.cs_wallet);
+    wallet.SetMinVersion(FEATURE_PRE_SPLIT_KEYPOOL);
+    wallet.SetupSPKM(false);
+    wallet.SetLastBlockProcessed(chainActive.Tip());
+
+    // Receive two outputs and confirm them
+    auto res = wallet.getNewAddress("receiving_address");
+    BOOST_ASSERT(res);
+    CTxOut creditOut(nCredit/2, GetScriptForDestination(*res.getObjResult()));
+    CWalletTx& wtxCredit = ReceiveBalanceWith({creditOut, creditOut}, wallet);
+    SimpleFakeMine(wtxCredit, wallet);
+    BOOST_CHECK(GetUnspentTxs(wallet) == std::set<uint256>{wtxCredit.GetHash()});
+    BOOST_CHECK_EQUAL(wallet.GetBalance().m_mine_trusted, nCredit);
+    std::vector<COutput> vCoins;
+    wallet.AvailableCoins(&vCoins);
+    BOOST_CHECK_EQUAL(vCoins.size(), 2);
+
+    // 1) Spend both outputs to an external source
+    CKey key;
+    key.MakeNewKey(true);
+    std::vector<CTxIn> vinDebit = {CTxIn(COutPoint(wtxCredit.GetHash(), 0)), CTxIn(COutPoint(wtxCredit.GetHash(), 1))};
+    std::vector<CTxOut> voutDebit = {CTxOut(nCredit, GetScriptForDestination(key.GetPubKey().GetID()))};
+    CWalletTx& wtxDebit = BuildAndLoadTxToWallet(vinDebit, voutDebit, wallet);
+    BOOST_CHECK(GetUnspentTxs(wallet).empty());
+    BOOST_CHECK_EQUAL(wallet.GetBalance().m_mine_trusted, 0);
+    BOOST_CHECK_EQUAL(wallet.GetAvailableBalance(), 0);
+    vCoins.clear();
+    wallet.AvailableCoins(&vCoins);
+    BOOST_CHECK(vCoins.empty());
+
+    // 2) The spender never made it to a block: abandon it
+    BOOST_CHECK(wallet.AbandonTransaction(wtxDebit.GetHash()));
+    BOOST_CHECK(GetUnspentTxs(wallet) == std::set<uint256>{wtxCredit.GetHash()});
+    BOOST_CHECK_EQUAL(wallet.GetBalance().m_mine_trusted, nCredit);
+    vCoins.clear();
+    wallet.AvailableCoins(&vCoins);
+    BOOST_CHECK_EQUAL(vCoins.size(), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
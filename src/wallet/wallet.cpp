@@ -888,6 +888,45 @@ void CWallet::MarkDirty()
     }
 }
 
+void CWallet::MarkUnspentTxDirty(const uint256& hash) const
+{
+    LOCK(cs_wallet);
+    setUnspentTxs.insert(hash);
+    mapBalanceCache.clear();
+}
+
+bool CWallet::HasUnspentOutputs(const CWalletTx& wtx) const
+{
+    AssertLockHeld(cs_wallet);
+    const uint256& hash = wtx.GetHash();
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        if (IsMine(wtx.tx->vout[i]) != ISMINE_NO && !IsSpent(hash, i)) {
+            return true;
+        }
+    }
+    for (const auto& it : wtx.mapSaplingNoteData) {
+        const SaplingNoteData& nd = it.second;
+        if (nd.IsMyNote() && !(nd.nullifier && m_sspk_man->IsSaplingSpent(*nd.nullifier))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CWallet::ForEachUnspentTx(const std::function<void(const CWalletTx&)>& f) const
+{
+    AssertLockHeld(cs_wallet);
+    for (auto it = setUnspentTxs.begin(); it != setUnspentTxs.end();) {
+        auto mit = mapWallet.find(*it);
+        if (mit == mapWallet.end() || !HasUnspentOutputs(mit->second)) {
+            it = setUnspentTxs.erase(it);
+            continue;
+        }
+        f(mit->second);
+        ++it;
+    }
+}
+
 bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
 {
     LOCK(cs_wallet);
@@ -1265,6 +1304,7 @@ void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx)
     auto it = mapWallet.find(ptx->GetHash());
     if (it != mapWallet.end()) {
         it->second.fInMempool = true;
+        mapBalanceCache.clear();
     }
 }
 
@@ -1273,6 +1313,9 @@ void CWallet::TransactionRemovedFromMempool(const CTransactionRef &ptx, MemPoolR
     auto it = mapWallet.find(ptx->GetHash());
     if (it != mapWallet.end()) {
         it->second.fInMempool = false;
+        // Out of the mempool and not in a block, it does not spend its inputs anymore
+        MarkAffectedTransactionsDirty(*ptx);
+        mapBalanceCache.clear();
     }
     // Handle transactions that were removed from the mempool because they
     // conflict with transactions in a newly connected block.
@@ -1314,6 +1357,7 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
         m_last_block_processed = pindex->GetBlockHash();
         m_last_block_processed_time = pindex->GetBlockTime();
         m_last_block_processed_height = pindex->nHeight;
+        mapBalanceCache.clear(); // Depths changed
         for (size_t index = 0; index < pblock->vtx.size(); index++) {
             CWalletTx::Confirmation confirm(CWalletTx::Status::CONFIRMED, m_last_block_processed_height,
                                             m_last_block_processed, index);
@@ -1371,6 +1415,7 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, con
     m_last_block_processed_height = nBlockHeight - 1;
     m_last_block_processed_time = blockTime;
     m_last_block_processed = blockHash;
+    mapBalanceCache.clear(); // Depths changed
     for (const CTransactionRef& ptx : pblock->vtx) {
         CWalletTx::Confirmation confirm(CWalletTx::Status::UNCONFIRMED, /* block_height */ 0, {}, /* nIndex */ 0);
         SyncTransaction(ptx, confirm);
@@ -2100,9 +2145,13 @@ CWallet::Balance CWallet::GetBalance(const int min_depth) const
     Balance ret;
     {
         LOCK(cs_wallet);
-        std::set<uint256> trusted_parents;
-        for (const auto& entry : mapWallet) {
-            const CWalletTx& wtx = entry.second;
+        auto it = mapBalanceCache.find(min_depth);
+        if (it != mapBalanceCache.end()) {
+            return it->second;
+        }
+        // Only the unspent outputs count: the trusted and pending balances
+        // are available credits, immature coins can't be spent yet
+        ForEachUnspentTx([&](const CWalletTx& wtx) {
             const bool is_trusted{wtx.IsTrusted()};
             const int tx_depth{wtx.GetDepthInMainChain()};
             const CAmount tx_credit_mine{wtx.GetAvailableCredit(/* fUseCache */ true, ISMINE_SPENDABLE_TRANSPARENT)};
@@ -2116,18 +2165,23 @@ CWallet::Balance CWallet::GetBalance(const int min_depth) const
                 ret.m_mine_untrusted_shielded_balance += tx_credit_shield_mine;
             }
             ret.m_mine_immature += wtx.GetImmatureCredit();
-        }
+        });
+        mapBalanceCache.emplace(min_depth, ret);
     }
     return ret;
 }
 
-CAmount CWallet::loopTxsBalance(const std::function<void(const uint256&, const CWalletTx&, CAmount&)>& method) const
+CAmount CWallet::loopTxsBalance(const std::function<void(const uint256&, const CWalletTx&, CAmount&)>& method, bool fOnlyUnspent) const
 {
     CAmount nTotal = 0;
     {
         LOCK(cs_wallet);
-        for (const auto& it : mapWallet) {
-            method(it.first, it.second, nTotal);
+        if (fOnlyUnspent) {
+            ForEachUnspentTx([&](const CWalletTx& wtx) { method(wtx.GetHash(), wtx, nTotal); });
+        } else {
+            for (const auto& it : mapWallet) {
+                method(it.first, it.second, nTotal);
+            }
         }
     }
     return nTotal;
@@ -2152,7 +2206,7 @@ CAmount CWallet::GetAvailableBalance(isminefilter& filter, bool useCache, int mi
         if (pcoin.IsTrusted(depth, fConflicted) && depth >= minDepth) {
             nTotal += pcoin.GetAvailableCredit(useCache, filter);
         }
-    });
+    }, true);
 }
 
 CAmount CWallet::GetLockedCoins() const
@@ -2207,7 +2261,7 @@ CAmount CWallet::GetImmatureBalance() const
 {
     return loopTxsBalance([](const uint256& id, const CWalletTx& pcoin, CAmount& nTotal) {
             nTotal += pcoin.GetImmatureCredit(false);
-    });
+    }, true);
 }
 
 CAmount CWallet::GetWatchOnlyBalance() const
@@ -2215,7 +2269,7 @@ CAmount CWallet::GetWatchOnlyBalance() const
     return loopTxsBalance([](const uint256& id, const CWalletTx& pcoin, CAmount& nTotal) {
             if (pcoin.IsTrusted())
                 nTotal += pcoin.GetAvailableWatchOnlyCredit();
-    });
+    }, true);
 }
 
 CAmount CWallet::GetUnconfirmedWatchOnlyBalance() const
@@ -2223,14 +2277,14 @@ CAmount CWallet::GetUnconfirmedWatchOnlyBalance() const
     return loopTxsBalance([](const uint256& id, const CWalletTx& pcoin, CAmount& nTotal) {
             if (!pcoin.IsTrusted() && pcoin.GetDepthInMainChain() == 0 && pcoin.InMempool())
                 nTotal += pcoin.GetAvailableWatchOnlyCredit();
-    });
+    }, true);
 }
 
 CAmount CWallet::GetImmatureWatchOnlyBalance() const
 {
     return loopTxsBalance([](const uint256& id, const CWalletTx& pcoin, CAmount& nTotal) {
             nTotal += pcoin.GetImmatureWatchOnlyCredit();
-    });
+    }, true);
 }
 
 // Calculate total balance in a different way from GetBalance. The biggest
@@ -2442,9 +2496,16 @@ bool CWallet::AvailableCoins(std::vector<COutput>* pCoins,      // --> populates
     {
         LOCK(cs_wallet);
         CAmount nTotal = 0;
-        for (const auto& entry : mapWallet) {
-            const uint256& wtxid = entry.first;
-            const CWalletTx* pcoin = &entry.second;
+        // Spent transactions are skipped without looking at their outputs
+        for (auto uit = setUnspentTxs.begin(); uit != setUnspentTxs.end();) {
+            auto mit = mapWallet.find(*uit);
+            if (mit == mapWallet.end() || !HasUnspentOutputs(mit->second)) {
+                uit = setUnspentTxs.erase(uit);
+                continue;
+            }
+            ++uit;
+            const uint256& wtxid = mit->first;
+            const CWalletTx* pcoin = &mit->second;
 
             // Check if the tx is selectable
             int nDepth = 0;
@@ -3559,36 +3620,42 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.insert(output);
+    mapBalanceCache.clear();
 }
 
 void CWallet::LockNote(const SaplingOutPoint& op)
 {
     AssertLockHeld(cs_wallet); // setLockedNotes
     setLockedNotes.insert(op);
+    mapBalanceCache.clear();
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.erase(output);
+    mapBalanceCache.clear();
 }
 
 void CWallet::UnlockNote(const SaplingOutPoint& op)
 {
     AssertLockHeld(cs_wallet); // setLockedNotes
     setLockedNotes.erase(op);
+    mapBalanceCache.clear();
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.clear();
+    mapBalanceCache.clear();
 }
 
 void CWallet::UnlockAllNotes()
 {
     AssertLockHeld(cs_wallet); // setLockedNotes
     setLockedNotes.clear();
+    mapBalanceCache.clear();
 }
 
 bool CWallet::IsLockedCoin(const uint256& hash, unsigned int n) const
@@ -4431,6 +4498,9 @@ void CWalletTx::MarkDirty()
     nShieldedChangeCached = 0;
     fShieldedChangeCached = false;
     fTxVoided = false;
+    if (pwallet && tx) {
+        pwallet->MarkUnspentTxDirty(GetHash());
+    }
 }
 
 void CWalletTx::BindWallet(CWallet* pwalletIn)
@@ -647,6 +647,7 @@ public:
         m_last_block_processed_height = pindex->nHeight;
         m_last_block_processed = pindex->GetBlockHash();
         m_last_block_processed_time = pindex->GetBlockTime();
+        mapBalanceCache.clear();
     };
 
     /* SPKM Helpers */
@@ -704,6 +705,16 @@ public:
 
     std::map<uint256, CWalletTx> mapWallet;
 
+    /**
+     * Index of the transactions with an output or a note of ours not spent
+     * yet: the only ones that can add to a balance or be selected as coins.
+     * A transaction is (re)inserted every time its balance caches are marked
+     * dirty, which is what happens when one of its spends is confirmed,
+     * conflicted, abandoned or leaves the mempool. The fully spent ones are
+     * pruned by ForEachUnspentTx. Protected by cs_wallet.
+     */
+    mutable std::set<uint256> setUnspentTxs;
+
     typedef std::multimap<int64_t, CWalletTx*> TxItems;
     TxItems wtxOrdered;
 
@@ -951,6 +962,12 @@ public:
     int64_t IncOrderPosNext(WalletBatch* batch = nullptr);
 
     void MarkDirty();
+    /** Called when the balance caches of a transaction are reset: re-index it, drop the cached balances */
+    void MarkUnspentTxDirty(const uint256& hash) const;
+    /** Whether an output or a note of ours in wtx is not spent yet */
+    bool HasUnspentOutputs(const CWalletTx& wtx) const;
+    /** Call f on every transaction of setUnspentTxs, in txid order, pruning the fully spent ones */
+    void ForEachUnspentTx(const std::function<void(const CWalletTx&)>& f) const;
     bool AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose = true);
     bool LoadToWallet(CWalletTx& wtxIn);
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
@@ -980,8 +997,10 @@ public:
         CAmount m_mine_untrusted_shielded_balance{0}; //!< Untrusted shield, but in mempool (pending)
     };
     Balance GetBalance(int min_depth = 0) const;
+    //! GetBalance() results by min_depth, until a transaction or the chain tip changes. Protected by cs_wallet.
+    mutable std::map<int, Balance> mapBalanceCache;
 
-    CAmount loopTxsBalance(const std::function<void(const uint256&, const CWalletTx&, CAmount&)>&method) const;
+    CAmount loopTxsBalance(const std::function<void(const uint256&, const CWalletTx&, CAmount&)>&method, bool fOnlyUnspent = false) const;
     CAmount GetAvailableBalance(bool fIncludeExternal = true, bool fIncludeShielded = true) const;
     CAmount GetAvailableBalance(isminefilter& filter, bool useCache = false, int minDepth = 1) const;
     CAmount GetLockedCoins() const;
@@ -38,6 +38,7 @@ MY_RELAY = 1  # from version 70001 onwards, fRelay should be appended to version
 MAX_INV_SZ = 50000
 MAX_BLOCK_BASE_SIZE = 2000000
 CURRENT_BLK_VERSION = 11
+FINALITY_CERT_BLK_VERSION = 12
 
 COIN = 100000000  # 1 PIV in satoshis
 
@@ -660,6 +661,12 @@ class CBlock(CBlockHeader):
             r += ser_vector(self.vtx, "serialize_without_witness")
             if hasattr(self, 'vchBlockSig'):
                 r += ser_string(self.vchBlockSig)
+            elif self.nVersion >= FINALITY_CERT_BLK_VERSION:
+                r += ser_string(b"")
+            if self.nVersion >= FINALITY_CERT_BLK_VERSION:
+                # empty finality certificate: no signer, no signature
+                r += struct.pack("<Q", 0)
+                r += ser_string_vector([])
         return r
 
     # Calculate the merkle root given a vector of transaction hashes